@@ -0,0 +1,589 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AtlasPacker.cpp
+ * File Function: 纹理图集打包实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+constexpr int AtlasPacker::kMaxPageSize;
+constexpr int AtlasPacker::kMinPageSize;
+constexpr int AtlasPacker::kMaxFrameSize;
+constexpr int AtlasPacker::kPadding;
+constexpr double AtlasPacker::kMaxPaletteError;
+
+namespace
+{
+
+/** @brief 按 '/' 拆分路径 */
+std::vector<std::string> splitPath(const std::string& path)
+{
+    std::vector<std::string> parts;
+    std::string              part;
+    std::istringstream       stream(path);
+    while (std::getline(stream, part, '/'))
+    {
+        if (!part.empty())
+            parts.push_back(part);
+    }
+    return parts;
+}
+
+/** @brief 分组名只保留小写字母、数字和下划线 */
+std::string sanitize(const std::string& name)
+{
+    std::string result;
+    for (char c : name)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        result += std::isalnum(uc) ? static_cast<char>(std::tolower(uc)) : '_';
+    }
+    return result;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** @brief XML 转义（帧名来自文件名） */
+std::string escapeXml(const std::string& text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '&':
+            result += "&amp;";
+            break;
+        case '<':
+            result += "&lt;";
+            break;
+        case '>':
+            result += "&gt;";
+            break;
+        default:
+            result += c;
+            break;
+        }
+    }
+    return result;
+}
+
+/** @brief JSON 字符串转义 */
+std::string escapeJson(const std::string& text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+/** @brief 候选页尺寸（2 的幂，长宽比不超过 2:1），按面积从小到大 */
+std::vector<std::pair<int, int>> candidatePageSizes()
+{
+    std::vector<std::pair<int, int>> sizes;
+    for (int w = AtlasPacker::kMinPageSize; w <= AtlasPacker::kMaxPageSize; w *= 2)
+    {
+        for (int h = AtlasPacker::kMinPageSize; h <= AtlasPacker::kMaxPageSize; h *= 2)
+        {
+            if (w <= h * 2 && h <= w * 2)
+                sizes.emplace_back(w, h);
+        }
+    }
+    std::stable_sort(sizes.begin(), sizes.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first * a.second < b.first * b.second;
+    });
+    return sizes;
+}
+
+/**
+ * @struct PaletteColor
+ * @brief 量化用的一种颜色（预乘后的 RGBA）及其像素数
+ */
+struct PaletteColor
+{
+    uint32_t rgba  = 0;   ///< 原始颜色（非预乘，按内存顺序 R G B A 打包）
+    double   v[4]  = {0}; ///< 预乘坐标
+    double   count = 0;   ///< 像素数
+};
+
+/**
+ * @struct PaletteBox
+ * @brief 中位切分中的一个颜色盒（colors 中的 [begin, end)）
+ */
+struct PaletteBox
+{
+    size_t begin   = 0;
+    size_t end     = 0;
+    double error   = 0; ///< 盒内平方误差和，越大越优先切分
+    int    channel = 0; ///< 方差最大的通道
+};
+
+/** @brief 计算盒内平方误差和方差最大的通道 */
+void measureBox(const std::vector<PaletteColor>& colors, PaletteBox& box)
+{
+    double sum[4] = {0}, sumSq[4] = {0}, weight = 0;
+    for (size_t i = box.begin; i < box.end; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            sum[c] += colors[i].v[c] * colors[i].count;
+            sumSq[c] += colors[i].v[c] * colors[i].v[c] * colors[i].count;
+        }
+        weight += colors[i].count;
+    }
+
+    box.error          = 0;
+    double maxVariance = -1;
+    for (int c = 0; c < 4; ++c)
+    {
+        double variance = sumSq[c] - sum[c] * sum[c] / weight;
+        box.error += variance;
+        if (variance > maxVariance)
+        {
+            maxVariance = variance;
+            box.channel = c;
+        }
+    }
+    if (box.end - box.begin < 2)
+        box.error = 0;
+}
+
+/** @brief 平方距离（预乘空间） */
+double distanceSq(const double* a, const double* b)
+{
+    double d = 0;
+    for (int c = 0; c < 4; ++c)
+        d += (a[c] - b[c]) * (a[c] - b[c]);
+    return d;
+}
+
+/** @brief 最近的调色板项（跳过第 0 项的全透明） */
+size_t nearestEntry(const double* color, const std::vector<std::array<double, 4>>& entries)
+{
+    size_t best     = 1;
+    double bestDist = distanceSq(color, entries[1].data());
+    for (size_t k = 2; k < entries.size(); ++k)
+    {
+        double d = distanceSq(color, entries[k].data());
+        if (d < bestDist)
+        {
+            bestDist = d;
+            best     = k;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+std::string AtlasPacker::groupForPath(const std::string& path)
+{
+    if (!endsWith(path, ".png"))
+        return std::string();
+
+    std::vector<std::string> parts = splitPath(path);
+    if (parts.size() == 2 && parts[0] == "icon")
+        return "ui";
+    if (parts.size() == 2 && parts[0] == "units" && parts[1].find("_select_button_") != std::string::npos)
+        return "ui";
+    if (parts.size() == 3 && parts[0] == "units")
+        return "units_" + sanitize(parts[1]);
+    if (parts.size() == 3 && parts[0] == "buildings")
+        return "buildings_" + sanitize(parts[1]);
+    return std::string();
+}
+
+void AtlasPacker::placeShelves(const std::vector<AtlasSourceImage>& images, int width, int height, AtlasPage& page,
+                               std::vector<AtlasSourceImage>& rest)
+{
+    int shelfY      = kPadding;
+    int shelfHeight = 0;
+    int cursorX     = kPadding;
+
+    for (const auto& image : images)
+    {
+        // 当前货架放不下时另起一层；按高度降序排列，新货架的高度由第一张图决定
+        if (cursorX + image.width + kPadding > width)
+        {
+            shelfY += shelfHeight + kPadding;
+            shelfHeight = 0;
+            cursorX     = kPadding;
+        }
+        if (image.width + 2 * kPadding > width || shelfY + image.height + kPadding > height)
+        {
+            rest.push_back(image);
+            continue;
+        }
+
+        AtlasFrame frame;
+        frame.path   = image.path;
+        frame.x      = cursorX;
+        frame.y      = shelfY;
+        frame.width  = image.width;
+        frame.height = image.height;
+        page.frames.push_back(frame);
+
+        cursorX += image.width + kPadding;
+        shelfHeight = std::max(shelfHeight, image.height);
+    }
+}
+
+std::vector<AtlasPage> AtlasPacker::pack(const std::string& group, std::vector<AtlasSourceImage> images)
+{
+    images.erase(std::remove_if(images.begin(), images.end(),
+                                [](const AtlasSourceImage& image) {
+                                    return image.width <= 0 || image.height <= 0 || image.width > kMaxFrameSize ||
+                                           image.height > kMaxFrameSize;
+                                }),
+                 images.end());
+
+    // 高度降序，其次宽度降序，最后按路径保证输出稳定
+    std::sort(images.begin(), images.end(), [](const AtlasSourceImage& a, const AtlasSourceImage& b) {
+        if (a.height != b.height)
+            return a.height > b.height;
+        if (a.width != b.width)
+            return a.width > b.width;
+        return a.path < b.path;
+    });
+
+    // 调色板散图单独成页，页内只有一种格式
+    std::vector<AtlasSourceImage> truecolor;
+    std::vector<AtlasSourceImage> indexed;
+    for (auto& image : images)
+        (image.indexed ? indexed : truecolor).push_back(std::move(image));
+
+    std::vector<AtlasPage> pages;
+    packPages(group, std::move(truecolor), false, pages);
+    packPages(group, std::move(indexed), true, pages);
+    return pages;
+}
+
+void AtlasPacker::packPages(const std::string& group, std::vector<AtlasSourceImage> images, bool indexed,
+                            std::vector<AtlasPage>& pages)
+{
+    static const std::vector<std::pair<int, int>> kSizes = candidatePageSizes();
+
+    while (!images.empty())
+    {
+        AtlasPage page;
+        page.name    = group + "_" + std::to_string(pages.size());
+        page.indexed = indexed;
+
+        // 找能放下剩余全部图片的最小尺寸
+        std::vector<AtlasSourceImage> rest;
+        bool                          fitted = false;
+        for (const auto& size : kSizes)
+        {
+            page.frames.clear();
+            rest.clear();
+            placeShelves(images, size.first, size.second, page, rest);
+            if (rest.empty())
+            {
+                page.width  = size.first;
+                page.height = size.second;
+                fitted      = true;
+                break;
+            }
+        }
+
+        // 一页放不下：按最大尺寸填满一页，剩余的进入下一页
+        if (!fitted)
+        {
+            page.frames.clear();
+            rest.clear();
+            page.width  = kMaxPageSize;
+            page.height = kMaxPageSize;
+            placeShelves(images, kMaxPageSize, kMaxPageSize, page, rest);
+        }
+
+        if (page.frames.empty())
+            break;
+
+        // 最后一层货架以下是空白，裁掉后解码和上传都少处理这些行
+        int usedHeight = 0;
+        for (const auto& frame : page.frames)
+            usedHeight = std::max(usedHeight, frame.y + frame.height);
+        page.height = std::min(page.height, usedHeight + kPadding);
+
+        pages.push_back(std::move(page));
+        images.swap(rest);
+    }
+}
+
+bool AtlasPacker::quantize(const std::vector<unsigned char>& rgba, AtlasIndexedImage& out)
+{
+    static const int kMaxColors    = 256; ///< PNG 调色板上限（含第 0 项的全透明）
+    static const int kRefinePasses = 4;   ///< k-means 修正轮数，再多误差基本不再下降
+    size_t           pixelCount    = rgba.size() / 4;
+
+    // 统计不透明颜色；全透明像素不参与，统一用第 0 项
+    std::unordered_map<uint32_t, double> histogram;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        if (rgba[i * 4 + 3] == 0)
+            continue;
+        uint32_t key;
+        std::memcpy(&key, &rgba[i * 4], 4);
+        histogram[key] += 1;
+    }
+
+    std::vector<PaletteColor> colors;
+    colors.reserve(histogram.size());
+    for (const auto& pair : histogram)
+    {
+        PaletteColor color;
+        color.rgba  = pair.first;
+        color.count = pair.second;
+        unsigned char c[4];
+        std::memcpy(c, &pair.first, 4);
+        for (int k = 0; k < 3; ++k)
+            color.v[k] = c[k] * c[3] / 255.0;
+        color.v[3] = c[3];
+        colors.push_back(color);
+    }
+    // 哈希表遍历顺序不固定，排序后输出才稳定
+    std::sort(colors.begin(), colors.end(),
+              [](const PaletteColor& a, const PaletteColor& b) { return a.rgba < b.rgba; });
+
+    // 调色板项（预乘坐标）；第 0 项为全透明
+    std::vector<std::array<double, 4>> entries(1, std::array<double, 4>{{0, 0, 0, 0}});
+    bool                               exact = colors.size() < static_cast<size_t>(kMaxColors);
+    if (exact)
+    {
+        for (const auto& color : colors)
+            entries.push_back({{color.v[0], color.v[1], color.v[2], color.v[3]}});
+    }
+    else
+    {
+        // 每次切分平方误差最大的盒，沿方差最大的通道在使两侧误差和最小的位置切开
+        std::vector<PaletteBox> boxes(1);
+        boxes[0].end = colors.size();
+        measureBox(colors, boxes[0]);
+        while (boxes.size() < static_cast<size_t>(kMaxColors - 1))
+        {
+            size_t target = 0;
+            for (size_t k = 1; k < boxes.size(); ++k)
+            {
+                if (boxes[k].error > boxes[target].error)
+                    target = k;
+            }
+            if (boxes[target].error <= 0)
+                break;
+
+            PaletteBox box     = boxes[target];
+            int        channel = box.channel;
+            std::sort(colors.begin() + box.begin, colors.begin() + box.end,
+                      [channel](const PaletteColor& a, const PaletteColor& b) {
+                          return a.v[channel] != b.v[channel] ? a.v[channel] < b.v[channel] : a.rgba < b.rgba;
+                      });
+
+            size_t              n = box.end - box.begin;
+            std::vector<double> weight(n + 1, 0), sum(n + 1, 0), sumSq(n + 1, 0);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const PaletteColor& color = colors[box.begin + i];
+                double              v     = color.v[channel];
+                weight[i + 1]             = weight[i] + color.count;
+                sum[i + 1]                = sum[i] + v * color.count;
+                sumSq[i + 1]              = sumSq[i] + v * v * color.count;
+            }
+            size_t split     = 1;
+            double bestError = -1;
+            for (size_t m = 1; m < n; ++m)
+            {
+                double left  = sumSq[m] - sum[m] * sum[m] / weight[m];
+                double rs    = sum[n] - sum[m];
+                double right = (sumSq[n] - sumSq[m]) - rs * rs / (weight[n] - weight[m]);
+                if (bestError < 0 || left + right < bestError)
+                {
+                    bestError = left + right;
+                    split     = m;
+                }
+            }
+
+            PaletteBox low  = box;
+            PaletteBox high = box;
+            low.end         = box.begin + split;
+            high.begin      = box.begin + split;
+            measureBox(colors, low);
+            measureBox(colors, high);
+            boxes[target] = low;
+            boxes.push_back(high);
+        }
+
+        for (const auto& box : boxes)
+        {
+            std::array<double, 4> mean{{0, 0, 0, 0}};
+            double                weight = 0;
+            for (size_t i = box.begin; i < box.end; ++i)
+            {
+                for (int c = 0; c < 4; ++c)
+                    mean[c] += colors[i].v[c] * colors[i].count;
+                weight += colors[i].count;
+            }
+            for (int c = 0; c < 4; ++c)
+                mean[c] /= weight;
+            entries.push_back(mean);
+        }
+
+        // k-means 修正：每种颜色归到最近的项，项移到其成员的加权均值
+        for (int pass = 0; pass < kRefinePasses; ++pass)
+        {
+            std::vector<std::array<double, 5>> accum(entries.size(), std::array<double, 5>{{0, 0, 0, 0, 0}});
+            for (const auto& color : colors)
+            {
+                std::array<double, 5>& a = accum[nearestEntry(color.v, entries)];
+                for (int c = 0; c < 4; ++c)
+                    a[c] += color.v[c] * color.count;
+                a[4] += color.count;
+            }
+            for (size_t k = 1; k < entries.size(); ++k)
+            {
+                if (accum[k][4] > 0)
+                {
+                    for (int c = 0; c < 4; ++c)
+                        entries[k][c] = accum[k][c] / accum[k][4];
+                }
+            }
+        }
+    }
+
+    // 调色板存非预乘值：运行时 cocos2d 展开为 RGBA 后再统一预乘
+    out.palette.assign(entries.size() * 4, 0);
+    for (size_t k = 1; k < entries.size(); ++k)
+    {
+        double alpha = std::round(entries[k][3]);
+        for (int c = 0; c < 3; ++c)
+        {
+            double value = alpha > 0 ? entries[k][c] * 255.0 / alpha : 0;
+            out.palette[k * 4 + c] = static_cast<unsigned char>(std::min(255.0, std::round(value)));
+        }
+        out.palette[k * 4 + 3] = static_cast<unsigned char>(alpha);
+    }
+
+    // 颜色 -> 下标，同时按实际写出的调色板值统计误差
+    std::unordered_map<uint32_t, unsigned char> lookup;
+    double                                      errorSum = 0;
+    double                                      counted  = 0;
+    for (const auto& color : colors)
+    {
+        size_t index = 0;
+        if (exact)
+        {
+            // 无损时颜色与调色板一一对应，按 rgba 有序存放
+            index = static_cast<size_t>(&color - &colors[0]) + 1;
+            std::memcpy(&out.palette[index * 4], &color.rgba, 4);
+        }
+        else
+        {
+            index = nearestEntry(color.v, entries);
+        }
+        lookup[color.rgba] = static_cast<unsigned char>(index);
+
+        const unsigned char* p = &out.palette[index * 4];
+        double               written[4];
+        for (int c = 0; c < 3; ++c)
+            written[c] = p[c] * p[3] / 255.0;
+        written[3] = p[3];
+        errorSum += distanceSq(color.v, written) * color.count;
+        counted += color.count * 4;
+    }
+    out.rmse = counted > 0 ? std::sqrt(errorSum / counted) : 0;
+
+    out.indices.assign(pixelCount, 0);
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        if (rgba[i * 4 + 3] == 0)
+            continue;
+        uint32_t key;
+        std::memcpy(&key, &rgba[i * 4], 4);
+        out.indices[i] = lookup[key];
+    }
+    return out.rmse <= kMaxPaletteError;
+}
+
+std::string AtlasPacker::writePlist(const AtlasPage& page, const std::string& textureFileName)
+{
+    std::ostringstream out;
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<!DOCTYPE plist PUBLIC \"-//Apple Computer//DTD PLIST 1.0//EN\" "
+           "\"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+        << "<plist version=\"1.0\">\n"
+        << "    <dict>\n"
+        << "        <key>frames</key>\n"
+        << "        <dict>\n";
+
+    for (const auto& frame : page.frames)
+    {
+        out << "            <key>" << escapeXml(frame.path) << "</key>\n"
+            << "            <dict>\n"
+            << "                <key>frame</key>\n"
+            << "                <string>{{" << frame.x << "," << frame.y << "},{" << frame.width << ","
+            << frame.height << "}}</string>\n"
+            << "                <key>offset</key>\n"
+            << "                <string>{0,0}</string>\n"
+            << "                <key>rotated</key>\n"
+            << "                <false/>\n"
+            << "                <key>sourceColorRect</key>\n"
+            << "                <string>{{0,0},{" << frame.width << "," << frame.height << "}}</string>\n"
+            << "                <key>sourceSize</key>\n"
+            << "                <string>{" << frame.width << "," << frame.height << "}</string>\n"
+            << "            </dict>\n";
+    }
+
+    out << "        </dict>\n"
+        << "        <key>metadata</key>\n"
+        << "        <dict>\n"
+        << "            <key>format</key>\n"
+        << "            <integer>2</integer>\n"
+        << "            <key>realTextureFileName</key>\n"
+        << "            <string>" << escapeXml(textureFileName) << "</string>\n"
+        << "            <key>size</key>\n"
+        << "            <string>{" << page.width << "," << page.height << "}</string>\n"
+        << "            <key>textureFileName</key>\n"
+        << "            <string>" << escapeXml(textureFileName) << "</string>\n"
+        << "        </dict>\n"
+        << "    </dict>\n"
+        << "</plist>\n";
+    return out.str();
+}
+
+std::string AtlasPacker::writeManifest(const std::vector<AtlasPage>& pages, const std::string& directory)
+{
+    std::ostringstream out;
+    out << "{\n  \"version\": 1,\n  \"atlases\": [";
+    for (size_t p = 0; p < pages.size(); ++p)
+    {
+        const AtlasPage& page = pages[p];
+        out << (p == 0 ? "\n" : ",\n") << "    {\n"
+            << "      \"name\": \"" << escapeJson(page.name) << "\",\n"
+            << "      \"plist\": \"" << escapeJson(directory + "/" + page.name + ".plist") << "\",\n"
+            << "      \"frames\": [";
+        for (size_t f = 0; f < page.frames.size(); ++f)
+        {
+            out << (f == 0 ? "\n" : ",\n") << "        \"" << escapeJson(page.frames[f].path) << "\"";
+        }
+        out << "\n      ]\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
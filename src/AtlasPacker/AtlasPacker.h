@@ -0,0 +1,158 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AtlasPacker.h
+ * File Function: 纹理图集打包 - 按用途分组、货架式排布，输出 plist 与图集清单（不依赖 cocos2d）
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __ATLAS_PACKER_H__
+#define __ATLAS_PACKER_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * @struct AtlasSourceImage
+ * @brief 待打包的散图
+ */
+struct AtlasSourceImage
+{
+    std::string path;       ///< 相对 Resources 的路径（同时作为图集中的帧名）
+    int         width   = 0;     ///< 宽度（像素）
+    int         height  = 0;     ///< 高度（像素）
+    bool        indexed = false; ///< 源文件是调色板 PNG（这类散图单独成页，写成调色板图集）
+};
+
+/**
+ * @struct AtlasFrame
+ * @brief 散图在图集页中的位置
+ */
+struct AtlasFrame
+{
+    std::string path;       ///< 帧名（原散图路径）
+    int         x      = 0; ///< 左上角 X（像素，图片坐标系）
+    int         y      = 0; ///< 左上角 Y
+    int         width  = 0; ///< 宽度
+    int         height = 0; ///< 高度
+};
+
+/**
+ * @struct AtlasPage
+ * @brief 一张图集纹理及其包含的帧
+ */
+struct AtlasPage
+{
+    std::string             name;            ///< 页名（分组名_序号），对应 <name>.png / <name>.plist
+    int                     width   = 0;     ///< 纹理宽度（2 的幂）
+    int                     height  = 0;     ///< 纹理高度（裁到最后一层货架，不一定是 2 的幂）
+    bool                    indexed = false; ///< 页内全部是调色板散图，写成 8 位调色板 PNG
+    std::vector<AtlasFrame> frames;          ///< 帧
+};
+
+/**
+ * @struct AtlasIndexedImage
+ * @brief 量化后的调色板图像
+ */
+struct AtlasIndexedImage
+{
+    std::vector<unsigned char> palette;  ///< RGBA 调色板（非预乘，最多 256 项，第 0 项为全透明）
+    std::vector<unsigned char> indices;  ///< 每像素一个调色板下标
+    double                     rmse = 0; ///< 与原图的均方根误差（预乘后的 RGBA，0~255）
+};
+
+/**
+ * @class AtlasPacker
+ * @brief 图集打包规则与排布算法
+ *
+ * 分组（同一场景中一起使用的图放在一起）：
+ * - units/<兵种>/ 下的 png         -> units_<兵种>
+ * - buildings/<建筑族>/ 下的 png   -> buildings_<建筑族>
+ * - icon/ 下的 png、units/ 下的兵种按钮（*_select_button_*） -> ui
+ * - 其余目录（地图、说明图片等）以及边长超过 kMaxFrameSize 的大图不打包
+ *
+ * 排布：按高度降序的货架算法，每帧四周留 kPadding 像素防止采样串色；
+ * 优先选择能放下整组的最小 2 的幂尺寸，放不下时按 kMaxPageSize 分页；页高最后裁到最后一层货架
+ * （散图本身就是任意尺寸的纹理，非 2 的幂的高度不会带来新的限制）。
+ *
+ * 格式：散图大多是 8 位调色板 PNG，整页写成 RGBA 后解码要多处理约 4 倍的数据，比逐张读散图还慢。
+ * 因此同一分组内的调色板散图单独成页，整页量化到 256 色写成调色板 PNG；真彩色散图仍写 RGBA。
+ */
+class AtlasPacker
+{
+public:
+    static constexpr int kMaxPageSize  = 2048; ///< 图集页最大边长
+    static constexpr int kMinPageSize  = 64;   ///< 图集页最小边长
+    static constexpr int kMaxFrameSize = 1024; ///< 参与打包的散图最大边长
+    static constexpr int kPadding      = 2;    ///< 帧间距（像素）
+
+    static constexpr double kMaxPaletteError = 8.0; ///< 调色板页允许的最大均方根误差，超出时改写 RGBA
+
+    /**
+     * @brief 散图所属的分组
+     * @param path 相对 Resources 的路径（使用 '/' 分隔）
+     * @return std::string 分组名，不打包时为空
+     */
+    static std::string groupForPath(const std::string& path);
+
+    /**
+     * @brief 打包一个分组
+     * @param group 分组名
+     * @param images 分组内的散图（超出 kMaxFrameSize 的会被跳过）
+     * @return std::vector<AtlasPage> 图集页，页名为 group_0、group_1 ...
+     */
+    static std::vector<AtlasPage> pack(const std::string& group, std::vector<AtlasSourceImage> images);
+
+    /**
+     * @brief 把整页像素量化为调色板图像
+     *
+     * 不透明颜色不超过 255 种时无损；否则在预乘空间做方差中位切分，再做几轮 k-means 修正。
+     * 全透明像素统一映射到第 0 项。
+     *
+     * @param rgba 非预乘 RGBA8888 像素
+     * @param out 输出：调色板、下标和误差
+     * @return bool 误差不超过 kMaxPaletteError
+     */
+    static bool quantize(const std::vector<unsigned char>& rgba, AtlasIndexedImage& out);
+
+    /**
+     * @brief 生成 cocos2d 可读取的 plist（format 2，与 TexturePacker 输出一致，不旋转、不裁边）
+     * @param page 图集页
+     * @param textureFileName 纹理文件名（与 plist 同目录）
+     * @return std::string plist 文本
+     */
+    static std::string writePlist(const AtlasPage& page, const std::string& textureFileName);
+
+    /**
+     * @brief 生成图集清单 JSON，运行时据此把散图路径解析到图集帧
+     * @param pages 全部图集页
+     * @param directory 图集目录（相对 Resources，例如 "atlas"）
+     * @return std::string JSON 文本
+     */
+    static std::string writeManifest(const std::vector<AtlasPage>& pages, const std::string& directory);
+
+private:
+    /**
+     * @brief 用货架算法把 images 放进 width x height 的页中
+     * @param images 待放置的散图（已按高度降序排序）
+     * @param width 页宽
+     * @param height 页高
+     * @param page 输出：放下的帧
+     * @param rest 输出：放不下的散图
+     */
+    static void placeShelves(const std::vector<AtlasSourceImage>& images, int width, int height, AtlasPage& page,
+                             std::vector<AtlasSourceImage>& rest);
+
+    /**
+     * @brief 把同一格式的散图排成若干页，追加到 pages（页名序号接着已有页）
+     * @param group 分组名
+     * @param images 待排布的散图（已排序）
+     * @param indexed 这些散图是否都是调色板 PNG
+     * @param pages 输出
+     */
+    static void packPages(const std::string& group, std::vector<AtlasSourceImage> images, bool indexed,
+                          std::vector<AtlasPage>& pages);
+};
+
+#endif // __ATLAS_PACKER_H__
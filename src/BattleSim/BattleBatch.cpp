@@ -0,0 +1,125 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleBatch.cpp
+ * File Function: 批量战斗模拟实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleBatch.h"
+
+#include "Managers/GameDataSerializer.h"
+#include "Managers/ReplayData.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <thread>
+
+BattleBatch::BattleBatch(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    _threadCount = std::max(1, threadCount);
+}
+
+bool BattleBatch::setBaseOverride(const std::string& baseJson)
+{
+    if (baseJson.empty())
+    {
+        _baseOverride.reset();
+        return true;
+    }
+
+    _baseOverride = std::make_shared<GameStateData>(GameStateData::fromJson(baseJson));
+    return !_baseOverride->buildings.empty();
+}
+
+uint64_t BattleBatch::addBaseSnapshot(const std::string& baseJson)
+{
+    uint64_t hash        = ReplayData::hashBaseSnapshot(baseJson);
+    _baseSnapshots[hash] = std::make_shared<GameStateData>(GameStateData::fromJson(baseJson));
+    return hash;
+}
+
+std::vector<BattleBatchResult> BattleBatch::run(const std::vector<BattleBatchJob>& jobs) const
+{
+    std::vector<BattleBatchResult> results(jobs.size());
+    std::atomic<size_t>            nextJob(0);
+
+    auto worker = [this, &jobs, &results, &nextJob]() {
+        BattleSimulator simulator;
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            results[i] = runOne(simulator, jobs[i]);
+        }
+    };
+
+    int threadCount = static_cast<int>(std::min<size_t>(static_cast<size_t>(_threadCount), jobs.size()));
+    if (threadCount <= 1)
+    {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+BattleBatchResult BattleBatch::runOne(BattleSimulator& simulator, const BattleBatchJob& job) const
+{
+    BattleBatchResult batchResult;
+    try
+    {
+        ReplayData replay = ReplayData::deserialize(job.replayText);
+
+        GameStateData base;
+        if (_baseOverride)
+        {
+            base = *_baseOverride;
+        }
+        else if (!replay.enemyGameDataJson.empty())
+        {
+            base = GameStateData::fromJson(replay.enemyGameDataJson);
+        }
+        else
+        {
+            // 回放只记录了快照哈希
+            auto it = _baseSnapshots.find(replay.baseSnapshotHash);
+            if (it == _baseSnapshots.end())
+            {
+                char message[64];
+                std::snprintf(message, sizeof(message), "base snapshot %016llx not provided",
+                              static_cast<unsigned long long>(replay.baseSnapshotHash));
+                batchResult.error = message;
+                return batchResult;
+            }
+            base = *it->second;
+        }
+
+        if (base.buildings.empty())
+        {
+            batchResult.error = "base has no buildings";
+            return batchResult;
+        }
+
+        batchResult.result = simulator.run(base, replay);
+        batchResult.ok     = true;
+    }
+    catch (const std::exception& e)
+    {
+        // 回放数据损坏或截断时抛出异常
+        batchResult.error = std::string("malformed replay: ") + e.what();
+    }
+    return batchResult;
+}
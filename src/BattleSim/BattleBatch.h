@@ -0,0 +1,91 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleBatch.h
+ * File Function: 批量战斗模拟 - 多线程并行模拟大量回放
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_BATCH_H__
+#define __BATTLE_BATCH_H__
+
+#include "BattleSimulator.h"
+#include "Managers/GameDataModels.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BattleBatchJob
+ * @brief 一场待模拟的战斗
+ */
+struct BattleBatchJob
+{
+    std::string name;       ///< 名称（通常为回放文件路径）
+    std::string replayText; ///< ReplayData::serialize() 得到的回放数据（二进制或旧版文本）
+};
+
+/**
+ * @struct BattleBatchResult
+ * @brief 一场战斗的模拟结果
+ */
+struct BattleBatchResult
+{
+    bool            ok = false; ///< 是否模拟成功
+    std::string     error;      ///< 失败原因
+    BattleSimResult result;     ///< 战果
+};
+
+/**
+ * @class BattleBatch
+ * @brief 批量模拟器
+ *
+ * 每个工作线程持有独立的 BattleSimulator，按任务下标领取任务，
+ * 结果按任务顺序返回，与线程数无关。
+ */
+class BattleBatch
+{
+public:
+    /**
+     * @brief 构造
+     * @param threadCount 工作线程数（<= 0 时使用硬件线程数）
+     */
+    explicit BattleBatch(int threadCount);
+
+    /**
+     * @brief 所有回放统一使用指定基地（为空时使用回放中记录的敌方基地快照）
+     * @param baseJson GameStateData JSON
+     * @return bool JSON 中没有可参战的建筑时返回 false
+     */
+    bool setBaseOverride(const std::string& baseJson);
+
+    /**
+     * @brief 提供一份基地快照，供只记录快照哈希的回放按哈希查找
+     * @param baseJson GameStateData JSON（即游戏保存在 defense_logs/<账号>/base_<哈希>.json 的内容）
+     * @return uint64_t 快照哈希
+     */
+    uint64_t addBaseSnapshot(const std::string& baseJson);
+
+    /**
+     * @brief 模拟全部任务
+     * @param jobs 任务列表
+     * @return std::vector<BattleBatchResult> 与任务一一对应的结果
+     */
+    std::vector<BattleBatchResult> run(const std::vector<BattleBatchJob>& jobs) const;
+
+    /** @brief 实际使用的线程数 */
+    int getThreadCount() const { return _threadCount; }
+
+private:
+    BattleBatchResult runOne(BattleSimulator& simulator, const BattleBatchJob& job) const;
+
+    int                                                _threadCount = 1;
+    std::shared_ptr<GameStateData>                     _baseOverride;
+    std::map<uint64_t, std::shared_ptr<GameStateData>> _baseSnapshots; ///< 快照哈希 -> 基地
+};
+
+#endif // __BATTLE_BATCH_H__
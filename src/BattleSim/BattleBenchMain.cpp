@@ -0,0 +1,425 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleBenchMain.cpp
+ * File Function: 战斗基准测试入口 - 按固定步数推进基准场景，输出逐步耗时、每秒可推进的回放秒数、分配次数和分阶段耗时
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleBenchScenarios.h"
+#include "BattleSimulator.h"
+#include "BattleWorld.h"
+#include "Managers/GameDataSerializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ==================== 分配计数 ====================
+// 替换全局 operator new，统计推进过程中的堆分配（基准程序单线程运行）
+
+namespace
+{
+
+unsigned long long g_allocationCount = 0;
+unsigned long long g_allocationBytes = 0;
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++g_allocationCount;
+    g_allocationBytes += size;
+    if (void* p = std::malloc(size > 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+const char* kUsage =
+    "用法: battle_bench [选项]\n"
+    "  --ticks <步数>      每个场景推进的固定步数（默认 3600，即 60 秒）\n"
+    "  --scenario <名称>   只运行指定场景（可重复）\n"
+    "  --json <文件>       结果写入 JSON 文件（默认输出到标准输出）\n"
+    "  --ai-budget <数量>  每步单位 AI 工作量预算（默认同游戏）\n"
+    "  --list              列出全部场景\n"
+    "  --write-corpus <目录> 把场景写成回放 <场景名>.bin 和回放列表 corpus.txt 后退出\n"
+    "                      （battle_sim --expect 的确定性回归语料）\n";
+
+/** @brief 分阶段统计的阶段（deploy 为应用部署事件，其余与 BattleStepPhase 对应） */
+const char* const kPhaseNames[] = {"navigation", "movement", "unit_ai", "projectiles", "defenses", "destruction"};
+constexpr int     kPhaseCount   = static_cast<int>(BattleStepPhase::kCount);
+
+/**
+ * @struct ScenarioResult
+ * @brief 一个场景的基准结果（时间单位为微秒）
+ */
+struct ScenarioResult
+{
+    std::string name;
+    int         ticks              = 0;
+    int         buildings          = 0;
+    int         unitsDeployed      = 0;
+    double      meanTickUs         = 0.0;
+    double      p50TickUs          = 0.0;
+    double      p99TickUs          = 0.0;
+    double      maxTickUs          = 0.0;
+    double      replayRate         = 0.0; ///< 每实际秒推进的回放秒数（高倍速回放和跳到结果的上限）
+    double      allocationsPerTick = 0.0;
+    double      bytesPerTick       = 0.0;
+    double      deployMeanUs       = 0.0;
+    double      phaseMeanUs[kPhaseCount] = {};
+    int         destructionPercent = 0;
+    int         stars              = 0;
+    int         aliveUnits         = 0;
+    int         aiMaxProcessed     = 0; ///< 单步执行的 AI 请求数最大值
+    int         aiMaxPending       = 0; ///< 单步结束时排队请求数最大值
+    unsigned    aiMaxWait          = 0; ///< 请求排队最久的步数
+};
+
+/**
+ * @class BenchRun
+ * @brief 按 BattleManager::fixedUpdate 的顺序推进一个场景：帧数 +1 -> 应用到期的部署 -> BattleWorld::step
+ */
+class BenchRun
+{
+public:
+    BenchRun(const BattleBenchScenario& scenario, const BattleMapLayout& layout, int aiBudget) : _scenario(scenario)
+    {
+        _world.setAIWorkBudget(aiBudget);
+        for (const auto& building : scenario.base.buildings)
+        {
+            BattleBuildingDesc desc;
+            if (BattleSetup::makeBuildingDesc(building, layout, desc))
+                _world.addBuilding(desc);
+        }
+        _world.setDefensesActive(true);
+    }
+
+    /** @brief 应用本帧到期的部署事件 */
+    void deploy()
+    {
+        ++_frame;
+        const auto& events = _scenario.deploys;
+        while (_nextEvent < events.size() && _frame >= events[_nextEvent].frameIndex)
+        {
+            const ReplayEvent& event = events[_nextEvent++];
+            UnitType           type  = static_cast<UnitType>(event.unitType);
+            _world.spawnUnit(BattleSetup::makeUnitDesc(type, SimVec2::fromFloat(event.x, event.y)));
+            ++_unitsDeployed;
+        }
+    }
+
+    /** @brief 推进一步，事件与游戏内一样每帧被视图取走 */
+    void step()
+    {
+        _world.step(BattleSimulator::kFixedTimeStep);
+        _world.clearEvents();
+    }
+
+    BattleWorld& getWorld() { return _world; }
+    int          getUnitsDeployed() const { return _unitsDeployed; }
+
+private:
+    const BattleBenchScenario& _scenario;
+    BattleWorld                _world;
+    size_t                     _nextEvent     = 0;
+    unsigned int               _frame         = 0;
+    int                        _unitsDeployed = 0;
+};
+
+double toMicroseconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+ScenarioResult runScenario(const BattleBenchScenario& scenario, const BattleMapLayout& layout, int ticks, int aiBudget)
+{
+    ScenarioResult result;
+    result.name  = scenario.name;
+    result.ticks = ticks;
+
+    // 第一遍：不计分阶段耗时，测量每步总耗时和分配次数
+    {
+        BenchRun            run(scenario, layout, aiBudget);
+        std::vector<double> tickUs;
+        tickUs.reserve(ticks);
+
+        unsigned long long allocations = 0;
+        unsigned long long bytes       = 0;
+        for (int t = 0; t < ticks; ++t)
+        {
+            unsigned long long allocationsBefore = g_allocationCount;
+            unsigned long long bytesBefore       = g_allocationBytes;
+            auto               start             = std::chrono::steady_clock::now();
+
+            run.deploy();
+            run.step();
+
+            auto end = std::chrono::steady_clock::now();
+            allocations += g_allocationCount - allocationsBefore;
+            bytes += g_allocationBytes - bytesBefore;
+            tickUs.push_back(toMicroseconds(end - start));
+
+            const BattleAIStats& ai = run.getWorld().getAIStats();
+            result.aiMaxProcessed   = std::max(result.aiMaxProcessed, ai.processed);
+            result.aiMaxPending     = std::max(result.aiMaxPending, ai.pending);
+            result.aiMaxWait        = std::max(result.aiMaxWait, ai.maxWait);
+        }
+
+        double total = 0.0;
+        for (double us : tickUs)
+            total += us;
+
+        std::sort(tickUs.begin(), tickUs.end());
+        result.meanTickUs         = ticks > 0 ? total / ticks : 0.0;
+        result.p50TickUs          = percentile(tickUs, 0.50);
+        result.p99TickUs          = percentile(tickUs, 0.99);
+        result.maxTickUs          = tickUs.empty() ? 0.0 : tickUs.back();
+        result.replayRate         = total > 0.0 ? ticks * BattleSimulator::kFixedTimeStep / (total / 1e6) : 0.0;
+        result.allocationsPerTick = ticks > 0 ? static_cast<double>(allocations) / ticks : 0.0;
+        result.bytesPerTick       = ticks > 0 ? static_cast<double>(bytes) / ticks : 0.0;
+
+        BattleWorld& world        = run.getWorld();
+        result.buildings          = world.getBuildingCount();
+        result.unitsDeployed      = run.getUnitsDeployed();
+        result.destructionPercent = world.getDestructionPercent();
+        result.stars              = world.getStars();
+        result.aliveUnits         = world.countAliveUnits();
+    }
+
+    // 第二遍：模拟是确定的，同样的推进过程打开分阶段计时
+    {
+        BenchRun          run(scenario, layout, aiBudget);
+        BattleStepTimings timings;
+        run.getWorld().setStepTimings(&timings);
+
+        double deployTotal              = 0.0;
+        double phaseTotal[kPhaseCount] = {};
+        for (int t = 0; t < ticks; ++t)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run.deploy();
+            deployTotal += toMicroseconds(std::chrono::steady_clock::now() - start);
+
+            run.step();
+            for (int p = 0; p < kPhaseCount; ++p)
+                phaseTotal[p] += timings.seconds[p] * 1e6;
+        }
+
+        if (ticks > 0)
+        {
+            result.deployMeanUs = deployTotal / ticks;
+            for (int p = 0; p < kPhaseCount; ++p)
+                result.phaseMeanUs[p] = phaseTotal[p] / ticks;
+        }
+    }
+    return result;
+}
+
+void writeJson(std::ostream& out, int ticks, int aiBudget, const std::vector<ScenarioResult>& results)
+{
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"ticks\": " << ticks << ",\n";
+    out << "  \"fixed_time_step\": " << std::setprecision(6) << BattleSimulator::kFixedTimeStep
+        << std::setprecision(3) << ",\n";
+    out << "  \"time_unit\": \"us\",\n";
+    out << "  \"ai_work_budget\": " << aiBudget << ",\n";
+    out << "  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const ScenarioResult& r = results[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << r.name << "\",\n";
+        out << "      \"buildings\": " << r.buildings << ",\n";
+        out << "      \"units_deployed\": " << r.unitsDeployed << ",\n";
+        out << "      \"mean_tick\": " << r.meanTickUs << ",\n";
+        out << "      \"p50_tick\": " << r.p50TickUs << ",\n";
+        out << "      \"p99_tick\": " << r.p99TickUs << ",\n";
+        out << "      \"max_tick\": " << r.maxTickUs << ",\n";
+        out << "      \"replay_seconds_per_second\": " << r.replayRate << ",\n";
+        out << "      \"allocations_per_tick\": " << r.allocationsPerTick << ",\n";
+        out << "      \"bytes_allocated_per_tick\": " << r.bytesPerTick << ",\n";
+        out << "      \"phases\": {\n";
+        out << "        \"deploy\": " << r.deployMeanUs;
+        for (int p = 0; p < kPhaseCount; ++p)
+            out << ",\n        \"" << kPhaseNames[p] << "\": " << r.phaseMeanUs[p];
+        out << "\n      },\n";
+        out << "      \"ai\": {\"max_processed\": " << r.aiMaxProcessed << ", \"max_pending\": " << r.aiMaxPending
+            << ", \"max_wait_ticks\": " << r.aiMaxWait << "},\n";
+        out << "      \"final\": {\"destruction\": " << r.destructionPercent << ", \"stars\": " << r.stars
+            << ", \"alive_units\": " << r.aliveUnits << "}\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+/**
+ * @brief 把场景写成回放文件（内嵌基地快照）和 battle_sim --list 使用的回放列表
+ * @return int 进程返回值
+ */
+int writeCorpus(const std::vector<const BattleBenchScenario*>& scenarios, const std::string& outDir)
+{
+    std::ofstream list(outDir + "/corpus.txt", std::ios::binary);
+    for (const BattleBenchScenario* scenario : scenarios)
+    {
+        ReplayData replay;
+        replay.enemyUserId       = scenario->name;
+        replay.enemyGameDataJson = scenario->base.toJson();
+        replay.baseSnapshotHash  = ReplayData::hashBaseSnapshot(replay.enemyGameDataJson);
+        replay.simRulesVersion   = BattleWorld::kRulesVersion;
+        replay.events            = scenario->deploys;
+
+        std::string   name = scenario->name + ".bin";
+        std::string   data = replay.serialize();
+        std::ofstream file(outDir + "/" + name, std::ios::binary);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file)
+        {
+            std::cerr << "无法写入: " << outDir << "/" << name << std::endl;
+            return 2;
+        }
+        list << name << "\n";
+        std::cerr << name << ": " << data.size() << " bytes, " << replay.events.size() << " events" << std::endl;
+    }
+
+    if (!list)
+    {
+        std::cerr << "无法写入: " << outDir << "/corpus.txt" << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int                      ticks    = 3600;
+    int                      aiBudget = BattleWorld::kDefaultAIWorkBudget;
+    std::string              jsonPath;
+    std::string              corpusDir;
+    std::vector<std::string> selected;
+    bool                     listOnly = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg     = argv[i];
+        bool        hasNext = i + 1 < argc;
+
+        if (arg == "--ticks" && hasNext)
+        {
+            ticks = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--scenario" && hasNext)
+        {
+            selected.push_back(argv[++i]);
+        }
+        else if (arg == "--json" && hasNext)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--ai-budget" && hasNext)
+        {
+            aiBudget = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--list")
+        {
+            listOnly = true;
+        }
+        else if (arg == "--write-corpus" && hasNext)
+        {
+            corpusDir = argv[++i];
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cerr << kUsage;
+            return 0;
+        }
+        else
+        {
+            std::cerr << "未知选项: " << arg << "\n" << kUsage;
+            return 2;
+        }
+    }
+
+    BattleMapLayout                  layout;
+    std::vector<BattleBenchScenario> scenarios = BattleBenchScenarios::createAll(layout);
+
+    if (listOnly)
+    {
+        for (const auto& scenario : scenarios)
+            std::cout << scenario.name << "\n";
+        return 0;
+    }
+
+    std::vector<const BattleBenchScenario*> chosen;
+    for (const auto& scenario : scenarios)
+    {
+        if (selected.empty() || std::find(selected.begin(), selected.end(), scenario.name) != selected.end())
+            chosen.push_back(&scenario);
+    }
+    if (chosen.empty())
+    {
+        std::cerr << "没有匹配的场景（--list 查看全部场景）" << std::endl;
+        return 2;
+    }
+
+    if (!corpusDir.empty())
+        return writeCorpus(chosen, corpusDir);
+
+    std::vector<ScenarioResult> results;
+    for (const BattleBenchScenario* scenario : chosen)
+    {
+        ScenarioResult r = runScenario(*scenario, layout, ticks, aiBudget);
+        std::cerr << std::fixed << std::setprecision(2) << r.name << ": mean=" << r.meanTickUs
+                  << "us p99=" << r.p99TickUs << "us replay_x=" << r.replayRate
+                  << " allocs/tick=" << r.allocationsPerTick << " ai_wait=" << r.aiMaxWait
+                  << " destruction=" << r.destructionPercent << "%" << std::endl;
+        results.push_back(r);
+    }
+
+    if (jsonPath.empty())
+    {
+        writeJson(std::cout, ticks, aiBudget, results);
+        return 0;
+    }
+
+    std::ofstream file(jsonPath);
+    if (!file)
+    {
+        std::cerr << "无法写入: " << jsonPath << std::endl;
+        return 2;
+    }
+    writeJson(file, ticks, aiBudget, results);
+    return 0;
+}
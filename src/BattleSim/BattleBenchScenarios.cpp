@@ -0,0 +1,226 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleBenchScenarios.cpp
+ * File Function: 战斗基准场景实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleBenchScenarios.h"
+
+namespace
+{
+
+constexpr int kMaxLevel     = 14; ///< 满级（BuildingHitpoints/DefenseConfig 会截断到各自的上限）
+constexpr int kBaseCenter   = 22; ///< 基地中心网格坐标
+constexpr int kDeployMargin = 3;  ///< 部署点离基地外缘的格数
+
+void addBuilding(GameStateData& base, const char* name, int gridX, int gridY, int size, int level = kMaxLevel)
+{
+    BuildingSerialData data;
+    data.name       = name;
+    data.level      = level;
+    data.gridX      = static_cast<float>(gridX);
+    data.gridY      = static_cast<float>(gridY);
+    data.gridWidth  = static_cast<float>(size);
+    data.gridHeight = static_cast<float>(size);
+    base.buildings.push_back(data);
+}
+
+/** @brief 以基地中心为圆心、半径为 radius 的方形城墙，每条边中间留 gap 格缺口 */
+void addWallRing(GameStateData& base, int radius, int gap)
+{
+    int lo = kBaseCenter - radius;
+    int hi = kBaseCenter + radius;
+    for (int i = lo; i <= hi; ++i)
+    {
+        bool inGap = i >= kBaseCenter - gap / 2 && i < kBaseCenter - gap / 2 + gap;
+        if (inGap)
+            continue;
+        addBuilding(base, "Wall", i, lo, 1);
+        addBuilding(base, "Wall", i, hi, 1);
+        if (i != lo && i != hi)
+        {
+            addBuilding(base, "Wall", lo, i, 1);
+            addBuilding(base, "Wall", hi, i, 1);
+        }
+    }
+}
+
+/**
+ * @brief 沿基地外围的方形轨迹依次部署
+ * @param radius 部署轨迹半径（格）
+ * @param firstFrame 第一个单位的部署帧
+ * @param frameStep 相邻两个单位的间隔帧数
+ * @param pickType 第 i 个单位的类型
+ */
+template <typename PickType>
+void deployAround(const BattleMapLayout& layout, std::vector<ReplayEvent>& events, int count, int radius,
+                  unsigned int firstFrame, unsigned int frameStep, PickType pickType)
+{
+    int side      = radius * 2;
+    int perimeter = side * 4;
+    for (int i = 0; i < count; ++i)
+    {
+        // 每个单位沿轨迹前进一个固定的步长（与周长互质），单位均匀分布在四条边上
+        int   t     = (i * 37) % perimeter;
+        int   edge  = t / side;
+        int   along = t % side;
+        float gx    = 0.0f;
+        float gy    = 0.0f;
+        switch (edge)
+        {
+        case 0:
+            gx = static_cast<float>(kBaseCenter - radius + along);
+            gy = static_cast<float>(kBaseCenter - radius);
+            break;
+        case 1:
+            gx = static_cast<float>(kBaseCenter + radius);
+            gy = static_cast<float>(kBaseCenter - radius + along);
+            break;
+        case 2:
+            gx = static_cast<float>(kBaseCenter + radius - along);
+            gy = static_cast<float>(kBaseCenter + radius);
+            break;
+        default:
+            gx = static_cast<float>(kBaseCenter - radius);
+            gy = static_cast<float>(kBaseCenter + radius - along);
+            break;
+        }
+
+        SimVec2     position = layout.gridToPosition(gx, gy);
+        ReplayEvent event;
+        event.frameIndex = firstFrame + static_cast<unsigned int>(i) * frameStep;
+        event.type       = ReplayEventType::DEPLOY_UNIT;
+        event.unitType   = static_cast<int>(pickType(i));
+        event.x          = position.floatX();
+        event.y          = position.floatY();
+        events.push_back(event);
+    }
+}
+
+} // namespace
+
+std::vector<BattleBenchScenario> BattleBenchScenarios::createAll(const BattleMapLayout& layout)
+{
+    std::vector<BattleBenchScenario> scenarios;
+    scenarios.push_back(createMaxLevelBase(layout, 50));
+    scenarios.push_back(createMaxLevelBase(layout, 150));
+    scenarios.push_back(createMaxLevelBase(layout, 300));
+    scenarios.push_back(createWallMaze(layout));
+    scenarios.push_back(createArcherSwarm(layout));
+    return scenarios;
+}
+
+BattleBenchScenario BattleBenchScenarios::createMaxLevelBase(const BattleMapLayout& layout, int troopCount)
+{
+    BattleBenchScenario scenario;
+    scenario.name = "max_base_vs_" + std::to_string(troopCount) + "_mixed";
+
+    GameStateData& base = scenario.base;
+    base.gold           = 1000000;
+    base.elixir         = 1000000;
+
+    addBuilding(base, "Town Hall", kBaseCenter - 2, kBaseCenter - 2, 4);
+
+    // 内圈防御 + 城墙
+    addBuilding(base, "Cannon", 16, 16, 3);
+    addBuilding(base, "Cannon", 26, 16, 3);
+    addBuilding(base, "Cannon", 16, 26, 3);
+    addBuilding(base, "Cannon", 26, 26, 3);
+    addBuilding(base, "Archer Tower", 21, 15, 3);
+    addBuilding(base, "Archer Tower", 15, 21, 3);
+    addBuilding(base, "Archer Tower", 27, 21, 3);
+    addBuilding(base, "Archer Tower", 21, 27, 3);
+    addWallRing(base, 8, 0);
+
+    // 外圈防御
+    addBuilding(base, "Cannon", 9, 9, 3);
+    addBuilding(base, "Cannon", 33, 9, 3);
+    addBuilding(base, "Cannon", 9, 33, 3);
+    addBuilding(base, "Cannon", 33, 33, 3);
+    addBuilding(base, "Archer Tower", 21, 8, 3);
+    addBuilding(base, "Archer Tower", 8, 21, 3);
+    addBuilding(base, "Archer Tower", 34, 21, 3);
+    addBuilding(base, "Archer Tower", 21, 34, 3);
+
+    // 资源与其他建筑
+    addBuilding(base, "Gold Mine", 5, 5, 3);
+    addBuilding(base, "Gold Mine", 37, 5, 3);
+    addBuilding(base, "Elixir Collector", 5, 37, 3);
+    addBuilding(base, "Elixir Collector", 37, 37, 3);
+    addBuilding(base, "Gold Storage", 12, 28, 3);
+    addBuilding(base, "Elixir Storage", 29, 12, 3);
+    addBuilding(base, "Barracks", 4, 20, 3);
+    addBuilding(base, "Army Camp", 38, 20, 4);
+    addBuilding(base, "Builder's Hut", 1, 1, 2);
+    addBuilding(base, "Builder's Hut", 41, 41, 2);
+
+    // 野蛮人:弓箭手:巨人:哥布林:炸弹人 = 3:3:1:2:1
+    static const UnitType kMix[] = {UnitType::kBarbarian, UnitType::kArcher,  UnitType::kBarbarian, UnitType::kGiant,
+                                    UnitType::kArcher,    UnitType::kGoblin,  UnitType::kBarbarian, UnitType::kArcher,
+                                    UnitType::kGoblin,    UnitType::kWallBreaker};
+    deployAround(layout, scenario.deploys, troopCount, kBaseCenter + kDeployMargin, 1, 2,
+                 [](int i) { return kMix[i % 10]; });
+    return scenario;
+}
+
+BattleBenchScenario BattleBenchScenarios::createWallMaze(const BattleMapLayout& layout)
+{
+    BattleBenchScenario scenario;
+    scenario.name = "wall_maze_vs_wall_breakers";
+
+    GameStateData& base = scenario.base;
+    base.gold           = 500000;
+    base.elixir         = 500000;
+
+    addBuilding(base, "Town Hall", kBaseCenter - 2, kBaseCenter - 2, 4);
+    addBuilding(base, "Gold Storage", 18, 18, 3);
+    addBuilding(base, "Elixir Storage", 24, 24, 3);
+
+    // 五层城墙，奇数层每条边中间留 2 格缺口，单位需要反复破墙
+    for (int ring = 0; ring < 5; ++ring)
+    {
+        addWallRing(base, 4 + ring * 3, ring % 2 == 0 ? 0 : 2);
+    }
+    addBuilding(base, "Cannon", 12, 12, 3);
+    addBuilding(base, "Cannon", 30, 12, 3);
+    addBuilding(base, "Cannon", 12, 30, 3);
+    addBuilding(base, "Cannon", 30, 30, 3);
+
+    // 炸弹人打头，野蛮人随后
+    deployAround(layout, scenario.deploys, 60, kBaseCenter + kDeployMargin, 1, 3,
+                 [](int i) { return i % 3 == 2 ? UnitType::kBarbarian : UnitType::kWallBreaker; });
+    deployAround(layout, scenario.deploys, 60, kBaseCenter + kDeployMargin, 200, 3,
+                 [](int) { return UnitType::kBarbarian; });
+    return scenario;
+}
+
+BattleBenchScenario BattleBenchScenarios::createArcherSwarm(const BattleMapLayout& layout)
+{
+    BattleBenchScenario scenario;
+    scenario.name = "archer_swarm_vs_defenses";
+
+    GameStateData& base = scenario.base;
+    base.gold           = 500000;
+    base.elixir         = 500000;
+
+    addBuilding(base, "Town Hall", kBaseCenter - 2, kBaseCenter - 2, 4);
+
+    // 7x7 网格排布的防御建筑，加农炮与箭塔交替
+    for (int row = 0; row < 7; ++row)
+    {
+        for (int col = 0; col < 7; ++col)
+        {
+            int gx = 2 + col * 6;
+            int gy = 2 + row * 6;
+            if (row == 3 && col == 3)
+                continue; // 中心留给大本营
+            addBuilding(base, (row + col) % 2 == 0 ? "Cannon" : "Archer Tower", gx, gy, 3);
+        }
+    }
+
+    deployAround(layout, scenario.deploys, 250, kBaseCenter + kDeployMargin, 1, 1,
+                 [](int) { return UnitType::kArcher; });
+    return scenario;
+}
@@ -0,0 +1,59 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleBenchScenarios.h
+ * File Function: 战斗基准场景 - 固定的基地布局和部署序列
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_BENCH_SCENARIOS_H__
+#define __BATTLE_BENCH_SCENARIOS_H__
+
+#include "BattleSetup.h"
+#include "Managers/GameDataModels.h"
+#include "Managers/ReplayData.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @struct BattleBenchScenario
+ * @brief 一个基准场景：防守方基地 + 按帧排列的部署事件
+ */
+struct BattleBenchScenario
+{
+    std::string              name;    ///< 场景名（JSON 输出中的键）
+    GameStateData            base;    ///< 防守方基地
+    std::vector<ReplayEvent> deploys; ///< 部署事件（帧数递增）
+};
+
+/**
+ * @class BattleBenchScenarios
+ * @brief 生成固定的基准场景
+ *
+ * 场景完全由代码生成（不使用随机数），任何机器上得到相同的布局和部署，
+ * 不同提交之间的基准结果可以直接比较。
+ */
+class BattleBenchScenarios
+{
+public:
+    /**
+     * @brief 生成全部场景
+     * @param layout 地图布局（部署坐标由网格坐标换算）
+     * @return std::vector<BattleBenchScenario> 场景列表
+     */
+    static std::vector<BattleBenchScenario> createAll(const BattleMapLayout& layout);
+
+private:
+    /** @brief 满级基地 vs 指定数量的混合部队 */
+    static BattleBenchScenario createMaxLevelBase(const BattleMapLayout& layout, int troopCount);
+
+    /** @brief 多层城墙迷宫 vs 炸弹人和野蛮人 */
+    static BattleBenchScenario createWallMaze(const BattleMapLayout& layout);
+
+    /** @brief 大量防御建筑 vs 弓箭手海 */
+    static BattleBenchScenario createArcherSwarm(const BattleMapLayout& layout);
+};
+
+#endif // __BATTLE_BENCH_SCENARIOS_H__
@@ -0,0 +1,292 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleMathBenchMain.cpp
+ * File Function: BattleMath 微基准 - 比较 SIMD 与标量实现的最近点、范围查询耗时，并校验结果逐位相同
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleMath.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const char* kUsage =
+    "用法: battle_math_bench [选项]\n"
+    "  --queries <次数>    每种元素数执行的查询次数（默认 20000）\n"
+    "  --count <元素数>    只测指定元素数（可重复，默认 16/64/256/1024/4096）\n"
+    "  --repeat <轮数>     每项重复计时的轮数，取中位数（默认 5）\n"
+    "  --json <文件>       结果写入 JSON 文件（默认输出到标准输出）\n";
+
+constexpr int32_t kMapPixels = 4000;  ///< 坐标范围（像素），与战斗地图同一量级
+constexpr int     kQueryPool = 1024;  ///< 预先生成的查询点数，循环使用
+constexpr int     kRangePx   = 300;   ///< 范围查询半径（像素，约等于防御建筑射程）
+
+volatile long long g_sink = 0; ///< 累加查询结果，防止被优化掉
+
+/**
+ * @struct Dataset
+ * @brief 一组 SoA 输入：约 3/4 存活，存活元素随机分到 4 个类别
+ */
+struct Dataset
+{
+    std::vector<int32_t> xs;
+    std::vector<int32_t> ys;
+    std::vector<uint8_t> flags;
+    std::vector<int32_t> queryX;
+    std::vector<int32_t> queryY;
+};
+
+/**
+ * @struct CountResult
+ * @brief 一种元素数的基准结果（纳秒/次查询）
+ */
+struct CountResult
+{
+    int    count            = 0;
+    double nearestScalarNs  = 0.0;
+    double nearestSimdNs    = 0.0;
+    double categoryScalarNs = 0.0;
+    double categorySimdNs   = 0.0;
+    double withinScalarNs   = 0.0;
+    double withinSimdNs     = 0.0;
+    bool   identical        = true;
+};
+
+int32_t toRaw(int32_t pixels)
+{
+    return pixels * 65536;
+}
+
+Dataset makeDataset(int count, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int32_t> coordinate(0, toRaw(kMapPixels));
+    std::uniform_int_distribution<int>     category(0, 3);
+    std::uniform_int_distribution<int>     alive(0, 3);
+
+    Dataset data;
+    for (int i = 0; i < count; ++i)
+    {
+        // 坐标取整像素，制造大量等距元素，检验同距离取下标较小者
+        data.xs.push_back(coordinate(rng) & ~0xFFFF);
+        data.ys.push_back(coordinate(rng) & ~0xFFFF);
+
+        uint8_t flags = BattleMath::categoryFlag(category(rng));
+        if (alive(rng) != 0)
+            flags |= BattleMath::kFlagAlive;
+        data.flags.push_back(flags);
+    }
+    for (int i = 0; i < kQueryPool; ++i)
+    {
+        data.queryX.push_back(coordinate(rng));
+        data.queryY.push_back(coordinate(rng));
+    }
+    return data;
+}
+
+using Clock = std::chrono::steady_clock;
+
+/** @brief 执行 repeats 轮、每轮 queries 次查询，返回每次耗时的中位数（纳秒），减少调度抖动的影响 */
+template <typename Query>
+double timeQueries(const Dataset& data, int queries, int repeats, Query query)
+{
+    std::vector<double> rounds;
+    for (int r = 0; r < repeats; ++r)
+    {
+        long long sink  = 0;
+        auto      start = Clock::now();
+        for (int q = 0; q < queries; ++q)
+        {
+            int p = q % kQueryPool;
+            sink += query(data.queryX[p], data.queryY[p]);
+        }
+        g_sink       = g_sink + sink;
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        rounds.push_back(queries > 0 ? elapsed / queries : 0.0);
+    }
+    std::sort(rounds.begin(), rounds.end());
+    return rounds.empty() ? 0.0 : rounds[rounds.size() / 2];
+}
+
+CountResult runCount(int count, int queries, int repeats, std::mt19937& rng)
+{
+    using namespace BattleMath;
+
+    CountResult result;
+    result.count = count;
+
+    Dataset          data     = makeDataset(count, rng);
+    const int32_t*   xs       = data.xs.data();
+    const int32_t*   ys       = data.ys.data();
+    const uint8_t*   flags    = data.flags.data();
+    const int64_t    noLimit  = std::numeric_limits<int64_t>::max();
+    const int64_t    range    = static_cast<int64_t>(toRaw(kRangePx)) * toRaw(kRangePx);
+    const uint8_t    category = kFlagAlive | categoryFlag(1);
+    std::vector<int> scalarOut(count), simdOut(count);
+
+    // 先逐个查询点校验两种实现结果相同
+    for (int p = 0; p < kQueryPool; ++p)
+    {
+        int32_t qx = data.queryX[p], qy = data.queryY[p];
+
+        NearestResult a = Scalar::findNearest(xs, ys, flags, kFlagAlive, count, qx, qy, noLimit);
+        NearestResult b = findNearest(xs, ys, flags, kFlagAlive, count, qx, qy, noLimit);
+        NearestResult c = Scalar::findNearest(xs, ys, flags, category, count, qx, qy, range);
+        NearestResult d = findNearest(xs, ys, flags, category, count, qx, qy, range);
+
+        int n1 = Scalar::collectWithinRange(xs, ys, flags, kFlagAlive, count, qx, qy, range, scalarOut.data());
+        int n2 = collectWithinRange(xs, ys, flags, kFlagAlive, count, qx, qy, range, simdOut.data());
+
+        if (a.index != b.index || a.distanceSquared != b.distanceSquared || c.index != d.index ||
+            c.distanceSquared != d.distanceSquared || n1 != n2 ||
+            !std::equal(scalarOut.begin(), scalarOut.begin() + n1, simdOut.begin()))
+        {
+            result.identical = false;
+        }
+    }
+
+    result.nearestScalarNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return Scalar::findNearest(xs, ys, flags, kFlagAlive, count, qx, qy, noLimit).index;
+    });
+    result.nearestSimdNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return findNearest(xs, ys, flags, kFlagAlive, count, qx, qy, noLimit).index;
+    });
+
+    result.categoryScalarNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return Scalar::findNearest(xs, ys, flags, category, count, qx, qy, range).index;
+    });
+    result.categorySimdNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return findNearest(xs, ys, flags, category, count, qx, qy, range).index;
+    });
+
+    result.withinScalarNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return Scalar::collectWithinRange(xs, ys, flags, kFlagAlive, count, qx, qy, range, scalarOut.data());
+    });
+    result.withinSimdNs = timeQueries(data, queries, repeats, [&](int32_t qx, int32_t qy) {
+        return collectWithinRange(xs, ys, flags, kFlagAlive, count, qx, qy, range, simdOut.data());
+    });
+
+    return result;
+}
+
+double speedup(double scalarNs, double simdNs)
+{
+    return simdNs > 0.0 ? scalarNs / simdNs : 0.0;
+}
+
+void writeJson(std::ostream& out, int queries, int repeats, const std::vector<CountResult>& results)
+{
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"kernel\": \"" << BattleMath::getKernelName() << "\",\n";
+    out << "  \"queries\": " << queries << ",\n";
+    out << "  \"repeat\": " << repeats << ",\n";
+    out << "  \"time_unit\": \"ns\",\n";
+    out << "  \"counts\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const CountResult& r = results[i];
+        out << "    {\n";
+        out << "      \"count\": " << r.count << ",\n";
+        out << "      \"identical\": " << (r.identical ? "true" : "false") << ",\n";
+        out << "      \"nearest\": {\"scalar\": " << r.nearestScalarNs << ", \"simd\": " << r.nearestSimdNs
+            << ", \"speedup\": " << speedup(r.nearestScalarNs, r.nearestSimdNs) << "},\n";
+        out << "      \"nearest_category_in_range\": {\"scalar\": " << r.categoryScalarNs
+            << ", \"simd\": " << r.categorySimdNs
+            << ", \"speedup\": " << speedup(r.categoryScalarNs, r.categorySimdNs) << "},\n";
+        out << "      \"within_range\": {\"scalar\": " << r.withinScalarNs << ", \"simd\": " << r.withinSimdNs
+            << ", \"speedup\": " << speedup(r.withinScalarNs, r.withinSimdNs) << "}\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int              queries = 20000;
+    int              repeats = 5;
+    std::string      jsonPath;
+    std::vector<int> counts;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg     = argv[i];
+        bool        hasNext = i + 1 < argc;
+
+        if (arg == "--queries" && hasNext)
+        {
+            queries = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--count" && hasNext)
+        {
+            counts.push_back(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--repeat" && hasNext)
+        {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--json" && hasNext)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cerr << kUsage;
+            return 0;
+        }
+        else
+        {
+            std::cerr << "未知选项: " << arg << "\n" << kUsage;
+            return 2;
+        }
+    }
+
+    if (counts.empty())
+        counts = {16, 64, 256, 1024, 4096};
+
+    // 固定种子：每次运行的数据相同
+    std::mt19937             rng(20261018);
+    std::vector<CountResult> results;
+    bool                     allIdentical = true;
+    for (int count : counts)
+    {
+        CountResult r = runCount(count, queries, repeats, rng);
+        std::cerr << std::fixed << std::setprecision(1) << "count=" << r.count << " nearest " << r.nearestScalarNs
+                  << "->" << r.nearestSimdNs << "ns within " << r.withinScalarNs << "->" << r.withinSimdNs
+                  << "ns" << (r.identical ? "" : " 结果不一致!") << std::endl;
+        allIdentical = allIdentical && r.identical;
+        results.push_back(r);
+    }
+
+    if (jsonPath.empty())
+    {
+        writeJson(std::cout, queries, repeats, results);
+    }
+    else
+    {
+        std::ofstream file(jsonPath);
+        if (!file)
+        {
+            std::cerr << "无法写入: " << jsonPath << std::endl;
+            return 2;
+        }
+        writeJson(file, queries, repeats, results);
+    }
+
+    // SIMD 与标量结果不一致会破坏回放确定性，视为失败
+    return allIdentical ? 0 : 1;
+}
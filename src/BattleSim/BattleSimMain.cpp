@@ -0,0 +1,402 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleSimMain.cpp
+ * File Function: 无界面战斗模拟命令行入口 - 回放校验、数值调优和性能回归
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleBatch.h"
+
+#include "Managers/ReplayData.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const char* kUsage =
+    "用法: battle_sim [选项] <回放文件>...\n"
+    "  --base <文件>     所有回放使用该 GameStateData JSON 作为防守方基地\n"
+    "                    （默认使用回放中记录的敌方基地快照）\n"
+    "  --snapshot <文件> 提供一份基地快照（游戏 defense_logs/<账号>/base_<哈希>.json），可重复\n"
+    "                    只记录快照哈希的回放按哈希使用对应快照\n"
+    "  --convert <目录>  把回放转换为二进制格式写入已存在的目录后退出：\n"
+    "                    基地快照去重保存为 <哈希>.json，回放保存为 <文件名>.bin\n"
+    "  --list <文件>     从文件读取回放路径，每行一个\n"
+    "  --threads <数量>  工作线程数（默认使用全部硬件线程）\n"
+    "  --repeat <次数>   每个回放重复模拟的次数（用于性能测量，结果不一致时报错）\n"
+    "  --expect <文件>   与之前保存的输出逐行比较（确定性校验），不一致时报错\n"
+    "                    回放中记录的状态摘要总会被校验，不一致时输出 DESYNC 和该帧状态\n"
+    "                    其他模拟规则版本录制的回放不校验摘要，输出 OUTDATED\n"
+    "  --quiet           只输出汇总\n";
+
+bool readFile(const std::string& path, std::string& outText)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    outText = oss.str();
+
+    // 去掉文本文件末尾的换行，旧版回放字符串本身不以换行结尾；二进制回放原样保留
+    if (ReplayData::isBinary(outText))
+        return true;
+    while (!outText.empty() && (outText.back() == '\n' || outText.back() == '\r'))
+        outText.pop_back();
+    return true;
+}
+
+const char* endReasonName(BattleSimEndReason reason)
+{
+    switch (reason)
+    {
+    case BattleSimEndReason::kAllDestroyed:
+        return "destroyed";
+    case BattleSimEndReason::kAllUnitsDead:
+        return "wiped";
+    case BattleSimEndReason::kEndEvent:
+        return "ended";
+    default:
+        return "timeout";
+    }
+}
+
+std::string formatResult(const std::string& name, const BattleSimResult& r)
+{
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(r.stateHash));
+
+    std::ostringstream oss;
+    oss << name << "\tstars=" << r.stars << "\tdestruction=" << r.destructionPercent << "\tgold=" << r.goldLooted
+        << "\telixir=" << r.elixirLooted << "\tframes=" << r.frames << "\tunits=" << r.unitsDeployed
+        << "\tend=" << endReasonName(r.endReason) << "\thash=" << hash;
+    return oss.str();
+}
+
+/**
+ * @brief 读取之前保存的输出（回放名 -> 整行）
+ * @note 战斗模拟只使用定点数，同一份回放在不同编译器、平台和优化级别下输出必须逐字相同
+ */
+bool readExpected(const std::string& path, std::map<std::string, std::string>& outLines)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        size_t tab = line.find('\t');
+        if (tab != std::string::npos)
+            outLines[line.substr(0, tab)] = line;
+    }
+    return true;
+}
+
+bool writeFile(const std::string& path, const std::string& data)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+std::string baseName(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+/**
+ * @brief 把回放转换为二进制格式，基地快照按哈希去重
+ * @return int 进程返回值
+ */
+int convertReplays(const std::vector<std::string>& replayPaths, const std::string& outDir)
+{
+    std::map<uint64_t, size_t> savedBases; // 快照哈希 -> 快照字节数
+    size_t                     oldBytes = 0;
+    size_t                     newBytes = 0;
+    int                        failed   = 0;
+
+    for (const auto& path : replayPaths)
+    {
+        std::string text;
+        ReplayData  replay;
+        try
+        {
+            if (!readFile(path, text))
+                throw std::runtime_error("unreadable file");
+            replay = ReplayData::deserialize(text);
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << path << "	error=" << e.what() << std::endl;
+            ++failed;
+            continue;
+        }
+
+        if (!replay.enemyGameDataJson.empty())
+        {
+            replay.baseSnapshotHash = ReplayData::hashBaseSnapshot(replay.enemyGameDataJson);
+            if (savedBases.find(replay.baseSnapshotHash) == savedBases.end())
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx.json", static_cast<unsigned long long>(replay.baseSnapshotHash));
+                if (!writeFile(outDir + "/" + name, replay.enemyGameDataJson))
+                {
+                    std::cout << path << "	error=cannot write " << name << std::endl;
+                    ++failed;
+                    continue;
+                }
+                savedBases[replay.baseSnapshotHash] = replay.enemyGameDataJson.size();
+                newBytes += replay.enemyGameDataJson.size();
+            }
+        }
+
+        std::string binary  = replay.serialize(false);
+        std::string outPath = outDir + "/" + baseName(path) + ".bin";
+        if (!writeFile(outPath, binary))
+        {
+            std::cout << path << "	error=cannot write " << outPath << std::endl;
+            ++failed;
+            continue;
+        }
+
+        oldBytes += text.size();
+        newBytes += binary.size();
+        std::cout << path << "	bytes=" << text.size() << "	converted=" << binary.size() << "	events=" << replay.events.size()
+                  << std::endl;
+    }
+
+    std::cerr << "replays=" << replayPaths.size() << " failed=" << failed << " bases=" << savedBases.size()
+              << " old_bytes=" << oldBytes << " new_bytes=" << newBytes << std::endl;
+    return failed > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> replayPaths;
+    std::vector<std::string> snapshotPaths;
+    std::string              basePath;
+    std::string              convertDir;
+    std::string              expectPath;
+    int                      threadCount = 0;
+    int                      repeat      = 1;
+    bool                     quiet       = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg     = argv[i];
+        bool        hasNext = i + 1 < argc;
+
+        if (arg == "--base" && hasNext)
+        {
+            basePath = argv[++i];
+        }
+        else if (arg == "--snapshot" && hasNext)
+        {
+            snapshotPaths.push_back(argv[++i]);
+        }
+        else if (arg == "--convert" && hasNext)
+        {
+            convertDir = argv[++i];
+        }
+        else if (arg == "--list" && hasNext)
+        {
+            std::ifstream list(argv[++i]);
+            std::string   line;
+            while (std::getline(list, line))
+            {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    replayPaths.push_back(line);
+            }
+        }
+        else if (arg == "--threads" && hasNext)
+        {
+            threadCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--repeat" && hasNext)
+        {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--expect" && hasNext)
+        {
+            expectPath = argv[++i];
+        }
+        else if (arg == "--quiet")
+        {
+            quiet = true;
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            std::cerr << kUsage;
+            return 0;
+        }
+        else if (arg[0] == '-')
+        {
+            std::cerr << "未知选项: " << arg << "\n" << kUsage;
+            return 2;
+        }
+        else
+        {
+            replayPaths.push_back(arg);
+        }
+    }
+
+    if (replayPaths.empty())
+    {
+        std::cerr << kUsage;
+        return 2;
+    }
+
+    if (!convertDir.empty())
+        return convertReplays(replayPaths, convertDir);
+
+    BattleBatch batch(threadCount);
+    for (const auto& path : snapshotPaths)
+    {
+        std::string baseJson;
+        if (!readFile(path, baseJson))
+        {
+            std::cerr << "无法读取基地快照: " << path << std::endl;
+            return 2;
+        }
+        batch.addBaseSnapshot(baseJson);
+    }
+    if (!basePath.empty())
+    {
+        std::string baseJson;
+        if (!readFile(basePath, baseJson) || !batch.setBaseOverride(baseJson))
+        {
+            std::cerr << "无法读取基地数据: " << basePath << std::endl;
+            return 2;
+        }
+    }
+
+    std::map<std::string, std::string> expected;
+    if (!expectPath.empty() && !readExpected(expectPath, expected))
+    {
+        std::cerr << "无法读取期望结果: " << expectPath << std::endl;
+        return 2;
+    }
+
+    std::vector<BattleBatchJob> jobs;
+    jobs.reserve(replayPaths.size() * repeat);
+    int unreadable = 0;
+    for (const auto& path : replayPaths)
+    {
+        BattleBatchJob job;
+        job.name = path;
+        if (!readFile(path, job.replayText))
+        {
+            std::cout << path << "\terror=unreadable file" << std::endl;
+            ++unreadable;
+            continue;
+        }
+        for (int r = 0; r < repeat; ++r)
+        {
+            jobs.push_back(job);
+        }
+    }
+
+    auto start   = std::chrono::steady_clock::now();
+    auto results = batch.run(jobs);
+    auto end     = std::chrono::steady_clock::now();
+
+    int                failed      = unreadable;
+    int                mismatched  = 0;
+    int                outdated    = 0;
+    unsigned long long totalFrames = 0;
+    std::string        firstLine;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const BattleBatchResult& batchResult = results[i];
+        if (!batchResult.ok)
+        {
+            ++failed;
+            std::cout << jobs[i].name << "\terror=" << batchResult.error << std::endl;
+            continue;
+        }
+
+        const BattleSimResult& r = batchResult.result;
+        totalFrames += r.frames;
+
+        // 重复模拟的结果必须与第一次完全相同，只输出一次
+        std::string line = formatResult(jobs[i].name, r);
+        if (i % repeat != 0)
+        {
+            if (line != firstLine)
+            {
+                ++mismatched;
+                std::cout << "MISMATCH(repeat)\t" << line << "\n";
+            }
+            continue;
+        }
+        firstLine = line;
+
+        // 规则版本不同的回放只能按当前规则重新模拟，结果与录制时不可比
+        if (r.rulesMismatch)
+        {
+            ++outdated;
+            std::cout << "OUTDATED\t" << jobs[i].name << "\tcurrent_rules=" << BattleWorld::kRulesVersion << "\n";
+        }
+
+        // 回放中记录了状态摘要时，第一个不一致的帧及当时的状态
+        if (r.desyncFrame != 0)
+        {
+            ++mismatched;
+            std::cout << "DESYNC\t" << jobs[i].name << "\tframe=" << r.desyncFrame << "\n";
+            if (!quiet)
+                std::cerr << jobs[i].name << " 第 " << r.desyncFrame << " 帧状态:\n" << r.desyncDump;
+        }
+
+        if (!expected.empty())
+        {
+            auto it = expected.find(jobs[i].name);
+            if (it == expected.end() || it->second != line)
+            {
+                ++mismatched;
+                std::cout << "MISMATCH\t" << line << "\n";
+                if (it != expected.end())
+                    std::cout << "EXPECTED\t" << it->second << "\n";
+                continue;
+            }
+        }
+
+        if (!quiet)
+            std::cout << line << "\n";
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cerr << "battles=" << jobs.size() << " failed=" << failed << " mismatched=" << mismatched << " outdated=" << outdated << " threads=" << batch.getThreadCount()
+              << " seconds=" << seconds;
+    if (seconds > 0.0)
+    {
+        std::cerr << " battles_per_sec=" << jobs.size() / seconds << " steps_per_sec=" << totalFrames / seconds
+                  << " replay_seconds_per_sec=" << totalFrames * BattleSimulator::kFixedTimeStep / seconds;
+    }
+    std::cerr << std::endl;
+
+    return (failed > 0 || mismatched > 0) ? 1 : 0;
+}
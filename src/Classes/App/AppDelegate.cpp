@@ -43,8 +43,11 @@
 #include "Managers/AccountManager.h"
 #include "Managers/ResourceManager.h"
 #include "Managers/ResourceCollectionManager.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Managers/TroopInventory.h"
 #include "Managers/UpgradeManager.h"
+#include "UI/ProfilerOverlay.h"
+#include "Unit/UnitAnimationLibrary.h"
 #include "audio/include/AudioEngine.h"
 // #define USE_AUDIO_ENGINE 1
 #if USE_AUDIO_ENGINE
@@ -69,6 +72,7 @@ AppDelegate::~AppDelegate()
     TroopInventory::destroyInstance();
     ResourceManager::destroyInstance();
     UpgradeManager::destroyInstance();
+    UnitAnimationLibrary::getInstance().clear();
 }
 // if you want a different context, modify the value of glContextAttrs
 // it will affect all platforms
@@ -137,6 +141,13 @@ bool AppDelegate::applicationDidFinishLaunching()
     }
 #endif
     register_all_packages();
+
+    // 性能面板：F3 显示各作用域耗时，F4 录制 Chrome Trace（FRAME_PROFILER_ENABLED=0 时不安装）
+    ProfilerOverlay::install();
+
+    // 图集清单：散图路径 -> 图集帧（清单不存在时全部使用散图）
+    SpriteAtlasManager::getInstance().loadManifest();
+
     // 新增：初始化资源管理器并设置初始资源
     CCLOG("Initializing Resource Manager...");
     auto resourceManager = &ResourceManager::getInstance();
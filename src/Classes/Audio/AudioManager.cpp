@@ -137,6 +137,10 @@ int AudioManager::PlayEffect(SoundEffectId effect_id) {
 }
 
 int AudioManager::PlayEffectByPath(const std::string& file_path) {
+  if (effects_suppressed_) {
+    return kInvalidAudioId;
+  }
+
   float volume = CalculateActualVolume(effect_volume_);
   int audio_id = cocos2d::AudioEngine::play2d(file_path, false, volume);
 
@@ -166,6 +166,14 @@ class AudioManager {
   /** @brief 获取静音状态 */
   bool IsMuted() const { return is_muted_; }
 
+  /**
+   * @brief 临时屏蔽音效（不影响音乐，不保存到设置）
+   *
+   * 观战追帧时无渲染地快速模拟，期间产生的音效全部丢弃。
+   * @param suppressed 是否屏蔽
+   */
+  void SetEffectsSuppressed(bool suppressed) { effects_suppressed_ = suppressed; }
+
   // ==================== 预加载 ====================
 
   /**
@@ -244,6 +252,9 @@ class AudioManager {
   /// 是否已初始化
   bool is_initialized_ = false;
 
+  /// 音效是否被临时屏蔽
+  bool effects_suppressed_ = false;
+
   // ==================== 设置键名常量 ====================
 
   static constexpr const char* kKeyMusicVolume = "AudioManager_MusicVolume";
@@ -0,0 +1,445 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleMath.cpp
+ * File Function: 战斗批量几何计算实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleMath.h"
+
+#include <cstring>
+
+#if defined(BATTLE_MATH_SCALAR)
+#define BATTLE_MATH_USE_SCALAR
+#elif defined(__AVX2__)
+#define BATTLE_MATH_USE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATTLE_MATH_USE_SSE2
+#include <emmintrin.h>
+// 默认 x86 编译选项只保证 SSE2：AVX2 内核按函数单独以 AVX2 编译，运行时检测到 CPU 支持才调用
+#if !defined(BATTLE_MATH_NO_DISPATCH)
+#define BATTLE_MATH_DISPATCH_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+#else
+#define BATTLE_MATH_USE_SCALAR
+#endif
+
+#if defined(BATTLE_MATH_USE_AVX2) || defined(BATTLE_MATH_DISPATCH_AVX2)
+#define BATTLE_MATH_HAS_AVX2_KERNEL
+#endif
+
+// GCC/Clang 需要给使用 AVX2 指令的函数标注目标；MSVC 不限制内建函数的指令集
+#if defined(BATTLE_MATH_DISPATCH_AVX2) && (defined(__GNUC__) || defined(__clang__))
+#define BATTLE_MATH_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define BATTLE_MATH_AVX2_TARGET
+#endif
+
+namespace BattleMath
+{
+
+namespace
+{
+
+/**
+ * @brief 单个元素的平方距离
+ * @note 差值按 32 位回绕（同 Fixed 减法），平方和按 64 位无符号相加后转回，与各 SIMD 实现逐位一致
+ */
+inline int64_t distanceSquared(int32_t x, int32_t y, int32_t qx, int32_t qy)
+{
+    int32_t dx = static_cast<int32_t>(static_cast<uint32_t>(x) - static_cast<uint32_t>(qx));
+    int32_t dy = static_cast<int32_t>(static_cast<uint32_t>(y) - static_cast<uint32_t>(qy));
+    return static_cast<int64_t>(static_cast<uint64_t>(static_cast<int64_t>(dx) * dx) +
+                                static_cast<uint64_t>(static_cast<int64_t>(dy) * dy));
+}
+
+inline bool hasFlags(uint8_t flags, uint8_t requiredFlags)
+{
+    return (flags & requiredFlags) == requiredFlags;
+}
+
+/** @brief 从 begin 开始用标量处理剩余元素，接着已有的最近结果继续比较 */
+NearestResult nearestTail(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags,
+                          int begin, int count, int32_t qx, int32_t qy, int64_t maxDistanceSquared,
+                          NearestResult best)
+{
+    for (int i = begin; i < count; ++i)
+    {
+        if (!hasFlags(flags[i], requiredFlags))
+            continue;
+
+        int64_t distance = distanceSquared(xs[i], ys[i], qx, qy);
+        if (distance <= maxDistanceSquared && distance < best.distanceSquared)
+        {
+            best.index           = i;
+            best.distanceSquared = distance;
+        }
+    }
+    return best;
+}
+
+int withinTail(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int begin,
+               int count, int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices, int found)
+{
+    for (int i = begin; i < count; ++i)
+    {
+        if (hasFlags(flags[i], requiredFlags) && distanceSquared(xs[i], ys[i], qx, qy) <= radiusSquared)
+            outIndices[found++] = i;
+    }
+    return found;
+}
+
+#if defined(BATTLE_MATH_HAS_AVX2_KERNEL)
+
+/**
+ * @brief 各通道最优距离的初值
+ * @note 把"距离 <= 上限"并进"距离 < 通道最优"，循环内每个通道只需一次比较。
+ *       平方距离之和不可能等于 2^63 - 1（模 4 余 3），上限为 int64 最大值时初值取最大值不会漏掉元素
+ */
+inline int64_t initialThreshold(int64_t maxDistanceSquared)
+{
+    if (maxDistanceSquared < 0)
+        return 0;
+    if (maxDistanceSquared == std::numeric_limits<int64_t>::max())
+        return maxDistanceSquared;
+    return maxDistanceSquared + 1;
+}
+
+/** @brief 合并各通道的最近结果：距离小者优先，同距离取下标较小者 */
+inline void mergeLane(NearestResult& best, int64_t distance, int64_t index)
+{
+    if (index < 0)
+        return;
+    if (distance < best.distanceSquared || (distance == best.distanceSquared && index < best.index))
+    {
+        best.index           = static_cast<int>(index);
+        best.distanceSquared = distance;
+    }
+}
+
+#endif
+
+#if !defined(BATTLE_MATH_USE_SCALAR)
+
+inline int appendBits(unsigned bits, int base, int* outIndices, int found)
+{
+    for (int k = 0; bits != 0; ++k, bits >>= 1)
+    {
+        if (bits & 1u)
+            outIndices[found++] = base + k;
+    }
+    return found;
+}
+
+/** @brief 把偶数下标和奇数下标通道的命中位交错成按元素顺序的位掩码 */
+inline unsigned interleaveBits(unsigned evenBits, unsigned oddBits, int lanes)
+{
+    unsigned bits = 0;
+    for (int k = 0; k < lanes; ++k)
+    {
+        bits |= ((evenBits >> k) & 1u) << (2 * k);
+        bits |= ((oddBits >> k) & 1u) << (2 * k + 1);
+    }
+    return bits;
+}
+
+#endif
+
+#if defined(BATTLE_MATH_HAS_AVX2_KERNEL)
+
+// 每次 8 个元素：32 位差值 -> _mm256_mul_epi32 分别得到偶数位和奇数位元素的 64 位平方
+namespace Avx2
+{
+
+BATTLE_MATH_AVX2_TARGET inline __m256i set1Epi64(int64_t value)
+{
+    return _mm256_broadcastq_epi64(_mm_set_epi32(static_cast<int32_t>(value >> 32), static_cast<int32_t>(value),
+                                                 static_cast<int32_t>(value >> 32), static_cast<int32_t>(value)));
+}
+
+/** @brief 8 个标志字节 -> 满足条件的元素对应 32 位全 1 */
+BATTLE_MATH_AVX2_TARGET inline __m256i flagMask(const uint8_t* flags, __m256i required)
+{
+    __m256i f = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(flags)));
+    return _mm256_cmpeq_epi32(_mm256_and_si256(f, required), required);
+}
+
+/** @brief 计算 8 个元素的平方距离，even 通道 k 对应元素 2k，odd 通道 k 对应元素 2k+1 */
+BATTLE_MATH_AVX2_TARGET inline void distances8(const int32_t* xs, const int32_t* ys, __m256i qx, __m256i qy,
+                                               __m256i& even, __m256i& odd)
+{
+    __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs)), qx);
+    __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys)), qy);
+    even       = _mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy));
+
+    __m256i dxOdd = _mm256_srli_epi64(dx, 32);
+    __m256i dyOdd = _mm256_srli_epi64(dy, 32);
+    odd           = _mm256_add_epi64(_mm256_mul_epi32(dxOdd, dxOdd), _mm256_mul_epi32(dyOdd, dyOdd));
+}
+
+BATTLE_MATH_AVX2_TARGET NearestResult findNearest(const int32_t* xs, const int32_t* ys, const uint8_t* flags,
+                                                  uint8_t requiredFlags, int count, int32_t qx, int32_t qy,
+                                                  int64_t maxDistanceSquared)
+{
+    const __m256i qxv      = _mm256_set1_epi32(qx);
+    const __m256i qyv      = _mm256_set1_epi32(qy);
+    const __m256i required = _mm256_set1_epi32(requiredFlags);
+    const __m256i step     = set1Epi64(8);
+
+    __m256i bestEven  = set1Epi64(initialThreshold(maxDistanceSquared));
+    __m256i bestOdd   = bestEven;
+    __m256i indexEven = set1Epi64(-1);
+    __m256i indexOdd  = indexEven;
+    __m256i laneEven  = _mm256_setr_epi32(0, 0, 2, 0, 4, 0, 6, 0);
+    __m256i laneOdd   = _mm256_setr_epi32(1, 0, 3, 0, 5, 0, 7, 0);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i even, odd;
+        distances8(xs + i, ys + i, qxv, qyv, even, odd);
+
+        // 条件：标志满足 && 距离 < 当前通道最优（初值已含上限）
+        __m256i mask   = flagMask(flags + i, required);
+        __m256i okEven = _mm256_and_si256(_mm256_shuffle_epi32(mask, _MM_SHUFFLE(2, 2, 0, 0)),
+                                          _mm256_cmpgt_epi64(bestEven, even));
+        __m256i okOdd  = _mm256_and_si256(_mm256_shuffle_epi32(mask, _MM_SHUFFLE(3, 3, 1, 1)),
+                                          _mm256_cmpgt_epi64(bestOdd, odd));
+
+        bestEven  = _mm256_blendv_epi8(bestEven, even, okEven);
+        indexEven = _mm256_blendv_epi8(indexEven, laneEven, okEven);
+        bestOdd   = _mm256_blendv_epi8(bestOdd, odd, okOdd);
+        indexOdd  = _mm256_blendv_epi8(indexOdd, laneOdd, okOdd);
+
+        laneEven = _mm256_add_epi64(laneEven, step);
+        laneOdd  = _mm256_add_epi64(laneOdd, step);
+    }
+
+    int64_t distances[8], indices[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(distances), bestEven);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(distances + 4), bestOdd);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), indexEven);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + 4), indexOdd);
+
+    NearestResult best;
+    for (int k = 0; k < 8; ++k)
+        mergeLane(best, distances[k], indices[k]);
+
+    return nearestTail(xs, ys, flags, requiredFlags, i, count, qx, qy, maxDistanceSquared, best);
+}
+
+BATTLE_MATH_AVX2_TARGET int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags,
+                                               uint8_t requiredFlags, int count, int32_t qx, int32_t qy,
+                                               int64_t radiusSquared, int* outIndices)
+{
+    const __m256i qxv      = _mm256_set1_epi32(qx);
+    const __m256i qyv      = _mm256_set1_epi32(qy);
+    const __m256i required = _mm256_set1_epi32(requiredFlags);
+    const __m256i radius   = set1Epi64(radiusSquared);
+
+    int found = 0;
+    int i     = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i even, odd;
+        distances8(xs + i, ys + i, qxv, qyv, even, odd);
+
+        __m256i mask   = flagMask(flags + i, required);
+        __m256i okEven = _mm256_andnot_si256(_mm256_cmpgt_epi64(even, radius),
+                                             _mm256_shuffle_epi32(mask, _MM_SHUFFLE(2, 2, 0, 0)));
+        __m256i okOdd  = _mm256_andnot_si256(_mm256_cmpgt_epi64(odd, radius),
+                                             _mm256_shuffle_epi32(mask, _MM_SHUFFLE(3, 3, 1, 1)));
+
+        unsigned bits = interleaveBits(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(okEven))),
+                                       static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(okOdd))), 4);
+        found = appendBits(bits, i, outIndices, found);
+    }
+
+    return withinTail(xs, ys, flags, requiredFlags, i, count, qx, qy, radiusSquared, outIndices, found);
+}
+
+} // namespace Avx2
+
+#endif
+
+#if defined(BATTLE_MATH_USE_SSE2)
+
+// 只有范围查询：每次 4 个元素。SSE2 没有有符号 32 位乘法和 64 位比较：
+// 先取差值的绝对值再用 _mm_mul_epu32（|d|^2 == d^2）；参与比较的值都在 [0, 2^63) 内，
+// 用 64 位减法结果的符号位代替比较。
+// 最近点查询每个元素要做两次比较和选择，实测不比标量快（带类别过滤时更慢），SSE2 下走标量
+namespace Sse2
+{
+
+inline __m128i set1Epi64(int64_t value)
+{
+    return _mm_set_epi32(static_cast<int32_t>(value >> 32), static_cast<int32_t>(value),
+                         static_cast<int32_t>(value >> 32), static_cast<int32_t>(value));
+}
+
+inline __m128i abs32(__m128i v)
+{
+    __m128i sign = _mm_srai_epi32(v, 31);
+    return _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+}
+
+inline __m128i flagMask(const uint8_t* flags, __m128i required)
+{
+    int32_t packed;
+    std::memcpy(&packed, flags, sizeof(packed));
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i       f    = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+    return _mm_cmpeq_epi32(_mm_and_si128(f, required), required);
+}
+
+/** @brief 计算 4 个元素的平方距离，even 通道 k 对应元素 2k，odd 通道 k 对应元素 2k+1 */
+inline void distances4(const int32_t* xs, const int32_t* ys, __m128i qx, __m128i qy, __m128i& even, __m128i& odd)
+{
+    __m128i dx = abs32(_mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs)), qx));
+    __m128i dy = abs32(_mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys)), qy));
+    even       = _mm_add_epi64(_mm_mul_epu32(dx, dx), _mm_mul_epu32(dy, dy));
+
+    __m128i dxOdd = _mm_srli_epi64(dx, 32);
+    __m128i dyOdd = _mm_srli_epi64(dy, 32);
+    odd           = _mm_add_epi64(_mm_mul_epu32(dxOdd, dxOdd), _mm_mul_epu32(dyOdd, dyOdd));
+}
+
+int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int count,
+                       int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices)
+{
+    const __m128i qxv      = _mm_set1_epi32(qx);
+    const __m128i qyv      = _mm_set1_epi32(qy);
+    const __m128i required = _mm_set1_epi32(requiredFlags);
+    const __m128i radius   = set1Epi64(radiusSquared);
+
+    int found = 0;
+    int i     = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i even, odd;
+        distances4(xs + i, ys + i, qxv, qyv, even, odd);
+
+        // radius - d 的符号位为 1 表示超出范围；标志不满足的元素直接清掉
+        unsigned mask    = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(flagMask(flags + i, required))));
+        unsigned outEven = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(radius, even))));
+        unsigned outOdd  = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(radius, odd))));
+
+        unsigned bits = mask & ~interleaveBits(outEven, outOdd, 2);
+        if (bits != 0)
+            found = appendBits(bits, i, outIndices, found);
+    }
+
+    return withinTail(xs, ys, flags, requiredFlags, i, count, qx, qy, radiusSquared, outIndices, found);
+}
+
+} // namespace Sse2
+
+#endif
+
+#if defined(BATTLE_MATH_DISPATCH_AVX2)
+
+/** @brief CPU 支持 AVX2 且操作系统保存 YMM 寄存器 */
+bool detectAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const int osxsave = 1 << 27;
+    const int avx     = 1 << 28;
+    if ((info[2] & (osxsave | avx)) != (osxsave | avx) || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+/** @brief 只检测一次，之后每次查询只读取结果 */
+bool hasAvx2()
+{
+    static const bool supported = detectAvx2();
+    return supported;
+}
+
+#endif
+
+} // namespace
+
+// ==================== 标量实现 ====================
+
+namespace Scalar
+{
+
+NearestResult findNearest(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags,
+                          int count, int32_t qx, int32_t qy, int64_t maxDistanceSquared)
+{
+    return nearestTail(xs, ys, flags, requiredFlags, 0, count, qx, qy, maxDistanceSquared, NearestResult());
+}
+
+int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int count,
+                       int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices)
+{
+    return withinTail(xs, ys, flags, requiredFlags, 0, count, qx, qy, radiusSquared, outIndices, 0);
+}
+
+} // namespace Scalar
+
+// ==================== 对外接口 ====================
+
+NearestResult findNearest(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags,
+                          int count, int32_t qx, int32_t qy, int64_t maxDistanceSquared)
+{
+#if defined(BATTLE_MATH_USE_AVX2)
+    return Avx2::findNearest(xs, ys, flags, requiredFlags, count, qx, qy, maxDistanceSquared);
+#else
+#if defined(BATTLE_MATH_DISPATCH_AVX2)
+    if (hasAvx2())
+        return Avx2::findNearest(xs, ys, flags, requiredFlags, count, qx, qy, maxDistanceSquared);
+#endif
+    return Scalar::findNearest(xs, ys, flags, requiredFlags, count, qx, qy, maxDistanceSquared);
+#endif
+}
+
+int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int count,
+                       int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices)
+{
+#if defined(BATTLE_MATH_USE_AVX2)
+    return Avx2::collectWithinRange(xs, ys, flags, requiredFlags, count, qx, qy, radiusSquared, outIndices);
+#elif defined(BATTLE_MATH_USE_SSE2)
+#if defined(BATTLE_MATH_DISPATCH_AVX2)
+    if (hasAvx2())
+        return Avx2::collectWithinRange(xs, ys, flags, requiredFlags, count, qx, qy, radiusSquared, outIndices);
+#endif
+    return Sse2::collectWithinRange(xs, ys, flags, requiredFlags, count, qx, qy, radiusSquared, outIndices);
+#else
+    return Scalar::collectWithinRange(xs, ys, flags, requiredFlags, count, qx, qy, radiusSquared, outIndices);
+#endif
+}
+
+const char* getKernelName()
+{
+#if defined(BATTLE_MATH_USE_AVX2)
+    return "avx2";
+#elif defined(BATTLE_MATH_DISPATCH_AVX2)
+    return hasAvx2() ? "avx2" : "sse2";
+#elif defined(BATTLE_MATH_USE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace BattleMath
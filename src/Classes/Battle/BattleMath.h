@@ -0,0 +1,100 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleMath.h
+ * File Function: 战斗批量几何计算 - 在分开存放的定点坐标数组上做最近点和范围查询（SIMD + 标量实现）
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_MATH_H__
+#define __BATTLE_MATH_H__
+
+#include <cstdint>
+#include <limits>
+
+/**
+ * @namespace BattleMath
+ * @brief 目标搜索内核
+ *
+ * 输入为 x、y 分开存放的 Q16.16 底层整数数组和每个元素一个字节的标志，
+ * 只计算 64 位平方距离（与 SimVec2::distanceSquaredRaw 完全一致），不开方。
+ * 元素满足 (flags[i] & requiredFlags) == requiredFlags 时参与查询。
+ *
+ * 实现选择：以 -mavx2 编译时固定用 AVX2（每次 8 个元素）；其余 x86 编译选项下运行时检测 CPU，
+ * 支持 AVX2 时用 AVX2，否则 SSE2 只加速范围查询（每次 4 个元素），最近点查询用标量
+ * （定义 BATTLE_MATH_NO_DISPATCH 时不编译 AVX2 内核）；其余平台（含 aarch64）或定义 BATTLE_MATH_SCALAR 时使用标量实现。
+ * 各实现结果逐位相同（同距离取下标较小者），不影响回放确定性。
+ * 前提：坐标差的绝对值小于 2^31（约 32768 像素，远大于战斗地图），平方上限不为负。
+ */
+namespace BattleMath
+{
+
+constexpr uint8_t kFlagAlive = 0x01; ///< 存活（单位和建筑通用）
+
+/**
+ * @brief 类别标志（建筑类别等，0 ~ 6）
+ * @param category 类别编号
+ * @return uint8_t 标志位
+ */
+constexpr uint8_t categoryFlag(int category)
+{
+    return static_cast<uint8_t>(0x02u << category);
+}
+
+/**
+ * @struct NearestResult
+ * @brief 最近点查询结果
+ */
+struct NearestResult
+{
+    int     index           = -1;                                  ///< 最近元素下标，没有符合条件的元素时为 -1
+    int64_t distanceSquared = std::numeric_limits<int64_t>::max(); ///< 平方距离（Q32.32）
+};
+
+/**
+ * @brief 最近点查询
+ * @param xs X 坐标底层值
+ * @param ys Y 坐标底层值
+ * @param flags 元素标志
+ * @param requiredFlags 需要全部满足的标志位
+ * @param count 元素数
+ * @param qx 查询点 X 底层值
+ * @param qy 查询点 Y 底层值
+ * @param maxDistanceSquared 平方距离上限（含），不限制时传 int64 最大值
+ * @return NearestResult 平方距离最小的元素（同距离取下标较小者）
+ */
+NearestResult findNearest(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags,
+                          int count, int32_t qx, int32_t qy, int64_t maxDistanceSquared);
+
+/**
+ * @brief 范围查询
+ * @param outIndices 输出下标（按升序），容量至少为 count
+ * @param radiusSquared 平方半径（含边界）
+ * @return int 范围内的元素数
+ * @note 其余参数同 findNearest
+ */
+int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int count,
+                       int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices);
+
+/** @brief 当前使用的实现名称（"avx2" / "sse2" / "scalar"，运行时选择时为检测结果） */
+const char* getKernelName();
+
+/**
+ * @namespace BattleMath::Scalar
+ * @brief 标量参考实现（始终可用，基准测试和一致性校验使用）
+ */
+namespace Scalar
+{
+
+NearestResult findNearest(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags,
+                          int count, int32_t qx, int32_t qy, int64_t maxDistanceSquared);
+
+int collectWithinRange(const int32_t* xs, const int32_t* ys, const uint8_t* flags, uint8_t requiredFlags, int count,
+                       int32_t qx, int32_t qy, int64_t radiusSquared, int* outIndices);
+
+} // namespace Scalar
+
+} // namespace BattleMath
+
+#endif // __BATTLE_MATH_H__
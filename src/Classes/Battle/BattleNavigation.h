@@ -0,0 +1,56 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleNavigation.h
+ * File Function: 战斗寻路接口 - BattleWorld 通过它为单位请求路径
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_NAVIGATION_H__
+#define __BATTLE_NAVIGATION_H__
+
+#include "BattleTypes.h"
+
+class BattleWorld;
+
+/**
+ * @class BattleNavigation
+ * @brief 战斗寻路接口
+ *
+ * BattleWorld 不知道地图的具体形式，需要绕路时通过该接口请求路径；
+ * 实现方通过 BattleWorld::moveUnitTo / moveUnitAlongPath 把结果交给单位。
+ * 未设置寻路实现时单位直线走向目标。
+ */
+class BattleNavigation
+{
+public:
+    virtual ~BattleNavigation() = default;
+
+    /**
+     * @brief 单位需要走向目标建筑
+     * @param world 战斗世界
+     * @param unit 单位下标
+     * @param target 目标建筑下标
+     * @note 实现方必须让单位立即开始移动（路径未就绪时先直线移动）
+     */
+    virtual void requestPath(BattleWorld& world, UnitIndex unit, BuildingIndex target) = 0;
+
+    /** @brief 单位换目标或死亡，尚未应用的请求作废 */
+    virtual void cancelPath(UnitIndex unit) = 0;
+
+    /**
+     * @brief 每个固定步开始时调用，应用到期的寻路结果
+     * @param world 战斗世界
+     */
+    virtual void beginStep(BattleWorld& world) = 0;
+
+    /**
+     * @brief 建筑被摧毁，占地不再阻挡
+     * @param world 战斗世界
+     * @param building 建筑下标
+     */
+    virtual void onBuildingDestroyed(BattleWorld& world, BuildingIndex building) = 0;
+};
+
+#endif // __BATTLE_NAVIGATION_H__
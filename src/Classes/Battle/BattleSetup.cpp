@@ -0,0 +1,217 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleSetup.cpp
+ * File Function: 战斗初始化实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleSetup.h"
+
+#include "Buildings/BuildingHitpoints.h"
+#include "Managers/GameDataModels.h"
+#include "Unit/CombatStats.h"
+
+#include <string>
+
+namespace
+{
+
+/** @brief 存档中的建筑种类（与 BuildingManager::createBuildingFromSerialData 的判断顺序一致） */
+enum class SerialBuildingKind
+{
+    kUnknown,
+    kTownHall,
+    kGoldMine,
+    kElixirCollector,
+    kGoldStorage,
+    kElixirStorage,
+    kBarracks,
+    kArmyCamp,
+    kWall,
+    kBuildersHut,
+    kArcherTower,
+    kCannon
+};
+
+bool contains(const std::string& text, const char* word)
+{
+    return text.find(word) != std::string::npos;
+}
+
+SerialBuildingKind parseBuildingKind(std::string name)
+{
+    // 移除等级后缀和括号残留
+    size_t lvPos = name.find(" (Lv.");
+    if (lvPos == std::string::npos)
+        lvPos = name.find(" Lv.");
+    if (lvPos != std::string::npos)
+        name = name.substr(0, lvPos);
+
+    size_t bracketPos = name.find(" (");
+    if (bracketPos != std::string::npos)
+        name = name.substr(0, bracketPos);
+
+    if (contains(name, "Town Hall") || contains(name, "大本营"))
+        return SerialBuildingKind::kTownHall;
+    if (contains(name, "Gold Mine") || contains(name, "金矿"))
+        return SerialBuildingKind::kGoldMine;
+    if (contains(name, "Elixir Collector") || contains(name, "圣水收集器"))
+        return SerialBuildingKind::kElixirCollector;
+    if (contains(name, "Gold Storage") || contains(name, "金币仓库"))
+        return SerialBuildingKind::kGoldStorage;
+    if (contains(name, "Elixir Storage") || contains(name, "圣水仓库"))
+        return SerialBuildingKind::kElixirStorage;
+    if (contains(name, "Barracks") || contains(name, "兵营"))
+        return SerialBuildingKind::kBarracks;
+    if (contains(name, "Army Camp") || contains(name, "军营"))
+        return SerialBuildingKind::kArmyCamp;
+    if (contains(name, "Wall") || contains(name, "城墙"))
+        return SerialBuildingKind::kWall;
+    if (contains(name, "Builder") || contains(name, "建筑工人"))
+        return SerialBuildingKind::kBuildersHut;
+    if (contains(name, "Archer Tower") || contains(name, "箭塔"))
+        return SerialBuildingKind::kArcherTower;
+    if (contains(name, "Cannon") || contains(name, "加农炮"))
+        return SerialBuildingKind::kCannon;
+    return SerialBuildingKind::kUnknown;
+}
+
+void applyDefenseStats(const CombatStats& stats, float projectileSpeed, BattleBuildingDesc& desc)
+{
+    desc.kind            = BattleBuildingKind::kDefense;
+    desc.maxHitpoints    = stats.maxHitpoints;
+    desc.armed           = true;
+    desc.damage          = stats.damage;
+    desc.attackRange     = stats.attackRange;
+    desc.attackSpeed     = stats.attackSpeed;
+    desc.projectileSpeed = projectileSpeed;
+}
+
+} // namespace
+
+SimVec2 BattleMapLayout::gridToPosition(float gridX, float gridY) const
+{
+    float halfW = tileSize / 2.0f;
+    float halfH = halfW * 0.75f;
+
+    float x = (gridX - gridY) * halfW + startPixelX;
+    float y = startPixelY - (gridX + gridY) * halfH;
+
+    return SimVec2::fromFloat(x, y);
+}
+
+bool BattleSetup::makeBuildingDesc(const BuildingSerialData& data, const BattleMapLayout& layout,
+                                   BattleBuildingDesc& outDesc)
+{
+    SerialBuildingKind kind  = parseBuildingKind(data.name);
+    int                level = data.level;
+
+    BattleBuildingDesc desc;
+    switch (kind)
+    {
+    case SerialBuildingKind::kTownHall:
+        desc.kind         = BattleBuildingKind::kTownHall;
+        desc.maxHitpoints = BuildingHitpoints::getTownHall(level);
+        break;
+    case SerialBuildingKind::kGoldMine:
+    case SerialBuildingKind::kElixirCollector:
+        desc.kind         = BattleBuildingKind::kResource;
+        desc.maxHitpoints = BuildingHitpoints::getProducer(level);
+        break;
+    case SerialBuildingKind::kGoldStorage:
+    case SerialBuildingKind::kElixirStorage:
+        desc.kind         = BattleBuildingKind::kResource;
+        desc.maxHitpoints = BuildingHitpoints::getStorage(level);
+        break;
+    case SerialBuildingKind::kBarracks:
+        desc.maxHitpoints = BuildingHitpoints::getBarracks(level);
+        break;
+    case SerialBuildingKind::kArmyCamp:
+        desc.maxHitpoints = BuildingHitpoints::getArmyCamp(level);
+        break;
+    case SerialBuildingKind::kWall:
+        desc.kind         = BattleBuildingKind::kWall;
+        desc.maxHitpoints = BuildingHitpoints::getWall(level);
+        break;
+    case SerialBuildingKind::kBuildersHut:
+        desc.maxHitpoints = BuildingHitpoints::getBuildersHut(level);
+        break;
+    case SerialBuildingKind::kArcherTower:
+        // 投射物速度与 DefenseBuilding::getProjectileSpeed 一致
+        applyDefenseStats(DefenseConfig::getArcherTower(level), 800.0f, desc);
+        break;
+    case SerialBuildingKind::kCannon:
+        applyDefenseStats(DefenseConfig::getCannon(level), 600.0f, desc);
+        break;
+    default:
+        return false;
+    }
+
+    // 同 BattleManager::setBuildings：异常血量按 100 处理，战斗开始时满血
+    if (desc.maxHitpoints <= 0)
+        desc.maxHitpoints = 100;
+    desc.hitpoints = desc.maxHitpoints;
+
+    // 同 BuildingManager::loadBuildingsFromData：建筑位于占地首尾两格的中点
+    SimVec2 posStart = layout.gridToPosition(data.gridX, data.gridY);
+    SimVec2 posEnd   = layout.gridToPosition(data.gridX + data.gridWidth - 1, data.gridY + data.gridHeight - 1);
+    desc.position    = (posStart + posEnd) * Fixed::fromRaw(Fixed::kOneRaw / 2);
+
+    desc.gridX      = static_cast<int>(data.gridX);
+    desc.gridY      = static_cast<int>(data.gridY);
+    desc.gridWidth  = static_cast<int>(data.gridWidth);
+    desc.gridHeight = static_cast<int>(data.gridHeight);
+
+    outDesc = desc;
+    return true;
+}
+
+BattleUnitDesc BattleSetup::makeUnitDesc(UnitType type, const SimVec2& position, int level)
+{
+    CombatStats stats;
+    switch (type)
+    {
+    case UnitType::kArcher:
+        stats = UnitConfig::getArcher(level);
+        break;
+    case UnitType::kGiant:
+        stats = UnitConfig::getGiant(level);
+        break;
+    case UnitType::kGoblin:
+        stats = UnitConfig::getGoblin(level);
+        break;
+    case UnitType::kWallBreaker:
+        stats = UnitConfig::getWallBreaker(level);
+        break;
+    default:
+        stats = UnitConfig::getBarbarian(level);
+        break;
+    }
+
+    BattleUnitDesc desc;
+    desc.type        = type;
+    desc.position    = position;
+    desc.hitpoints   = stats.currentHitpoints;
+    desc.armor       = stats.armor;
+    desc.damage      = stats.damage;
+    desc.attackRange = stats.attackRange;
+    desc.attackSpeed = stats.attackSpeed;
+    desc.moveSpeed   = getUnitMoveSpeed(type);
+    return desc;
+}
+
+float BattleSetup::getUnitMoveSpeed(UnitType type)
+{
+    switch (type)
+    {
+    case UnitType::kGiant:
+        return 60.0f;
+    case UnitType::kGoblin:
+        return 150.0f;
+    case UnitType::kWallBreaker:
+        return 120.0f;
+    default:
+        return 100.0f;
+    }
+}
@@ -0,0 +1,64 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleSetup.h
+ * File Function: 战斗初始化 - 从存档数据直接生成 BattleWorld 的建筑和单位描述
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_SETUP_H__
+#define __BATTLE_SETUP_H__
+
+#include "BattleWorld.h"
+
+struct BuildingSerialData;
+
+/**
+ * @struct BattleMapLayout
+ * @brief 战斗地图的网格布局（与 BattleScene 中 GridMap 的参数一致）
+ */
+struct BattleMapLayout
+{
+    float tileSize    = 55.6f;   ///< 单个网格的宽度（像素）
+    float startPixelX = 1406.0f; ///< 网格(0,0)对应的像素 X 坐标
+    float startPixelY = 2107.2f; ///< 网格(0,0)对应的像素 Y 坐标
+
+    /** @brief 网格坐标转像素坐标（同 GridMap::getPositionFromGrid，结果转为定点数） */
+    SimVec2 gridToPosition(float gridX, float gridY) const;
+};
+
+/**
+ * @class BattleSetup
+ * @brief 不经过场景节点生成战斗描述
+ *
+ * 建筑名称解析、等级数值和摆放位置与 BuildingManager 加载敌方基地时一致，
+ * 单位数值与 UnitFactory 创建的单位一致，因此无界面模拟得到的结果与游戏内相同。
+ */
+class BattleSetup
+{
+public:
+    /**
+     * @brief 由存档中的建筑数据生成建筑描述
+     * @param data 建筑存档数据
+     * @param layout 地图布局
+     * @param outDesc 输出的建筑描述
+     * @return bool 建筑名称无法识别时返回 false（游戏内同样不会创建该建筑）
+     */
+    static bool makeBuildingDesc(const BuildingSerialData& data, const BattleMapLayout& layout,
+                                 BattleBuildingDesc& outDesc);
+
+    /**
+     * @brief 生成单位描述
+     * @param type 单位类型
+     * @param position 部署位置
+     * @param level 单位等级
+     * @return BattleUnitDesc 单位描述
+     */
+    static BattleUnitDesc makeUnitDesc(UnitType type, const SimVec2& position, int level = 1);
+
+    /** @brief 单位移动速度（像素/秒），与各兵种 init() 中的设置一致 */
+    static float getUnitMoveSpeed(UnitType type);
+};
+
+#endif // __BATTLE_SETUP_H__
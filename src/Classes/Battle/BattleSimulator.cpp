@@ -0,0 +1,129 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleSimulator.cpp
+ * File Function: 无界面战斗模拟实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleSimulator.h"
+
+#include "Managers/GameDataModels.h"
+#include "Managers/ReplayData.h"
+
+#include <algorithm>
+
+constexpr float BattleSimulator::kFixedTimeStep;
+constexpr float BattleSimulator::kBattleTime;
+
+BattleSimResult BattleSimulator::run(const GameStateData& base, const ReplayData& replay)
+{
+    BattleSimResult result;
+
+    _world.reset();
+    _world.setNavigation(nullptr);
+    _world.setRecordEvents(false);
+
+    for (const auto& building : base.buildings)
+    {
+        BattleBuildingDesc desc;
+        if (BattleSetup::makeBuildingDesc(building, _layout, desc))
+        {
+            _world.addBuilding(desc);
+            ++result.buildingCount;
+        }
+    }
+
+    // 回放模式跳过准备阶段，防御建筑立即启用
+    _world.setDefensesActive(true);
+
+    int remainingTroops = 0;
+    for (const auto& event : replay.events)
+    {
+        if (event.type == ReplayEventType::DEPLOY_UNIT)
+            ++remainingTroops;
+    }
+
+    const std::vector<ReplayEvent>& events         = replay.events;
+    size_t                          nextEventIndex = 0;
+    unsigned int                    frame          = 0;
+    float                           elapsedTime    = 0.0f;
+    bool                            finished       = false;
+
+    // 同 ReplaySystem::loadReplay：其他规则版本录制的回放不做摘要校验
+    result.rulesMismatch = replay.simRulesVersion != BattleWorld::kRulesVersion;
+
+    ReplayDesyncDetector desyncDetector;
+    desyncDetector.reset(result.rulesMismatch ? nullptr : &replay.checksums);
+
+    while (!finished)
+    {
+        ++frame;
+
+        // 同 ReplaySystem::updateFrame：到期的事件按录制顺序依次执行
+        while (nextEventIndex < events.size() && frame >= events[nextEventIndex].frameIndex)
+        {
+            const ReplayEvent& event = events[nextEventIndex++];
+            if (event.type == ReplayEventType::END_BATTLE)
+            {
+                result.endReason = BattleSimEndReason::kEndEvent;
+                finished         = true;
+                break;
+            }
+
+            UnitType type = static_cast<UnitType>(event.unitType);
+            _world.spawnUnit(BattleSetup::makeUnitDesc(type, SimVec2::fromFloat(event.x, event.y)));
+            ++result.unitsDeployed;
+            --remainingTroops;
+        }
+        if (finished)
+            break;
+
+        elapsedTime += kFixedTimeStep;
+        _world.step(kFixedTimeStep);
+
+        // 同 BattleManager::updateStateChecksum：与录制时的摘要比较，保留第一个不一致帧的状态
+        if (frame % ReplayData::kChecksumInterval == 0 && !desyncDetector.check(frame, _world.computeStateHash()))
+        {
+            result.desyncFrame = frame;
+            result.desyncDump  = _world.describeState();
+        }
+
+        // 结束条件与 BattleManager::checkBattleEndConditions 相同
+        if (kBattleTime - elapsedTime <= 0)
+        {
+            result.endReason = BattleSimEndReason::kTimeout;
+            finished         = true;
+        }
+        else if (_world.getDestructionPercent() >= 100)
+        {
+            result.endReason = BattleSimEndReason::kAllDestroyed;
+            finished         = true;
+        }
+        else if (result.unitsDeployed > 0 && _world.countAliveUnits() == 0 && remainingTroops == 0)
+        {
+            result.endReason = BattleSimEndReason::kAllUnitsDead;
+            finished         = true;
+        }
+    }
+
+    result.frames             = frame;
+    result.stars              = _world.getStars();
+    result.destructionPercent = _world.getDestructionPercent();
+    result.stateHash          = _world.computeStateHash();
+    calculateLoot(result.stars, result.destructionPercent, base.resources.gold, base.resources.elixir,
+                  result.goldLooted, result.elixirLooted);
+    return result;
+}
+
+void BattleSimulator::calculateLoot(int stars, int destructionPercent, int gold, int elixir, int& outGold,
+                                    int& outElixir)
+{
+    // 根据星星数量调整掠夺率
+    float baseLootRate = 0.2f;
+    float starBonus    = stars * 0.1f;
+    float lootRate     = std::min(0.5f, baseLootRate + starBonus);
+
+    outGold   = static_cast<int>(gold * (destructionPercent / 100.0f) * lootRate);
+    outElixir = static_cast<int>(elixir * (destructionPercent / 100.0f) * lootRate);
+}
@@ -0,0 +1,102 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleSimulator.h
+ * File Function: 无界面战斗模拟 - 按回放事件全速推进 BattleWorld 并给出战果
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_SIMULATOR_H__
+#define __BATTLE_SIMULATOR_H__
+
+#include "BattleSetup.h"
+#include "BattleWorld.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GameStateData;
+struct ReplayData;
+
+/**
+ * @enum BattleSimEndReason
+ * @brief 模拟结束原因（与 BattleManager::BattleEndReason 对应）
+ */
+enum class BattleSimEndReason
+{
+    kTimeout,      ///< 战斗时间耗尽
+    kAllDestroyed, ///< 全部建筑被摧毁
+    kAllUnitsDead, ///< 全军覆没
+    kEndEvent      ///< 回放中的结束战斗事件
+};
+
+/**
+ * @struct BattleSimResult
+ * @brief 模拟战果
+ */
+struct BattleSimResult
+{
+    int                stars              = 0;                            ///< 星数
+    int                destructionPercent = 0;                            ///< 破坏率
+    int                goldLooted         = 0;                            ///< 掠夺金币
+    int                elixirLooted       = 0;                            ///< 掠夺圣水
+    unsigned int       frames             = 0;                            ///< 推进的固定步数
+    int                unitsDeployed      = 0;                            ///< 部署的单位数
+    int                buildingCount      = 0;                            ///< 参战建筑数
+    BattleSimEndReason endReason          = BattleSimEndReason::kTimeout; ///< 结束原因
+    uint64_t           stateHash          = 0;                            ///< 结束时的 BattleWorld::computeStateHash()
+    unsigned int       desyncFrame        = 0;                            ///< 与回放记录的摘要第一次不一致的帧（0 表示一致）
+    std::string        desyncDump;                                        ///< 不一致时的状态导出
+    bool               rulesMismatch      = false;                        ///< 回放由其他模拟规则版本录制（不做摘要校验）
+};
+
+/**
+ * @class BattleSimulator
+ * @brief 无界面战斗模拟器
+ *
+ * 流程与 BattleManager 的回放模式一致：直接进入战斗状态，每个固定步先应用到期的回放事件，
+ * 再推进 BattleWorld 并检查结束条件。不依赖 cocos2d 和任何单例，
+ * 每个实例可以在独立线程中运行。
+ */
+class BattleSimulator
+{
+public:
+    static constexpr float kFixedTimeStep = 1.0f / 60.0f; ///< 固定时间步长（同 BattleManager）
+    static constexpr float kBattleTime    = 180.0f;       ///< 战斗总时间（秒）
+
+    BattleSimulator() = default;
+
+    /** @brief 地图布局（默认与 BattleScene 一致） */
+    void setMapLayout(const BattleMapLayout& layout) { _layout = layout; }
+
+    /**
+     * @brief 模拟一场战斗
+     * @param base 防守方基地数据
+     * @param replay 回放数据（只使用其中的事件）
+     * @return BattleSimResult 战果
+     */
+    BattleSimResult run(const GameStateData& base, const ReplayData& replay);
+
+    /** @brief 最近一次模拟的战斗世界（用于检查最终状态） */
+    const BattleWorld& getWorld() const { return _world; }
+
+    /**
+     * @brief 计算掠夺资源（BattleManager::calculateBattleResult 使用同一规则）
+     * @param stars 星数
+     * @param destructionPercent 破坏率
+     * @param gold 防守方金币
+     * @param elixir 防守方圣水
+     * @param outGold 输出掠夺金币
+     * @param outElixir 输出掠夺圣水
+     */
+    static void calculateLoot(int stars, int destructionPercent, int gold, int elixir, int& outGold,
+                              int& outElixir);
+
+private:
+    BattleMapLayout _layout;
+    BattleWorld     _world;
+};
+
+#endif // __BATTLE_SIMULATOR_H__
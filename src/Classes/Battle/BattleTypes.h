@@ -0,0 +1,122 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleTypes.h
+ * File Function: 战斗模拟基础类型 - 不依赖 cocos2d 的定点向量、下标和事件
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_TYPES_H__
+#define __BATTLE_TYPES_H__
+
+#include "FixedPoint.h"
+
+#include <cstdint>
+
+/**
+ * @struct SimVec2
+ * @brief 战斗模拟使用的二维定点向量（像素坐标，与地图层节点坐标一致）
+ *
+ * 分量为 Q16.16 定点数，距离比较使用 64 位平方距离，开方使用整数平方根，
+ * 模拟结果不受浮点运算顺序和平台差异影响。
+ */
+struct SimVec2
+{
+    Fixed x;
+    Fixed y;
+
+    SimVec2() = default;
+    SimVec2(Fixed px, Fixed py) : x(px), y(py) {}
+
+    /** @brief 由浮点坐标构造（部署坐标、建筑位置等边界输入） */
+    static SimVec2 fromFloat(float px, float py) { return SimVec2(Fixed::fromFloat(px), Fixed::fromFloat(py)); }
+
+    float floatX() const { return x.toFloat(); }
+    float floatY() const { return y.toFloat(); }
+
+    SimVec2 operator+(const SimVec2& o) const { return SimVec2(x + o.x, y + o.y); }
+    SimVec2 operator-(const SimVec2& o) const { return SimVec2(x - o.x, y - o.y); }
+    SimVec2 operator*(Fixed s) const { return SimVec2(x * s, y * s); }
+    bool    operator==(const SimVec2& o) const { return x == o.x && y == o.y; }
+    bool    operator!=(const SimVec2& o) const { return !(*this == o); }
+
+    /** @brief 长度的平方（Q32.32） */
+    int64_t lengthSquaredRaw() const { return FixedMath::squareRaw(x) + FixedMath::squareRaw(y); }
+
+    /** @brief 与另一点距离的平方（Q32.32） */
+    int64_t distanceSquaredRaw(const SimVec2& o) const { return (o - *this).lengthSquaredRaw(); }
+
+    Fixed length() const { return FixedMath::sqrtFromSquaredRaw(lengthSquaredRaw()); }
+
+    Fixed distance(const SimVec2& o) const { return (o - *this).length(); }
+
+    /** @brief 是否在指定距离之内（含边界），不开方 */
+    bool isWithin(const SimVec2& o, Fixed range) const
+    {
+        return distanceSquaredRaw(o) <= FixedMath::squareRaw(range);
+    }
+
+    /** @brief 单位向量，长度为 0 时返回自身 */
+    SimVec2 normalized() const
+    {
+        Fixed len = length();
+        if (len == Fixed())
+            return *this;
+        return SimVec2(x / len, y / len);
+    }
+};
+
+using UnitIndex       = int; ///< 单位在 BattleWorld 中的下标（部署顺序，不复用）
+using BuildingIndex   = int; ///< 建筑在 BattleWorld 中的下标（加入顺序）
+using ProjectileIndex = int; ///< 投射物下标（槽位会复用）
+
+constexpr int kInvalidIndex = -1; ///< 无效下标
+
+/**
+ * @enum BattleBuildingKind
+ * @brief 模拟关心的建筑类别（决定兵种优先目标和星数规则）
+ */
+enum class BattleBuildingKind : uint8_t
+{
+    kTownHall, ///< 大本营
+    kResource, ///< 资源建筑
+    kDefense,  ///< 防御建筑
+    kWall,     ///< 城墙
+    kOther     ///< 其他
+};
+
+/**
+ * @enum BattleEventType
+ * @brief 模拟产生的事件类型，由视图层在渲染帧中播放对应表现
+ */
+enum class BattleEventType : uint8_t
+{
+    kUnitMoveStarted,   ///< 单位开始朝 to 移动（from 为当时位置）
+    kUnitStopped,       ///< 单位停止移动
+    kUnitAttacked,      ///< 单位发动攻击
+    kUnitDamaged,       ///< 单位受到伤害，value 为剩余生命值
+    kUnitDied,          ///< 单位死亡
+    kBuildingDamaged,   ///< 建筑受到伤害，value 为伤害值
+    kBuildingDestroyed, ///< 建筑被摧毁
+    kProjectileFired,   ///< 防御建筑发射投射物（from -> to，duration 秒）
+    kProjectileHit      ///< 投射物命中
+};
+
+/**
+ * @struct BattleEvent
+ * @brief 模拟事件
+ */
+struct BattleEvent
+{
+    BattleEventType type       = BattleEventType::kUnitStopped;
+    UnitIndex       unit       = kInvalidIndex; ///< 相关单位
+    BuildingIndex   building   = kInvalidIndex; ///< 相关建筑
+    ProjectileIndex projectile = kInvalidIndex; ///< 相关投射物
+    int             value      = 0;             ///< 附加数值（见事件类型说明）
+    SimVec2         from;                       ///< 起点
+    SimVec2         to;                         ///< 终点
+    float           duration = 0.0f;            ///< 持续时间（秒，仅用于表现）
+};
+
+#endif // __BATTLE_TYPES_H__
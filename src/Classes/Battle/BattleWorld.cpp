@@ -0,0 +1,795 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleWorld.cpp
+ * File Function: 战斗世界实现 - 固定步长的单位/建筑/投射物模拟
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleWorld.h"
+
+#include "BattleMath.h"
+#include "BattleNavigation.h"
+#include "Unit/CombatStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+
+constexpr int BattleWorld::kDefaultAIWorkBudget;
+constexpr uint32_t BattleWorld::kRulesVersion;
+
+namespace
+{
+
+constexpr Fixed kWallBreakerDamageMultiplier = Fixed::fromInt(40); ///< 炸弹人自爆伤害倍数
+constexpr Fixed kPathSnapDistance            = Fixed::fromInt(10); ///< 路径首点距离小于此值时直接跳过
+constexpr Fixed kMinMoveDistance             = Fixed::fromInt(1);  ///< 小于此距离不再移动
+
+constexpr uint64_t kHashOffsetBasis = 14695981039346656037ULL; ///< FNV-1a 初始值
+constexpr uint64_t kHashPrime       = 1099511628211ULL;        ///< FNV-1a 乘数
+
+/** @brief 按类别查找建筑时需要的标志：未摧毁 + 类别 */
+inline uint8_t kindFlags(BattleBuildingKind kind)
+{
+    return BattleMath::kFlagAlive | BattleMath::categoryFlag(static_cast<int>(kind));
+}
+
+/**
+ * @class StepPhaseTimer
+ * @brief 记录 step() 各阶段耗时，未设置输出时不读时钟
+ */
+class StepPhaseTimer
+{
+public:
+    explicit StepPhaseTimer(BattleStepTimings* timings) : _timings(timings)
+    {
+        if (_timings)
+            _start = std::chrono::steady_clock::now();
+    }
+
+    /** @brief 结束一个阶段并开始下一个 */
+    void lap(BattleStepPhase phase)
+    {
+        if (!_timings)
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        _timings->seconds[static_cast<int>(phase)] = std::chrono::duration<double>(now - _start).count();
+        _start = now;
+    }
+
+private:
+    BattleStepTimings*                    _timings;
+    std::chrono::steady_clock::time_point _start;
+};
+
+/**
+ * @brief 把两个 32 位整数作为一个 64 位字混入摘要
+ * @note 按数值而不是内存字节混合，与平台字节序无关；每个字只做一次乘法，摘要耗时远小于一步模拟
+ */
+inline void hashPair(uint64_t& hash, int32_t high, int32_t low)
+{
+    hash ^= (static_cast<uint64_t>(static_cast<uint32_t>(high)) << 32) | static_cast<uint32_t>(low);
+    hash *= kHashPrime;
+}
+
+} // namespace
+
+void BattleWorld::reset()
+{
+    _units       = UnitArrays();
+    _buildings   = BuildingArrays();
+    _projectiles = ProjectileArrays();
+
+    _tick               = 0;
+    _aliveUnits         = 0;
+    _standingBuildings  = 0;
+    _totalHitpoints     = 0;
+    _destroyedHitpoints = 0;
+    _destructionPercent = 0;
+    _stars              = 0;
+    _townHallDestroyed  = false;
+    _defensesActive     = false;
+
+    _aiBudgetLeft = 0;
+    _aiStats      = BattleAIStats();
+    _aiQueue.clear();
+    _aiQueueHead = 0;
+
+    _events.clear();
+}
+
+BuildingIndex BattleWorld::addBuilding(const BattleBuildingDesc& desc)
+{
+    BuildingIndex b = getBuildingCount();
+
+    _buildings.kind.push_back(desc.kind);
+    _buildings.positionX.push_back(desc.position.x.raw());
+    _buildings.positionY.push_back(desc.position.y.raw());
+    _buildings.gridRect.push_back(desc.gridX);
+    _buildings.gridRect.push_back(desc.gridY);
+    _buildings.gridRect.push_back(desc.gridWidth);
+    _buildings.gridRect.push_back(desc.gridHeight);
+    _buildings.hitpoints.push_back(desc.hitpoints);
+    _buildings.maxHitpoints.push_back(desc.maxHitpoints);
+    _buildings.targetFlags.push_back(desc.hitpoints > 0 ? kindFlags(desc.kind)
+                                                        : BattleMath::categoryFlag(static_cast<int>(desc.kind)));
+    _buildings.armed.push_back(desc.armed ? 1 : 0);
+    _buildings.damage.push_back(Fixed::fromFloat(desc.damage));
+    _buildings.attackRange.push_back(Fixed::fromFloat(desc.attackRange));
+    _buildings.attackSpeed.push_back(Fixed::fromFloat(desc.attackSpeed));
+    _buildings.cooldown.push_back(Fixed());
+    _buildings.projectileSpeed.push_back(Fixed::fromFloat(desc.projectileSpeed));
+    _buildings.splashRadius.push_back(Fixed::fromFloat(desc.splashRadius));
+    _buildings.target.push_back(kInvalidIndex);
+
+    _totalHitpoints += desc.maxHitpoints;
+    if (desc.hitpoints > 0)
+        _standingBuildings++;
+    return b;
+}
+
+UnitIndex BattleWorld::spawnUnit(const BattleUnitDesc& desc)
+{
+    UnitIndex u = getUnitCount();
+
+    _units.type.push_back(desc.type);
+    _units.positionX.push_back(desc.position.x.raw());
+    _units.positionY.push_back(desc.position.y.raw());
+    _units.hitpoints.push_back(desc.hitpoints);
+    _units.armor.push_back(desc.armor);
+    _units.damage.push_back(Fixed::fromFloat(desc.damage));
+    _units.attackRange.push_back(Fixed::fromFloat(desc.attackRange));
+    _units.attackSpeed.push_back(Fixed::fromFloat(desc.attackSpeed));
+    // 新部署的单位先等半个攻击间隔，给移动留出时间
+    _units.cooldown.push_back(Fixed::fromRaw(_units.attackSpeed.back().raw() / 2));
+    _units.moveSpeed.push_back(Fixed::fromFloat(desc.moveSpeed));
+    _units.target.push_back(kInvalidIndex);
+    _units.moveTarget.push_back(desc.position);
+    _units.velocity.push_back(SimVec2());
+    _units.path.emplace_back();
+    _units.pathIndex.push_back(0);
+    _units.moving.push_back(0);
+    _units.alive.push_back(desc.hitpoints > 0 ? 1 : 0);
+    _units.aiRequest.push_back(AIRequest::kNone);
+
+    if (desc.hitpoints > 0)
+        _aliveUnits++;
+    return u;
+}
+
+void BattleWorld::step(float dt)
+{
+    _tick++;
+
+    Fixed          fixedDt = Fixed::fromFloat(dt);
+    StepPhaseTimer timer(_stepTimings);
+
+    // 应用到期的寻路结果（在移动之前，保证每步的处理顺序固定）
+    if (_navigation)
+        _navigation->beginStep(*this);
+    timer.lap(BattleStepPhase::kNavigation);
+
+    stepMovement(fixedDt);
+    timer.lap(BattleStepPhase::kMovement);
+    stepUnitAI(fixedDt);
+    timer.lap(BattleStepPhase::kUnitAI);
+    stepProjectiles(fixedDt);
+    timer.lap(BattleStepPhase::kProjectiles);
+    stepDefenses(fixedDt);
+    timer.lap(BattleStepPhase::kDefenses);
+    updateDestruction();
+    timer.lap(BattleStepPhase::kDestruction);
+}
+
+void BattleWorld::getBuildingGridRect(BuildingIndex b, int& x, int& y, int& width, int& height) const
+{
+    const int* rect = &_buildings.gridRect[b * 4];
+    x               = rect[0];
+    y               = rect[1];
+    width           = rect[2];
+    height          = rect[3];
+}
+
+uint64_t BattleWorld::computeStateHash() const
+{
+    int unitCount     = getUnitCount();
+    int buildingCount = getBuildingCount();
+
+    uint64_t hash = kHashOffsetBasis;
+    hashPair(hash, static_cast<int32_t>(_tick), unitCount);
+    hashPair(hash, buildingCount, _destructionPercent);
+
+    for (UnitIndex u = 0; u < unitCount; ++u)
+    {
+        hashPair(hash, _units.positionX[u], _units.positionY[u]);
+        hashPair(hash, _units.hitpoints[u], _units.target[u]);
+    }
+    for (BuildingIndex b = 0; b < buildingCount; ++b)
+    {
+        hashPair(hash, _buildings.hitpoints[b], _buildings.target[b]);
+    }
+
+    // 乘法只向高位扩散，最后把高位折回低位
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::string BattleWorld::describeState() const
+{
+    std::ostringstream oss;
+    oss << "tick=" << _tick << " units=" << getUnitCount() << " buildings=" << getBuildingCount()
+        << " destruction=" << _destructionPercent << " stars=" << _stars
+        << " aiQueue=" << (_aiQueue.size() - _aiQueueHead) << "\n";
+
+    for (UnitIndex u = 0; u < getUnitCount(); ++u)
+    {
+        oss << "unit " << u << " type=" << static_cast<int>(_units.type[u]) << " hp=" << _units.hitpoints[u]
+            << " pos=" << _units.positionX[u] << "," << _units.positionY[u]
+            << " target=" << _units.target[u] << " alive=" << static_cast<int>(_units.alive[u]) << "\n";
+    }
+    for (BuildingIndex b = 0; b < getBuildingCount(); ++b)
+    {
+        oss << "building " << b << " kind=" << static_cast<int>(_buildings.kind[b]) << " hp=" << _buildings.hitpoints[b]
+            << " target=" << _buildings.target[b] << "\n";
+    }
+    return oss.str();
+}
+
+// ==================== 移动 ====================
+
+void BattleWorld::moveUnitTo(UnitIndex u, const SimVec2& position)
+{
+    if (!_units.alive[u])
+        return;
+
+    _units.moveTarget[u] = position;
+    SimVec2 from         = getUnitPosition(u);
+    SimVec2 diff         = position - from;
+
+    if (diff.lengthSquaredRaw() < FixedMath::squareRaw(kMinMoveDistance))
+        return;
+
+    _units.velocity[u] = diff.normalized() * _units.moveSpeed[u];
+    _units.moving[u]   = 1;
+
+    BattleEvent event;
+    event.type = BattleEventType::kUnitMoveStarted;
+    event.unit = u;
+    event.from = from;
+    event.to   = position;
+    emit(event);
+}
+
+void BattleWorld::moveUnitAlongPath(UnitIndex u, const std::vector<SimVec2>& path)
+{
+    if (path.empty() || !_units.alive[u])
+        return;
+
+    _units.path[u]      = path;
+    _units.pathIndex[u] = 0;
+
+    if (getUnitPosition(u).distanceSquaredRaw(path[0]) < FixedMath::squareRaw(kPathSnapDistance))
+        _units.pathIndex[u] = 1;
+
+    if (_units.pathIndex[u] < static_cast<int>(path.size()))
+        moveUnitTo(u, path[_units.pathIndex[u]]);
+}
+
+void BattleWorld::setUnitPosition(UnitIndex u, const SimVec2& position)
+{
+    _units.positionX[u] = position.x.raw();
+    _units.positionY[u] = position.y.raw();
+}
+
+bool BattleWorld::isUnitInAttackRange(UnitIndex u, const SimVec2& position) const
+{
+    return getUnitPosition(u).isWithin(position, _units.attackRange[u]);
+}
+
+void BattleWorld::stopUnit(UnitIndex u)
+{
+    _units.moving[u] = 0;
+    _units.path[u].clear();
+
+    BattleEvent event;
+    event.type = BattleEventType::kUnitStopped;
+    event.unit = u;
+    emit(event);
+}
+
+void BattleWorld::stepMovement(Fixed dt)
+{
+    int count = getUnitCount();
+    for (UnitIndex u = 0; u < count; ++u)
+    {
+        if (!_units.alive[u] || !_units.moving[u])
+            continue;
+
+        SimVec2 current = getUnitPosition(u);
+        Fixed   stepLen = _units.moveSpeed[u] * dt;
+
+        if (FixedMath::squareRaw(stepLen) >= current.distanceSquaredRaw(_units.moveTarget[u]))
+        {
+            setUnitPosition(u, _units.moveTarget[u]);
+
+            // 到达路径点，继续下一个或停止
+            _units.pathIndex[u]++;
+            if (_units.pathIndex[u] < static_cast<int>(_units.path[u].size()))
+                moveUnitTo(u, _units.path[u][_units.pathIndex[u]]);
+            else
+                stopUnit(u);
+        }
+        else
+        {
+            setUnitPosition(u, current + _units.velocity[u] * dt);
+        }
+    }
+}
+
+// ==================== 单位 AI ====================
+
+BuildingIndex BattleWorld::findTarget(UnitIndex u) const
+{
+    // 未摧毁且满足类别标志的建筑中最近的一个（同距离取下标较小者）
+    auto findClosest = [&](uint8_t requiredFlags) -> BuildingIndex {
+        return BattleMath::findNearest(_buildings.positionX.data(), _buildings.positionY.data(),
+                                       _buildings.targetFlags.data(), requiredFlags, getBuildingCount(),
+                                       _units.positionX[u], _units.positionY[u],
+                                       std::numeric_limits<int64_t>::max())
+            .index;
+    };
+
+    // 根据单位类型选择优先目标
+    BuildingIndex best = kInvalidIndex;
+    switch (_units.type[u])
+    {
+    case UnitType::kGiant:
+        best = findClosest(kindFlags(BattleBuildingKind::kDefense)); // 巨人优先攻击防御建筑
+        break;
+    case UnitType::kGoblin:
+        best = findClosest(kindFlags(BattleBuildingKind::kResource)); // 哥布林优先攻击资源建筑
+        break;
+    case UnitType::kWallBreaker:
+        best = findClosest(kindFlags(BattleBuildingKind::kWall)); // 炸弹人优先攻击城墙
+        break;
+    default:
+        break;
+    }
+
+    // 没有优先目标时选择最近的任意建筑
+    if (best == kInvalidIndex)
+        best = findClosest(BattleMath::kFlagAlive);
+    return best;
+}
+
+void BattleWorld::runAIRequest(UnitIndex u, AIRequest request)
+{
+    if (request == AIRequest::kRetarget)
+    {
+        BuildingIndex best = findTarget(u);
+        if (best != kInvalidIndex)
+        {
+            if (_navigation)
+                _navigation->cancelPath(u);
+            _units.target[u] = best;
+            stopUnit(u);
+        }
+        return;
+    }
+
+    BuildingIndex target = _units.target[u];
+    if (_navigation)
+        _navigation->requestPath(*this, u, target);
+    else
+        moveUnitTo(u, getBuildingPosition(target));
+}
+
+bool BattleWorld::scheduleAI(UnitIndex u, AIRequest request)
+{
+    // 预算有剩余时队列一定已清空，直接执行，与不排队时的结果相同
+    if (_aiBudgetLeft > 0)
+    {
+        _aiBudgetLeft--;
+        _aiStats.processed++;
+        runAIRequest(u, request);
+        return true;
+    }
+
+    // 排到队尾，等待期间原地不动
+    if (_units.moving[u])
+    {
+        if (_navigation)
+            _navigation->cancelPath(u);
+        stopUnit(u);
+    }
+
+    AIQueueEntry entry;
+    entry.unit = u;
+    entry.tick = _tick;
+    _aiQueue.push_back(entry);
+    _units.aiRequest[u] = request;
+    return false;
+}
+
+void BattleWorld::processAIQueue()
+{
+    while (_aiQueueHead < _aiQueue.size() && _aiBudgetLeft > 0)
+    {
+        AIQueueEntry entry   = _aiQueue[_aiQueueHead++];
+        UnitIndex    u       = entry.unit;
+        AIRequest    request = _units.aiRequest[u];
+        _units.aiRequest[u]  = AIRequest::kNone;
+
+        if (!_units.alive[u])
+            continue;
+
+        // 排队期间目标被摧毁或单位已到位的寻路请求直接作废，不占预算
+        if (request == AIRequest::kPath)
+        {
+            BuildingIndex target = _units.target[u];
+            if (target == kInvalidIndex || isBuildingDestroyed(target) ||
+                isUnitInAttackRange(u, getBuildingPosition(target)))
+                continue;
+        }
+
+        _aiBudgetLeft--;
+        _aiStats.processed++;
+        _aiStats.maxWait = std::max(_aiStats.maxWait, _tick - entry.tick);
+        runAIRequest(u, request);
+    }
+
+    // 队列清空后复用容量；长期积压时把已处理部分移出，避免数组无限增长
+    if (_aiQueueHead == _aiQueue.size())
+    {
+        _aiQueue.clear();
+        _aiQueueHead = 0;
+    }
+    else if (_aiQueueHead * 2 > _aiQueue.size())
+    {
+        _aiQueue.erase(_aiQueue.begin(), _aiQueue.begin() + static_cast<std::ptrdiff_t>(_aiQueueHead));
+        _aiQueueHead = 0;
+    }
+}
+
+void BattleWorld::stepUnitAI(Fixed dt)
+{
+    // 先按入队顺序处理之前积压的请求，剩余预算留给本步新产生的请求
+    _aiBudgetLeft = _aiWorkBudget;
+    _aiStats      = BattleAIStats();
+    processAIQueue();
+
+    int count = getUnitCount();
+    for (UnitIndex u = 0; u < count; ++u)
+    {
+        if (!_units.alive[u] || _units.aiRequest[u] != AIRequest::kNone)
+            continue;
+
+        BuildingIndex target = _units.target[u];
+
+        // 需要寻找新目标（建筑全部被摧毁后不再搜索，也不占预算）
+        if (target == kInvalidIndex || isBuildingDestroyed(target))
+        {
+            _units.target[u] = kInvalidIndex;
+            if (_standingBuildings == 0 || !scheduleAI(u, AIRequest::kRetarget))
+                continue;
+            target = _units.target[u];
+        }
+
+        if (target == kInvalidIndex || isBuildingDestroyed(target))
+            continue;
+
+        SimVec2 targetPos = getBuildingPosition(target);
+
+        if (!isUnitInAttackRange(u, targetPos))
+        {
+            // 不在攻击范围内，没有在移动时重新出发
+            if (!_units.moving[u])
+                scheduleAI(u, AIRequest::kPath);
+            continue;
+        }
+
+        if (_units.moving[u])
+            stopUnit(u);
+
+        // 先更新攻击冷却，再检查是否可以攻击
+        if (_units.cooldown[u] > Fixed())
+            _units.cooldown[u] -= dt;
+        if (_units.cooldown[u] > Fixed())
+            continue;
+
+        BattleEvent event;
+        event.type     = BattleEventType::kUnitAttacked;
+        event.unit     = u;
+        event.building = target;
+        emit(event);
+        _units.moving[u] = 0;
+
+        if (_units.type[u] == UnitType::kWallBreaker)
+        {
+            // 炸弹人自爆攻击
+            damageBuilding(target, (_units.damage[u] * kWallBreakerDamageMultiplier).toInt());
+            killUnit(u);
+        }
+        else
+        {
+            damageBuilding(target, _units.damage[u].toInt());
+            _units.cooldown[u] = _units.attackSpeed[u];
+        }
+
+        if (isBuildingDestroyed(target))
+            _units.target[u] = kInvalidIndex;
+    }
+
+    _aiStats.pending = static_cast<int>(_aiQueue.size() - _aiQueueHead);
+}
+
+// ==================== 伤害 ====================
+
+void BattleWorld::damageUnit(UnitIndex u, Fixed damage)
+{
+    if (!_units.alive[u])
+        return;
+
+    Fixed actualDamage  = CombatStats::computeDamage(damage, _units.armor[u]);
+    _units.hitpoints[u] = CombatStats::applyDamage(_units.hitpoints[u], actualDamage);
+
+    BattleEvent event;
+    event.type  = BattleEventType::kUnitDamaged;
+    event.unit  = u;
+    event.value = _units.hitpoints[u];
+    emit(event);
+
+    if (_units.hitpoints[u] <= 0)
+        killUnit(u);
+}
+
+void BattleWorld::killUnit(UnitIndex u)
+{
+    if (!_units.alive[u])
+        return;
+
+    _units.alive[u]  = 0;
+    _units.moving[u] = 0;
+    _units.path[u].clear();
+    _aliveUnits--;
+
+    if (_navigation)
+        _navigation->cancelPath(u);
+
+    BattleEvent event;
+    event.type = BattleEventType::kUnitDied;
+    event.unit = u;
+    emit(event);
+}
+
+void BattleWorld::damageBuilding(BuildingIndex b, int damage)
+{
+    if (damage <= 0)
+        return;
+
+    bool wasDestroyed       = _buildings.hitpoints[b] <= 0;
+    _buildings.hitpoints[b] = std::max(0, _buildings.hitpoints[b] - damage);
+
+    BattleEvent event;
+    event.type     = BattleEventType::kBuildingDamaged;
+    event.building = b;
+    event.value    = damage;
+    emit(event);
+
+    if (wasDestroyed || _buildings.hitpoints[b] > 0)
+        return;
+
+    _buildings.targetFlags[b] &= static_cast<uint8_t>(~BattleMath::kFlagAlive);
+    _standingBuildings--;
+
+    event.type  = BattleEventType::kBuildingDestroyed;
+    event.value = 0;
+    emit(event);
+
+    if (_navigation)
+        _navigation->onBuildingDestroyed(*this, b);
+}
+
+// ==================== 防御建筑与投射物 ====================
+
+void BattleWorld::fireProjectile(BuildingIndex b, UnitIndex u)
+{
+    ProjectileArrays& p = _projectiles;
+
+    ProjectileIndex slot;
+    if (!p.freeSlots.empty())
+    {
+        slot = p.freeSlots.back();
+        p.freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<ProjectileIndex>(p.alive.size());
+        p.position.emplace_back();
+        p.velocity.emplace_back();
+        p.to.emplace_back();
+        p.elapsed.push_back(Fixed());
+        p.duration.push_back(Fixed());
+        p.damage.push_back(Fixed());
+        p.splashRadius.push_back(Fixed());
+        p.target.push_back(kInvalidIndex);
+        p.alive.push_back(0);
+    }
+
+    // 终点固定为发射时目标所在位置，飞行时间由距离和速度决定
+    SimVec2 from     = getBuildingPosition(b);
+    SimVec2 to       = getUnitPosition(u);
+    Fixed   speed    = _buildings.projectileSpeed[b];
+    Fixed   duration = from.distance(to) / speed; // 速度为 0 时立即命中
+
+    p.position[slot]     = from;
+    p.velocity[slot]     = (to - from).normalized() * speed;
+    p.to[slot]           = to;
+    p.elapsed[slot]      = Fixed();
+    p.duration[slot]     = duration;
+    p.damage[slot]       = _buildings.damage[b];
+    p.splashRadius[slot] = _buildings.splashRadius[b];
+    p.target[slot]       = u;
+    p.alive[slot]        = 1;
+
+    BattleEvent event;
+    event.type       = BattleEventType::kProjectileFired;
+    event.unit       = u;
+    event.building   = b;
+    event.projectile = slot;
+    event.from       = from;
+    event.to         = to;
+    event.duration   = duration.toFloat();
+    emit(event);
+}
+
+void BattleWorld::stepProjectiles(Fixed dt)
+{
+    ProjectileArrays& p     = _projectiles;
+    int               count = static_cast<int>(p.alive.size());
+
+    // 先推进全部投射物并收集本步命中的槽位，再按槽位顺序统一结算
+    p.landed.clear();
+    for (ProjectileIndex i = 0; i < count; ++i)
+    {
+        if (!p.alive[i])
+            continue;
+
+        p.elapsed[i] += dt;
+        if (p.elapsed[i] < p.duration[i])
+        {
+            p.position[i] = p.position[i] + p.velocity[i] * dt;
+            continue;
+        }
+
+        p.position[i] = p.to[i];
+        p.alive[i]    = 0;
+        p.freeSlots.push_back(i);
+        p.landed.push_back(i);
+    }
+
+    for (ProjectileIndex i : p.landed)
+    {
+        resolveProjectileHit(i);
+    }
+}
+
+void BattleWorld::resolveProjectileHit(ProjectileIndex i)
+{
+    const ProjectileArrays& p = _projectiles;
+
+    BattleEvent event;
+    event.type       = BattleEventType::kProjectileHit;
+    event.unit       = p.target[i];
+    event.projectile = i;
+    event.to         = p.to[i];
+    emit(event);
+
+    // 单体伤害：命中时目标已死亡则不再结算
+    if (p.splashRadius[i] <= Fixed())
+    {
+        damageUnit(p.target[i], p.damage[i]);
+        return;
+    }
+
+    // 溅射伤害：先查出落点半径内的存活单位，再按下标顺序结算
+    int unitCount = getUnitCount();
+    if (static_cast<int>(_queryIndices.size()) < unitCount)
+        _queryIndices.resize(unitCount);
+
+    int hits = BattleMath::collectWithinRange(_units.positionX.data(), _units.positionY.data(), _units.alive.data(),
+                                              BattleMath::kFlagAlive, unitCount, p.to[i].x.raw(), p.to[i].y.raw(),
+                                              FixedMath::squareRaw(p.splashRadius[i]), _queryIndices.data());
+    for (int h = 0; h < hits; ++h)
+    {
+        damageUnit(_queryIndices[h], p.damage[i]);
+    }
+}
+
+void BattleWorld::stepDefenses(Fixed dt)
+{
+    if (!_defensesActive)
+        return;
+
+    int buildingCount = getBuildingCount();
+    int unitCount     = getUnitCount();
+
+    for (BuildingIndex b = 0; b < buildingCount; ++b)
+    {
+        if (!_buildings.armed[b] || _buildings.hitpoints[b] <= 0)
+            continue;
+
+        SimVec2 myPos = getBuildingPosition(b);
+        Fixed   range = _buildings.attackRange[b];
+
+        if (_buildings.cooldown[b] > Fixed())
+            _buildings.cooldown[b] -= dt;
+
+        // 当前目标死亡或离开范围时放弃，否则冷却结束后开火
+        UnitIndex target = _buildings.target[b];
+        if (target != kInvalidIndex)
+        {
+            if (!_units.alive[target] || !getUnitPosition(target).isWithin(myPos, range))
+            {
+                _buildings.target[b] = kInvalidIndex;
+            }
+            else if (_buildings.cooldown[b] <= Fixed())
+            {
+                fireProjectile(b, target);
+                _buildings.cooldown[b] = _buildings.attackSpeed[b];
+            }
+        }
+
+        // 已有有效目标时不重新选择
+        target = _buildings.target[b];
+        if (target != kInvalidIndex && _units.alive[target])
+            continue;
+
+        // 范围内最近的存活单位（同距离取下标较小者）
+        UnitIndex closest = BattleMath::findNearest(_units.positionX.data(), _units.positionY.data(),
+                                                    _units.alive.data(), BattleMath::kFlagAlive, unitCount,
+                                                    _buildings.positionX[b], _buildings.positionY[b],
+                                                    FixedMath::squareRaw(range))
+                                .index;
+        if (closest != kInvalidIndex)
+            _buildings.target[b] = closest;
+    }
+}
+
+// ==================== 战果 ====================
+
+void BattleWorld::updateDestruction()
+{
+    int count = getBuildingCount();
+    if (count == 0)
+    {
+        _destructionPercent = 100;
+        _stars              = 3;
+        return;
+    }
+
+    _destroyedHitpoints = 0;
+    for (BuildingIndex b = 0; b < count; ++b)
+    {
+        _destroyedHitpoints += _buildings.maxHitpoints[b] - _buildings.hitpoints[b];
+
+        if (_buildings.hitpoints[b] <= 0 && _buildings.kind[b] == BattleBuildingKind::kTownHall)
+            _townHallDestroyed = true;
+    }
+
+    if (_totalHitpoints > 0)
+        _destructionPercent = std::min(100, (_destroyedHitpoints * 100) / _totalHitpoints);
+
+    // 摧毁大本营、破坏率 >= 50%、破坏率 100% 各 1 星，只增不减
+    int stars = (_townHallDestroyed ? 1 : 0) + (_destructionPercent >= 50 ? 1 : 0) + (_destructionPercent >= 100 ? 1 : 0);
+    _stars    = std::max(_stars, stars);
+}
+
+void BattleWorld::emit(const BattleEvent& event)
+{
+    if (_recordEvents)
+        _events.push_back(event);
+}
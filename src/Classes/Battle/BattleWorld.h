@@ -0,0 +1,401 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleWorld.h
+ * File Function: 战斗世界 - 以数组结构（SoA）保存单位、建筑和投射物的模拟状态
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_WORLD_H__
+#define __BATTLE_WORLD_H__
+
+#include "BattleTypes.h"
+#include "Unit/UnitTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class BattleNavigation;
+
+/**
+ * @struct BattleUnitDesc
+ * @brief 部署单位时的初始属性
+ */
+struct BattleUnitDesc
+{
+    UnitType type        = UnitType::kBarbarian; ///< 单位类型
+    SimVec2  position;                           ///< 部署位置
+    int      hitpoints   = 100;                  ///< 生命值
+    int      armor       = 0;                    ///< 护甲
+    float    damage      = 0.0f;                 ///< 每次攻击伤害
+    float    attackRange = 0.0f;                 ///< 攻击范围（像素）
+    float    attackSpeed = 1.0f;                 ///< 攻击间隔（秒）
+    float    moveSpeed   = 100.0f;               ///< 移动速度（像素/秒）
+};
+
+/**
+ * @struct BattleBuildingDesc
+ * @brief 加入战斗的建筑属性
+ */
+struct BattleBuildingDesc
+{
+    BattleBuildingKind kind            = BattleBuildingKind::kOther; ///< 建筑类别
+    SimVec2            position;                                     ///< 位置
+    int                gridX           = 0;                          ///< 占地起点 X
+    int                gridY           = 0;                          ///< 占地起点 Y
+    int                gridWidth       = 1;                          ///< 占地宽度
+    int                gridHeight      = 1;                          ///< 占地高度
+    int                hitpoints       = 100;                        ///< 当前生命值
+    int                maxHitpoints    = 100;                        ///< 最大生命值
+    bool               armed           = false;                      ///< 是否会主动攻击
+    float              damage          = 0.0f;                       ///< 每发伤害
+    float              attackRange     = 0.0f;                       ///< 攻击范围（像素）
+    float              attackSpeed     = 1.0f;                       ///< 攻击间隔（秒）
+    float              projectileSpeed = 600.0f;                     ///< 投射物速度（像素/秒）
+    float              splashRadius    = 0.0f;                       ///< 溅射半径（像素，0 为单体伤害）
+};
+
+/**
+ * @enum BattleStepPhase
+ * @brief step() 的各个阶段（按执行顺序）
+ */
+enum class BattleStepPhase
+{
+    kNavigation,  ///< 应用寻路结果
+    kMovement,    ///< 单位移动
+    kUnitAI,      ///< 单位 AI（选目标、攻击）
+    kProjectiles, ///< 投射物飞行与命中
+    kDefenses,    ///< 防御建筑选目标、开火
+    kDestruction, ///< 破坏率与星数
+    kCount
+};
+
+/**
+ * @struct BattleStepTimings
+ * @brief 最近一步各阶段耗时（秒），设置给 BattleWorld 后每步覆盖
+ */
+struct BattleStepTimings
+{
+    double seconds[static_cast<int>(BattleStepPhase::kCount)] = {}; ///< 按 BattleStepPhase 索引
+
+    double get(BattleStepPhase phase) const { return seconds[static_cast<int>(phase)]; }
+};
+
+/**
+ * @struct BattleAIStats
+ * @brief 单位 AI 调度统计（最近一步）
+ */
+struct BattleAIStats
+{
+    int          processed = 0; ///< 本步执行的请求数（选目标 + 请求寻路）
+    int          pending   = 0; ///< 本步结束时仍在排队的请求数
+    unsigned int maxWait   = 0; ///< 本步执行的请求中排队最久的步数
+};
+
+/**
+ * @class BattleWorld
+ * @brief 战斗模拟核心
+ *
+ * - 单位、建筑、投射物各自以数组结构保存，目标用下标而不是指针表示
+ * - 不依赖 cocos2d，可以在没有场景的环境下运行
+ * - 坐标、速度、冷却和伤害均为定点数，描述结构中的浮点数在加入时转换
+ * - step() 按固定步推进，规则与原先基于节点的实现一致：
+ *   寻路结果 -> 单位移动 -> 单位 AI -> 投射物 -> 防御建筑 -> 破坏率
+ * - 需要表现的变化记录为 BattleEvent，由视图层在渲染帧统一播放
+ * - 单位选目标和请求寻路受每步工作量预算限制，超出的请求按产生顺序排队到后续步，
+ *   排队中的单位原地等待（大建筑被摧毁时几十个单位同时换目标不会集中在一步内）
+ */
+class BattleWorld
+{
+public:
+    BattleWorld() = default;
+
+    /** @brief 清空所有状态 */
+    void reset();
+
+    /** @brief 设置寻路实现（可以为空，为空时单位直线移动） */
+    void setNavigation(BattleNavigation* navigation) { _navigation = navigation; }
+
+    /** @brief 设置分阶段计时输出（为空时不计时，用于基准测试和性能分析） */
+    void setStepTimings(BattleStepTimings* timings) { _stepTimings = timings; }
+
+    /**
+     * @brief 加入建筑
+     * @return BuildingIndex 建筑下标
+     */
+    BuildingIndex addBuilding(const BattleBuildingDesc& desc);
+
+    /**
+     * @brief 部署单位
+     * @return UnitIndex 单位下标
+     */
+    UnitIndex spawnUnit(const BattleUnitDesc& desc);
+
+    /**
+     * @brief 设置单位 AI 每步的工作量预算（一次选目标、一次请求寻路各计 1）
+     * @note 预算是模拟规则的一部分，录制和回放必须相同，游戏和 battle_sim 都使用 kDefaultAIWorkBudget
+     */
+    void setAIWorkBudget(int budget) { _aiWorkBudget = budget > 0 ? budget : 1; }
+    int  getAIWorkBudget() const { return _aiWorkBudget; }
+
+    /** @brief 最近一步的单位 AI 调度统计 */
+    const BattleAIStats& getAIStats() const { return _aiStats; }
+
+    /** @brief 启用/停用防御建筑（战斗正式开始时启用） */
+    void setDefensesActive(bool active) { _defensesActive = active; }
+
+    /**
+     * @brief 推进一个固定步
+     * @param dt 固定时间步长（秒），进入模拟前转换为定点数
+     */
+    void step(float dt);
+
+    /**
+     * @brief 模拟状态摘要（单位/建筑生命值、位置、目标）
+     * @return uint64_t 同一状态在任何平台上得到同一个值
+     */
+    uint64_t computeStateHash() const;
+
+    /**
+     * @brief 导出参与摘要的全部状态（定点数按底层整数输出），用于排查回放不同步
+     * @return std::string 每个单位/建筑一行
+     */
+    std::string describeState() const;
+
+    /** @brief 已推进的步数 */
+    unsigned int getTick() const { return _tick; }
+
+    // ==================== 单位 ====================
+
+    int           getUnitCount() const { return static_cast<int>(_units.type.size()); }
+    UnitType      getUnitType(UnitIndex u) const { return _units.type[u]; }
+    SimVec2       getUnitPosition(UnitIndex u) const
+    {
+        return SimVec2(Fixed::fromRaw(_units.positionX[u]), Fixed::fromRaw(_units.positionY[u]));
+    }
+    int           getUnitHitpoints(UnitIndex u) const { return _units.hitpoints[u]; }
+    bool          isUnitAlive(UnitIndex u) const { return _units.alive[u] != 0; }
+    bool          isUnitMoving(UnitIndex u) const { return _units.moving[u] != 0; }
+    SimVec2       getUnitMoveTarget(UnitIndex u) const { return _units.moveTarget[u]; }
+    BuildingIndex getUnitTarget(UnitIndex u) const { return _units.target[u]; }
+
+    /** @brief 存活单位数量 */
+    int countAliveUnits() const { return _aliveUnits; }
+
+    /**
+     * @brief 单位直线走向指定位置（同 BaseUnit::moveTo）
+     */
+    void moveUnitTo(UnitIndex u, const SimVec2& position);
+
+    /**
+     * @brief 单位沿路径移动（同 BaseUnit::moveToPath）
+     */
+    void moveUnitAlongPath(UnitIndex u, const std::vector<SimVec2>& path);
+
+    /** @brief 单位与指定位置的距离是否在攻击范围内 */
+    bool isUnitInAttackRange(UnitIndex u, const SimVec2& position) const;
+
+    // ==================== 建筑 ====================
+
+    int     getBuildingCount() const { return static_cast<int>(_buildings.kind.size()); }
+    SimVec2 getBuildingPosition(BuildingIndex b) const
+    {
+        return SimVec2(Fixed::fromRaw(_buildings.positionX[b]), Fixed::fromRaw(_buildings.positionY[b]));
+    }
+    int     getBuildingHitpoints(BuildingIndex b) const { return _buildings.hitpoints[b]; }
+    bool    isBuildingDestroyed(BuildingIndex b) const { return _buildings.hitpoints[b] <= 0; }
+
+    BattleBuildingKind getBuildingKind(BuildingIndex b) const { return _buildings.kind[b]; }
+
+    /** @brief 建筑占地矩形（网格坐标） */
+    void getBuildingGridRect(BuildingIndex b, int& x, int& y, int& width, int& height) const;
+
+    // ==================== 投射物 ====================
+
+    /** @brief 投射物槽位数（含空闲槽位） */
+    int     getProjectileSlotCount() const { return static_cast<int>(_projectiles.alive.size()); }
+    bool    isProjectileAlive(ProjectileIndex p) const { return _projectiles.alive[p] != 0; }
+    SimVec2 getProjectilePosition(ProjectileIndex p) const { return _projectiles.position[p]; }
+
+    /** @brief 飞行中的投射物数量 */
+    int countAliveProjectiles() const
+    {
+        return getProjectileSlotCount() - static_cast<int>(_projectiles.freeSlots.size());
+    }
+
+    // ==================== 战果 ====================
+
+    /** @brief 破坏率（0 ~ 100，基于生命值） */
+    int getDestructionPercent() const { return _destructionPercent; }
+
+    /** @brief 所有建筑最大生命值之和 */
+    int getTotalHitpoints() const { return _totalHitpoints; }
+
+    /** @brief 所有建筑已损失的生命值之和 */
+    int getDestroyedHitpoints() const { return _destroyedHitpoints; }
+
+    /** @brief 大本营是否被摧毁 */
+    bool isTownHallDestroyed() const { return _townHallDestroyed; }
+
+    /** @brief 已获得星数（只增不减） */
+    int getStars() const { return _stars; }
+
+    // ==================== 事件 ====================
+
+    /** @brief 自上次 clearEvents() 以来的事件 */
+    const std::vector<BattleEvent>& getEvents() const { return _events; }
+
+    /** @brief 清空事件 */
+    void clearEvents() { _events.clear(); }
+
+    /** @brief 是否记录事件（无视图的模拟可以关闭） */
+    void setRecordEvents(bool record) { _recordEvents = record; }
+
+    static constexpr int kDefaultAIWorkBudget = 16; ///< 默认每步单位 AI 工作量
+
+    /**
+     * @brief 模拟规则版本，写入回放头部；改变模拟结果的修改都要递增
+     * @note 1：最初的定点数固定步模拟；
+     *       2：投射物按飞行时间结算并支持溅射、单位 AI 按每步预算排队、网格寻路与视线修正
+     */
+    static constexpr uint32_t kRulesVersion = 2;
+
+private:
+    /**
+     * @enum AIRequest
+     * @brief 单位 AI 中受预算限制的工作
+     */
+    enum class AIRequest : uint8_t
+    {
+        kNone,     ///< 未排队
+        kRetarget, ///< 选择新目标
+        kPath      ///< 请求走向目标
+    };
+
+    /**
+     * @struct AIQueueEntry
+     * @brief 排队中的请求（类型记录在 UnitArrays::aiRequest）
+     */
+    struct AIQueueEntry
+    {
+        UnitIndex    unit = kInvalidIndex; ///< 单位下标
+        unsigned int tick = 0;             ///< 入队的步
+    };
+
+    /**
+     * @brief 单位数组
+     *
+     * 位置按 x、y 分开保存定点数底层值，与 alive 一起直接交给 BattleMath 做批量查询。
+     */
+    struct UnitArrays
+    {
+        std::vector<UnitType>             type;
+        std::vector<int32_t>              positionX;
+        std::vector<int32_t>              positionY;
+        std::vector<int>                  hitpoints;
+        std::vector<int>                  armor;
+        std::vector<Fixed>                damage;
+        std::vector<Fixed>                attackRange;
+        std::vector<Fixed>                attackSpeed;
+        std::vector<Fixed>                cooldown;
+        std::vector<Fixed>                moveSpeed;
+        std::vector<BuildingIndex>        target;
+        std::vector<SimVec2>              moveTarget;
+        std::vector<SimVec2>              velocity;
+        std::vector<std::vector<SimVec2>> path;
+        std::vector<int>                  pathIndex;
+        std::vector<uint8_t>              moving;
+        std::vector<uint8_t>              alive;
+        std::vector<AIRequest>            aiRequest; ///< 排队中的请求，排队期间跳过该单位的 AI
+    };
+
+    /** @brief 建筑数组 */
+    struct BuildingArrays
+    {
+        std::vector<BattleBuildingKind> kind;
+        std::vector<int32_t>            positionX;
+        std::vector<int32_t>            positionY;
+        std::vector<int>                gridRect; ///< 每个建筑 4 个数：x, y, w, h
+        std::vector<int>                hitpoints;
+        std::vector<int>                maxHitpoints;
+        std::vector<uint8_t>            targetFlags; ///< BattleMath 标志：未摧毁 + 类别
+        std::vector<uint8_t>            armed;
+        std::vector<Fixed>              damage;
+        std::vector<Fixed>              attackRange;
+        std::vector<Fixed>              attackSpeed;
+        std::vector<Fixed>              cooldown;
+        std::vector<Fixed>              projectileSpeed;
+        std::vector<Fixed>              splashRadius;
+        std::vector<UnitIndex>          target;
+    };
+
+    /**
+     * @brief 投射物数组（槽位复用）
+     *
+     * 落点在发射时固定为目标当时的位置，position 每步沿 velocity 前进；
+     * 命中时刻由 elapsed 和 duration 决定，与位置的定点误差无关。
+     */
+    struct ProjectileArrays
+    {
+        std::vector<SimVec2>         position;
+        std::vector<SimVec2>         velocity; ///< 像素/秒
+        std::vector<SimVec2>         to;
+        std::vector<Fixed>           elapsed;
+        std::vector<Fixed>           duration;
+        std::vector<Fixed>           damage;
+        std::vector<Fixed>           splashRadius;
+        std::vector<UnitIndex>       target;
+        std::vector<uint8_t>         alive;
+        std::vector<ProjectileIndex> freeSlots;
+        std::vector<ProjectileIndex> landed; ///< 本步命中的槽位（复用的临时数组）
+    };
+
+    void stepMovement(Fixed dt);
+    void stepUnitAI(Fixed dt);
+    void stepProjectiles(Fixed dt);
+    void stepDefenses(Fixed dt);
+    void updateDestruction();
+
+    BuildingIndex findTarget(UnitIndex u) const;
+    bool          scheduleAI(UnitIndex u, AIRequest request);
+    void          runAIRequest(UnitIndex u, AIRequest request);
+    void          processAIQueue();
+    void          setUnitPosition(UnitIndex u, const SimVec2& position);
+    void          stopUnit(UnitIndex u);
+    void          killUnit(UnitIndex u);
+    void          damageUnit(UnitIndex u, Fixed damage);
+    void          damageBuilding(BuildingIndex b, int damage);
+    void          fireProjectile(BuildingIndex b, UnitIndex u);
+    void          resolveProjectileHit(ProjectileIndex p);
+    void          emit(const BattleEvent& event);
+
+    UnitArrays         _units;
+    BuildingArrays     _buildings;
+    ProjectileArrays   _projectiles;
+    BattleNavigation*  _navigation  = nullptr;
+    BattleStepTimings* _stepTimings = nullptr;
+
+    unsigned int _tick               = 0;     ///< 已推进步数
+    int          _aliveUnits         = 0;     ///< 存活单位数
+    int          _standingBuildings  = 0;     ///< 未摧毁的建筑数
+    int          _totalHitpoints     = 0;     ///< 所有建筑最大生命值之和
+    int          _destroyedHitpoints = 0;     ///< 所有建筑已损失的生命值之和
+    int          _destructionPercent = 0;     ///< 破坏率
+    int          _stars              = 0;     ///< 星数
+    bool         _townHallDestroyed  = false; ///< 大本营是否被摧毁
+    bool         _defensesActive     = false; ///< 防御建筑是否启用
+    bool         _recordEvents       = true;  ///< 是否记录事件
+
+    int                       _aiWorkBudget = kDefaultAIWorkBudget; ///< 每步单位 AI 工作量预算
+    int                       _aiBudgetLeft = 0;                    ///< 本步剩余预算
+    BattleAIStats             _aiStats;                             ///< 最近一步的调度统计
+    std::vector<AIQueueEntry> _aiQueue;                             ///< 按入队顺序排列的请求
+    size_t                    _aiQueueHead  = 0;                    ///< 队首在 _aiQueue 中的位置
+
+    std::vector<BattleEvent> _events;       ///< 待播放的事件
+    std::vector<UnitIndex>   _queryIndices; ///< BattleMath 范围查询结果（复用的临时数组）
+};
+
+#endif // __BATTLE_WORLD_H__
@@ -0,0 +1,152 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     FixedPoint.h
+ * File Function: 定点数 - 战斗模拟使用的 Q16.16 数值类型，保证跨平台结果一致
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __FIXED_POINT_H__
+#define __FIXED_POINT_H__
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @class Fixed
+ * @brief Q16.16 定点数
+ *
+ * - 底层是一个 int32，整数部分 ±32767，精度 1/65536，足够表示地图像素坐标
+ * - 加减乘除只使用整数运算，结果与编译器、优化级别和 CPU 无关
+ * - 乘法按 64 位计算后右移（向下取整），除法向零取整
+ * - 浮点数只在边界处转换（配置数值、部署坐标、渲染），模拟过程中不再出现浮点运算
+ */
+class Fixed
+{
+public:
+    static constexpr int     kFractionBits = 16;
+    static constexpr int32_t kOneRaw       = 1 << kFractionBits;
+
+    constexpr Fixed() : _raw(0) {}
+
+    /** @brief 由底层整数构造 */
+    static constexpr Fixed fromRaw(int32_t raw) { return Fixed(raw, RawTag()); }
+
+    /** @brief 由整数构造 */
+    static constexpr Fixed fromInt(int value) { return Fixed(value * kOneRaw, RawTag()); }
+
+    /**
+     * @brief 由浮点数构造（四舍五入到最近的 1/65536）
+     * @note 乘以 2 的幂在 double 中是精确的，因此同一个 float 在任何平台上得到同一个结果
+     */
+    static Fixed fromFloat(float value)
+    {
+        double scaled = static_cast<double>(value) * kOneRaw;
+        return fromRaw(static_cast<int32_t>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5));
+    }
+
+    constexpr int32_t raw() const { return _raw; }
+
+    /** @brief 转为浮点数（仅用于渲染和日志） */
+    float toFloat() const { return static_cast<float>(_raw) / kOneRaw; }
+
+    /** @brief 向零取整（同 static_cast<int>） */
+    constexpr int toInt() const { return _raw / kOneRaw; }
+
+    /** @brief 四舍五入取整（.5 向上） */
+    constexpr int roundToInt() const
+    {
+        return static_cast<int>((static_cast<int64_t>(_raw) + kOneRaw / 2) >> kFractionBits);
+    }
+
+    constexpr Fixed operator+(Fixed o) const { return fromRaw(_raw + o._raw); }
+    constexpr Fixed operator-(Fixed o) const { return fromRaw(_raw - o._raw); }
+    constexpr Fixed operator-() const { return fromRaw(-_raw); }
+
+    constexpr Fixed operator*(Fixed o) const
+    {
+        return fromRaw(static_cast<int32_t>((static_cast<int64_t>(_raw) * o._raw) >> kFractionBits));
+    }
+
+    /** @brief 除法，除数为 0 时返回 0 */
+    constexpr Fixed operator/(Fixed o) const
+    {
+        return o._raw == 0 ? Fixed() : fromRaw(static_cast<int32_t>(static_cast<int64_t>(_raw) * kOneRaw / o._raw));
+    }
+
+    Fixed& operator+=(Fixed o)
+    {
+        _raw += o._raw;
+        return *this;
+    }
+
+    Fixed& operator-=(Fixed o)
+    {
+        _raw -= o._raw;
+        return *this;
+    }
+
+    constexpr bool operator==(Fixed o) const { return _raw == o._raw; }
+    constexpr bool operator!=(Fixed o) const { return _raw != o._raw; }
+    constexpr bool operator<(Fixed o) const { return _raw < o._raw; }
+    constexpr bool operator<=(Fixed o) const { return _raw <= o._raw; }
+    constexpr bool operator>(Fixed o) const { return _raw > o._raw; }
+    constexpr bool operator>=(Fixed o) const { return _raw >= o._raw; }
+
+private:
+    struct RawTag
+    {
+    };
+
+    constexpr Fixed(int32_t raw, RawTag) : _raw(raw) {}
+
+    int32_t _raw;
+};
+
+// 定点数数组可以直接按 int32 数组交给整数 SIMD 内核处理
+static_assert(sizeof(Fixed) == sizeof(int32_t), "Fixed must be a plain int32");
+static_assert(std::is_trivially_copyable<Fixed>::value, "Fixed must be trivially copyable");
+
+namespace FixedMath
+{
+
+/** @brief 64 位无符号整数平方根（向下取整，逐位求解，不使用浮点） */
+inline uint64_t isqrt64(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit    = uint64_t(1) << 62;
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+/** @brief 定点数的平方（64 位 Q32.32，用于与平方距离比较） */
+constexpr int64_t squareRaw(Fixed value)
+{
+    return static_cast<int64_t>(value.raw()) * value.raw();
+}
+
+/** @brief Q32.32 平方值开方，得到 Q16.16 */
+inline Fixed sqrtFromSquaredRaw(int64_t squared)
+{
+    return squared <= 0 ? Fixed() : Fixed::fromRaw(static_cast<int32_t>(isqrt64(static_cast<uint64_t>(squared))));
+}
+
+} // namespace FixedMath
+
+#endif // __FIXED_POINT_H__
@@ -8,9 +8,11 @@
  ****************************************************************/
 #include "BaseBuilding.h"
 
-#include "BuildingHealthBarUI.h"
+#include "BuildingHitpoints.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Managers/UpgradeManager.h"
 #include "Services/BuildingUpgradeService.h"
+#include "UI/HealthBarLayer.h"
 #include "Unit/BaseUnit.h"
 #include "Unit/CombatStats.h"
 #include "Audio/AudioManager.h"
@@ -21,45 +23,18 @@ USING_NS_CC;
 
 BaseBuilding::~BaseBuilding()
 {
-    // 安全清理血条UI
-    if (_healthBarUI)
+    // 血条由血条层统一绘制，这里只归还槽位
+    if (_healthBarLayer)
     {
-        // 先停止更新调度，防止并发访问
-        _healthBarUI->unscheduleUpdate();
-        
-        if (_healthBarUI->getParent() != nullptr)
-        {
-            _healthBarUI->removeFromParent();
-        }
-        _healthBarUI = nullptr;
+        _healthBarLayer->removeBar(_healthBarSlot);
+        _healthBarLayer = nullptr;
+        _healthBarSlot  = -1;
     }
 }
 
 // ==================== 大本营配置数据表 (17级) ====================
 namespace TownHallConfigTable
 {
-// 生命值表
-static const int kHitpoints[] = {
-    0,      // Level 0 (无效)
-    400,    // Level 1
-    800,    // Level 2
-    1600,   // Level 3
-    2000,   // Level 4
-    2400,   // Level 5
-    2800,   // Level 6
-    3300,   // Level 7
-    3900,   // Level 8
-    4600,   // Level 9
-    5500,   // Level 10
-    6800,   // Level 11
-    7500,   // Level 12
-    8200,   // Level 13
-    8900,   // Level 14
-    9600,   // Level 15
-    10000,  // Level 16
-    10400   // Level 17
-};
-
 // 升级费用表（金币）
 static const int kUpgradeCosts[] = {
     0,          // Level 0 (无效)
@@ -132,27 +107,6 @@ static const int kMaxLevel = 17;
 // ==================== 城墙配置数据表 (16级) ====================
 namespace WallConfigTable
 {
-// 生命值表
-static const int kHitpoints[] = {
-    0,      // Level 0 (无效)
-    300,    // Level 1
-    500,    // Level 2
-    700,    // Level 3
-    900,    // Level 4
-    1400,   // Level 5
-    2000,   // Level 6
-    2500,   // Level 7
-    3000,   // Level 8
-    4000,   // Level 9
-    5500,   // Level 10
-    7000,   // Level 11
-    8500,   // Level 12
-    10000,  // Level 13
-    12000,  // Level 14
-    14000,  // Level 15
-    17000   // Level 16
-};
-
 // 升级费用表（金币）
 static const int kUpgradeCosts[] = {
     0,        // Level 0 (无效)
@@ -201,25 +155,6 @@ static const int kMaxLevel = 16;
 // ==================== 兵营配置数据表 (14级) ====================
 namespace ArmyConfigTable
 {
-// 生命值表
-static const int kHitpoints[] = {
-    0,    // Level 0 (无效)
-    250,  // Level 1
-    270,  // Level 2
-    300,  // Level 3
-    330,  // Level 4
-    360,  // Level 5
-    400,  // Level 6
-    450,  // Level 7
-    500,  // Level 8
-    560,  // Level 9
-    620,  // Level 10
-    700,  // Level 11
-    780,  // Level 12
-    860,  // Level 13
-    950   // Level 14
-};
-
 // 升级费用表（圣水）
 static const int kUpgradeCosts[] = {
     0,       // Level 0 (无效)
@@ -264,24 +199,6 @@ static const int kMaxLevel = 14;
 // ==================== 军营配置数据表 (13级) ====================
 namespace ArmyCampConfigTable
 {
-// 生命值表
-static const int kHitpoints[] = {
-    0,    // Level 0 (无效)
-    250,  // Level 1
-    280,  // Level 2
-    320,  // Level 3
-    360,  // Level 4
-    400,  // Level 5
-    450,  // Level 6
-    500,  // Level 7
-    550,  // Level 8
-    620,  // Level 9
-    700,  // Level 10
-    800,  // Level 11
-    1000, // Level 12
-    1200  // Level 13
-};
-
 // 容纳人口表
 static const int kHousingSpace[] = {
     0,   // Level 0 (无效)
@@ -350,7 +267,7 @@ bool BaseBuilding::initWithType(BuildingType type, int level)
     _config = getStaticConfig(type, level);
 
     // 2. 初始化 Sprite (使用配置中的图片)
-    if (!Sprite::initWithFile(_config.imageFile))
+    if (!initSpriteWithImage(_config.imageFile))
     {
         // 如果图片不存在，尝试使用默认图片或纯色块，避免崩溃
         if (!Sprite::init())
@@ -376,7 +293,7 @@ bool BaseBuilding::init(int level)
 bool BaseBuilding::init(int level, const std::string& imageFile)
 {
     // 兼容旧接口
-    if (!Sprite::initWithFile(imageFile))
+    if (!initSpriteWithImage(imageFile))
     {
         return false;
     }
@@ -386,6 +303,23 @@ bool BaseBuilding::init(int level, const std::string& imageFile)
     return true;
 }
 
+bool BaseBuilding::initSpriteWithImage(const std::string& imageFile)
+{
+    SpriteFrame* frame = SpriteAtlasManager::getInstance().getSpriteFrame(imageFile);
+    return frame && Sprite::initWithSpriteFrame(frame);
+}
+
+bool BaseBuilding::setSpriteImage(const std::string& imageFile)
+{
+    SpriteFrame* frame = SpriteAtlasManager::getInstance().getSpriteFrame(imageFile);
+    if (!frame)
+        return false;
+
+    // setSpriteFrame 同时设置纹理和纹理区域，图集帧与散图都适用
+    setSpriteFrame(frame);
+    return true;
+}
+
 void BaseBuilding::updateProperties()
 {
     // 重新加载配置
@@ -424,7 +358,7 @@ void BaseBuilding::updateProperties()
     {
         if (!_config.imageFile.empty())
         {
-            setTexture(_config.imageFile);
+            setSpriteImage(_config.imageFile);
         }
     }
 }
@@ -453,7 +387,7 @@ BuildingConfigData BaseBuilding::getStaticConfig(BuildingType type, int level)
 
         // 限制等级范围
         int idx = std::max(1, std::min(level, TownHallConfigTable::kMaxLevel));
-        config.maxHitpoints = TownHallConfigTable::kHitpoints[idx];
+        config.maxHitpoints = BuildingHitpoints::getTownHall(idx);
         config.upgradeCost  = TownHallConfigTable::kUpgradeCosts[idx];
         config.upgradeTime  = TownHallConfigTable::kUpgradeTimes[idx];
         config.imageFile    = StringUtils::format("buildings/BaseCamp/town-hall-%d.png", idx);
@@ -470,7 +404,7 @@ BuildingConfigData BaseBuilding::getStaticConfig(BuildingType type, int level)
 
         // 限制等级范围
         int idx = std::max(1, std::min(level, WallConfigTable::kMaxLevel));
-        config.maxHitpoints = WallConfigTable::kHitpoints[idx];
+        config.maxHitpoints = BuildingHitpoints::getWall(idx);
         config.upgradeCost  = WallConfigTable::kUpgradeCosts[idx];
         config.upgradeTime  = WallConfigTable::kUpgradeTimes[idx];
         config.imageFile    = StringUtils::format("buildings/Wall/Wall%d.png", idx);
@@ -487,7 +421,7 @@ BuildingConfigData BaseBuilding::getStaticConfig(BuildingType type, int level)
 
         // 限制等级范围
         int idx = std::max(1, std::min(level, ArmyConfigTable::kMaxLevel));
-        config.maxHitpoints = ArmyConfigTable::kHitpoints[idx];
+        config.maxHitpoints = BuildingHitpoints::getBarracks(idx);
         config.upgradeCost  = ArmyConfigTable::kUpgradeCosts[idx];
         config.upgradeTime  = ArmyConfigTable::kUpgradeTimes[idx];
         config.imageFile    = StringUtils::format("buildings/Barracks/Barracks%d.png", idx);
@@ -509,7 +443,7 @@ BuildingConfigData BaseBuilding::getStaticConfig(BuildingType type, int level)
 
         // 限制等级范围
         int idx = std::max(1, std::min(level, ArmyCampConfigTable::kMaxLevel));
-        config.maxHitpoints     = ArmyCampConfigTable::kHitpoints[idx];
+        config.maxHitpoints     = BuildingHitpoints::getArmyCamp(idx);
         config.upgradeCost      = ArmyCampConfigTable::kUpgradeCosts[idx];
         config.upgradeTime      = ArmyCampConfigTable::kUpgradeTimes[idx];
         config.resourceCapacity = ArmyCampConfigTable::kHousingSpace[idx];  // 用于存储人口容量
@@ -610,15 +544,7 @@ void BaseBuilding::onLevelUp()
     std::string newImageFile = getImageForLevel(_level);
     if (!newImageFile.empty())
     {
-        auto textureCache = Director::getInstance()->getTextureCache();
-        auto texture = textureCache->addImage(newImageFile);
-        if (texture)
-        {
-            this->setTexture(texture);
-            // 必须同时设置 TextureRect，否则纹理不会正确显示
-            this->setTextureRect(Rect(0, 0, texture->getContentSize().width, 
-                                            texture->getContentSize().height));
-        }
+        setSpriteImage(newImageFile);
     }
     
     CCLOG("[Building] %s upgraded to Lv.%d", getDisplayName().c_str(), _level);
@@ -667,6 +593,10 @@ void BaseBuilding::takeDamage(int damage)
     if (_currentHitpoints < 0)
         _currentHitpoints = 0;
 
+    // 通知血条层刷新（血条不再每帧轮询生命值）
+    if (_healthBarLayer)
+        _healthBarLayer->setHitpoints(_healthBarSlot, _currentHitpoints, _maxHitpoints);
+
     // 首次受伤时显示血条
     if (_battleModeEnabled && !_hasBeenAttacked)
     {
@@ -682,6 +612,25 @@ void BaseBuilding::takeDamage(int damage)
     }
 }
 
+void BaseBuilding::syncHitpoints(int hitpoints)
+{
+    hitpoints = std::max(0, std::min(hitpoints, _maxHitpoints));
+    if (hitpoints == _currentHitpoints)
+        return;
+
+    _currentHitpoints = hitpoints;
+    if (_healthBarLayer)
+        _healthBarLayer->setHitpoints(_healthBarSlot, _currentHitpoints, _maxHitpoints);
+
+    if (_battleModeEnabled && !_hasBeenAttacked && _currentHitpoints < _maxHitpoints)
+    {
+        _hasBeenAttacked = true;
+        showHealthBar();
+    }
+
+    this->setVisible(!isDestroyed());
+}
+
 void BaseBuilding::repair(int amount)
 {
     if (amount <= 0)
@@ -689,6 +638,9 @@ void BaseBuilding::repair(int amount)
     _currentHitpoints += amount;
     if (_currentHitpoints > _maxHitpoints)
         _currentHitpoints = _maxHitpoints;
+
+    if (_healthBarLayer)
+        _healthBarLayer->setHitpoints(_healthBarSlot, _currentHitpoints, _maxHitpoints);
 }
 
 void BaseBuilding::setTarget(BaseUnit* target)
@@ -707,31 +659,43 @@ void BaseBuilding::attackTarget(BaseUnit* target)
 
 void BaseBuilding::initHealthBarUI()
 {
-    if (_healthBarUI != nullptr || !_battleModeEnabled)
+    if (_healthBarSlot >= 0 || !_healthBarLayer || !_battleModeEnabled)
     {
         return;
     }
-    
-    auto* healthBarUI = BuildingHealthBarUI::create(this);
-    if (healthBarUI)
-    {
-        // 初始隐藏，首次受伤后再显示
-        healthBarUI->setVisible(false);
-        healthBarUI->setAlwaysVisible(false);
-        this->addChild(healthBarUI, 1000);
-        _healthBarUI = healthBarUI;
-    }
+
+    // 初始隐藏，首次受伤后再显示
+    _healthBarSlot = _healthBarLayer->addBuilding(this);
 }
 
 void BaseBuilding::showHealthBar()
 {
-    if (_healthBarUI && _healthBarUI->getParent() != nullptr)
+    if (_healthBarLayer && _healthBarSlot >= 0)
     {
-        _healthBarUI->setAlwaysVisible(true);
-        _healthBarUI->show();
+        _healthBarLayer->setAlwaysVisible(_healthBarSlot, true);
+        _healthBarLayer->show(_healthBarSlot);
     }
 }
 
+void BaseBuilding::attachHealthBarLayer(HealthBarLayer* layer)
+{
+    if (_healthBarLayer == layer)
+        return;
+
+    if (_healthBarLayer)
+        _healthBarLayer->removeBar(_healthBarSlot);
+    _healthBarLayer = layer;
+    _healthBarSlot  = -1;
+
+    initHealthBarUI();
+}
+
+void BaseBuilding::detachHealthBar()
+{
+    _healthBarLayer = nullptr;
+    _healthBarSlot  = -1;
+}
+
 void BaseBuilding::enableBattleMode()
 {
     _battleModeEnabled = true;
@@ -744,19 +708,13 @@ void BaseBuilding::disableBattleMode()
     _battleModeEnabled = false;
     _hasBeenAttacked = false;
     
-    // 安全移除血条UI
-    if (_healthBarUI)
+    // 移除血条（保留与血条层的关联，再次进入战斗模式时重新创建）
+    if (_healthBarLayer)
     {
-        // 先停止更新调度，防止并发访问
-        _healthBarUI->unscheduleUpdate();
-        
-        if (_healthBarUI->getParent() != nullptr)
-        {
-            _healthBarUI->removeFromParent();
-        }
-        _healthBarUI = nullptr;
+        _healthBarLayer->removeBar(_healthBarSlot);
+        _healthBarSlot = -1;
     }
-    
+
     // 恢复满血
     if (!isDestroyed())
     {
@@ -17,7 +17,7 @@
 #include <string>
 
 class BaseUnit;
-class BuildingHealthBarUI;
+class HealthBarLayer;
 
 /**
  * @enum BuildingType
@@ -139,12 +139,27 @@ public:
     /** @brief 是否处于战斗模式 */
     bool isBattleModeEnabled() const { return _battleModeEnabled; }
 
+    /**
+     * @brief 关联战斗血条层（战斗模式下立即创建血条）
+     * @param layer 血条层
+     */
+    void attachHealthBarLayer(HealthBarLayer* layer);
+
+    /** @brief 血条层清空时回调：只清除引用，不再通知血条层 */
+    void detachHealthBar();
+
     /**
      * @brief 受到伤害
      * @param damage 伤害值
      */
     void takeDamage(int damage);
 
+    /**
+     * @brief 直接同步生命值（观战追帧结束时使用，不播放音效）
+     * @param hitpoints 模拟中的当前生命值
+     */
+    void syncHitpoints(int hitpoints);
+
     /**
      * @brief 修复建筑
      * @param amount 恢复量
@@ -229,7 +244,21 @@ protected:
     virtual bool init(int level);
     virtual bool init(int level, const std::string& imageFile);
 
-    /** @brief 初始化血条UI（仅在战斗模式下调用）*/
+    /**
+     * @brief 用图片初始化精灵（图集中有同名帧时使用图集帧，否则加载散图）
+     * @param imageFile 散图路径
+     * @return bool 图片是否存在
+     */
+    bool initSpriteWithImage(const std::string& imageFile);
+
+    /**
+     * @brief 切换显示的图片，纹理区域随之更新为整张图片/整个图集帧
+     * @param imageFile 散图路径
+     * @return bool 图片是否存在（不存在时保持原样）
+     */
+    bool setSpriteImage(const std::string& imageFile);
+
+    /** @brief 在血条层中创建血条（仅在战斗模式下且已关联血条层时生效）*/
     void initHealthBarUI();
 
     /** @brief 显示血条（首次受伤时调用）*/
@@ -261,9 +290,10 @@ protected:
     BaseUnit*   _currentTarget  = nullptr;  ///< 当前攻击目标
     float       _attackCooldown = 0.0f;     ///< 攻击冷却计时器
 
-    BuildingHealthBarUI* _healthBarUI       = nullptr;  ///< 血条UI
-    bool                 _battleModeEnabled = false;    ///< 战斗模式是否启用
-    bool                 _hasBeenAttacked   = false;    ///< 是否已被攻击过（用于控制血条显示）
+    HealthBarLayer* _healthBarLayer    = nullptr;  ///< 血条层（战斗场景持有）
+    int             _healthBarSlot     = -1;       ///< 在血条层中的槽位，-1 表示没有血条
+    bool            _battleModeEnabled = false;    ///< 战斗模式是否启用
+    bool            _hasBeenAttacked   = false;    ///< 是否已被攻击过（用于控制血条显示）
 };
 
 #endif // BASE_BUILDING_H_
\ No newline at end of file
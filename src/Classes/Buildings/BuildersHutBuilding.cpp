@@ -28,7 +28,7 @@ bool BuildersHutBuilding::init(int level)
     _isBuilderAvailable = true;
     
     std::string imageFile = getImageFile();
-    if (!Sprite::initWithFile(imageFile))
+    if (!initSpriteWithImage(imageFile))
         return false;
     
     // 设置锚点和缩放
@@ -88,6 +88,11 @@ std::string BuildersHutBuilding::getImageFile() const
 }
 
 std::string BuildersHutBuilding::getImageForLevel(int level) const
+{
+    return getImageFileFor(level);
+}
+
+std::string BuildersHutBuilding::getImageFileFor(int level)
 {
     if (level < 1 || level > 7)
         level = 1;
@@ -24,6 +24,13 @@ public:
      */
     static BuildersHutBuilding* create(int level = 1);
 
+    /**
+     * @brief 获取指定等级的图片路径（无需实例，供资源预加载使用）
+     * @param level 建筑等级，超出范围时按 1 级处理
+     * @return std::string 图片路径
+     */
+    static std::string getImageFileFor(int level);
+
     /** @brief 获取建筑类型 */
     virtual BuildingType getBuildingType() const override { return BuildingType::kDecoration; }
 
@@ -0,0 +1,154 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BuildingHitpoints.h
+ * File Function: 建筑生命值表 - 建筑节点和无界面战斗模拟共用（不依赖 cocos2d）
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BUILDING_HITPOINTS_H__
+#define __BUILDING_HITPOINTS_H__
+
+/**
+ * @brief 各类非防御建筑的生命值表
+ *
+ * 防御建筑的生命值见 CombatStats.h 中的 DefenseConfig。
+ * 等级超出范围时按最近的有效等级取值。
+ */
+namespace BuildingHitpoints
+{
+
+namespace detail
+{
+template <int N>
+inline int lookup(const int (&table)[N], int level)
+{
+    if (level < 1)
+        level = 1;
+    if (level > N - 1)
+        level = N - 1;
+    return table[level];
+}
+} // namespace detail
+
+// 大本营（17级）
+inline int getTownHall(int level)
+{
+    static const int kTable[] = {
+        0,      // Level 0 (无效)
+        400,    // Level 1
+        800,    // Level 2
+        1600,   // Level 3
+        2000,   // Level 4
+        2400,   // Level 5
+        2800,   // Level 6
+        3300,   // Level 7
+        3900,   // Level 8
+        4600,   // Level 9
+        5500,   // Level 10
+        6800,   // Level 11
+        7500,   // Level 12
+        8200,   // Level 13
+        8900,   // Level 14
+        9600,   // Level 15
+        10000,  // Level 16
+        10400   // Level 17
+    };
+    return detail::lookup(kTable, level);
+}
+
+// 城墙（16级）
+inline int getWall(int level)
+{
+    static const int kTable[] = {
+        0,      // Level 0 (无效)
+        300,    // Level 1
+        500,    // Level 2
+        700,    // Level 3
+        900,    // Level 4
+        1400,   // Level 5
+        2000,   // Level 6
+        2500,   // Level 7
+        3000,   // Level 8
+        4000,   // Level 9
+        5500,   // Level 10
+        7000,   // Level 11
+        8500,   // Level 12
+        10000,  // Level 13
+        12000,  // Level 14
+        14000,  // Level 15
+        17000   // Level 16
+    };
+    return detail::lookup(kTable, level);
+}
+
+// 兵营（14级）
+inline int getBarracks(int level)
+{
+    static const int kTable[] = {
+        0,    // Level 0 (无效)
+        250,  // Level 1
+        270,  // Level 2
+        300,  // Level 3
+        330,  // Level 4
+        360,  // Level 5
+        400,  // Level 6
+        450,  // Level 7
+        500,  // Level 8
+        560,  // Level 9
+        620,  // Level 10
+        700,  // Level 11
+        780,  // Level 12
+        860,  // Level 13
+        950   // Level 14
+    };
+    return detail::lookup(kTable, level);
+}
+
+// 军营（13级）
+inline int getArmyCamp(int level)
+{
+    static const int kTable[] = {
+        0,    // Level 0 (无效)
+        250,  // Level 1
+        280,  // Level 2
+        320,  // Level 3
+        360,  // Level 4
+        400,  // Level 5
+        450,  // Level 6
+        500,  // Level 7
+        550,  // Level 8
+        620,  // Level 9
+        700,  // Level 10
+        800,  // Level 11
+        1000, // Level 12
+        1200  // Level 13
+    };
+    return detail::lookup(kTable, level);
+}
+
+// 生产型资源建筑（金矿、圣水收集器）
+inline int getProducer(int level)
+{
+    static const int kTable[] = {0, 400, 450, 500, 550, 600, 640, 680, 720, 780, 840, 900, 960, 1020, 1080, 1180};
+    return detail::lookup(kTable, level);
+}
+
+// 存储型资源建筑（金币仓库、圣水仓库）
+inline int getStorage(int level)
+{
+    static const int kTable[] = {0,    600,  700,  800,  900,  1000, 1200, 1300, 1400,
+                                 1600, 1800, 2100, 2400, 2700, 3000, 3400, 3800, 4200};
+    return detail::lookup(kTable, level);
+}
+
+// 建筑工人小屋（沿用建筑默认生命值）
+inline int getBuildersHut(int /*level*/)
+{
+    return 100;
+}
+
+} // namespace BuildingHitpoints
+
+#endif // __BUILDING_HITPOINTS_H__
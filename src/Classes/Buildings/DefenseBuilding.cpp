@@ -8,17 +8,8 @@
 ****************************************************************/
 #include "DefenseBuilding.h"
 
-#include "UI/BuildingHealthBarUI.h"
-#include "Unit/BaseUnit.h"
-
 USING_NS_CC;
 
-// 辅助函数
-static bool isInRange(const Vec2& pos1, const Vec2& pos2, float range)
-{
-    return pos1.distance(pos2) <= range;
-}
-
 DefenseBuilding* DefenseBuilding::create(DefenseType defenseType, int level)
 {
     DefenseBuilding* ret = new (std::nothrow) DefenseBuilding();
@@ -175,7 +166,12 @@ std::string DefenseBuilding::getBuildingDescription() const
 std::string DefenseBuilding::getImageForLevel(int level) const
 {
     // 始终根据等级生成路径，确保升级后图片正确更新
-    switch (_defenseType)
+    return getImageFileFor(_defenseType, level);
+}
+
+std::string DefenseBuilding::getImageFileFor(DefenseType defenseType, int level)
+{
+    switch (defenseType)
     {
     case DefenseType::kCannon:
         return StringUtils::format("buildings/Cannon_Static/Cannon%d.png", level);
@@ -196,167 +192,24 @@ void DefenseBuilding::onLevelUp()
 
 // ==================== 战斗逻辑 ====================
 
-void DefenseBuilding::tick(float dt)
-{
-    if (!_battleModeEnabled || isDestroyed())
-        return;
-
-    if (_attackCooldown > 0.0f)
-    {
-        _attackCooldown -= dt;
-    }
-
-    if (_currentTarget)
-    {
-        // 检查目标是否死亡或等待移除
-        if (_currentTarget->isDead() || _currentTarget->isPendingRemoval())
-        {
-            clearTarget();
-            return;
-        }
-
-        Vec2 targetPos = _currentTarget->getPosition();
-        Vec2 myPos     = this->getPosition();
-
-        if (!isInRange(targetPos, myPos, _combatStats.attackRange))
-        {
-            clearTarget();
-            return;
-        }
-
-        if (_attackCooldown <= 0.0f)
-        {
-            attackTarget(_currentTarget);
-            _attackCooldown = _combatStats.attackSpeed;
-        }
-    }
-}
-
-void DefenseBuilding::detectEnemies(const std::vector<BaseUnit*>& units)
+float DefenseBuilding::getProjectileSpeed() const
 {
-    if (!_battleModeEnabled || isDestroyed())
-        return;
-
-    // 如果已有有效目标，不重新选择
-    if (_currentTarget && !_currentTarget->isDead() && !_currentTarget->isPendingRemoval())
-        return;
-
-    Vec2      myPos           = this->getPosition();
-    BaseUnit* closestUnit     = nullptr;
-    float     closestDistance = _combatStats.attackRange + 1.0f;
-
-    for (auto* unit : units)
-    {
-        // 跳过空指针、已死亡或等待移除的单位
-        if (!unit || unit->isDead() || unit->isPendingRemoval())
-            continue;
-
-        Vec2  unitPos  = unit->getPosition();
-        float distance = myPos.distance(unitPos);
-
-        if (distance <= _combatStats.attackRange && distance < closestDistance)
-        {
-            closestUnit     = unit;
-            closestDistance = distance;
-        }
-    }
-
-    if (closestUnit)
-    {
-        setTarget(closestUnit);
-    }
-}
-
-void DefenseBuilding::attackTarget(BaseUnit* target)
-{
-    // 增加 isPendingRemoval 检查
-    if (!target || target->isDead() || target->isPendingRemoval())
-        return;
-
-    BaseBuilding::attackTarget(target);
-
-    fireProjectile(target);
-    playAttackAnimation();
-}
-
-void DefenseBuilding::fireProjectile(BaseUnit* target)
-{
-    if (!target || target->isDead() || target->isPendingRemoval())
-        return;
-
-    // 保持对目标的引用，防止在动画过程中被释放
-    target->retain();
-    float damage = _combatStats.damage;
-
-    // 创建炮弹/箭矢视觉效果
-    Sprite* projectile      = nullptr;
-    float   projectileSpeed = 0.0f;
-
     switch (_defenseType)
     {
-    case DefenseType::kCannon:
-        projectile      = createCannonballSprite();
-        projectileSpeed = 600.0f;
-        break;
     case DefenseType::kArcherTower:
-        projectile      = createArrowSprite();
-        projectileSpeed = 800.0f;
-        break;
+        return 800.0f;
     case DefenseType::kWizardTower:
-        projectile      = createCannonballSprite();
-        projectileSpeed = 500.0f;
-        break;
+        return 500.0f;
+    case DefenseType::kCannon:
     default:
-        projectile      = createCannonballSprite();
-        projectileSpeed = 600.0f;
-        break;
-    }
-
-    if (!projectile || !this->getParent())
-    {
-        // 创建失败时直接造成伤害
-        if (!target->isDead() && !target->isPendingRemoval())
-        {
-            target->takeDamage(damage);
-        }
-        target->release();
-        return;
-    }
-
-    // 炮弹飞行动画
-    Vec2 startPos = this->getPosition();
-    Vec2 endPos   = target->getPosition();
-
-    projectile->setPosition(startPos);
-    this->getParent()->addChild(projectile, 5000);
-
-    float distance = startPos.distance(endPos);
-    float duration = distance / projectileSpeed;
-
-    // 箭矢旋转朝向目标
-    if (_defenseType == DefenseType::kArcherTower)
-    {
-        Vec2  direction = endPos - startPos;
-        float angle     = CC_RADIANS_TO_DEGREES(direction.getAngle());
-        projectile->setRotation(-angle);
+        return 600.0f;
     }
+}
 
-    auto moveTo = MoveTo::create(duration, endPos);
-    
-    // 在回调中使用 retain/release 管理目标生命周期
-    auto hitCallback = CallFunc::create([target, damage, projectile]() {
-        // 确保目标仍然存在且未死亡
-        if (!target->isDead() && !target->isPendingRemoval())
-        {
-            target->takeDamage(damage);
-        }
-        // 释放之前 retain 的引用
-        target->release();
-        projectile->removeFromParent();
-    });
-
-    auto sequence = Sequence::create(moveTo, hitCallback, nullptr);
-    projectile->runAction(sequence);
+float DefenseBuilding::getSplashRadius() const
+{
+    // 法师塔的法球对落点周围造成溅射伤害，其余防御只伤害目标
+    return _defenseType == DefenseType::kWizardTower ? 40.0f : 0.0f;
 }
 
 void DefenseBuilding::playAttackAnimation()
@@ -416,6 +269,24 @@ void DefenseBuilding::rotateToTarget(const cocos2d::Vec2& targetPos)
 
 // ==================== 炮弹/箭矢创建 ====================
 
+Sprite* DefenseBuilding::createProjectileSprite()
+{
+    if (_defenseType == DefenseType::kArcherTower)
+        return createArrowSprite();
+    return createCannonballSprite();
+}
+
+void DefenseBuilding::orientProjectile(Sprite* projectile, const Vec2& startPos, const Vec2& endPos)
+{
+    // 箭矢旋转朝向目标
+    if (_defenseType == DefenseType::kArcherTower)
+    {
+        Vec2  direction = endPos - startPos;
+        float angle     = CC_RADIANS_TO_DEGREES(direction.getAngle());
+        projectile->setRotation(-angle);
+    }
+}
+
 Sprite* DefenseBuilding::createCannonballSprite()
 {
     auto cannonball = Sprite::create();
@@ -15,9 +15,6 @@
 #include <string>
 #include <vector>
 
-class BaseUnit;
-class BuildingHealthBarUI;
-
 /**
  * @enum DefenseType
  * @brief 防御建筑类型枚举
@@ -53,6 +50,14 @@ public:
      */
     static DefenseBuilding* create(DefenseType defenseType, int level, const std::string& imageFile);
 
+    /**
+     * @brief 获取防御建筑指定等级的图片路径（无需实例，供资源预加载使用）
+     * @param defenseType 防御类型
+     * @param level 等级
+     * @return std::string 图片路径，未知类型返回空串
+     */
+    static std::string getImageFileFor(DefenseType defenseType, int level);
+
     /** @brief 获取建筑类型 */
     virtual BuildingType getBuildingType() const override { return BuildingType::kDefense; }
 
@@ -81,28 +86,20 @@ public:
     virtual std::string getImageForLevel(int level) const override;
 
     /**
-     * @brief 每帧更新
-     * @param dt 帧时间间隔
+     * @brief 按防御类型创建投射物精灵
+     * @return cocos2d::Sprite* 投射物精灵（autorelease）
+     * @note 战斗中的投射物由 BattleNodePool 复用，伤害由 BattleWorld 结算
      */
-    virtual void tick(float dt) override;
+    cocos2d::Sprite* createProjectileSprite();
 
-    /**
-     * @brief 检测敌方士兵并自动选择目标
-     * @param units 敌方单位列表
-     */
-    void detectEnemies(const std::vector<BaseUnit*>& units);
+    /** @brief 箭矢旋转朝向落点 */
+    void orientProjectile(cocos2d::Sprite* projectile, const cocos2d::Vec2& startPos, const cocos2d::Vec2& endPos);
 
-    /**
-     * @brief 攻击目标
-     * @param target 目标单位
-     */
-    virtual void attackTarget(BaseUnit* target) override;
+    /** @brief 获取投射物飞行速度（像素/秒） */
+    float getProjectileSpeed() const;
 
-    /**
-     * @brief 发射炮弹并造成伤害
-     * @param target 目标单位
-     */
-    void fireProjectile(BaseUnit* target);
+    /** @brief 获取溅射半径（像素，0 表示只伤害目标） */
+    float getSplashRadius() const;
 
     /** @brief 播放攻击动画 */
     void playAttackAnimation();
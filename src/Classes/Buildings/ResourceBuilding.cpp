@@ -7,6 +7,7 @@
  * License:       MIT License
  ****************************************************************/
 #include "ResourceBuilding.h"
+#include "BuildingHitpoints.h"
 #include "Managers/ResourceManager.h"
 #include "UI/ResourceCollectionUI.h"
 #include "Managers/BuildingCapacityManager.h"
@@ -31,10 +32,6 @@ static const int UPGRADE_COSTS[] = {0,     150,   300,    700,    1400,   3000,
                                     28000, 56000, 100000, 200000, 400000, 800000, 1500000, 3000000,
                                     6000000, 0};
 
-// 生命值数据表
-static const int PRODUCER_HP[] = {0, 400, 450, 500, 550, 600, 640, 680, 720, 780, 840, 900, 960, 1020, 1080, 1180};
-static const int STORAGE_HP[] = {0,    600,  700,  800,  900,  1000, 1200, 1300, 1400,
-                                 1600, 1800, 2100, 2400, 2700, 3000, 3400, 3800, 4200};
 ResourceBuilding::~ResourceBuilding()
 {
     // 析构时从管理器注销
@@ -82,7 +79,7 @@ bool ResourceBuilding::init(int level)
     _productionAccumulator = 0.0f;
     
     std::string imageFile = getImageFile();
-    if (!Sprite::initWithFile(imageFile))
+    if (!initSpriteWithImage(imageFile))
         return false;
         
     this->setAnchorPoint(Vec2(0.5f, 0.35f));
@@ -100,13 +97,11 @@ bool ResourceBuilding::init(int level)
     int hp = 400;
     if (isProducer())
     {
-        int idx = std::min(_level, (int)(sizeof(PRODUCER_HP) / sizeof(int) - 1));
-        hp = PRODUCER_HP[idx];
+        hp = BuildingHitpoints::getProducer(_level);
     }
     else if (isStorage())
     {
-        int idx = std::min(_level, (int)(sizeof(STORAGE_HP) / sizeof(int) - 1));
-        hp = STORAGE_HP[idx];
+        hp = BuildingHitpoints::getStorage(_level);
     }
     setMaxHitpoints(hp);
     initHealthBarUI();
@@ -162,9 +157,14 @@ std::string ResourceBuilding::getImageFile() const
 }
 
 std::string ResourceBuilding::getImageForLevel(int level) const
+{
+    return getImageFileFor(_buildingType, level);
+}
+
+std::string ResourceBuilding::getImageFileFor(ResourceBuildingType buildingType, int level)
 {
     // 根据建筑类型和等级返回对应的图片路径
-    switch (_buildingType)
+    switch (buildingType)
     {
     case ResourceBuildingType::kGoldMine:
         return "buildings/GoldMine/Gold_Mine" + std::to_string(level) + ".png";
@@ -346,10 +346,8 @@ int ResourceBuilding::collect()
 
 void ResourceBuilding::updateAppearance()
 {
-    auto texture = Director::getInstance()->getTextureCache()->addImage(getImageFile());
-    if (texture)
+    if (setSpriteImage(getImageFile()))
     {
-        this->setTexture(texture);
         this->setName(getDisplayName());
     }
 }
@@ -402,29 +400,18 @@ void ResourceBuilding::onLevelUp()
     std::string newImageFile = getImageForLevel(_level);
     if (!newImageFile.empty())
     {
-        auto textureCache = Director::getInstance()->getTextureCache();
-        auto texture = textureCache->addImage(newImageFile);
-        if (texture)
-        {
-            this->setTexture(texture);
-            this->setTextureRect(Rect(0, 0, texture->getContentSize().width, 
-                                            texture->getContentSize().height));
-        }
+        setSpriteImage(newImageFile);
     }
     
     // 更新生命值
     int hp = 400;
     if (isProducer())
     {
-        static const int PRODUCER_HP_TABLE[] = {0, 400, 450, 500, 550, 600, 640, 680, 720, 780, 840, 900, 960, 1020, 1080, 1180};
-        int idx = std::min(_level, (int)(sizeof(PRODUCER_HP_TABLE) / sizeof(int) - 1));
-        hp = PRODUCER_HP_TABLE[idx];
+        hp = BuildingHitpoints::getProducer(_level);
     }
     else if (isStorage())
     {
-        static const int STORAGE_HP_TABLE[] = {0, 600, 700, 800, 900, 1000, 1200, 1300, 1400, 1600, 1800, 2100, 2400, 2700, 3000, 3400, 3800, 4200};
-        int idx = std::min(_level, (int)(sizeof(STORAGE_HP_TABLE) / sizeof(int) - 1));
-        hp = STORAGE_HP_TABLE[idx];
+        hp = BuildingHitpoints::getStorage(_level);
     }
     setMaxHitpoints(hp);
 
@@ -40,6 +40,14 @@ public:
      */
     static ResourceBuilding* create(ResourceBuildingType buildingType, int level = 1);
 
+    /**
+     * @brief 获取资源建筑指定等级的图片路径（无需实例，供资源预加载使用）
+     * @param buildingType 资源建筑类型
+     * @param level 建筑等级
+     * @return std::string 图片路径
+     */
+    static std::string getImageFileFor(ResourceBuildingType buildingType, int level);
+
     virtual ~ResourceBuilding();
 
     /** @brief 获取建筑类型 */
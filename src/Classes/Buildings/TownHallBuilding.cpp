@@ -62,11 +62,8 @@ void TownHallBuilding::onLevelUp()
 
 void TownHallBuilding::updateAppearance()
 {
-    std::string imageFile = getImageFile();
-    auto texture = Director::getInstance()->getTextureCache()->addImage(imageFile);
-    if (texture)
+    if (setSpriteImage(getImageFile()))
     {
-        this->setTexture(texture);
         this->setName(getDisplayName());
     }
 }
@@ -0,0 +1,66 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     CollisionSnapshot.h
+ * File Function: 碰撞地图快照 - 供寻路线程读取的只读副本
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __COLLISION_SNAPSHOT_H__
+#define __COLLISION_SNAPSHOT_H__
+
+#include "GridBitset.h"
+
+#include <utility>
+
+/**
+ * @class CollisionSnapshot
+ * @brief 某一版本碰撞地图的不可变副本
+ *
+ * GridMap 是 cocos2d::Node，只能在主线程访问。寻路线程只读取快照，
+ * 快照创建后不再修改，可以通过 std::shared_ptr<const CollisionSnapshot> 在线程间共享。
+ */
+class CollisionSnapshot
+{
+public:
+    /**
+     * @brief 构造快照
+     * @param owner 来源地图的标识（只用于比较，不会被解引用）
+     * @param version 碰撞地图版本号
+     * @param blocked 碰撞位图，置位表示被占用
+     */
+    CollisionSnapshot(const void* owner, unsigned int version, GridBitset blocked)
+        : _owner(owner), _version(version), _blocked(std::move(blocked))
+    {}
+
+    /** @brief 检查指定网格是否被阻挡，超出范围视为阻挡 */
+    bool isBlocked(int x, int y) const
+    {
+        if (x < 0 || y < 0 || x >= _blocked.getWidth() || y >= _blocked.getHeight())
+            return true;
+        return _blocked.test(x, y);
+    }
+
+    /** @brief 获取网格宽度 */
+    int getGridWidth() const { return _blocked.getWidth(); }
+
+    /** @brief 获取网格高度 */
+    int getGridHeight() const { return _blocked.getHeight(); }
+
+    /** @brief 获取碰撞位图 */
+    const GridBitset& getBitset() const { return _blocked; }
+
+    /** @brief 获取碰撞地图版本号 */
+    unsigned int getVersion() const { return _version; }
+
+    /** @brief 获取来源地图标识 */
+    const void* getOwner() const { return _owner; }
+
+private:
+    const void*  _owner;   ///< 来源地图标识
+    unsigned int _version; ///< 碰撞地图版本号
+    GridBitset   _blocked; ///< 碰撞位图
+};
+
+#endif // __COLLISION_SNAPSHOT_H__
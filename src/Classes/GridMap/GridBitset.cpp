@@ -0,0 +1,222 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridBitset.cpp
+ * File Function: 按行打包的网格位图实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "GridBitset.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRID_BITSET_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GRID_BITSET_NEON 1
+#endif
+
+namespace
+{
+
+// 字内 [lo, hi) 位的掩码，0 <= lo < hi <= 64
+uint64_t rangeMask(int lo, int hi)
+{
+    uint64_t high = hi >= 64 ? ~uint64_t(0) : ((uint64_t(1) << hi) - 1);
+    return high & ~((uint64_t(1) << lo) - 1);
+}
+
+int popcount64(uint64_t v)
+{
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((v * 0x0101010101010101ULL) >> 56);
+}
+
+// dst[i] |= src[i]
+void orWords(uint64_t* dst, const uint64_t* src, int n)
+{
+    int i = 0;
+#if defined(GRID_BITSET_SSE2)
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(a, b));
+    }
+#elif defined(GRID_BITSET_NEON)
+    for (; i + 2 <= n; i += 2)
+    {
+        vst1q_u64(dst + i, vorrq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        dst[i] |= src[i];
+    }
+}
+
+// 任意一个字非零
+bool anyWords(const uint64_t* words, int n)
+{
+    int i = 0;
+#if defined(GRID_BITSET_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 2 <= n; i += 2)
+    {
+        acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i)));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF)
+        return true;
+#elif defined(GRID_BITSET_NEON)
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 2 <= n; i += 2)
+    {
+        acc = vorrq_u64(acc, vld1q_u64(words + i));
+    }
+    if ((vgetq_lane_u64(acc, 0) | vgetq_lane_u64(acc, 1)) != 0)
+        return true;
+#endif
+    for (; i < n; ++i)
+    {
+        if (words[i])
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void GridBitset::reset(int width, int height)
+{
+    _width       = std::max(0, width);
+    _height      = std::max(0, height);
+    _wordsPerRow = (_height + 63) / 64;
+    _words.assign(static_cast<size_t>(_width * _wordsPerRow), 0);
+}
+
+void GridBitset::clear()
+{
+    std::fill(_words.begin(), _words.end(), 0);
+}
+
+void GridBitset::fillRect(int x, int y, int w, int h, bool value)
+{
+    int x0 = std::max(0, x);
+    int y0 = std::max(0, y);
+    int x1 = std::min(_width, x + w);
+    int y1 = std::min(_height, y + h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    int firstWord = y0 >> 6;
+    int lastWord  = (y1 - 1) >> 6;
+
+    for (int row = x0; row < x1; ++row)
+    {
+        uint64_t* words = &_words[row * _wordsPerRow];
+        for (int wi = firstWord; wi <= lastWord; ++wi)
+        {
+            int      lo   = wi == firstWord ? (y0 & 63) : 0;
+            int      hi   = wi == lastWord ? ((y1 - 1) & 63) + 1 : 64;
+            uint64_t mask = rangeMask(lo, hi);
+            words[wi]     = value ? (words[wi] | mask) : (words[wi] & ~mask);
+        }
+    }
+}
+
+bool GridBitset::anyInRect(int x, int y, int w, int h) const
+{
+    int x0 = std::max(0, x);
+    int y0 = std::max(0, y);
+    int x1 = std::min(_width, x + w);
+    int y1 = std::min(_height, y + h);
+    if (x0 >= x1 || y0 >= y1)
+        return false;
+
+    int firstWord = y0 >> 6;
+    int lastWord  = (y1 - 1) >> 6;
+
+    // 常见情况：矩形在 Y 方向落在同一个字内，每行只需一次与运算
+    if (firstWord == lastWord)
+    {
+        uint64_t        mask  = rangeMask(y0 & 63, ((y1 - 1) & 63) + 1);
+        const uint64_t* words = &_words[x0 * _wordsPerRow + firstWord];
+        uint64_t        acc   = 0;
+        for (int row = x0; row < x1; ++row, words += _wordsPerRow)
+        {
+            acc |= *words;
+        }
+        return (acc & mask) != 0;
+    }
+
+    uint64_t firstMask = rangeMask(y0 & 63, 64);
+    uint64_t lastMask  = rangeMask(0, ((y1 - 1) & 63) + 1);
+    for (int row = x0; row < x1; ++row)
+    {
+        const uint64_t* words = &_words[row * _wordsPerRow];
+        if ((words[firstWord] & firstMask) || (words[lastWord] & lastMask))
+            return true;
+        if (anyWords(words + firstWord + 1, lastWord - firstWord - 1))
+            return true;
+    }
+    return false;
+}
+
+void GridBitset::dilate(int radius, GridBitset& out) const
+{
+    out.reset(_width, _height);
+    if (_words.empty())
+        return;
+    if (radius <= 0)
+    {
+        out._words = _words;
+        return;
+    }
+
+    // 1. Y 方向：每行反复与左右各移一位的自身按位或，共 radius 次
+    std::vector<uint64_t> spread(_words);
+    std::vector<uint64_t> rowCopy(static_cast<size_t>(_wordsPerRow));
+    uint64_t              tailMask = rangeMask(0, ((_height - 1) & 63) + 1);
+
+    for (int row = 0; row < _width; ++row)
+    {
+        uint64_t* words = &spread[row * _wordsPerRow];
+        for (int step = 0; step < radius; ++step)
+        {
+            std::copy(words, words + _wordsPerRow, rowCopy.begin());
+            for (int wi = 0; wi < _wordsPerRow; ++wi)
+            {
+                uint64_t up   = (rowCopy[wi] << 1) | (wi > 0 ? rowCopy[wi - 1] >> 63 : 0);
+                uint64_t down = (rowCopy[wi] >> 1) | (wi + 1 < _wordsPerRow ? rowCopy[wi + 1] << 63 : 0);
+                words[wi]     = rowCopy[wi] | up | down;
+            }
+            words[_wordsPerRow - 1] &= tailMask;
+        }
+    }
+
+    // 2. X 方向：整行按位或相邻 radius 行
+    for (int row = 0; row < _width; ++row)
+    {
+        uint64_t* dst  = &out._words[row * _wordsPerRow];
+        int       from = std::max(0, row - radius);
+        int       to   = std::min(_width - 1, row + radius);
+        for (int src = from; src <= to; ++src)
+        {
+            orWords(dst, &spread[src * _wordsPerRow], _wordsPerRow);
+        }
+    }
+}
+
+int GridBitset::count() const
+{
+    int total = 0;
+    for (uint64_t word : _words)
+    {
+        total += popcount64(word);
+    }
+    return total;
+}
@@ -0,0 +1,93 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridBitset.h
+ * File Function: 按行打包的网格位图 - 碰撞地图和部署禁区使用
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __GRID_BITSET_H__
+#define __GRID_BITSET_H__
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class GridBitset
+ * @brief 按行打包的二维位图
+ *
+ * 第 x 行存放 (x, 0) ~ (x, height-1)，每行占 ceil(height / 64) 个 64 位字，
+ * 与原先 std::vector<std::vector<bool>> 的 [x][y] 下标含义一致。
+ * 矩形填充、矩形检测按字整体处理；整行的按位或（膨胀）使用 SSE2 / NEON。
+ */
+class GridBitset
+{
+public:
+    GridBitset() = default;
+    GridBitset(int width, int height) { reset(width, height); }
+
+    /**
+     * @brief 重新设置尺寸并清零
+     * @param width 行数（网格 X 方向）
+     * @param height 每行的位数（网格 Y 方向）
+     */
+    void reset(int width, int height);
+
+    /** @brief 全部清零 */
+    void clear();
+
+    /** @brief 读取一个格子，超出范围返回 false */
+    bool test(int x, int y) const
+    {
+        if (x < 0 || y < 0 || x >= _width || y >= _height)
+            return false;
+        return (_words[x * _wordsPerRow + (y >> 6)] >> (y & 63)) & 1u;
+    }
+
+    /** @brief 设置一个格子，超出范围忽略 */
+    void set(int x, int y, bool value)
+    {
+        if (x < 0 || y < 0 || x >= _width || y >= _height)
+            return;
+        uint64_t& word = _words[x * _wordsPerRow + (y >> 6)];
+        uint64_t  bit  = uint64_t(1) << (y & 63);
+        word           = value ? (word | bit) : (word & ~bit);
+    }
+
+    /**
+     * @brief 填充矩形区域（自动裁剪到位图范围内）
+     * @param x 起始 X
+     * @param y 起始 Y
+     * @param w X 方向格子数
+     * @param h Y 方向格子数
+     * @param value 填充值
+     */
+    void fillRect(int x, int y, int w, int h, bool value);
+
+    /**
+     * @brief 矩形区域内是否有被置位的格子（超出范围的部分忽略）
+     */
+    bool anyInRect(int x, int y, int w, int h) const;
+
+    /**
+     * @brief 切比雪夫距离膨胀：距离任一置位格子不超过 radius 的格子全部置位
+     * @param radius 膨胀半径（格子）
+     * @param out 输出位图（可以是自身以外的任意位图，会被重置为相同尺寸）
+     */
+    void dilate(int radius, GridBitset& out) const;
+
+    /** @brief 置位格子总数 */
+    int count() const;
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+private:
+    int                   _width       = 0; ///< 行数
+    int                   _height      = 0; ///< 每行位数
+    int                   _wordsPerRow = 0; ///< 每行字数
+    std::vector<uint64_t> _words;           ///< 位数据，行优先
+};
+
+#endif // __GRID_BITSET_H__
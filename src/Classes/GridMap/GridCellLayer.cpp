@@ -0,0 +1,159 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridCellLayer.cpp
+ * File Function: 网格单元着色层实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "GridCellLayer.h"
+
+#include "GridMap.h"
+#include "Managers/FrameProfiler.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+GridCellLayer* GridCellLayer::create(GridMap* gridMap)
+{
+    GridCellLayer* ret = new (std::nothrow) GridCellLayer();
+    if (ret && ret->init(gridMap))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+GridCellLayer::~GridCellLayer()
+{
+    CC_SAFE_RELEASE(_gridMap);
+}
+
+bool GridCellLayer::init(GridMap* gridMap)
+{
+    if (!Node::init() || !gridMap)
+        return false;
+
+    _gridMap = gridMap;
+    _gridMap->retain();
+    _width  = gridMap->getGridWidth();
+    _height = gridMap->getGridHeight();
+    if (_width <= 0 || _height <= 0)
+        return false;
+
+    _pixels.assign(static_cast<size_t>(_width) * _height * 4, 0);
+
+    auto* texture = new (std::nothrow) Texture2D();
+    if (!texture || !texture->initWithData(_pixels.data(), static_cast<ssize_t>(_pixels.size()),
+                                           backend::PixelFormat::RGBA8888, _width, _height,
+                                           Size(static_cast<float>(_width), static_cast<float>(_height)), true))
+    {
+        CC_SAFE_RELEASE(texture);
+        return false;
+    }
+    // 最近邻采样：每个像素边缘清晰，正好是一个菱形格子
+    texture->setAliasTexParameters();
+
+    _sprite = Sprite::createWithTexture(texture);
+    texture->release();
+    if (!_sprite)
+        return false;
+
+    _texture = texture;
+    _sprite->setAnchorPoint(Vec2::ZERO);
+    _sprite->setPosition(Vec2::ZERO);
+    this->addChild(_sprite);
+
+    updateTransform();
+    return true;
+}
+
+void GridCellLayer::updateTransform()
+{
+    // 精灵本地坐标 (sx, sy) -> 连续网格坐标 (u, v)：u 沿纹理列，v 自下而上（纹理第 0 行在顶部）
+    Size  contentSize = _sprite->getContentSize();
+    float unitX       = contentSize.width > 0.0f ? _width / contentSize.width : 1.0f;
+    float unitY       = contentSize.height > 0.0f ? _height / contentSize.height : 1.0f;
+
+    float halfW = _gridMap->getTileSize() / 2.0f;
+    float halfH = halfW * 0.75f;
+    Vec2  start = _gridMap->getStartPixel();
+
+    // 格子 (x, y) 的中心 (u, v) = (x + 0.5, H - y - 0.5) 映射到 getPositionFromGrid(x, y)：
+    //   X = start.x + halfW * (u + v - H)
+    //   Y = start.y - halfH * (u - v + H - 1)
+    float height = static_cast<float>(_height);
+    _sprite->setAdditionalTransform(AffineTransformMake(halfW * unitX, -halfH * unitX,
+                                                        halfW * unitY, halfH * unitY,
+                                                        start.x - halfW * height,
+                                                        start.y - halfH * (height - 1.0f)));
+
+    _appliedStartPixel = start;
+    _transformValid    = true;
+}
+
+void GridCellLayer::setCell(int x, int y, const Color4F& color)
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+        return;
+
+    // 纹理按预乘 alpha 创建
+    float a = std::max(0.0f, std::min(1.0f, color.a));
+    uint8_t rgba[4] = {static_cast<uint8_t>(color.r * a * 255.0f + 0.5f),
+                       static_cast<uint8_t>(color.g * a * 255.0f + 0.5f),
+                       static_cast<uint8_t>(color.b * a * 255.0f + 0.5f),
+                       static_cast<uint8_t>(a * 255.0f + 0.5f)};
+
+    uint8_t* pixel = &_pixels[(static_cast<size_t>(y) * _width + x) * 4];
+    if (std::equal(rgba, rgba + 4, pixel))
+        return;
+
+    std::copy(rgba, rgba + 4, pixel);
+    if (_dirtyMaxRow < _dirtyMinRow)
+    {
+        _dirtyMinRow = y;
+        _dirtyMaxRow = y;
+    }
+    else
+    {
+        _dirtyMinRow = std::min(_dirtyMinRow, y);
+        _dirtyMaxRow = std::max(_dirtyMaxRow, y);
+    }
+}
+
+void GridCellLayer::clearCells()
+{
+    std::fill(_pixels.begin(), _pixels.end(), 0);
+    _dirtyMinRow = 0;
+    _dirtyMaxRow = _height - 1;
+}
+
+void GridCellLayer::flush()
+{
+    if (_dirtyMaxRow < _dirtyMinRow || !_texture)
+        return;
+
+    PROFILE_SCOPE("GridCellLayer::flush");
+
+    // 脏行在内存中是连续的，一次上传
+    int rows = _dirtyMaxRow - _dirtyMinRow + 1;
+    _texture->updateWithData(&_pixels[static_cast<size_t>(_dirtyMinRow) * _width * 4], 0, _dirtyMinRow, _width, rows);
+
+    _dirtyMinRow = 0;
+    _dirtyMaxRow = -1;
+}
+
+void GridCellLayer::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (_visible && _sprite)
+    {
+        if (!_transformValid || !_appliedStartPixel.equals(_gridMap->getStartPixel()))
+            updateTransform();
+        flush();
+    }
+
+    Node::visit(renderer, parentTransform, parentFlags);
+}
@@ -0,0 +1,93 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridCellLayer.h
+ * File Function: 网格单元着色层 - 每个网格对应纹理的一个像素，整张地图一个四边形绘制，只上传变化的行
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __GRID_CELL_LAYER_H__
+#define __GRID_CELL_LAYER_H__
+
+#include "cocos2d.h"
+
+#include <cstdint>
+#include <vector>
+
+class GridMap;
+
+/**
+ * @class GridCellLayer
+ * @brief 按网格着色的覆盖层
+ *
+ * 网格 (x, y) 对应纹理第 y 行第 x 列的像素。等距投影是仿射变换，
+ * 把 gridWidth x gridHeight 的纹理经一次仿射变换（最近邻采样）画成整张菱形网格，
+ * 每个像素恰好覆盖一个菱形格子（与 getPositionFromGrid 相同的 0.75 高宽比）。
+ *
+ * 修改格子只改内存中的像素并记录脏行，下一次绘制前只上传脏行；
+ * 没有修改时不产生任何顶点或纹理上传。
+ */
+class GridCellLayer : public cocos2d::Node
+{
+public:
+    /**
+     * @brief 创建着色层
+     * @param gridMap 网格地图（坐标系与本层的父节点一致）
+     * @return GridCellLayer* 着色层指针
+     */
+    static GridCellLayer* create(GridMap* gridMap);
+
+    virtual ~GridCellLayer();
+
+    /**
+     * @brief 初始化
+     * @param gridMap 网格地图
+     * @return bool 是否成功
+     */
+    virtual bool init(GridMap* gridMap);
+
+    /**
+     * @brief 绘制前上传脏行，并在网格原点变化时更新变换
+     */
+    virtual void visit(cocos2d::Renderer* renderer, const cocos2d::Mat4& parentTransform,
+                       uint32_t parentFlags) override;
+
+    /**
+     * @brief 设置一个格子的颜色，超出范围忽略
+     * @param x 网格X坐标
+     * @param y 网格Y坐标
+     * @param color 颜色（非预乘），透明表示不着色
+     */
+    void setCell(int x, int y, const cocos2d::Color4F& color);
+
+    /** @brief 清除所有格子 */
+    void clearCells();
+
+    /** @brief 着色精灵（用于淡入淡出） */
+    cocos2d::Sprite* getSprite() const { return _sprite; }
+
+private:
+    GridCellLayer() = default;
+
+    /** @brief 根据网格原点和格子尺寸设置仿射变换 */
+    void updateTransform();
+
+    /** @brief 把脏行上传到纹理 */
+    void flush();
+
+    GridMap*            _gridMap = nullptr; ///< 网格地图（持有引用）
+    cocos2d::Sprite*    _sprite  = nullptr; ///< 显示纹理的精灵
+    cocos2d::Texture2D* _texture = nullptr; ///< 每格一个像素的纹理（由精灵持有）
+
+    int                  _width       = 0;  ///< 纹理宽度（网格X方向）
+    int                  _height      = 0;  ///< 纹理高度（网格Y方向）
+    std::vector<uint8_t> _pixels;           ///< RGBA8888，预乘 alpha
+    int                  _dirtyMinRow = 0;  ///< 脏行起点
+    int                  _dirtyMaxRow = -1; ///< 脏行终点（含），小于起点表示没有脏行
+
+    cocos2d::Vec2 _appliedStartPixel;      ///< 当前变换对应的网格原点
+    bool          _transformValid = false; ///< 变换是否已设置
+};
+
+#endif // __GRID_CELL_LAYER_H__
@@ -8,6 +8,12 @@
  ****************************************************************/
 #include "GridMap.h"
 
+#include "Managers/FrameProfiler.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
 USING_NS_CC;
 
 GridMap* GridMap::create(const Size& mapSize, float tileSize)
@@ -30,8 +36,13 @@ bool GridMap::init(const Size& mapSize, float tileSize)
     _tileSize = tileSize;
 
     _gridNode = DrawNode::create();
+    _gridNode->setVisible(false);
     this->addChild(_gridNode, 1);
 
+    _bigGridNode = DrawNode::create();
+    _bigGridNode->setVisible(false);
+    this->addChild(_bigGridNode, 1);
+
     _baseNode = DrawNode::create();
     this->addChild(_baseNode, 2);
 
@@ -43,11 +54,15 @@ bool GridMap::init(const Size& mapSize, float tileSize)
     _gridWidth = static_cast<int>(round(mapSize.width / tileSize)) - 1;
     _gridHeight = _gridWidth;
 
-    _collisionMap.resize(_gridWidth, std::vector<bool>(_gridHeight, false));
+    _collisionMap.reset(_gridWidth, _gridHeight);
 
     _startPixel = Vec2(_mapSize.width / 2.0f, _mapSize.height + 30.0f - _tileSize * 0.5f);
     _gridVisible = false;
     _deployOverlayVisible = false;
+    _bigGridStep = 0;
+
+    // 网格几何在下一帧生成（此时原点通常已由 setStartCorner 确定），进入建造模式时不再生成
+    invalidateGridMesh();
 
     return true;
 }
@@ -63,7 +78,7 @@ Vec2 GridMap::getPositionFromGrid(Vec2 gridPos)
     return Vec2(x, y);
 }
 
-Vec2 GridMap::getGridPosition(Vec2 worldPosition)
+Vec2 GridMap::getGridPositionExact(Vec2 worldPosition)
 {
     Vec2 localPos = this->convertToNodeSpace(worldPosition);
 
@@ -76,8 +91,15 @@ Vec2 GridMap::getGridPosition(Vec2 worldPosition)
     float x = (dy / halfH + dx / halfW) / 2.0f;
     float y = (dy / halfH - dx / halfW) / 2.0f;
 
-    int gridX = static_cast<int>(round(x));
-    int gridY = static_cast<int>(round(y));
+    return Vec2(x, y);
+}
+
+Vec2 GridMap::getGridPosition(Vec2 worldPosition)
+{
+    Vec2 exact = getGridPositionExact(worldPosition);
+
+    int gridX = static_cast<int>(round(exact.x));
+    int gridY = static_cast<int>(round(exact.y));
 
     gridX = MAX(0, MIN(_gridWidth - 1, gridX));
     gridY = MAX(0, MIN(_gridHeight - 1, gridY));
@@ -87,8 +109,12 @@ Vec2 GridMap::getGridPosition(Vec2 worldPosition)
 
 void GridMap::showWholeGrid(bool visible, const cocos2d::Size& currentBuildingSize)
 {
+    // 进入建造/移动模式的耗时（网格已缓存时只切换可见性）
+    PROFILE_SCOPE("GridMap::showWholeGrid");
+
     _gridVisible = visible;
-    _gridNode->clear();
+    _gridNode->setVisible(visible);
+    _bigGridNode->setVisible(visible);
     if (!visible)
         return;
 
@@ -99,22 +125,40 @@ void GridMap::showWholeGrid(bool visible, const cocos2d::Size& currentBuildingSi
         bigGridStep = static_cast<int>(currentBuildingSize.width);
     }
 
-    // 定义网格颜色：小网格填充、小网格边线、大网格边线
+    // 小网格通常已在进入建造模式之前生成；几何刚变化且还没来得及重建时在这里补上
+    if (_gridMeshDirty)
+        buildGridMesh();
+    if (bigGridStep != _bigGridStep)
+        buildBigGridMesh(bigGridStep);
+}
+
+void GridMap::invalidateGridMesh()
+{
+    _gridMeshDirty = true;
+    this->scheduleOnce([this](float) {
+        if (_gridMeshDirty)
+            buildGridMesh();
+    }, 0.0f, "build_grid_mesh");
+}
+
+void GridMap::buildGridMesh()
+{
+    PROFILE_SCOPE("GridMap::buildGridMesh");
+
+    _gridNode->clear();
+
+    // 定义网格颜色：小网格填充、小网格边线
     Color4F smallGridColor = Color4F(1.0f, 1.0f, 1.0f, 0.03f);
     Color4F smallGridLineColor = Color4F(1.0f, 1.0f, 1.0f, 0.15f);
-    Color4F bigGridLineColor = Color4F(1.0f, 1.0f, 1.0f, 0.35f);
 
     // 计算菱形网格的半宽和半高（0.79是isometric视角的比例系数）
     float halfW = _tileSize / 2.0f;
     float halfH = halfW * 0.79f;
 
-    int maxX = _gridWidth;
-    int maxY = _gridHeight;
-
-    // 第一步：绘制所有小网格
-    for (int x = 0; x < maxX; x++)
+    // 所有小网格只生成一次，DrawNode 保留顶点缓冲，之后显示/隐藏不再重新生成
+    for (int x = 0; x < _gridWidth; x++)
     {
-        for (int y = 0; y < maxY; y++)
+        for (int y = 0; y < _gridHeight; y++)
         {
             Vec2 center = getPositionFromGrid(Vec2(static_cast<float>(x), static_cast<float>(y)));
 
@@ -131,7 +175,29 @@ void GridMap::showWholeGrid(bool visible, const cocos2d::Size& currentBuildingSi
         }
     }
 
-    // 第二步：绘制大网格边框（用于标识建筑占用区域）
+    _gridMeshDirty = false;
+
+    // 大网格依赖同一原点，下次显示时按当前步长重建
+    _bigGridNode->clear();
+    _bigGridStep = 0;
+}
+
+void GridMap::buildBigGridMesh(int bigGridStep)
+{
+    _bigGridNode->clear();
+    _bigGridStep = bigGridStep;
+    if (bigGridStep <= 0)
+        return;
+
+    Color4F bigGridLineColor = Color4F(1.0f, 1.0f, 1.0f, 0.35f);
+
+    float halfW = _tileSize / 2.0f;
+    float halfH = halfW * 0.79f;
+
+    int maxX = _gridWidth;
+    int maxY = _gridHeight;
+
+    // 绘制大网格边框（用于标识建筑占用区域）
     for (int x = 0; x < maxX; x += bigGridStep)
     {
         for (int y = 0; y < maxY; y += bigGridStep)
@@ -156,7 +222,7 @@ void GridMap::showWholeGrid(bool visible, const cocos2d::Size& currentBuildingSi
             p[2] = Vec2(bottomGridCenter.x, bottomGridCenter.y - halfH);
             p[3] = Vec2(leftGridCenter.x - halfW, leftGridCenter.y);
 
-            _gridNode->drawPoly(p, 4, true, bigGridLineColor);
+            _bigGridNode->drawPoly(p, 4, true, bigGridLineColor);
         }
     }
 }
@@ -305,30 +371,8 @@ bool GridMap::canDeployAt(int gridX, int gridY) const
         return false;
     }
 
-    // 检查周围3x3区域（包括自身和周围一圈）是否有被占用的网格
-    for (int dx = -1; dx <= 1; ++dx)
-    {
-        for (int dy = -1; dy <= 1; ++dy)
-        {
-            int checkX = gridX + dx;
-            int checkY = gridY + dy;
-
-            // 边界检查
-            if (checkX < 0 || checkX >= _gridWidth ||
-                checkY < 0 || checkY >= _gridHeight)
-            {
-                continue;
-            }
-
-            // 如果该网格被建筑占用，则不能在此位置部署
-            if (_collisionMap[checkX][checkY])
-            {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    // 检查周围3x3区域（包括自身和周围一圈）是否有被占用的网格，超出地图的部分忽略
+    return !_collisionMap.anyInRect(gridX - 1, gridY - 1, 3, 3);
 }
 
 void GridMap::updateBuildingBase(Vec2 gridPos, Size size, bool isValid)
@@ -389,26 +433,20 @@ bool GridMap::checkArea(Vec2 startGridPos, Size size)
         return false;
     }
 
-    for (int x = startX; x < startX + w; x++)
-    {
-        for (int y = startY; y < startY + h; y++)
-        {
-            if (_collisionMap[x][y])
-            {
-                return false;
-            }
-        }
-    }
-    return true;
+    return !_collisionMap.anyInRect(startX, startY, w, h);
 }
 
 
 
 void GridMap::setStartPixel(const Vec2& pixel)
 {
+    if (pixel.equals(_startPixel))
+        return;
+
     _startPixel = pixel;
+    invalidateGridMesh();
     if (_gridVisible)
-        showWholeGrid(true);
+        showWholeGrid(true, Size(static_cast<float>(_bigGridStep), static_cast<float>(_bigGridStep)));
 }
 
 Vec2 GridMap::getStartPixel() const
@@ -444,11 +482,95 @@ void GridMap::setStartCorner(GridMap::Corner corner)
     setStartPixel(p);
 }
 
+std::shared_ptr<const CollisionSnapshot> GridMap::getCollisionSnapshot() const
+{
+    if (_snapshot && _snapshot->getVersion() == _collisionVersion)
+        return _snapshot;
+
+    _snapshot = std::make_shared<const CollisionSnapshot>(this, _collisionVersion, _collisionMap);
+    return _snapshot;
+}
+
+void GridMap::restoreCollision(const std::shared_ptr<const CollisionSnapshot>& snapshot)
+{
+    if (!snapshot || snapshot->getOwner() != this)
+        return;
+
+    _collisionMap     = snapshot->getBitset();
+    _collisionVersion = snapshot->getVersion();
+    _snapshot         = snapshot;
+
+    if (_onAreaChanged)
+        _onAreaChanged(0, 0, _gridWidth, _gridHeight);
+}
+
 bool GridMap::isBlocked(int x, int y) const
 {
     if (x < 0 || y < 0 || x >= _gridWidth || y >= _gridHeight)
         return true;
-    return _collisionMap[x][y];
+    return _collisionMap.test(x, y);
+}
+
+bool GridMap::hasLineOfSight(const Vec2& startWorld, const Vec2& endWorld)
+{
+    // 网格中心为整数坐标，+0.5 后向下取整即为所在格子
+    Vec2 from = getGridPositionExact(startWorld) + Vec2(0.5f, 0.5f);
+    Vec2 to   = getGridPositionExact(endWorld) + Vec2(0.5f, 0.5f);
+
+    int cellX = static_cast<int>(std::floor(from.x));
+    int cellY = static_cast<int>(std::floor(from.y));
+    int endX  = static_cast<int>(std::floor(to.x));
+    int endY  = static_cast<int>(std::floor(to.y));
+
+    float dirX  = to.x - from.x;
+    float dirY  = to.y - from.y;
+    int   stepX = dirX > 0.0f ? 1 : (dirX < 0.0f ? -1 : 0);
+    int   stepY = dirY > 0.0f ? 1 : (dirY < 0.0f ? -1 : 0);
+
+    // tMax：沿连线走到下一条竖/横格线的参数；tDelta：跨过一整格的参数增量
+    const float kInfinity = std::numeric_limits<float>::infinity();
+    float       tDeltaX   = stepX != 0 ? 1.0f / std::fabs(dirX) : kInfinity;
+    float       tDeltaY   = stepY != 0 ? 1.0f / std::fabs(dirY) : kInfinity;
+    float       tMaxX     = kInfinity;
+    float       tMaxY     = kInfinity;
+    if (stepX != 0)
+        tMaxX = (stepX > 0 ? cellX + 1 - from.x : from.x - cellX) * tDeltaX;
+    if (stepY != 0)
+        tMaxY = (stepY > 0 ? cellY + 1 - from.y : from.y - cellY) * tDeltaY;
+
+    // 起点所在格不检查（单位可能贴着建筑边缘站立）；超出地图的格子与 isBlocked 一致视为阻挡
+    const float kCornerEpsilon = 1e-6f;
+    int         remaining      = std::abs(endX - cellX) + std::abs(endY - cellY);
+    while (remaining > 0)
+    {
+        if (remaining >= 2 && stepX != 0 && stepY != 0 && std::fabs(tMaxX - tMaxY) <= kCornerEpsilon)
+        {
+            // 连线恰好穿过格点：两侧的格子都会被擦到，任一被挡即视线不通，然后斜跨一步
+            if (isBlocked(cellX + stepX, cellY) || isBlocked(cellX, cellY + stepY))
+                return false;
+            cellX += stepX;
+            cellY += stepY;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+            remaining -= 2;
+        }
+        else if (tMaxX < tMaxY)
+        {
+            cellX += stepX;
+            tMaxX += tDeltaX;
+            --remaining;
+        }
+        else
+        {
+            cellY += stepY;
+            tMaxY += tDeltaY;
+            --remaining;
+        }
+
+        if (isBlocked(cellX, cellY))
+            return false;
+    }
+    return true;
 }
 
 void GridMap::markArea(cocos2d::Vec2 startGridPos, cocos2d::Size size, bool occupied)
@@ -458,17 +580,12 @@ void GridMap::markArea(cocos2d::Vec2 startGridPos, cocos2d::Size size, bool occu
     int w = static_cast<int>(size.width);
     int h = static_cast<int>(size.height);
 
-    // 遍历建筑覆盖的每一个格子
-    for (int x = startX; x < startX + w; x++)
-    {
-        for (int y = startY; y < startY + h; y++)
-        {
-            // 边界检查，防止数组越界
-            if (x >= 0 && x < _gridWidth && y >= 0 && y < _gridHeight)
-            {
-                // _collisionMap 是你在 GridMap 中存储 true/false 的二维数组
-                _collisionMap[x][y] = occupied;
-            }
-        }
-    }
+    // 碰撞地图发生变化，递增版本号使寻路缓存失效
+    ++_collisionVersion;
+
+    // 按字整体填充建筑覆盖的格子，超出地图的部分自动裁剪
+    _collisionMap.fillRect(startX, startY, w, h, occupied);
+
+    if (_onAreaChanged)
+        _onAreaChanged(startX, startY, w, h);
 }
\ No newline at end of file
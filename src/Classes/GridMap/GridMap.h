@@ -8,7 +8,11 @@
  ****************************************************************/
 #pragma once
 
+#include "CollisionSnapshot.h"
+#include "GridBitset.h"
 #include "cocos2d.h"
+#include <functional>
+#include <memory>
 #include <vector>
 
 /**
@@ -27,17 +31,36 @@ class GridMap : public cocos2d::Node
 private:
     cocos2d::Size _mapSize;                          ///< 地图的像素尺寸
     float _tileSize;                                  ///< 单个网格的宽度（像素）
-    cocos2d::DrawNode* _gridNode;                     ///< 用于绘制网格线的节点
+    cocos2d::DrawNode* _gridNode;                     ///< 小网格网格线（缓存，几何变化时才重建）
+    cocos2d::DrawNode* _bigGridNode;                  ///< 大网格边框（缓存，步长变化时才重建）
     cocos2d::DrawNode* _baseNode;                     ///< 用于绘制建筑底座预览的节点
     cocos2d::DrawNode* _deployOverlayNode;            ///< 用于绘制部署区域覆盖层的节点
 
-    std::vector<std::vector<bool>> _collisionMap;     ///< 碰撞地图，true表示该网格被占用
+    GridBitset _collisionMap;                         ///< 碰撞地图，置位表示该网格被占用
+    unsigned int _collisionVersion = 0;               ///< 碰撞地图版本号，每次 markArea 递增
+    mutable std::shared_ptr<const CollisionSnapshot> _snapshot; ///< 最近一次生成的碰撞快照
     int _gridWidth;                                   ///< 网格宽度（网格单位）
     int _gridHeight;                                  ///< 网格高度（网格单位）
 
     cocos2d::Vec2 _startPixel;                        ///< 网格(0,0)对应的像素坐标
     bool _gridVisible;                                ///< 网格是否可见
     bool _deployOverlayVisible;                       ///< 部署覆盖层是否可见
+    bool _gridMeshDirty;                              ///< 小网格缓存是否需要重建
+    int _bigGridStep;                                 ///< 大网格缓存对应的步长，0 表示未生成
+
+    std::function<void(int, int, int, int)> _onAreaChanged; ///< markArea 变化回调
+
+    /** @brief 标记网格缓存失效，下一帧重建（同一帧内多次失效只重建一次） */
+    void invalidateGridMesh();
+
+    /** @brief 重建小网格缓存 */
+    void buildGridMesh();
+
+    /**
+     * @brief 重建大网格缓存
+     * @param bigGridStep 大网格步长
+     */
+    void buildBigGridMesh(int bigGridStep);
 
 public:
     /**
@@ -58,6 +81,13 @@ public:
      * @param occupied true=不可通行(有建筑), false=可通行(建筑被移除)
      */
     void markArea(cocos2d::Vec2 startGridPos, cocos2d::Size size, bool occupied);
+
+    /**
+     * @brief 设置占用变化回调，每次 markArea 后以裁剪前的矩形 (x, y, w, h) 调用
+     * @param callback 回调，传空函数取消
+     * @note 覆盖层据此只更新变化的格子，不需要遍历全部建筑
+     */
+    void setOnAreaChanged(const std::function<void(int, int, int, int)>& callback) { _onAreaChanged = callback; }
     /**
      * @brief 创建GridMap实例
      * @param mapSize 地图的像素尺寸
@@ -98,6 +128,13 @@ public:
      * @return 对应的网格坐标（已限制在有效范围内）
      */
     cocos2d::Vec2 getGridPosition(cocos2d::Vec2 worldPosition);
+
+    /**
+     * @brief 将世界坐标转换为连续的网格坐标
+     * @param worldPosition 世界坐标
+     * @return 未取整、未限制范围的网格坐标，网格中心为整数
+     */
+    cocos2d::Vec2 getGridPositionExact(cocos2d::Vec2 worldPosition);
     
     /**
      * @brief 将网格坐标转换为世界坐标
@@ -131,6 +168,7 @@ public:
      * @brief 显示或隐藏整个网格
      * @param visible 是否显示
      * @param currentBuildingSize 当前建筑尺寸，用于绘制大网格分组（默认为ZERO）
+     * @note 网格几何已预先缓存，这里只切换可见性；大网格只在步长变化时重建
      */
     void showWholeGrid(bool visible, const cocos2d::Size& currentBuildingSize = cocos2d::Size::ZERO);
     
@@ -191,4 +229,39 @@ public:
      * @return 被阻挡或超出范围返回true，否则返回false
      */
     bool isBlocked(int x, int y) const;
+
+    /**
+     * @brief 检查两点之间的连线是否穿过被占用的网格
+     * @param startWorld 起点坐标（与 getGridPosition 使用同一坐标系）
+     * @param endWorld 终点坐标
+     * @return 沿途（不含起点所在格）没有被占用的网格返回true
+     * @note 按格子逐一遍历（DDA），不会像固定步长采样那样漏掉只被擦过一角的格子
+     */
+    bool hasLineOfSight(const cocos2d::Vec2& startWorld, const cocos2d::Vec2& endWorld);
+
+    /**
+     * @brief 获取碰撞位图
+     * @return 碰撞位图的只读引用
+     */
+    const GridBitset& getCollisionBitset() const { return _collisionMap; }
+
+    /**
+     * @brief 获取碰撞地图版本号
+     * @return 版本号，每次 markArea 后递增，用于使寻路缓存失效
+     */
+    inline unsigned int getCollisionVersion() const { return _collisionVersion; }
+
+    /**
+     * @brief 获取当前碰撞地图的只读快照
+     * @return 快照指针，同一版本多次调用返回同一份快照
+     * @note 只能在主线程调用；返回的快照可以交给寻路线程使用
+     */
+    std::shared_ptr<const CollisionSnapshot> getCollisionSnapshot() const;
+
+    /**
+     * @brief 把碰撞地图（含版本号）恢复为快照的内容
+     * @param snapshot 本地图之前生成的快照
+     * @note 用于回放定位：版本号一并恢复，与之配套保存的寻路缓存和任务保持一致
+     */
+    void restoreCollision(const std::shared_ptr<const CollisionSnapshot>& snapshot);
 };
\ No newline at end of file
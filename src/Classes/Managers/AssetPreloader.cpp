@@ -0,0 +1,464 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AssetPreloader.cpp
+ * File Function: 资源预加载器实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "AssetPreloader.h"
+
+#include "Managers/BuildingManager.h"
+#include "Managers/SpriteAtlasManager.h"
+#include "audio/include/AudioEngine.h"
+#include "base/CCAsyncTaskPool.h"
+#include "json/document.h"
+
+#include <memory>
+
+USING_NS_CC;
+
+constexpr int64_t AssetPreloader::kDefaultTextureBudgetBytes;
+
+namespace
+{
+
+const std::vector<std::string> kTextureExtensions = {".png", ".jpg"};
+const std::vector<std::string> kPlistExtensions   = {".plist"};
+const std::vector<std::string> kAudioExtensions   = {".mp3", ".ogg", ".wav"};
+
+bool hasExtension(const std::string& path, const std::vector<std::string>& extensions)
+{
+    for (const auto& ext : extensions)
+    {
+        if (path.size() >= ext.size() && path.compare(path.size() - ext.size(), ext.size(), ext) == 0)
+            return true;
+    }
+    return false;
+}
+
+std::string directoryOf(const std::string& path)
+{
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+void appendStrings(const rapidjson::Value& doc, const char* key, std::vector<std::string>& out)
+{
+    if (!doc.HasMember(key) || !doc[key].IsArray())
+        return;
+    for (const auto& item : doc[key].GetArray())
+    {
+        if (item.IsString())
+            out.push_back(item.GetString());
+    }
+}
+
+/** @brief 纹理占用的显存估算 */
+int64_t textureBytes(Texture2D* texture)
+{
+    return static_cast<int64_t>(texture->getPixelsWide()) * texture->getPixelsHigh() *
+           texture->getBitsPerPixelForFormat() / 8;
+}
+
+/**
+ * @struct PlistReadResult
+ * @brief IO 线程读取 plist 的结果
+ */
+struct PlistReadResult
+{
+    std::string fullPath;    ///< plist 完整路径（主线程解析，IO 线程只读文件）
+    int64_t     bytes = 0;   ///< plist 文件大小
+    std::string textureFile; ///< metadata 中的纹理文件名
+};
+
+} // namespace
+
+// ==================== AssetManifest ====================
+
+void AssetManifest::merge(const AssetManifest& other)
+{
+    textures.insert(textures.end(), other.textures.begin(), other.textures.end());
+    plists.insert(plists.end(), other.plists.begin(), other.plists.end());
+    audio.insert(audio.end(), other.audio.begin(), other.audio.end());
+}
+
+// ==================== 清单 ====================
+
+AssetPreloader& AssetPreloader::getInstance()
+{
+    static AssetPreloader instance;
+    return instance;
+}
+
+AssetManifest AssetPreloader::loadManifest(const std::string& manifestFile)
+{
+    AssetManifest manifest;
+    auto*         fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(manifestFile))
+    {
+        CCLOG("⚠️ 预加载清单不存在: %s", manifestFile.c_str());
+        return manifest;
+    }
+
+    rapidjson::Document doc;
+    doc.Parse(fileUtils->getStringFromFile(manifestFile).c_str());
+    if (doc.HasParseError() || !doc.IsObject())
+    {
+        CCLOG("❌ 预加载清单解析失败: %s", manifestFile.c_str());
+        return manifest;
+    }
+
+    appendStrings(doc, "textures", manifest.textures);
+    appendStrings(doc, "plists", manifest.plists);
+    appendStrings(doc, "audio", manifest.audio);
+    return manifest;
+}
+
+AssetManifest AssetPreloader::manifestForBase(const std::vector<BuildingSerialData>& buildings)
+{
+    AssetManifest manifest;
+    for (const auto& building : buildings)
+    {
+        std::string imageFile = BuildingManager::getImageFileForSerialData(building);
+        if (!imageFile.empty())
+            manifest.textures.push_back(imageFile);
+    }
+    return manifest;
+}
+
+std::vector<std::string> AssetPreloader::expandEntries(const std::vector<std::string>& entries,
+                                                       const std::vector<std::string>& extensions)
+{
+    auto*                    fileUtils = FileUtils::getInstance();
+    std::set<std::string>    seen;
+    std::vector<std::string> result;
+
+    auto add = [&](const std::string& path) {
+        if (seen.insert(path).second)
+            result.push_back(path);
+    };
+
+    for (const auto& entry : entries)
+    {
+        if (!entry.empty() && entry.back() == '/')
+        {
+            // listFiles 返回完整路径，按文件名拼回相对路径
+            for (const auto& fullPath : fileUtils->listFiles(entry))
+            {
+                if (fullPath.empty() || fullPath.back() == '/' || !hasExtension(fullPath, extensions))
+                    continue;
+                size_t slash = fullPath.find_last_of('/');
+                add(entry + (slash == std::string::npos ? fullPath : fullPath.substr(slash + 1)));
+            }
+        }
+        else if (fileUtils->isFileExist(entry))
+        {
+            add(entry);
+        }
+        else
+        {
+            CCLOG("⚠️ 预加载跳过不存在的文件: %s", entry.c_str());
+        }
+    }
+    return result;
+}
+
+// ==================== 预加载 ====================
+
+void AssetPreloader::preload(const std::string& sceneName, const AssetManifest& manifest,
+                             const ProgressCallback& onProgress, const CompleteCallback& onComplete)
+{
+    cancel();
+    unsigned generation = _generation;
+
+    _loadingScene = sceneName;
+    _scenes[sceneName].active = true;
+    _progress   = AssetPreloadProgress();
+    _onProgress = onProgress;
+    _onComplete = onComplete;
+    _startTime  = std::chrono::steady_clock::now();
+
+    // 已打入图集的散图改为加载整页图集，同一页只加载一次
+    auto&                    atlas = SpriteAtlasManager::getInstance();
+    std::vector<std::string> textures;
+    std::vector<std::string> plists = expandEntries(manifest.plists, kPlistExtensions);
+    std::set<std::string>    plistSet(plists.begin(), plists.end());
+    for (const auto& texture : expandEntries(manifest.textures, kTextureExtensions))
+    {
+        std::string atlasPlist = atlas.getAtlasPlist(texture);
+        if (atlasPlist.empty())
+            textures.push_back(texture);
+        else if (plistSet.insert(atlasPlist).second)
+            plists.push_back(atlasPlist);
+    }
+    std::vector<std::string> audio = expandEntries(manifest.audio, kAudioExtensions);
+
+    auto* fileUtils = FileUtils::getInstance();
+    std::vector<int64_t> textureSizes;
+    std::vector<int64_t> audioSizes;
+    for (const auto& path : textures)
+    {
+        textureSizes.push_back(fileUtils->getFileSize(path));
+        _progress.totalBytes += textureSizes.back();
+    }
+    for (const auto& path : audio)
+    {
+        audioSizes.push_back(fileUtils->getFileSize(path));
+        _progress.totalBytes += audioSizes.back();
+    }
+    for (const auto& path : plists)
+        _progress.totalBytes += fileUtils->getFileSize(path);
+
+    _progress.totalFiles = static_cast<int>(textures.size() + plists.size() + audio.size());
+    _pending             = _progress.totalFiles;
+
+    CCLOG("📦 预加载 %s: 纹理 %zu, plist %zu, 音频 %zu, 共 %.1f MB", sceneName.c_str(), textures.size(),
+          plists.size(), audio.size(), _progress.totalBytes / (1024.0 * 1024.0));
+
+    if (_pending == 0)
+    {
+        _pending = 1;
+        onItemLoaded(0, generation);
+        return;
+    }
+
+    // plist 最先提交：读到后才知道其纹理的大小，尽早计入总量
+    for (const auto& plist : plists)
+        loadPlist(plist, generation);
+    for (size_t i = 0; i < textures.size(); ++i)
+        loadTexture(textures[i], textureSizes[i], generation);
+    for (size_t i = 0; i < audio.size(); ++i)
+        loadAudio(audio[i], audioSizes[i], generation);
+}
+
+void AssetPreloader::loadPlist(const std::string& plist, unsigned generation)
+{
+    _scenes[_loadingScene].plists.insert(plist);
+
+    auto result      = std::make_shared<PlistReadResult>();
+    result->fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+
+    // IO 线程：读文件并解析 metadata，不触碰任何缓存
+    auto readTask = [result]() {
+        Data data = FileUtils::getInstance()->getDataFromFile(result->fullPath);
+        if (data.isNull())
+            return;
+        result->bytes = data.getSize();
+
+        ValueMap dict = FileUtils::getInstance()->getValueMapFromData(reinterpret_cast<const char*>(data.getBytes()),
+                                                                      static_cast<int>(data.getSize()));
+        auto     metadataIt = dict.find("metadata");
+        if (metadataIt != dict.end() && metadataIt->second.getType() == Value::Type::MAP)
+        {
+            const ValueMap& metadata  = metadataIt->second.asValueMap();
+            auto            textureIt = metadata.find("textureFileName");
+            if (textureIt != metadata.end())
+                result->textureFile = textureIt->second.asString();
+        }
+    };
+
+    // 主线程：异步加载纹理，完成后按 plist 文件名注册精灵帧（plist 很小，以文件名注册才能被
+    // isSpriteFramesWithFileLoaded 识别，后续 addSpriteFramesWithFile 不会重复解析）
+    auto onRead = [this, plist, result, generation](void*) {
+        if (generation != _generation)
+            return;
+
+        if (result->textureFile.empty())
+        {
+            std::string stem    = plist.substr(0, plist.find_last_of('.'));
+            result->textureFile = stem.substr(stem.find_last_of('/') + 1) + ".png";
+        }
+        std::string texturePath = directoryOf(plist) + result->textureFile;
+        _plistTextures[plist]   = texturePath;
+
+        int64_t textureSize = FileUtils::getInstance()->getFileSize(texturePath);
+        _progress.totalBytes += textureSize;
+        _progress.loadedBytes += result->bytes;
+
+        Director::getInstance()->getTextureCache()->addImageAsync(
+            texturePath, [this, plist, textureSize, generation](Texture2D* texture) {
+                if (generation != _generation)
+                    return;
+                if (texture)
+                    SpriteFrameCache::getInstance()->addSpriteFramesWithFile(plist, texture);
+                else
+                    CCLOG("⚠️ 预加载纹理失败: %s", _plistTextures[plist].c_str());
+                onItemLoaded(textureSize, generation);
+            });
+    };
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, onRead, nullptr, readTask);
+}
+
+void AssetPreloader::loadTexture(const std::string& path, int64_t bytes, unsigned generation)
+{
+    _scenes[_loadingScene].textures.insert(path);
+
+    Director::getInstance()->getTextureCache()->addImageAsync(path, [this, path, bytes, generation](Texture2D* texture) {
+        if (generation != _generation)
+            return;
+        if (!texture)
+            CCLOG("⚠️ 预加载纹理失败: %s", path.c_str());
+        onItemLoaded(bytes, generation);
+    });
+}
+
+void AssetPreloader::loadAudio(const std::string& path, int64_t bytes, unsigned generation)
+{
+    _scenes[_loadingScene].audio.insert(path);
+
+    // 回调可能来自音频解码线程，统一转到主线程
+    AudioEngine::preload(path, [this, bytes, generation](bool) {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(
+            [this, bytes, generation]() { onItemLoaded(bytes, generation); });
+    });
+}
+
+void AssetPreloader::onItemLoaded(int64_t bytes, unsigned generation)
+{
+    if (generation != _generation || _pending <= 0)
+        return;
+
+    _progress.loadedBytes += bytes;
+    _progress.loadedFiles++;
+    _pending--;
+
+    if (_onProgress)
+        _onProgress(_progress);
+
+    if (_pending > 0)
+        return;
+
+    double elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _startTime).count();
+    CCLOG("📦 预加载 %s 完成: %d 个文件, %.1f MB, %.0f ms", _loadingScene.c_str(), _progress.loadedFiles,
+          _progress.loadedBytes / (1024.0 * 1024.0), elapsedMs);
+
+    CompleteCallback onComplete = std::move(_onComplete);
+    _onComplete                 = nullptr;
+    _onProgress                 = nullptr;
+    if (onComplete)
+        onComplete();
+}
+
+void AssetPreloader::cancel()
+{
+    _generation++;
+    _pending    = 0;
+    _onProgress = nullptr;
+    _onComplete = nullptr;
+}
+
+// ==================== 回收 ====================
+
+void AssetPreloader::releaseScene(const std::string& sceneName)
+{
+    auto it = _scenes.find(sceneName);
+    if (it == _scenes.end())
+        return;
+
+    it->second.active = false;
+
+    // 退出场景时其节点尚未释放，纹理仍被引用；等到下一帧再检查
+    Director::getInstance()->getScheduler()->performFunctionInCocosThread([this]() { evictOverBudget(); });
+}
+
+int64_t AssetPreloader::residentTextureBytes() const
+{
+    auto*                 cache = Director::getInstance()->getTextureCache();
+    std::set<std::string> counted;
+    int64_t               total = 0;
+
+    auto add = [&](const std::string& path) {
+        if (!counted.insert(path).second)
+            return;
+        if (Texture2D* texture = cache->getTextureForKey(path))
+            total += textureBytes(texture);
+    };
+
+    for (const auto& pair : _scenes)
+    {
+        for (const auto& path : pair.second.textures)
+            add(path);
+        for (const auto& plist : pair.second.plists)
+        {
+            auto textureIt = _plistTextures.find(plist);
+            if (textureIt != _plistTextures.end())
+                add(textureIt->second);
+        }
+    }
+    return total;
+}
+
+void AssetPreloader::evictOverBudget()
+{
+    int64_t resident = residentTextureBytes();
+    if (resident <= _textureBudgetBytes)
+    {
+        CCLOG("📦 预加载纹理 %.1f MB，未超过预算 %.1f MB，保留", resident / (1024.0 * 1024.0),
+              _textureBudgetBytes / (1024.0 * 1024.0));
+        return;
+    }
+
+    // 仍在使用的场景需要的资源不回收
+    std::set<std::string> keepTextures;
+    std::set<std::string> keepPlists;
+    std::set<std::string> keepAudio;
+    for (const auto& pair : _scenes)
+    {
+        if (!pair.second.active)
+            continue;
+        keepTextures.insert(pair.second.textures.begin(), pair.second.textures.end());
+        keepPlists.insert(pair.second.plists.begin(), pair.second.plists.end());
+        keepAudio.insert(pair.second.audio.begin(), pair.second.audio.end());
+    }
+
+    auto*   textureCache = Director::getInstance()->getTextureCache();
+    int64_t evicted      = 0;
+
+    // 只回收缓存是唯一持有者的纹理（引用计数为 1），仍在显示的不受影响
+    auto evictTexture = [&](const std::string& path) {
+        Texture2D* texture = textureCache->getTextureForKey(path);
+        if (!texture || texture->getReferenceCount() != 1)
+            return;
+        int64_t bytes = textureBytes(texture);
+        textureCache->removeTexture(texture);
+        resident -= bytes;
+        evicted += bytes;
+    };
+
+    for (auto it = _scenes.begin(); it != _scenes.end() && resident > _textureBudgetBytes;)
+    {
+        SceneAssets& assets = it->second;
+        if (assets.active)
+        {
+            ++it;
+            continue;
+        }
+
+        for (const auto& plist : assets.plists)
+        {
+            if (keepPlists.count(plist))
+                continue;
+            SpriteFrameCache::getInstance()->removeSpriteFramesFromFile(plist);
+            evictTexture(_plistTextures[plist]);
+        }
+        for (const auto& path : assets.textures)
+        {
+            if (!keepTextures.count(path))
+                evictTexture(path);
+        }
+        for (const auto& path : assets.audio)
+        {
+            if (!keepAudio.count(path))
+                AudioEngine::uncache(path);
+        }
+
+        CCLOG("📦 回收场景 %s 的预加载资源", it->first.c_str());
+        it = _scenes.erase(it);
+    }
+
+    CCLOG("📦 预加载纹理超出预算：回收 %.1f MB，剩余 %.1f MB", evicted / (1024.0 * 1024.0),
+          resident / (1024.0 * 1024.0));
+}
@@ -0,0 +1,166 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AssetPreloader.h
+ * File Function: 资源预加载器 - 按场景清单异步加载纹理/plist/音频，按实际字节数汇报进度，离开场景时按内存预算回收
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __ASSET_PRELOADER_H__
+#define __ASSET_PRELOADER_H__
+
+#include "Managers/GameDataModels.h"
+#include "cocos2d.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @struct AssetManifest
+ * @brief 一个场景需要的资源
+ *
+ * 路径均相对 Resources；以 '/' 结尾的条目表示目录下的全部同类文件（不递归）。
+ * 已打入图集的散图在加载时自动换成所在的图集页。
+ */
+struct AssetManifest
+{
+    std::vector<std::string> textures; ///< 图片
+    std::vector<std::string> plists;   ///< 精灵帧 plist（纹理随 plist 一起加载）
+    std::vector<std::string> audio;    ///< 音效/音乐
+
+    /** @brief 合并另一份清单（不去重，加载时统一去重） */
+    void merge(const AssetManifest& other);
+};
+
+/**
+ * @struct AssetPreloadProgress
+ * @brief 预加载进度（按文件字节数统计）
+ */
+struct AssetPreloadProgress
+{
+    int64_t loadedBytes = 0; ///< 已完成的字节数
+    int64_t totalBytes  = 0; ///< 总字节数（plist 的纹理在读到 plist 后计入）
+    int     loadedFiles = 0; ///< 已完成的文件数
+    int     totalFiles  = 0; ///< 文件总数
+
+    /** @brief 完成百分比（0~100） */
+    float getPercent() const
+    {
+        return totalBytes > 0 ? 100.0f * static_cast<float>(loadedBytes) / static_cast<float>(totalBytes) : 100.0f;
+    }
+};
+
+/**
+ * @class AssetPreloader
+ * @brief 资源预加载器（单例）
+ *
+ * - 纹理：TextureCache::addImageAsync，在引擎的加载线程解码
+ * - plist：在 AsyncTaskPool 的 IO 线程读取并解析出纹理文件名，纹理异步加载后在主线程注册精灵帧
+ * - 音频：AudioEngine::preload
+ *
+ * 每个场景记录自己加载的资源。场景退出时（releaseScene）若预加载纹理的显存估算超过预算，
+ * 回收已退出场景独占且不再被引用的资源，直到回到预算以内；未超预算时保留，再次进入时无需重新加载。
+ */
+class AssetPreloader
+{
+public:
+    using ProgressCallback = std::function<void(const AssetPreloadProgress&)>;
+    using CompleteCallback = std::function<void()>;
+
+    static constexpr int64_t kDefaultTextureBudgetBytes = 128 * 1024 * 1024; ///< 默认纹理预算（字节）
+
+    static AssetPreloader& getInstance();
+
+    /**
+     * @brief 读取场景清单文件
+     * @param manifestFile 清单路径（相对 Resources，例如 "preload/battle.json"）
+     * @return AssetManifest 清单，文件不存在时为空
+     */
+    static AssetManifest loadManifest(const std::string& manifestFile);
+
+    /**
+     * @brief 根据基地的建筑列表生成清单（每种建筑、每个等级的外观图片）
+     * @param buildings 建筑序列化数据
+     * @return AssetManifest 清单
+     */
+    static AssetManifest manifestForBase(const std::vector<BuildingSerialData>& buildings);
+
+    /**
+     * @brief 异步预加载一个场景的资源（会取消尚未完成的上一次预加载的回调）
+     * @param sceneName 场景名（用于记录归属和回收）
+     * @param manifest 资源清单
+     * @param onProgress 进度回调（主线程）
+     * @param onComplete 完成回调（主线程）
+     */
+    void preload(const std::string& sceneName, const AssetManifest& manifest, const ProgressCallback& onProgress,
+                 const CompleteCallback& onComplete);
+
+    /** @brief 取消当前预加载的回调（已提交的加载仍会完成并进入缓存） */
+    void cancel();
+
+    /** @brief 是否正在预加载 */
+    bool isLoading() const { return _pending > 0; }
+
+    /**
+     * @brief 场景退出：标记为不再使用，下一帧（场景节点已释放后）按预算回收
+     * @param sceneName 场景名
+     */
+    void releaseScene(const std::string& sceneName);
+
+    /** @brief 设置纹理预算（字节） */
+    void setTextureBudget(int64_t bytes) { _textureBudgetBytes = bytes; }
+
+private:
+    /**
+     * @struct SceneAssets
+     * @brief 一个场景加载过的资源
+     */
+    struct SceneAssets
+    {
+        std::set<std::string> textures; ///< 单独加载的纹理
+        std::set<std::string> plists;   ///< plist（纹理记录在 _plistTextures）
+        std::set<std::string> audio;    ///< 音频
+        bool                  active = true;
+    };
+
+    AssetPreloader() = default;
+
+    /** @brief 展开目录条目并过滤不存在的文件 */
+    static std::vector<std::string> expandEntries(const std::vector<std::string>& entries,
+                                                  const std::vector<std::string>& extensions);
+
+    void loadPlist(const std::string& plist, unsigned generation);
+    void loadTexture(const std::string& path, int64_t bytes, unsigned generation);
+    void loadAudio(const std::string& path, int64_t bytes, unsigned generation);
+
+    /** @brief 一个文件完成（成功或失败都计入进度） */
+    void onItemLoaded(int64_t bytes, unsigned generation);
+
+    /** @brief 预加载资源当前占用的纹理内存估算 */
+    int64_t residentTextureBytes() const;
+
+    /** @brief 超出预算时回收已退出场景独占的资源 */
+    void evictOverBudget();
+
+    std::map<std::string, SceneAssets> _scenes;        ///< 场景 -> 资源
+    std::map<std::string, std::string> _plistTextures; ///< plist -> 纹理路径
+
+    std::string          _loadingScene;    ///< 正在预加载的场景
+    unsigned             _generation = 0;  ///< 每次 preload/cancel 递增，过期回调据此忽略
+    int                  _pending    = 0;  ///< 未完成的文件数
+    AssetPreloadProgress _progress;
+    ProgressCallback     _onProgress;
+    CompleteCallback     _onComplete;
+
+    std::chrono::steady_clock::time_point _startTime;
+
+    int64_t _textureBudgetBytes = kDefaultTextureBudgetBytes;
+};
+
+#endif // __ASSET_PRELOADER_H__
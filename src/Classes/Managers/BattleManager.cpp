@@ -9,28 +9,114 @@
 
 #include "BattleManager.h"
 #include "AccountManager.h"
+#include "BattleSimulator.h"
+#include "Audio/AudioManager.h"
 #include "Managers/DefenseLogSystem.h"
 #include "Managers/DeploymentValidator.h"
+#include "Managers/FrameProfiler.h"
 #include "Managers/MusicManager.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Managers/TroopInventory.h"
 #include "PathFinder.h"
 #include "ResourceManager.h"
-#include "Unit/UnitFactory.h"
+#include "Unit/UnitAnimationLibrary.h"
 
+#include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <limits>
 
 USING_NS_CC;
 
+constexpr float        BattleManager::kCatchUpSliceSeconds;
+constexpr unsigned int BattleManager::kKeyframeIntervalFrames;
+constexpr int          BattleManager::kFastForwardSyncInterval;
+
 BattleManager::BattleManager() : _deploymentValidator(nullptr) {}
 
-BattleManager::~BattleManager() {}
+BattleManager::~BattleManager()
+{
+    // 追帧或高倍速播放中退出战斗时恢复音效
+    if (_isCatchingUp || _isFastForward)
+        AudioManager::GetInstance().SetEffectsSuppressed(false);
+}
+
+namespace
+{
 
-void BattleManager::init(cocos2d::Node* mapLayer, const AccountGameData& enemyData, const std::string& enemyUserId,
-                         bool isReplay)
+/** @brief 建筑在模拟中的类别（决定兵种优先目标和大本营星） */
+BattleBuildingKind toBattleBuildingKind(const BaseBuilding* building)
+{
+    if (building->isDefenseBuilding())
+        return BattleBuildingKind::kDefense;
+
+    switch (building->getBuildingType())
+    {
+    case BuildingType::kTownHall:
+        return BattleBuildingKind::kTownHall;
+    case BuildingType::kResource:
+        return BattleBuildingKind::kResource;
+    case BuildingType::kWall:
+        return BattleBuildingKind::kWall;
+    default:
+        return BattleBuildingKind::kOther;
+    }
+}
+
+#if FRAME_PROFILER_ENABLED
+/** @brief BattleWorld::step 各阶段在性能面板和 Trace 中的作用域名（按 BattleStepPhase 索引） */
+const char* const kStepPhaseScopes[] = {
+    "BattleWorld::step/navigation", "BattleWorld::step/movement", "BattleWorld::step/unitAI",
+    "BattleWorld::step/projectiles", "BattleWorld::step/defenses", "BattleWorld::step/destruction",
+};
+static_assert(sizeof(kStepPhaseScopes) / sizeof(kStepPhaseScopes[0]) == static_cast<int>(BattleStepPhase::kCount),
+              "kStepPhaseScopes must cover every BattleStepPhase");
+#endif
+
+/**
+ * @brief 推进一个固定步
+ *
+ * 性能分析器激活时借用 BattleWorld 的分阶段计时（模拟库不依赖分析器），
+ * 把各阶段按先后顺序还原成连续的子作用域，Trace 中显示为 step 下的嵌套区间
+ */
+void stepWorld(BattleWorld& world, float dt)
+{
+#if FRAME_PROFILER_ENABLED
+    auto& profiler = FrameProfiler::getInstance();
+    if (profiler.isActive())
+    {
+        BattleStepTimings timings;
+        world.setStepTimings(&timings);
+        auto start = FrameProfiler::Clock::now();
+        world.step(dt);
+        auto end = FrameProfiler::Clock::now();
+        world.setStepTimings(nullptr);
+
+        profiler.record("BattleWorld::step", start, end);
+        auto phaseStart = start;
+        for (int p = 0; p < static_cast<int>(BattleStepPhase::kCount); ++p)
+        {
+            auto phaseEnd = phaseStart + std::chrono::duration_cast<FrameProfiler::Clock::duration>(
+                                             std::chrono::duration<double>(timings.seconds[p]));
+            profiler.record(kStepPhaseScopes[p], phaseStart, phaseEnd);
+            phaseStart = phaseEnd;
+        }
+        return;
+    }
+#endif
+    world.step(dt);
+}
+
+} // namespace
+
+void BattleManager::init(cocos2d::Node* mapLayer, GridMap* gridMap, const AccountGameData& enemyData,
+                         const std::string& enemyUserId, bool isReplay)
 {
     _mapLayer = mapLayer;
+    _gridMap  = gridMap;
 
-    _gridMap = dynamic_cast<GridMap*>(mapLayer);
+    if (!_gridMap)
+        _gridMap = dynamic_cast<GridMap*>(mapLayer);
 
     if (!_gridMap && mapLayer)
     {
@@ -65,21 +151,54 @@ void BattleManager::init(cocos2d::Node* mapLayer, const AccountGameData& enemyDa
     _destructionPercent = 0;
     _accumulatedTime    = 0.0f;
     _currentFrame       = 0;
+    _scheduledDeploys.clear();
+    _keyframes.clear();
+    if (_isCatchingUp || _isFastForward)
+    {
+        _isCatchingUp  = false;
+        _isFastForward = false;
+        _world.setRecordEvents(true);
+        AudioManager::GetInstance().SetEffectsSuppressed(false);
+    }
+    _catchUpTargetFrame = 0;
 
     // 重置战斗结束状态
     _endReason          = BattleEndReason::TIMEOUT;
     _townHallDestroyed  = false;
     _hasDeployedAnyUnit = false;
 
-    _deployedUnits.clear();
     _enemyBuildings.clear();
+    _world.reset();
+    _worldView.reset();
+
+    // 新战斗使用新的碰撞地图，旧的寻路缓存和未完成的寻路任务全部作废
+    PathFinder::getInstance().clearCache();
+    PathFinder::getInstance().resetCacheStats();
+
+    // 有战斗网格时按网格寻路（缓存 + 异步任务），否则单位直线走向目标
+    if (_gridMap)
+    {
+        if (!_navigation)
+            _navigation.reset(new GridMapNavigation(_gridMap));
+        else
+            _navigation->setGridMap(_gridMap);
+        _navigation->resetStats();
+
+        // 回放定位回到关键帧后重走的寻路请求直接复用之前的搜索结果
+        _navigation->setRememberResults(_isReplayMode);
+    }
+    else if (_navigation)
+    {
+        _navigation->cancelAll();
+    }
+    _world.setNavigation(_gridMap ? _navigation.get() : nullptr);
 }
 
 void BattleManager::setBuildings(const std::vector<BaseBuilding*>& buildings)
 {
-    _enemyBuildings      = buildings;
-    _totalBuildingHP     = 0;
-    _destroyedBuildingHP = 0;
+    _enemyBuildings = buildings;
+    _world.reset();
+    _worldView.reset();
 
     if (!_gridMap)
         CCLOG("❌ 警告: setBuildings 调用时 _gridMap 为空!");
@@ -110,7 +229,28 @@ void BattleManager::setBuildings(const std::vector<BaseBuilding*>& buildings)
                 building->repair(maxHP - curHP);
             }
             
-            _totalBuildingHP += maxHP;
+            BattleBuildingDesc desc;
+            desc.kind         = toBattleBuildingKind(building);
+            desc.position     = SimVec2::fromFloat(building->getPositionX(), building->getPositionY());
+            desc.gridX        = static_cast<int>(building->getGridPosition().x);
+            desc.gridY        = static_cast<int>(building->getGridPosition().y);
+            desc.gridWidth    = static_cast<int>(building->getGridSize().width);
+            desc.gridHeight   = static_cast<int>(building->getGridSize().height);
+            desc.hitpoints    = building->getHitpoints();
+            desc.maxHitpoints = maxHP;
+
+            if (auto* defense = dynamic_cast<DefenseBuilding*>(building))
+            {
+                const CombatStats& stats = defense->getCombatStats();
+                desc.armed               = true;
+                desc.damage              = stats.damage;
+                desc.attackRange         = stats.attackRange;
+                desc.attackSpeed         = stats.attackSpeed;
+                desc.projectileSpeed     = defense->getProjectileSpeed();
+                desc.splashRadius        = defense->getSplashRadius();
+            }
+
+            _worldView.bindBuilding(_world.addBuilding(desc), building);
 
             CCLOG("📊 建筑: %s, 血量: %d/%d, 类型: %d", 
                   building->getDisplayName().c_str(), 
@@ -137,7 +277,7 @@ void BattleManager::setBuildings(const std::vector<BaseBuilding*>& buildings)
         }
     }
 
-    CCLOG("📊 总血量: %d", _totalBuildingHP);
+    CCLOG("📊 总血量: %d", _world.getTotalHitpoints());
     CCLOG("📊 ========================================");
 }
 
@@ -189,6 +329,14 @@ void BattleManager::startBattle(const TroopDeploymentMap& deployment)
     CCLOG("📦 可部署部队: 野蛮人=%d, 弓箭手=%d, 巨人=%d, 哥布林=%d, 炸弹人=%d", 
           _barbarianCount, _archerCount, _giantCount, _goblinCount, _wallBreakerCount);
 
+    // 按部署数量预热单位节点，部署时不再在战斗帧内加载精灵、动画和血条
+    SpriteAtlasManager::getInstance().beginScene("BattleManager::startBattle 预热");
+    for (const auto& pair : deployment)
+    {
+        _worldView.getNodePool().prewarmUnits(pair.first, pair.second);
+    }
+    SpriteAtlasManager::getInstance().endScene();
+
     // 非回放模式下消耗部队并开始录制
     if (!_isReplayMode)
     {
@@ -227,6 +375,13 @@ void BattleManager::skipReadyPhase()
     // 激活所有防御建筑
     activateAllBuildings();
 
+    // 第 0 帧的关键帧保证任何位置都能定位
+    if (_isReplayMode)
+    {
+        _keyframes.clear();
+        captureKeyframe();
+    }
+
     // 播放战斗音乐（回放模式在 BattleScene 中已处理）
 }
 
@@ -286,6 +441,16 @@ float BattleManager::getReadyPhaseRemainingTime() const
 
 void BattleManager::update(float dt)
 {
+    PROFILE_SCOPE("BattleManager::update");
+
+    // 远程部署的首个单位在第 1 帧推进之前生成，触发战斗开始
+    if (_state == BattleState::READY)
+        applyScheduledDeploys(_currentFrame + 1);
+
+    // 追帧等待战斗开始期间，攻击方的战斗仍在进行
+    if (_isCatchingUp && _state != BattleState::FIGHTING)
+        _accumulatedTime += dt;
+
     // READY 状态：更新准备阶段倒计时
     if (_state == BattleState::READY)
     {
@@ -303,179 +468,151 @@ void BattleManager::update(float dt)
     // FIGHTING 状态：正常更新战斗逻辑
     if (_state == BattleState::FIGHTING)
     {
-        _accumulatedTime += dt;
-
-        while (_accumulatedTime >= FIXED_TIME_STEP)
+        if (_isCatchingUp)
         {
-            fixedUpdate();
-            _accumulatedTime -= FIXED_TIME_STEP;
+            // 观战追帧期间攻击方的实时时间继续累加；回放定位只推进到目标帧
+            if (_catchUpTargetFrame == 0)
+                _accumulatedTime += dt;
+            runCatchUp();
+        }
+        else
+        {
+            _accumulatedTime += dt;
+            auto sliceStart = std::chrono::steady_clock::now();
+            while (_accumulatedTime >= FIXED_TIME_STEP)
+            {
+                fixedUpdate();
+                _accumulatedTime -= FIXED_TIME_STEP;
+
+                if (!_isFastForward)
+                    continue;
+
+                // 高倍速时模拟跟不上就丢弃积压的时间（实际倍速降低），不拖慢渲染
+                auto sliceEnd = std::chrono::steady_clock::now();
+                if (std::chrono::duration<float>(sliceEnd - sliceStart).count() >= kCatchUpSliceSeconds)
+                {
+                    _accumulatedTime = std::min(_accumulatedTime, FIXED_TIME_STEP);
+                    break;
+                }
+            }
         }
     }
+
+    // 追帧期间不同步节点，追上后由 finishCatchUp 一次对齐
+    if (_isCatchingUp)
+        return;
+
+    if (_isFastForward)
+    {
+        if (--_fastForwardSyncCountdown > 0)
+            return;
+        _fastForwardSyncCountdown = kFastForwardSyncInterval;
+
+        PROFILE_SCOPE("BattleWorldView::syncState");
+        _worldView.syncState(_world);
+        if (_onUIUpdate)
+            _onUIUpdate();
+        return;
+    }
+
+    // 每个渲染帧同步一次节点（战斗结束后仍需同步，让死亡单位完成淡出后被释放）
+    PROFILE_SCOPE("BattleWorldView::sync");
+    _worldView.sync(_world);
 }
 
 void BattleManager::fixedUpdate()
 {
+    PROFILE_SCOPE("BattleManager::fixedUpdate");
+
     _currentFrame++;
 
     if (_isReplayMode)
     {
         ReplaySystem::getInstance().updateFrame(_currentFrame);
+
+        // 结束战斗事件与录制时一样在推进之前生效
+        if (_state == BattleState::FINISHED)
+            return;
     }
 
+    // 远程部署在其原始帧推进之前生成，与攻击方的顺序一致
+    applyScheduledDeploys(_currentFrame);
+
     updateBattleState(FIXED_TIME_STEP);
-}
 
-void BattleManager::updateBattleState(float dt)
-{
-    // 仅在 FIGHTING 状态下累加战斗时间
-    if (_state == BattleState::FIGHTING)
-    {
-        _elapsedTime += dt;
-    }
+    // 每 kChecksumInterval 帧计算一次摘要，分摊后远小于一帧的模拟耗时
+    if (_currentFrame % ReplayData::kChecksumInterval == 0)
+        updateStateChecksum();
 
-    // 更新 Z-Order
-    for (auto* unit : _deployedUnits)
-    {
-        if (unit && !unit->isDead() && !unit->isPendingRemoval())
-        {
-            int newZOrder = 10000 - static_cast<int>(unit->getPositionY());
-            unit->setLocalZOrder(newZOrder);
-        }
-    }
+    if (_isReplayMode && _currentFrame % kKeyframeIntervalFrames == 0)
+        captureKeyframe();
+}
 
-    for (auto* building : _enemyBuildings)
-    {
-        if (building && !building->isDestroyed())
-        {
-            int newZOrder = 10000 - static_cast<int>(building->getPositionY());
-            building->setLocalZOrder(newZOrder);
-        }
-    }
+void BattleManager::updateStateChecksum()
+{
+    PROFILE_SCOPE("BattleManager::updateStateChecksum");
 
-    // 清理已死亡且等待移除的单位
-    _deployedUnits.erase(
-        std::remove_if(_deployedUnits.begin(), _deployedUnits.end(),
-            [](BaseUnit* unit) {
-                if (unit == nullptr)
-                {
-                    return true;
-                }
-                // 检查是否已标记为等待移除
-                if (unit->isPendingRemoval())
-                {
-                    return true;
-                }
-                return false;
-            }),
-        _deployedUnits.end());
+    _lastChecksumFrame = _currentFrame;
+    _lastChecksum      = _world.computeStateHash();
 
-    // 更新单位移动
-    for (auto* unit : _deployedUnits)
+    auto& replaySystem = ReplaySystem::getInstance();
+    if (!_isReplayMode)
     {
-        if (unit && !unit->isDead())
-        {
-            unit->tickMovement(dt);
-        }
+        replaySystem.recordChecksum(_currentFrame, _lastChecksum);
+        return;
     }
 
-    // 更新 AI（包括攻击冷却和攻击逻辑）
-    updateUnitAI(dt);
-
-    // 更新防御建筑
-    for (auto* building : _enemyBuildings)
+    if (!replaySystem.verifyChecksum(_currentFrame, _lastChecksum))
     {
-        if (building && building->isDefenseBuilding())
-        {
-            auto* defenseBuilding = dynamic_cast<DefenseBuilding*>(building);
-            if (defenseBuilding)
-            {
-                defenseBuilding->tick(dt);
-                defenseBuilding->detectEnemies(_deployedUnits);
-            }
-        }
+        const auto& detector = replaySystem.getDesyncDetector();
+        CCLOG("❌ 回放不同步: 第 %u 帧, 录制摘要=%016llx, 回放摘要=%016llx", detector.getDesyncFrame(),
+              static_cast<unsigned long long>(detector.getExpectedHash()),
+              static_cast<unsigned long long>(detector.getActualHash()));
+        CCLOG("%s", _world.describeState().c_str());
     }
-
-    // 更新星星和破坏率
-    updateStarsAndDestruction();
-
-    // 检查战斗结束条件
-    checkBattleEndConditions();
-
-    if (_onUIUpdate)
-        _onUIUpdate();
 }
 
-void BattleManager::updateStarsAndDestruction()
+void BattleManager::updateBattleState(float dt)
 {
-    if (_enemyBuildings.empty())
+    // 仅在 FIGHTING 状态下累加战斗时间
+    if (_state == BattleState::FIGHTING)
     {
-        _destructionPercent = 100;
-        _starsEarned        = 3;
-        return;
+        _elapsedTime += dt;
     }
 
-    // 计算破坏的 HP
-    _destroyedBuildingHP = 0;
-    int  destroyedCount  = 0;
-    bool townHallFound   = false;
+    // 寻路结果、移动、单位 AI、投射物、防御建筑都在模拟中按固定顺序推进
+    stepWorld(_world, dt);
 
-    for (auto* building : _enemyBuildings)
     {
-        if (!building)
-            continue;
+        PROFILE_SCOPE("BattleManager::updateBattleState/result");
 
-        int lostHP = building->getMaxHitpoints() - building->getHitpoints();
-        _destroyedBuildingHP += lostHP;
+        // 更新星星和破坏率
+        updateStarsAndDestruction();
 
-        if (building->isDestroyed())
-        {
-            destroyedCount++;
-
-            // 检測大本营是否被摧毁
-            if (building->getBuildingType() == BuildingType::kTownHall)
-            {
-                if (!_townHallDestroyed)
-                {
-                    _townHallDestroyed = true;
-                    CCLOG("⭐ 大本营被摧毁! +1 星");
-                }
-            }
-        }
-
-        if (building->getBuildingType() == BuildingType::kTownHall)
-        {
-            townHallFound = true;
-        }
-    }
-
-    // 计算破坏率 (基于 HP)
-    if (_totalBuildingHP > 0)
-    {
-        _destructionPercent = std::min(100, (_destroyedBuildingHP * 100) / _totalBuildingHP);
+        // 检查战斗结束条件
+        checkBattleEndConditions();
     }
 
-    // 统一的星星计算逻辑
-    int newStars = 0;
-
-    // 规则1: 摧毁大本营 = 1 星
-    if (_townHallDestroyed)
+    // 追帧和高倍速期间 UI 不逐帧刷新，由 update 按渲染帧刷新
+    if (_onUIUpdate && !_isCatchingUp && !_isFastForward)
     {
-        newStars++;
+        PROFILE_SCOPE("BattleManager::updateBattleState/ui");
+        _onUIUpdate();
     }
+}
 
-    // 规则2: 破坏率 >= 50% = 1 星
-    if (_destructionPercent >= 50)
-    {
-        newStars++;
-    }
+void BattleManager::updateStarsAndDestruction()
+{
+    _destructionPercent = _world.getDestructionPercent();
 
-    // 规则3: 破坏率 = 100% = 1 星 (总共最多3星)
-    if (_destructionPercent >= 100)
+    if (_world.isTownHallDestroyed() && !_townHallDestroyed)
     {
-        newStars++;
+        _townHallDestroyed = true;
+        CCLOG("⭐ 大本营被摧毁! +1 星");
     }
 
     // 只能增加星星，不能减少
+    int newStars = _world.getStars();
     if (newStars > _starsEarned)
     {
         int gained   = newStars - _starsEarned;
@@ -531,29 +668,12 @@ void BattleManager::checkBattleEndConditions()
 
 bool BattleManager::checkAllUnitsDeadOrDeployed() const
 {
-    for (auto* unit : _deployedUnits)
-    {
-        // 跳过空指针和等待移除的单位
-        if (unit && !unit->isDead() && !unit->isPendingRemoval())
-        {
-            return false;
-        }
-    }
-    return true;
+    return _world.countAliveUnits() == 0;
 }
 
 int BattleManager::countAliveUnits() const
 {
-    int count = 0;
-    for (auto* unit : _deployedUnits)
-    {
-        // 只统计有效且未死亡且未等待移除的单位
-        if (unit && !unit->isDead() && !unit->isPendingRemoval())
-        {
-            count++;
-        }
-    }
-    return count;
+    return _world.countAliveUnits();
 }
 
 int BattleManager::getTotalRemainingTroops() const
@@ -615,7 +735,8 @@ void BattleManager::deployUnit(UnitType type, const cocos2d::Vec2& position)
     // 非回放模式下记录操作
     if (!_isReplayMode)
     {
-        ReplaySystem::getInstance().recordDeployUnit(_currentFrame, type, position);
+        // 录制为下一帧：回放时事件在该帧推进之前执行，与此处部署后再推进一致
+        ReplaySystem::getInstance().recordDeployUnit(_currentFrame + 1, type, position);
 
         // 网络模式下发送操作
         if (_isNetworked && _isAttacker && _onNetworkDeploy)
@@ -628,26 +749,73 @@ void BattleManager::deployUnit(UnitType type, const cocos2d::Vec2& position)
     spawnUnit(type, position);
 }
 
-void BattleManager::deployUnitRemote(UnitType type, const cocos2d::Vec2& position)
+void BattleManager::deployUnitRemote(UnitType type, const cocos2d::Vec2& position, unsigned int frame)
 {
     // 远程部署不进行位置验证，因为原始部署已在攻击方验证过
     // 这适用于网络同步、观战和回放场景
-    spawnUnit(type, position);
+    if (frame == 0)
+    {
+        spawnUnit(type, position);
+        return;
+    }
+
+    // 同一帧的部署保持到达顺序
+    ScheduledDeploy deploy{frame, type, position};
+    auto            it = std::upper_bound(_scheduledDeploys.begin(), _scheduledDeploys.end(), deploy,
+                                          [](const ScheduledDeploy& a, const ScheduledDeploy& b) { return a.frame < b.frame; });
+    _scheduledDeploys.insert(it, deploy);
 }
 
-void BattleManager::spawnUnit(UnitType type, const cocos2d::Vec2& position)
+void BattleManager::applyScheduledDeploys(unsigned int frame)
 {
-    BaseUnit* unit = UnitFactory::createUnit(type);
-    if (!unit)
+    size_t due = 0;
+    while (due < _scheduledDeploys.size() && _scheduledDeploys[due].frame <= frame)
+        ++due;
+    if (due == 0)
         return;
 
+    // 先移出队列再生成：spawnUnit 可能触发战斗开始回调
+    std::vector<ScheduledDeploy> deploys(_scheduledDeploys.begin(), _scheduledDeploys.begin() + due);
+    _scheduledDeploys.erase(_scheduledDeploys.begin(), _scheduledDeploys.begin() + due);
+
+    for (const auto& deploy : deploys)
+        spawnUnit(deploy.type, deploy.position);
+}
+
+BaseUnit* BattleManager::createUnitNode(UnitType type, const cocos2d::Vec2& position)
+{
+    BaseUnit* unit = _worldView.getNodePool().acquireUnit(type);
+    if (!unit)
+        return nullptr;
+
     unit->setPosition(position);
     unit->enableBattleMode();
 
-    int zOrder = 10000 - static_cast<int>(position.y);
-    if (_mapLayer)
-        _mapLayer->addChild(unit, zOrder);
-    _deployedUnits.push_back(unit);
+    // 层级由 BattleWorldView 绑定单位时按深度桶设置
+    if (_depthLayer)
+        _depthLayer->addChild(unit);
+    else if (_mapLayer)
+        _mapLayer->addChild(unit);
+    return unit;
+}
+
+void BattleManager::spawnUnit(UnitType type, const cocos2d::Vec2& position)
+{
+    BaseUnit* unit = createUnitNode(type, position);
+    if (!unit)
+        return;
+
+    const CombatStats& stats = unit->getCombatStats();
+    BattleUnitDesc     desc;
+    desc.type        = type;
+    desc.position    = SimVec2::fromFloat(position.x, position.y);
+    desc.hitpoints   = stats.currentHitpoints;
+    desc.armor       = stats.armor;
+    desc.damage      = stats.damage;
+    desc.attackRange = stats.attackRange;
+    desc.attackSpeed = stats.attackSpeed;
+    desc.moveSpeed   = unit->getMoveSpeed();
+    _worldView.bindUnit(_world.spawnUnit(desc), unit);
 
     // 首次部署单位时触发战斗正式开始
     if (!_hasDeployedAnyUnit)
@@ -661,170 +829,8 @@ void BattleManager::spawnUnit(UnitType type, const cocos2d::Vec2& position)
         }
     }
 
-    CCLOG("🪖 部署单位: type=%d, pos=(%.1f,%.1f), 存活单位数=%zu", 
-          static_cast<int>(type), position.x, position.y, _deployedUnits.size());
-}
-
-void BattleManager::updateUnitAI(float dt)
-{
-    GridMap* gridMap = dynamic_cast<GridMap*>(_mapLayer);
-
-    for (auto it = _deployedUnits.begin(); it != _deployedUnits.end();)
-    {
-        BaseUnit* unit = *it;
-        
-        // 安全检查：跳过空指针、已死亡或等待移除的单位
-        if (!unit || unit->isDead() || unit->isPendingRemoval())
-        {
-            ++it;
-            continue;
-        }
-
-        BaseBuilding* target = unit->getTarget();
-
-        // 需要寻找新目标
-        if (!target || target->isDestroyed())
-        {
-            unit->clearTarget();
-
-            BaseBuilding* bestTarget = nullptr;
-            Vec2          unitPos    = unit->getPosition();
-
-            // 目标查找辅助函数
-            auto findTargetWithFilter = [&](std::function<bool(BaseBuilding*)> filter) -> BaseBuilding* {
-                BaseBuilding* closest = nullptr;
-                float         minDist = 999999.0f;
-                for (auto* b : _enemyBuildings)
-                {
-                    if (b && !b->isDestroyed() && filter(b))
-                    {
-                        float dist = unitPos.distance(b->getPosition());
-                        if (dist < minDist)
-                        {
-                            minDist = dist;
-                            closest = b;
-                        }
-                    }
-                }
-                return closest;
-            };
-
-            // 根据单位类型选择优先目标
-            if (unit->getUnitType() == UnitType::kGiant)
-            {
-                // 巨人优先攻击防御建筑
-                bestTarget = findTargetWithFilter([](BaseBuilding* b) { return b->isDefenseBuilding(); });
-            }
-            else if (unit->getUnitType() == UnitType::kGoblin)
-            {
-                // 哥布林优先攻击资源建筑
-                bestTarget = findTargetWithFilter(
-                    [](BaseBuilding* b) { return b->getBuildingType() == BuildingType::kResource; });
-            }
-            else if (unit->getUnitType() == UnitType::kWallBreaker)
-            {
-                // 炸弹人优先攻击城墙
-                bestTarget =
-                    findTargetWithFilter([](BaseBuilding* b) { return b->getBuildingType() == BuildingType::kWall; });
-            }
-
-            // 如果没有优先目标，选择最近的任意建筑
-            if (!bestTarget)
-            {
-                bestTarget = findTargetWithFilter([](BaseBuilding* b) { return true; });
-            }
-
-            if (bestTarget)
-            {
-                unit->setTarget(bestTarget);
-                target = bestTarget;
-                unit->stopMoving();
-            }
-        }
-
-        // 执行攻击或移动逻辑
-        if (target && !target->isDestroyed())
-        {
-            Vec2 targetPos = target->getPosition();
-
-            if (unit->isInAttackRange(targetPos))
-            {
-                // 在攻击范围内
-                if (unit->isMoving())
-                    unit->stopMoving();
-
-                // 🔴 修复：先更新攻击冷却，再检查是否可以攻击
-                unit->updateAttackCooldown(dt);
-                
-                if (unit->isAttackReady())
-                {
-                    // 🔴 修复：在攻击前再次检查目标有效性，防止重复攻击已摧毁的建筑
-                    if (target->isDestroyed())
-                    {
-                        unit->clearTarget();
-                        ++it;
-                        continue;
-                    }
-                    
-                    if (unit->getUnitType() == UnitType::kWallBreaker)
-                    {
-                        // 炸弹人自爆攻击
-                        unit->attack(false);
-                        float damage = unit->getDamage() * 40.0f;
-                        target->takeDamage(static_cast<int>(damage));
-                        unit->die();
-                        
-                        CCLOG("💥 炸弹人自爆攻击: 伤害=%.1f, 目标血量=%d/%d",
-                              damage, target->getHitpoints(), target->getMaxHitpoints());
-                    }
-                    else
-                    {
-                        // 普通攻击
-                        unit->attack(false);
-                        int damage = static_cast<int>(unit->getDamage());
-                        target->takeDamage(damage);
-                        unit->resetAttackCooldown();
-                        
-                        CCLOG("⚔️ %s 攻击 %s: 伤害=%d, 目标血量=%d/%d",
-                              unit->getDisplayName().c_str(), target->getDisplayName().c_str(),
-                              damage, target->getHitpoints(), target->getMaxHitpoints());
-                    }
-
-                    // 检查目标是否被摧毁
-                    if (target->isDestroyed())
-                    {
-                        CCLOG("🔥 %s 被摧毁!", target->getDisplayName().c_str());
-                        unit->clearTarget();
-                        if (gridMap)
-                        {
-                            gridMap->markArea(target->getGridPosition(), target->getGridSize(), false);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                // 不在攻击范围内，需要移动
-                bool needsPathfinding = !unit->isMoving();
-
-                if (needsPathfinding)
-                {
-                    if (gridMap)
-                    {
-                        std::vector<Vec2> path =
-                            PathFinder::getInstance().findPath(gridMap, unit->getPosition(), targetPos, false);
-                        unit->moveToPath(path);
-                    }
-                    else
-                    {
-                        unit->moveTo(targetPos);
-                    }
-                }
-            }
-        }
-
-        ++it;
-    }
+    CCLOG("🪖 部署单位: type=%d, pos=(%.1f,%.1f), 存活单位数=%d", 
+          static_cast<int>(type), position.x, position.y, _world.countAliveUnits());
 }
 
 void BattleManager::activateAllBuildings()
@@ -836,6 +842,8 @@ void BattleManager::activateAllBuildings()
             building->enableBattleMode();
         }
     }
+
+    _world.setDefensesActive(true);
 }
 
 void BattleManager::endBattle(bool surrender)
@@ -844,6 +852,9 @@ void BattleManager::endBattle(bool surrender)
         return;
     _state = BattleState::FINISHED;
 
+    // 追帧中途结束（如超时）时先对齐节点
+    finishCatchUp();
+
     // 处理投降
     if (surrender)
     {
@@ -853,11 +864,21 @@ void BattleManager::endBattle(bool surrender)
 
     if (!_isReplayMode)
     {
-        ReplaySystem::getInstance().recordEndBattle(_currentFrame);
+        ReplaySystem::getInstance().recordEndBattle(_currentFrame + 1);
     }
 
     calculateBattleResult();
 
+    if (_navigation)
+    {
+        _navigation->cancelAll();
+        _navigation->logStats();
+    }
+    PathFinder::getInstance().logCacheStats();
+    _worldView.getNodePool().logStats();
+    UnitAnimationLibrary::getInstance().logStats();
+    SpriteAtlasManager::getInstance().logStats();
+
     // 胜负判定：获得至少1星 或 破坏率>=50% 视为胜利
     bool isVictory = (_starsEarned > 0) || (_destructionPercent >= 50);
 
@@ -941,13 +962,12 @@ void BattleManager::calculateBattleResult()
     int maxGold   = _enemyGameData.gold;
     int maxElixir = _enemyGameData.elixir;
 
-    // 根据星星数量调整掠夺率
-    float baseLootRate = 0.2f;
-    float starBonus    = _starsEarned * 0.1f;
-    float lootRate     = std::min(0.5f, baseLootRate + starBonus);
+    // 掠夺规则与无界面模拟共用
+    BattleSimulator::calculateLoot(_starsEarned, _destructionPercent, maxGold, maxElixir, _goldLooted, _elixirLooted);
 
-    _goldLooted   = static_cast<int>(maxGold * (_destructionPercent / 100.0f) * lootRate);
-    _elixirLooted = static_cast<int>(maxElixir * (_destructionPercent / 100.0f) * lootRate);
+    // 回放只展示战果（定位后可能多次结束），不发放资源
+    if (_isReplayMode)
+        return;
 
     auto& resMgr = ResourceManager::getInstance();
     resMgr.addResource(ResourceType::kGold, _goldLooted);
@@ -974,7 +994,9 @@ void BattleManager::uploadBattleResult()
     defenseLog.trophyChange = -(_starsEarned * 10 - (3 - _starsEarned) * 3);
     defenseLog.timestamp    = getCurrentTimestamp();
     defenseLog.isViewed     = false;
-    defenseLog.replayData   = ReplaySystem::getInstance().stopRecording();
+    defenseLog.replayData   = ReplaySystem::getInstance().stopRecording(&defenseLog.baseSnapshot);
+    if (!defenseLog.baseSnapshot.empty())
+        defenseLog.baseSnapshotHash = ReplaySystem::getInstance().getCurrentReplayData().baseSnapshotHash;
 
     std::string attackerUserId = currentAccount->account.userId;
     std::string enemyUserId = _enemyUserId;
@@ -1092,42 +1114,284 @@ int BattleManager::calculateStars() const
 
 float BattleManager::calculateDestructionRate() const
 {
-    if (_totalBuildingHP <= 0)
+    if (_world.getTotalHitpoints() <= 0)
         return 0.0f;
 
-    return static_cast<float>(_destroyedBuildingHP) / static_cast<float>(_totalBuildingHP);
+    return static_cast<float>(_world.getDestroyedHitpoints()) / static_cast<float>(_world.getTotalHitpoints());
 }
 
 // ============================================================================
 // 时间同步（观战模式）
 // ============================================================================
 
-void BattleManager::setTimeOffset(int64_t elapsed_ms)
+void BattleManager::startCatchUp(int64_t elapsed_ms)
 {
-    // 将毫秒转换为秒
-    float elapsed_seconds = static_cast<float>(elapsed_ms) / 1000.0f;
-    
-    // 确保不超过战斗总时间
-    _elapsedTime = std::min(elapsed_seconds, _battleTime);
-    
-    // 计算对应的帧数
-    _currentFrame = static_cast<unsigned int>(_elapsedTime / FIXED_TIME_STEP);
-    
-    // 如果有时间偏移，说明战斗已经在进行中
-    if (elapsed_ms > 0 && _state == BattleState::READY)
+    if (_isCatchingUp)
+        return;
+
+    // 旧客户端的部署不带帧号、到达即生成，没有可模拟的历史，只同步战斗时钟
+    if (_scheduledDeploys.empty())
+    {
+        CCLOG("📺 [BattleManager] 没有排队的部署，不追帧");
+        applyTimeOffset(elapsed_ms);
+        return;
+    }
+
+    // 至少追到最后一个已知部署的帧，不超过战斗总时间
+    float elapsedSeconds = std::max(static_cast<float>(elapsed_ms) / 1000.0f,
+                                    _scheduledDeploys.back().frame * FIXED_TIME_STEP);
+    elapsedSeconds       = std::min(elapsedSeconds, _battleTime);
+    _accumulatedTime += std::max(0.0f, elapsedSeconds - _currentFrame * FIXED_TIME_STEP);
+
+    _catchUpTargetFrame = 0;
+    beginCatchUp();
+
+    CCLOG("📺 [BattleManager] 开始追帧: 已进行 %lldms, 目标 %.2fs, 排队部署 %zu 个",
+          static_cast<long long>(elapsed_ms), elapsedSeconds, _scheduledDeploys.size());
+}
+
+void BattleManager::applyTimeOffset(int64_t elapsed_ms)
+{
+    if (elapsed_ms <= 0)
+        return;
+
+    _elapsedTime  = std::min(static_cast<float>(elapsed_ms) / 1000.0f, _battleTime);
+    _currentFrame = std::max(_currentFrame, static_cast<unsigned int>(_elapsedTime / FIXED_TIME_STEP));
+
+    // 战斗已经在进行中
+    if (_state == BattleState::READY)
     {
-        _state = BattleState::FIGHTING;
+        _state              = BattleState::FIGHTING;
         _hasDeployedAnyUnit = true;
-        _readyPhaseElapsed = _readyPhaseTime;  // 标记准备阶段已完成
+        _readyPhaseElapsed  = _readyPhaseTime;
+        activateAllBuildings();
     }
-    
-    CCLOG("📺 [BattleManager] 设置时间偏移: %lldms -> %.2fs (帧: %u)", 
-          static_cast<long long>(elapsed_ms), _elapsedTime, _currentFrame);
-    
+
+    CCLOG("📺 [BattleManager] 设置时间偏移: %lldms -> %.2fs (帧: %u)", static_cast<long long>(elapsed_ms),
+          _elapsedTime, _currentFrame);
+
     if (_onUIUpdate)
+        _onUIUpdate();
+}
+
+void BattleManager::beginCatchUp()
+{
+    _isCatchingUp      = true;
+    _catchUpStartFrame = _currentFrame;
+    _catchUpCost       = 0.0;
+
+    // 追帧期间不记录视图事件、不播放音效
+    _world.setRecordEvents(false);
+    AudioManager::GetInstance().SetEffectsSuppressed(true);
+}
+
+void BattleManager::runCatchUp()
+{
+    PROFILE_SCOPE("BattleManager::runCatchUp");
+
+    // 回放定位推进到目标帧，观战追帧推进完累积时间
+    auto pending = [this]() {
+        if (_catchUpTargetFrame != 0)
+            return _currentFrame < _catchUpTargetFrame;
+        return _accumulatedTime >= FIXED_TIME_STEP;
+    };
+
+    // 每个渲染帧只占用一个时间片，画面和网络回调保持响应，期间的实时时间继续累加到 _accumulatedTime
+    auto sliceStart = std::chrono::steady_clock::now();
+    auto sliceEnd   = sliceStart;
+    while (_state == BattleState::FIGHTING && pending())
     {
+        fixedUpdate();
+        if (_catchUpTargetFrame == 0)
+            _accumulatedTime -= FIXED_TIME_STEP;
+
+        sliceEnd = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(sliceEnd - sliceStart).count() >= kCatchUpSliceSeconds)
+            break;
+    }
+    _catchUpCost += std::chrono::duration<double>(sliceEnd - sliceStart).count();
+
+    if (_state != BattleState::FIGHTING || !pending())
+        finishCatchUp();
+}
+
+void BattleManager::finishCatchUp()
+{
+    if (!_isCatchingUp)
+        return;
+    _isCatchingUp = false;
+
+    // 追帧期间没有事件，直接把节点对齐到模拟状态（此时仍屏蔽音效）；
+    // 回放向后定位后，存活但已没有节点的单位在这里重新创建
+    auto snapStart = std::chrono::steady_clock::now();
+    snapViewToWorld();
+    double snapCost = std::chrono::duration<double>(std::chrono::steady_clock::now() - snapStart).count();
+
+    // 高倍速播放中定位时继续保持无事件、无音效
+    _world.setRecordEvents(!_isFastForward);
+    AudioManager::GetInstance().SetEffectsSuppressed(_isFastForward);
+
+    unsigned int frames = _currentFrame - _catchUpStartFrame;
+    CCLOG("📺 [BattleManager] %s完成: %u 帧（战斗时间 %.2fs），耗时 %.1fms，%.0f 回放秒/秒，节点对齐 %.1fms",
+          _catchUpTargetFrame != 0 ? "回放定位" : "追帧", frames, _elapsedTime, _catchUpCost * 1000.0,
+          _catchUpCost > 0.0 ? frames * FIXED_TIME_STEP / _catchUpCost : 0.0, snapCost * 1000.0);
+    _catchUpTargetFrame = 0;
+
+    if (_onUIUpdate)
         _onUIUpdate();
+}
+
+void BattleManager::snapViewToWorld()
+{
+    _worldView.snapToWorld(_world, [this](UnitIndex u) {
+        SimVec2 position = _world.getUnitPosition(u);
+        return createUnitNode(_world.getUnitType(u), Vec2(position.floatX(), position.floatY()));
+    });
+}
+
+void BattleManager::setFastForward(bool enabled)
+{
+    if (!_isReplayMode || _isFastForward == enabled)
+        return;
+    _isFastForward = enabled;
+
+    if (enabled)
+    {
+        _fastForwardStartFrame    = _currentFrame;
+        _fastForwardStartTime     = std::chrono::steady_clock::now();
+        _fastForwardSyncCountdown = 0;
+
+        // 追帧中由 finishCatchUp 按当前模式恢复
+        if (!_isCatchingUp)
+        {
+            // 丢弃尚未播放的事件，收回飞行中的投射物
+            _worldView.snapToWorld(_world);
+            _world.setRecordEvents(false);
+            AudioManager::GetInstance().SetEffectsSuppressed(true);
+        }
+        return;
+    }
+
+    auto         now         = std::chrono::steady_clock::now();
+    double       wallSeconds = std::chrono::duration<double>(now - _fastForwardStartTime).count();
+    unsigned int frames      = _currentFrame - _fastForwardStartFrame;
+    CCLOG("⏩ [BattleManager] 高倍速回放: %u 帧（%.2fs），实际 %.2fs，%.1f 回放秒/秒", frames,
+          frames * FIXED_TIME_STEP, wallSeconds, wallSeconds > 0.0 ? frames * FIXED_TIME_STEP / wallSeconds : 0.0);
+
+    if (!_isCatchingUp)
+    {
+        snapViewToWorld();
+        _world.setRecordEvents(true);
+        AudioManager::GetInstance().SetEffectsSuppressed(false);
+    }
+}
+
+void BattleManager::skipReplayToResult()
+{
+    if (!_isReplayMode || _state != BattleState::FIGHTING)
+        return;
+
+    // 战斗结束时追帧随之结束，目标帧只是上限
+    seekReplay(std::numeric_limits<unsigned int>::max());
+}
+
+void BattleManager::captureKeyframe()
+{
+    if (_state != BattleState::FIGHTING)
+        return;
+
+    // 定位后重新推进已记录过的区间时不重复记录
+    if (!_keyframes.empty() && _keyframes.back().frame >= _currentFrame)
+        return;
+
+    PROFILE_SCOPE("BattleManager::captureKeyframe");
+
+    Keyframe keyframe;
+    keyframe.frame              = _currentFrame;
+    keyframe.elapsedTime        = _elapsedTime;
+    keyframe.starsEarned        = _starsEarned;
+    keyframe.destructionPercent = _destructionPercent;
+    keyframe.townHallDestroyed  = _townHallDestroyed;
+    keyframe.hasDeployedAnyUnit = _hasDeployedAnyUnit;
+    keyframe.troopCounts[0]     = _barbarianCount;
+    keyframe.troopCounts[1]     = _archerCount;
+    keyframe.troopCounts[2]     = _giantCount;
+    keyframe.troopCounts[3]     = _goblinCount;
+    keyframe.troopCounts[4]     = _wallBreakerCount;
+    keyframe.lastChecksumFrame  = _lastChecksumFrame;
+    keyframe.lastChecksum       = _lastChecksum;
+    keyframe.world              = _world;
+    keyframe.world.clearEvents();
+    if (_navigation)
+        _navigation->saveSnapshot(keyframe.navigation);
+
+    _keyframes.push_back(std::move(keyframe));
+}
+
+void BattleManager::restoreKeyframe(const Keyframe& keyframe)
+{
+    PROFILE_SCOPE("BattleManager::restoreKeyframe");
+
+    _world = keyframe.world;
+    if (_navigation && keyframe.navigation.collision)
+        _navigation->restoreSnapshot(keyframe.navigation);
+
+    _currentFrame       = keyframe.frame;
+    _accumulatedTime    = 0.0f;
+    _elapsedTime        = keyframe.elapsedTime;
+    _starsEarned        = keyframe.starsEarned;
+    _destructionPercent = keyframe.destructionPercent;
+    _townHallDestroyed  = keyframe.townHallDestroyed;
+    _hasDeployedAnyUnit = keyframe.hasDeployedAnyUnit;
+    _barbarianCount     = keyframe.troopCounts[0];
+    _archerCount        = keyframe.troopCounts[1];
+    _giantCount         = keyframe.troopCounts[2];
+    _goblinCount        = keyframe.troopCounts[3];
+    _wallBreakerCount   = keyframe.troopCounts[4];
+    _lastChecksumFrame  = keyframe.lastChecksumFrame;
+    _lastChecksum       = keyframe.lastChecksum;
+    _endReason          = BattleEndReason::TIMEOUT;
+    _goldLooted         = 0;
+    _elixirLooted       = 0;
+
+    // 从结算画面定位回战斗中
+    if (_state == BattleState::FINISHED)
+        MusicManager::getInstance().playMusic(MusicType::BATTLE_GOING);
+    _state = BattleState::FIGHTING;
+
+    ReplaySystem::getInstance().seekToFrame(keyframe.frame);
+}
+
+void BattleManager::seekReplay(unsigned int frame)
+{
+    if (!_isReplayMode || _keyframes.empty())
+        return;
+
+    PROFILE_SCOPE("BattleManager::seekReplay");
+    auto start = std::chrono::steady_clock::now();
+
+    // 不晚于目标帧的最近关键帧
+    auto it = std::upper_bound(_keyframes.begin(), _keyframes.end(), frame,
+                               [](unsigned int f, const Keyframe& keyframe) { return f < keyframe.frame; });
+    if (it == _keyframes.begin())
+        return;
+    const Keyframe& keyframe = *std::prev(it);
+
+    // 向前定位且当前状态比关键帧更接近目标时直接继续推进
+    bool continueForward = _state == BattleState::FIGHTING && frame >= _currentFrame && keyframe.frame <= _currentFrame;
+    if (!continueForward)
+    {
+        if (_state == BattleState::FINISHED && frame >= _currentFrame)
+            return;
+        restoreKeyframe(keyframe);
     }
+
+    beginCatchUp();
+    _catchUpTargetFrame = std::max(frame, _currentFrame);
+    _catchUpCost        = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 关键帧间隔内的推进在一个时间片内完成，超出已记录范围时由后续 update 继续
+    runCatchUp();
 }
 
 int64_t BattleManager::getElapsedTimeMs() const
@@ -9,17 +9,21 @@
 #ifndef BATTLE_MANAGER_H_
 #define BATTLE_MANAGER_H_
 
+#include "BattleWorld.h"
 #include "Buildings/BaseBuilding.h"
 #include "Buildings/DefenseBuilding.h"
 #include "GameDataModels.h"
 #include "GridMap.h"
+#include "Managers/BattleWorldView.h"
 #include "Managers/DeploymentValidator.h"
+#include "Managers/GridMapNavigation.h"
 #include "Managers/ReplaySystem.h"
 #include "PathFinder.h"
 #include "Unit/BaseUnit.h"
 #include "Unit/UnitTypes.h"
 #include "cocos2d.h"
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -84,15 +88,29 @@ class BattleManager {
     /**
      * @brief 初始化战斗管理器
      * @param map_layer 地图层
+     * @param grid_map 战斗网格（寻路和部署校验使用；为空时在地图层及其子节点中查找）
      * @param enemy_data 敌方数据
      * @param enemy_user_id 敌方用户ID
      * @param is_replay 是否为回放模式
      */
     void init(cocos2d::Node* map_layer, 
+              GridMap* grid_map,
               const GameStateData& enemy_data, 
               const std::string& enemy_user_id, 
               bool is_replay);
 
+    /**
+     * @brief 设置单位所在的深度排序层（为空时单位直接加入地图层）
+     * @param layer 与建筑共用的 DepthSortLayer
+     */
+    void setDepthLayer(DepthSortLayer* layer) { _depthLayer = layer; }
+
+    /**
+     * @brief 设置战斗血条层（建筑和单位绑定时在其中登记血条）
+     * @param layer 与深度排序层同一坐标系的 HealthBarLayer
+     */
+    void setHealthBarLayer(HealthBarLayer* layer) { _worldView.setHealthBarLayer(layer); }
+
     /**
      * @brief 设置建筑列表
      * @param buildings 建筑列表
@@ -233,19 +251,60 @@ class BattleManager {
      * @brief 远程部署单位
      * @param type 单位类型
      * @param position 部署位置
+     * @param frame 攻击方执行部署时的模拟帧（0 表示未知，立即生成）
+     * @note frame 非 0 时按帧排队，在该帧推进之前生成，与攻击方的模拟顺序一致
      */
-    void deployUnitRemote(UnitType type, const cocos2d::Vec2& position);
+    void deployUnitRemote(UnitType type, const cocos2d::Vec2& position, unsigned int frame = 0);
 
     /** @brief 设置网络部署回调 */
     void setNetworkDeployCallback(
         const std::function<void(UnitType, const cocos2d::Vec2&)>& callback);
 
     /**
-     * @brief 设置时间偏移（用于观战同步）
-     * @param elapsed_ms 已经过的时间（毫秒）
-     * @note 观战者加入时使用此方法同步战斗进度
+     * @brief 开始追帧（观战者加入进行中的战斗时同步进度）
+     * @param elapsed_ms 战斗已进行时间（毫秒）
+     * @note 以已排队的远程部署为输入，后续 update 中不同步节点、不播放音效，
+     *       按固定步长尽快推进到实时进度（至少到最后一个部署的帧），然后对齐节点恢复正常渲染。
+     *       没有排队的部署时（历史操作都来自不带帧号的旧客户端）不追帧，直接按 elapsed_ms 设置战斗时钟。
      */
-    void setTimeOffset(int64_t elapsed_ms);
+    void startCatchUp(int64_t elapsed_ms);
+
+    /** @brief 是否正在追帧 */
+    bool isCatchingUp() const { return _isCatchingUp; }
+
+    /** @brief 获取当前模拟帧 */
+    unsigned int getCurrentFrame() const { return _currentFrame; }
+
+    /** @brief 每个模拟帧的时长（秒） */
+    float getFrameDuration() const { return FIXED_TIME_STEP; }
+
+    /**
+     * @brief 回放定位到指定帧（可前进也可后退）
+     * @param frame 目标帧
+     * @note 从不晚于目标帧的最近关键帧恢复，再按固定步长快速推进到目标帧；
+     *       关键帧在回放推进时每 kKeyframeIntervalFrames 帧记录一次，
+     *       目标超出已记录范围时推进会跨越多个渲染帧（与观战追帧相同的时间片方式）
+     */
+    void seekReplay(unsigned int frame);
+
+    /**
+     * @brief 开启/关闭回放高倍速播放（仅回放模式）
+     * @param enabled 是否开启
+     * @note 开启后每个渲染帧推进多个固定步（单帧耗时受 kCatchUpSliceSeconds 限制），
+     *       模拟保持完整精度；视图不记录事件、不播放动画、投射物和音效，
+     *       每 kFastForwardSyncInterval 个渲染帧对齐一次节点和 UI。
+     *       关闭时节点对齐到模拟状态并恢复事件驱动的表现，日志输出期间的回放秒数 / 实际秒数
+     */
+    void setFastForward(bool enabled);
+
+    /** @brief 是否正在高倍速播放 */
+    bool isFastForward() const { return _isFastForward; }
+
+    /**
+     * @brief 回放直接跳到结果
+     * @note 与回放定位相同的追帧方式推进到战斗结束，中间过程不渲染
+     */
+    void skipReplayToResult();
 
     /**
      * @brief 获取已进行时间（毫秒）
@@ -259,15 +318,21 @@ class BattleManager {
      */
     void skipReadyPhase();
 
+    /** @brief 最近一次计算状态摘要的帧（0 表示尚未计算） */
+    unsigned int getLastChecksumFrame() const { return _lastChecksumFrame; }
+
+    /** @brief 最近一次计算的状态摘要（BattleWorld::computeStateHash） */
+    uint64_t getLastChecksum() const { return _lastChecksum; }
+
  private:
     /** @brief 固定时间步长更新 */
     void fixedUpdate();
     
-    /** @brief 更新战斗状态 */
+    /** @brief 更新战斗状态（推进 BattleWorld 一个固定步） */
     void updateBattleState(float dt);
-    
-    /** @brief 更新单位AI */
-    void updateUnitAI(float dt);
+
+    /** @brief 计算状态摘要，录制时写入回放，回放时与录制结果比较 */
+    void updateStateChecksum();
     
     /** @brief 激活所有建筑 */
     void activateAllBuildings();
@@ -293,6 +358,30 @@ class BattleManager {
     /** @brief 统计存活单位数量 */
     int countAliveUnits() const;
 
+    /**
+     * @brief 生成已到期的排队远程部署
+     * @param frame 当前即将推进的帧，frame 不大于它的部署按入队顺序生成
+     */
+    void applyScheduledDeploys(unsigned int frame);
+
+    /** @brief 进入追帧：关闭视图事件和音效，清零追帧统计 */
+    void beginCatchUp();
+
+    /** @brief 在本渲染帧的时间片内追帧，追上后调用 finishCatchUp */
+    void runCatchUp();
+
+    /** @brief 结束追帧：对齐节点，恢复事件和音效 */
+    void finishCatchUp();
+
+    /**
+     * @brief 直接把战斗时钟设到已进行时间（无法追帧时的退路，单位状态不做模拟）
+     * @param elapsed_ms 战斗已进行时间（毫秒）
+     */
+    void applyTimeOffset(int64_t elapsed_ms);
+
+    /** @brief 把节点对齐到模拟状态，存活但没有节点的单位重新创建 */
+    void snapViewToWorld();
+
     /** @brief 触发战斗正式开始（从 READY 切换到 FIGHTING） */
     void triggerBattleStart();
 
@@ -307,7 +396,43 @@ class BattleManager {
 
     void spawnUnit(UnitType type, const cocos2d::Vec2& position);
 
+    /**
+     * @brief 从对象池取单位节点并加入场景（不加入模拟）
+     * @param type 单位类型
+     * @param position 节点位置
+     * @return BaseUnit* 单位节点，失败返回 nullptr
+     */
+    BaseUnit* createUnitNode(UnitType type, const cocos2d::Vec2& position);
+
+    /** @brief 回放推进到关键帧间隔时记录关键帧 */
+    void captureKeyframe();
+
+    /**
+     * @struct Keyframe
+     * @brief 回放关键帧：恢复后从该帧继续推进与顺序回放完全一致
+     */
+    struct Keyframe {
+        unsigned int frame              = 0;     ///< 已推进的帧
+        float        elapsedTime        = 0.0f;  ///< 战斗已用时间
+        int          starsEarned        = 0;     ///< 星星数
+        int          destructionPercent = 0;     ///< 摧毁百分比
+        bool         townHallDestroyed  = false; ///< 大本营是否被摧毁
+        bool         hasDeployedAnyUnit = false; ///< 是否曾部署过单位
+        int          troopCounts[5]     = {};    ///< 剩余部队（野蛮人、弓箭手、巨人、哥布林、炸弹人）
+        unsigned int lastChecksumFrame  = 0;     ///< 最近一次摘要的帧
+        uint64_t     lastChecksum       = 0;     ///< 最近一次摘要
+        BattleWorld  world;                      ///< 模拟状态
+        GridMapNavigation::Snapshot navigation;  ///< 碰撞地图、寻路缓存和未完成的寻路任务
+    };
+
+    /**
+     * @brief 恢复关键帧（不同步节点）
+     * @param keyframe 关键帧
+     */
+    void restoreKeyframe(const Keyframe& keyframe);
+
     cocos2d::Node* _mapLayer = nullptr;                  ///< 地图层
+    DepthSortLayer* _depthLayer = nullptr;               ///< 单位和建筑的深度排序层
     GameStateData  _enemyGameData;                       ///< 敌方游戏数据
     std::string    _enemyUserId;                         ///< 敌方用户ID
     bool           _isReplayMode = false;                ///< 是否为回放模式
@@ -326,10 +451,11 @@ class BattleManager {
     bool            _townHallDestroyed  = false;                    ///< 大本营是否被摧毁
     bool            _hasDeployedAnyUnit = false;                    ///< 是否曾部署过单位
 
-    std::vector<BaseUnit*>     _deployedUnits;           ///< 已部署的单位
-    std::vector<BaseBuilding*> _enemyBuildings;          ///< 敌方建筑
-    int                        _totalBuildingHP     = 0; ///< 总建筑血量
-    int                        _destroyedBuildingHP = 0; ///< 已摧毁建筑血量
+    std::vector<BaseBuilding*> _enemyBuildings; ///< 敌方建筑
+
+    BattleWorld                        _world;      ///< 战斗模拟（单位/建筑/投射物状态）
+    BattleWorldView                    _worldView;  ///< 每个渲染帧把模拟结果同步到节点
+    std::unique_ptr<GridMapNavigation> _navigation; ///< 网格寻路（地图层为 GridMap 时启用）
 
     int _barbarianCount   = 0; ///< 野蛮人数量
     int _archerCount      = 0; ///< 弓箭手数量
@@ -341,6 +467,9 @@ class BattleManager {
     unsigned int _currentFrame    = 0;            ///< 当前帧
     const float  FIXED_TIME_STEP  = 1.0f / 60.0f; ///< 固定时间步长
 
+    unsigned int _lastChecksumFrame = 0; ///< 最近一次计算状态摘要的帧
+    uint64_t     _lastChecksum      = 0; ///< 最近一次计算的状态摘要
+
     std::function<void()>              _onUIUpdate;     ///< UI更新回调
     std::function<void()>              _onBattleEnd;    ///< 战斗结束回调
     std::function<void()>              _onBattleStart;  ///< 战斗正式开始回调
@@ -351,6 +480,36 @@ class BattleManager {
     bool _isAttacker  = false; ///< 是否为攻击者
     std::function<void(UnitType, const cocos2d::Vec2&)> _onNetworkDeploy; ///< 网络部署回调
 
+    /**
+     * @struct ScheduledDeploy
+     * @brief 等待在指定帧生成的远程部署
+     */
+    struct ScheduledDeploy {
+        unsigned int  frame;    ///< 在该帧推进之前生成
+        UnitType      type;     ///< 单位类型
+        cocos2d::Vec2 position; ///< 部署位置
+    };
+
+    std::vector<ScheduledDeploy> _scheduledDeploys; ///< 按帧排序的远程部署
+
+    static constexpr float kCatchUpSliceSeconds = 0.05f; ///< 追帧时每个渲染帧最多占用的时间（秒）
+
+    bool         _isCatchingUp       = false; ///< 是否正在追帧
+    unsigned int _catchUpStartFrame  = 0;     ///< 追帧开始时的帧
+    unsigned int _catchUpTargetFrame = 0;     ///< 回放定位的目标帧（0 表示按累积时间追帧）
+    double       _catchUpCost        = 0.0;   ///< 追帧累计耗时（秒）
+
+    static constexpr unsigned int kKeyframeIntervalFrames = 300; ///< 回放关键帧间隔（5 秒）
+
+    std::vector<Keyframe> _keyframes; ///< 回放关键帧（按帧递增）
+
+    static constexpr int kFastForwardSyncInterval = 3; ///< 高倍速时每隔多少个渲染帧同步一次节点
+
+    bool         _isFastForward            = false; ///< 是否正在高倍速播放
+    int          _fastForwardSyncCountdown = 0;     ///< 距下一次节点同步的渲染帧数
+    unsigned int _fastForwardStartFrame    = 0;     ///< 开启高倍速时的帧
+    std::chrono::steady_clock::time_point _fastForwardStartTime; ///< 开启高倍速时的实际时间
+
     std::unique_ptr<DeploymentValidator> _deploymentValidator; ///< 部署验证器
 
     /** @brief 返还未使用的部队到库存并保存 */
@@ -0,0 +1,215 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleNodePool.cpp
+ * File Function: 战斗节点对象池实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleNodePool.h"
+
+#include "Unit/BaseUnit.h"
+#include "Unit/UnitFactory.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+constexpr int BattleNodePool::kMaxPrewarmUnitsPerType;
+constexpr int BattleNodePool::kPrewarmProjectilesPerDefense;
+constexpr int BattleNodePool::kProjectileZOrder;
+
+BattleNodePool::~BattleNodePool()
+{
+    clear();
+}
+
+void BattleNodePool::clear()
+{
+    for (auto& pair : _freeUnits)
+    {
+        for (auto* unit : pair.second)
+            unit->release();
+    }
+    _freeUnits.clear();
+
+    recallProjectiles();
+    for (auto& pair : _freeProjectiles)
+    {
+        for (auto* sprite : pair.second)
+        {
+            sprite->removeFromParent();
+            sprite->release();
+        }
+    }
+    _freeProjectiles.clear();
+}
+
+// ==================== 单位 ====================
+
+void BattleNodePool::prewarmUnits(UnitType type, int count)
+{
+    auto& pool   = _freeUnits[type];
+    int   target = std::min(count, kMaxPrewarmUnitsPerType);
+    while (static_cast<int>(pool.size()) < target)
+    {
+        BaseUnit* unit = UnitFactory::createUnit(type);
+        if (!unit)
+            break;
+        unit->retain();
+        pool.push_back(unit);
+        _stats.unitsPrewarmed++;
+    }
+}
+
+BaseUnit* BattleNodePool::acquireUnit(UnitType type, int level)
+{
+    auto& pool = _freeUnits[type];
+    auto  it   = std::find_if(pool.rbegin(), pool.rend(), [level](BaseUnit* unit) { return unit->getLevel() == level; });
+    if (it == pool.rend())
+    {
+        BaseUnit* unit = UnitFactory::createUnit(type, level);
+        if (unit)
+            _stats.unitsCreated++;
+        return unit;
+    }
+
+    BaseUnit* unit = *it;
+    pool.erase(std::next(it).base());
+    _stats.unitsReused++;
+
+    // 池持有的引用交给自动释放池，调用方 addChild 后的引用关系与新建节点相同
+    unit->autorelease();
+    return unit;
+}
+
+void BattleNodePool::recycleUnit(BaseUnit* unit)
+{
+    if (!unit)
+        return;
+
+    if (unit->getParent())
+        unit->removeFromParent();
+    unit->resetForReuse();
+    _freeUnits[unit->getUnitType()].push_back(unit);
+}
+
+// ==================== 投射物 ====================
+
+Sprite* BattleNodePool::createProjectile(DefenseBuilding* defense)
+{
+    Sprite* sprite = defense->createProjectileSprite();
+    if (!sprite)
+        return nullptr;
+
+    sprite->retain();
+    sprite->setVisible(false);
+    if (defense->getParent())
+        defense->getParent()->addChild(sprite, kProjectileZOrder);
+    return sprite;
+}
+
+void BattleNodePool::prewarmProjectiles(DefenseBuilding* defense, int count)
+{
+    if (!defense)
+        return;
+
+    auto& pool = _freeProjectiles[defense->getDefenseType()];
+    for (int i = 0; i < count; ++i)
+    {
+        Sprite* sprite = createProjectile(defense);
+        if (!sprite)
+            break;
+        pool.push_back(sprite);
+        _stats.projectilesPrewarmed++;
+    }
+}
+
+void BattleNodePool::launchProjectile(ProjectileIndex index, DefenseBuilding* defense, const Vec2& endPos)
+{
+    Node* parent = defense ? defense->getParent() : nullptr;
+    if (index < 0 || !parent)
+        return;
+
+    releaseProjectile(index);
+
+    auto&   pool   = _freeProjectiles[defense->getDefenseType()];
+    Sprite* sprite = nullptr;
+    if (!pool.empty())
+    {
+        sprite = pool.back();
+        pool.pop_back();
+        _stats.projectilesReused++;
+    }
+    else
+    {
+        sprite = createProjectile(defense);
+        if (!sprite)
+            return;
+        _stats.projectilesCreated++;
+    }
+
+    if (sprite->getParent() != parent)
+    {
+        sprite->removeFromParent();
+        parent->addChild(sprite, kProjectileZOrder);
+    }
+
+    Vec2 startPos = defense->getPosition();
+    sprite->setPosition(startPos);
+    defense->orientProjectile(sprite, startPos, endPos);
+    sprite->setVisible(true);
+
+    if (index >= static_cast<int>(_activeProjectiles.size()))
+        _activeProjectiles.resize(index + 1);
+    _activeProjectiles[index].sprite = sprite;
+    _activeProjectiles[index].type   = defense->getDefenseType();
+
+    _activeCount++;
+    _stats.projectilesPeak = std::max(_stats.projectilesPeak, _activeCount);
+}
+
+void BattleNodePool::moveProjectile(ProjectileIndex index, const Vec2& position)
+{
+    if (index < 0 || index >= static_cast<int>(_activeProjectiles.size()))
+        return;
+
+    Sprite* sprite = _activeProjectiles[index].sprite;
+    if (sprite)
+        sprite->setPosition(position);
+}
+
+void BattleNodePool::releaseProjectile(ProjectileIndex index)
+{
+    if (index < 0 || index >= static_cast<int>(_activeProjectiles.size()))
+        return;
+
+    ActiveProjectile& projectile = _activeProjectiles[index];
+    if (!projectile.sprite)
+        return;
+
+    projectile.sprite->setVisible(false);
+    _freeProjectiles[projectile.type].push_back(projectile.sprite);
+    projectile.sprite = nullptr;
+    _activeCount--;
+}
+
+void BattleNodePool::recallProjectiles()
+{
+    for (auto& projectile : _activeProjectiles)
+    {
+        if (!projectile.sprite)
+            continue;
+        projectile.sprite->setVisible(false);
+        _freeProjectiles[projectile.type].push_back(projectile.sprite);
+    }
+    _activeProjectiles.clear();
+    _activeCount = 0;
+}
+
+void BattleNodePool::logStats() const
+{
+    CCLOG("♻️ 对象池: 单位 预热=%d 新建=%d 复用=%d | 投射物 预热=%d 新建=%d 复用=%d 峰值=%d", _stats.unitsPrewarmed,
+          _stats.unitsCreated, _stats.unitsReused, _stats.projectilesPrewarmed, _stats.projectilesCreated,
+          _stats.projectilesReused, _stats.projectilesPeak);
+}
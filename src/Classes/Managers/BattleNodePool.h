@@ -0,0 +1,151 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleNodePool.h
+ * File Function: 战斗节点对象池 - 复用单位节点和投射物精灵，战斗加载时按部署预热
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_NODE_POOL_H__
+#define __BATTLE_NODE_POOL_H__
+
+#include "BattleTypes.h"
+#include "Buildings/DefenseBuilding.h"
+#include "Unit/UnitTypes.h"
+#include "cocos2d.h"
+
+#include <map>
+#include <vector>
+
+class BaseUnit;
+
+/**
+ * @struct BattleNodePoolStats
+ * @brief 一场战斗中对象池的分配统计
+ */
+struct BattleNodePoolStats
+{
+    int unitsPrewarmed       = 0; ///< 加载时预热创建的单位节点
+    int unitsCreated         = 0; ///< 战斗中池为空时新建的单位节点
+    int unitsReused          = 0; ///< 从池中取出的单位节点
+    int projectilesPrewarmed = 0; ///< 加载时预热创建的投射物精灵
+    int projectilesCreated   = 0; ///< 战斗中池为空时新建的投射物精灵
+    int projectilesReused    = 0; ///< 从池中取出的投射物精灵
+    int projectilesPeak      = 0; ///< 同时飞行的投射物峰值
+};
+
+/**
+ * @class BattleNodePool
+ * @brief 战斗节点对象池（由 BattleWorldView 持有，生命周期与战斗场景相同）
+ *
+ * - 单位：按 UnitType 分池。死亡淡出后由视图层回收，resetForReuse 恢复满血和待机状态，
+ *   已加载的精灵、动画缓存和血条全部保留
+ * - 投射物：按 DefenseType 分池。精灵一直挂在建筑层下，空闲时隐藏；
+ *   精灵与 BattleWorld 的投射物槽位一一对应，只跟随模拟位置，命中后回收，
+ *   不为每一发创建 MoveTo / CallFunc / Sequence 动作
+ * - 池持有空闲和飞行中节点各一个引用，clear 时统一释放
+ */
+class BattleNodePool
+{
+public:
+    static constexpr int kMaxPrewarmUnitsPerType       = 300;  ///< 每种单位最多预热的节点数
+    static constexpr int kPrewarmProjectilesPerDefense = 2;    ///< 每座防御建筑预热的投射物数
+    static constexpr int kProjectileZOrder             = 5000; ///< 投射物层级
+
+    BattleNodePool() = default;
+    ~BattleNodePool();
+
+    BattleNodePool(const BattleNodePool&) = delete;
+    BattleNodePool& operator=(const BattleNodePool&) = delete;
+
+    /** @brief 释放池中所有节点 */
+    void clear();
+
+    /** @brief 清零分配统计（新战斗开始时调用） */
+    void resetStats() { _stats = BattleNodePoolStats(); }
+
+    /**
+     * @brief 预热单位节点，使池中空闲数量达到 count（不超过 kMaxPrewarmUnitsPerType）
+     * @param type 单位类型
+     * @param count 期望的空闲数量（通常为该兵种的部署数量）
+     */
+    void prewarmUnits(UnitType type, int count);
+
+    /**
+     * @brief 取出一个单位节点，池中没有同等级的节点时新建
+     * @param type 单位类型
+     * @param level 单位等级
+     * @return BaseUnit* 单位节点（autorelease，与 UnitFactory::createUnit 一致），失败返回 nullptr
+     */
+    BaseUnit* acquireUnit(UnitType type, int level = 1);
+
+    /**
+     * @brief 回收已从父节点移除的单位节点
+     * @param unit 单位节点，调用方持有的一个引用转交给池
+     */
+    void recycleUnit(BaseUnit* unit);
+
+    /**
+     * @brief 为防御建筑预热投射物精灵（挂到建筑的父节点下并隐藏）
+     * @param defense 防御建筑
+     * @param count 预热数量
+     */
+    void prewarmProjectiles(DefenseBuilding* defense, int count);
+
+    /**
+     * @brief 为模拟中的投射物显示精灵（仅表现，伤害由 BattleWorld 结算）
+     * @param index 投射物在 BattleWorld 中的槽位，槽位上已有精灵时先回收
+     * @param defense 防御建筑（精灵从建筑位置出发）
+     * @param endPos 落点（决定箭矢朝向）
+     */
+    void launchProjectile(ProjectileIndex index, DefenseBuilding* defense, const cocos2d::Vec2& endPos);
+
+    /**
+     * @brief 把槽位上的精灵移到模拟位置，槽位没有精灵时忽略
+     * @param index 投射物槽位
+     * @param position 模拟中的当前位置
+     */
+    void moveProjectile(ProjectileIndex index, const cocos2d::Vec2& position);
+
+    /**
+     * @brief 投射物命中后回收槽位上的精灵
+     * @param index 投射物槽位
+     */
+    void releaseProjectile(ProjectileIndex index);
+
+    /** @brief 收回所有飞行中的投射物 */
+    void recallProjectiles();
+
+    /** @brief 获取分配统计 */
+    const BattleNodePoolStats& getStats() const { return _stats; }
+
+    /** @brief 输出分配统计日志 */
+    void logStats() const;
+
+private:
+    /**
+     * @struct ActiveProjectile
+     * @brief 飞行中的投射物精灵
+     */
+    struct ActiveProjectile
+    {
+        cocos2d::Sprite* sprite = nullptr; ///< 为空表示槽位没有精灵
+        DefenseType      type   = DefenseType::kCannon;
+    };
+
+    /**
+     * @brief 新建一个投射物精灵并由池持有引用
+     * @param defense 防御建筑
+     * @return cocos2d::Sprite* 精灵，失败返回 nullptr
+     */
+    cocos2d::Sprite* createProjectile(DefenseBuilding* defense);
+
+    std::map<UnitType, std::vector<BaseUnit*>>            _freeUnits;         ///< 空闲单位节点
+    std::map<DefenseType, std::vector<cocos2d::Sprite*>> _freeProjectiles;   ///< 空闲投射物精灵
+    std::vector<ActiveProjectile>                         _activeProjectiles; ///< 模拟槽位 -> 飞行中的精灵
+    int                                                   _activeCount = 0;   ///< 飞行中的精灵数
+    BattleNodePoolStats                                   _stats;             ///< 分配统计
+};
+
+#endif // __BATTLE_NODE_POOL_H__
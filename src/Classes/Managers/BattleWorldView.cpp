@@ -0,0 +1,295 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleWorldView.cpp
+ * File Function: 战斗视图层实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "BattleWorldView.h"
+
+#include "BattleWorld.h"
+#include "Buildings/BaseBuilding.h"
+#include "Buildings/DefenseBuilding.h"
+#include "UI/HealthBarLayer.h"
+#include "Unit/BaseUnit.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+namespace
+{
+
+Vec2 toVec2(const SimVec2& v)
+{
+    return Vec2(v.floatX(), v.floatY());
+}
+
+} // namespace
+
+BattleWorldView::~BattleWorldView()
+{
+    reset();
+    CC_SAFE_RELEASE_NULL(_healthBars);
+}
+
+void BattleWorldView::reset()
+{
+    for (auto* unit : _units)
+    {
+        if (unit)
+            unit->release();
+    }
+    _units.clear();
+    _buildings.clear();
+    if (_healthBars)
+        _healthBars->clear();
+    _depthSort.reset();
+    _pool.recallProjectiles();
+    _pool.resetStats();
+}
+
+void BattleWorldView::setHealthBarLayer(HealthBarLayer* layer)
+{
+    if (_healthBars == layer)
+        return;
+
+    CC_SAFE_RETAIN(layer);
+    if (_healthBars)
+    {
+        _healthBars->clear();
+        _healthBars->release();
+    }
+    _healthBars = layer;
+}
+
+void BattleWorldView::bindBuilding(BuildingIndex index, BaseBuilding* building)
+{
+    if (index >= static_cast<int>(_buildings.size()))
+        _buildings.resize(index + 1, nullptr);
+    _buildings[index] = building;
+
+    // 建筑在战斗中不会移动，层级只在加载时设置一次
+    _depthSort.addStatic(building);
+
+    if (_healthBars)
+        building->attachHealthBarLayer(_healthBars);
+
+    if (auto* defense = dynamic_cast<DefenseBuilding*>(building))
+        _pool.prewarmProjectiles(defense, BattleNodePool::kPrewarmProjectilesPerDefense);
+}
+
+void BattleWorldView::bindUnit(UnitIndex index, BaseUnit* unit)
+{
+    if (index >= static_cast<int>(_units.size()))
+        _units.resize(index + 1, nullptr);
+
+    // 回放向后定位后重新部署时同一下标可能还绑着旧节点（仍在深度层中、占着血条），先交还对象池
+    if (_units[index] && _units[index] != unit)
+        recycleUnit(index);
+
+    // 单位死亡后会自行淡出并 removeFromParent，这里持有引用，确认移除后交给对象池
+    if (unit)
+        unit->retain();
+    if (_units[index])
+        _units[index]->release();
+    _units[index] = unit;
+
+    _depthSort.setDynamic(index, unit, unit ? unit->getPositionY() : 0.0f);
+
+    if (unit && _healthBars)
+        unit->attachHealthBarLayer(_healthBars);
+}
+
+void BattleWorldView::sync(BattleWorld& world)
+{
+    for (const auto& event : world.getEvents())
+    {
+        playEvent(event);
+    }
+    world.clearEvents();
+
+    int count = std::min(world.getUnitCount(), static_cast<int>(_units.size()));
+    for (UnitIndex u = 0; u < count; ++u)
+    {
+        BaseUnit* unit = _units[u];
+        if (!unit)
+            continue;
+
+        if (unit->isPendingRemoval())
+        {
+            _depthSort.removeDynamic(u);
+            _pool.recycleUnit(unit);
+            _units[u] = nullptr;
+            continue;
+        }
+
+        if (!world.isUnitAlive(u))
+            continue;
+
+        SimVec2 position = world.getUnitPosition(u);
+        unit->setPosition(toVec2(position));
+        _depthSort.updateDynamic(u, position.floatY());
+    }
+
+    // 投射物精灵只跟随模拟位置，命中和伤害都在模拟中结算
+    int projectileCount = world.getProjectileSlotCount();
+    for (ProjectileIndex p = 0; p < projectileCount; ++p)
+    {
+        if (world.isProjectileAlive(p))
+            _pool.moveProjectile(p, toVec2(world.getProjectilePosition(p)));
+    }
+}
+
+void BattleWorldView::snapToWorld(BattleWorld& world, const std::function<BaseUnit*(UnitIndex)>& createUnit)
+{
+    world.clearEvents();
+    _pool.recallProjectiles();
+
+    int buildingCount = std::min(world.getBuildingCount(), static_cast<int>(_buildings.size()));
+    for (BuildingIndex b = 0; b < buildingCount; ++b)
+    {
+        if (_buildings[b])
+            _buildings[b]->syncHitpoints(world.getBuildingHitpoints(b));
+    }
+
+    // 定位到更早的帧时，之后才部署的单位不再存在
+    for (UnitIndex u = world.getUnitCount(); u < static_cast<int>(_units.size()); ++u)
+    {
+        if (_units[u])
+            recycleUnit(u);
+    }
+    if (static_cast<int>(_units.size()) > world.getUnitCount())
+        _units.resize(world.getUnitCount());
+
+    int count = world.getUnitCount();
+    for (UnitIndex u = 0; u < count; ++u)
+    {
+        BaseUnit* unit = u < static_cast<int>(_units.size()) ? _units[u] : nullptr;
+
+        // 追帧期间死亡的单位不再播放死亡动画；模拟中复活的单位不能沿用死亡中的节点
+        if (unit && (!world.isUnitAlive(u) || unit->isPendingRemoval() || unit->isDead()))
+        {
+            recycleUnit(u);
+            unit = nullptr;
+        }
+
+        if (!world.isUnitAlive(u))
+            continue;
+
+        if (!unit)
+        {
+            if (!createUnit)
+                continue;
+            unit = createUnit(u);
+            if (!unit)
+                continue;
+            bindUnit(u, unit);
+        }
+
+        SimVec2 position = world.getUnitPosition(u);
+        unit->setPosition(toVec2(position));
+        unit->syncHitpoints(world.getUnitHitpoints(u));
+        _depthSort.updateDynamic(u, position.floatY());
+
+        if (world.isUnitMoving(u))
+            unit->moveTo(toVec2(world.getUnitMoveTarget(u)));
+        else
+            unit->stopMoving();
+    }
+}
+
+void BattleWorldView::syncState(BattleWorld& world)
+{
+    _pool.recallProjectiles();
+
+    int buildingCount = std::min(world.getBuildingCount(), static_cast<int>(_buildings.size()));
+    for (BuildingIndex b = 0; b < buildingCount; ++b)
+    {
+        if (_buildings[b])
+            _buildings[b]->syncHitpoints(world.getBuildingHitpoints(b));
+    }
+
+    int count = std::min(world.getUnitCount(), static_cast<int>(_units.size()));
+    for (UnitIndex u = 0; u < count; ++u)
+    {
+        BaseUnit* unit = _units[u];
+        if (!unit)
+            continue;
+
+        if (!world.isUnitAlive(u) || unit->isPendingRemoval() || unit->isDead())
+        {
+            recycleUnit(u);
+            continue;
+        }
+
+        SimVec2 position = world.getUnitPosition(u);
+        unit->setPosition(toVec2(position));
+        unit->syncHitpoints(world.getUnitHitpoints(u));
+        _depthSort.updateDynamic(u, position.floatY());
+    }
+}
+
+void BattleWorldView::recycleUnit(UnitIndex index)
+{
+    BaseUnit* unit = _units[index];
+    unit->attachHealthBarLayer(nullptr);
+    _depthSort.removeDynamic(index);
+    _pool.recycleUnit(unit);
+    _units[index] = nullptr;
+}
+
+void BattleWorldView::playEvent(const BattleEvent& event)
+{
+    BaseUnit* unit = (event.unit >= 0 && event.unit < static_cast<int>(_units.size())) ? _units[event.unit] : nullptr;
+    BaseBuilding* building =
+        (event.building >= 0 && event.building < static_cast<int>(_buildings.size())) ? _buildings[event.building]
+                                                                                       : nullptr;
+
+    switch (event.type)
+    {
+    case BattleEventType::kUnitMoveStarted:
+        // 节点只用来切换朝向和奔跑动画，位置以模拟为准
+        if (unit)
+        {
+            unit->setPosition(toVec2(event.from));
+            unit->moveTo(toVec2(event.to));
+        }
+        break;
+    case BattleEventType::kUnitStopped:
+        if (unit)
+            unit->stopMoving();
+        break;
+    case BattleEventType::kUnitAttacked:
+        if (unit)
+            unit->attack(false);
+        break;
+    case BattleEventType::kUnitDamaged:
+        if (unit)
+            unit->syncHitpoints(event.value);
+        break;
+    case BattleEventType::kUnitDied:
+        if (unit)
+            unit->die();
+        break;
+    case BattleEventType::kBuildingDamaged:
+        if (building)
+            building->takeDamage(event.value);
+        break;
+    case BattleEventType::kBuildingDestroyed:
+        if (building)
+            CCLOG("🔥 %s 被摧毁!", building->getDisplayName().c_str());
+        break;
+    case BattleEventType::kProjectileFired:
+        if (auto* defense = dynamic_cast<DefenseBuilding*>(building))
+        {
+            _pool.launchProjectile(event.projectile, defense, toVec2(event.to));
+            defense->playAttackAnimation();
+        }
+        break;
+    case BattleEventType::kProjectileHit:
+        _pool.releaseProjectile(event.projectile);
+        break;
+    }
+}
@@ -0,0 +1,111 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     BattleWorldView.h
+ * File Function: 战斗视图层 - 每个渲染帧把 BattleWorld 的状态同步到 cocos2d 节点
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __BATTLE_WORLD_VIEW_H__
+#define __BATTLE_WORLD_VIEW_H__
+
+#include "BattleTypes.h"
+#include "Managers/BattleNodePool.h"
+#include "Managers/DepthSortService.h"
+
+#include <functional>
+#include <vector>
+
+class BattleWorld;
+class BaseBuilding;
+class BaseUnit;
+class HealthBarLayer;
+
+/**
+ * @class BattleWorldView
+ * @brief 战斗视图层
+ *
+ * 只读取模拟结果，不参与规则计算：
+ * - 播放 BattleWorld 产生的事件（动画、受击、死亡、投射物飞行）
+ * - 同步单位位置；层级交给 DepthSortService（建筑绑定时设置一次，单位跨越深度桶时才更新）
+ * - 单位节点在死亡淡出并被移除后回收到 BattleNodePool；投射物精灵按模拟槽位从对象池取出，
+ *   每帧跟随模拟位置，命中事件到达时回收
+ * - 绑定的建筑和单位在 HealthBarLayer 中登记血条，受伤时由 takeDamage / syncHitpoints 通知
+ */
+class BattleWorldView
+{
+public:
+    BattleWorldView() = default;
+    ~BattleWorldView();
+
+    BattleWorldView(const BattleWorldView&) = delete;
+    BattleWorldView& operator=(const BattleWorldView&) = delete;
+
+    /** @brief 解除所有绑定（含血条），收回飞行中的投射物并清零对象池统计（池中的空闲节点保留） */
+    void reset();
+
+    /**
+     * @brief 设置血条层（持有引用，reset 后仍然保留）
+     * @param layer 血条层
+     */
+    void setHealthBarLayer(HealthBarLayer* layer);
+
+    /**
+     * @brief 绑定建筑节点
+     * @param index 建筑在 BattleWorld 中的下标
+     * @param building 建筑节点
+     */
+    void bindBuilding(BuildingIndex index, BaseBuilding* building);
+
+    /**
+     * @brief 绑定单位节点（持有引用直到节点被移除）
+     * @param index 单位在 BattleWorld 中的下标
+     * @param unit 单位节点
+     */
+    void bindUnit(UnitIndex index, BaseUnit* unit);
+
+    /**
+     * @brief 播放并清空模拟事件，同步单位和投射物位置
+     * @param world 战斗世界
+     */
+    void sync(BattleWorld& world);
+
+    /**
+     * @brief 不播放事件，直接把节点对齐到模拟的当前状态（观战追帧、回放定位结束时使用）
+     *
+     * 追帧期间不记录事件：已死亡单位的节点直接回收，存活单位和建筑同步位置、
+     * 生命值和移动目标，之后由 sync 继续按事件驱动。
+     * 回放向后定位时模拟会回到更早的状态：超出单位数的节点和正在播放死亡动画的节点被回收，
+     * 存活但没有节点的单位由 createUnit 重新创建；飞行中的投射物全部收回。
+     * @param world 战斗世界
+     * @param createUnit 为存活单位创建节点（已加入场景），为空时不创建
+     */
+    void snapToWorld(BattleWorld& world, const std::function<BaseUnit*(UnitIndex)>& createUnit = nullptr);
+
+    /**
+     * @brief 高倍速回放时的节点同步：只对齐位置、生命值和死亡状态
+     *
+     * 调用方已关闭事件记录。死亡单位的节点直接回收（不播放死亡动画），
+     * 存活单位只设置位置，不切换奔跑和攻击动画；投射物不显示，已显示的全部收回。
+     * @param world 战斗世界
+     */
+    void syncState(BattleWorld& world);
+
+    /** @brief 获取节点对象池（部署时取单位节点、加载时预热） */
+    BattleNodePool& getNodePool() { return _pool; }
+
+private:
+    void playEvent(const BattleEvent& event);
+
+    /** @brief 回收单位节点并解除绑定 */
+    void recycleUnit(UnitIndex index);
+
+    std::vector<BaseBuilding*> _buildings; ///< 建筑下标 -> 节点
+    std::vector<BaseUnit*>     _units;     ///< 单位下标 -> 节点，已移除的为空
+    DepthSortService           _depthSort;            ///< 节点层级
+    BattleNodePool             _pool;                 ///< 单位和投射物对象池
+    HealthBarLayer*            _healthBars = nullptr; ///< 血条层
+};
+
+#endif // __BATTLE_WORLD_VIEW_H__
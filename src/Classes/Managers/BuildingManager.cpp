@@ -13,6 +13,7 @@
 #include "Managers/UpgradeManager.h"
 #include "Managers/TroopInventory.h"
 #include "Managers/BuildingLimitManager.h"
+#include "Managers/FrameProfiler.h"
 #include "Managers/OccupiedGridOverlay.h"
 #include "ArmyBuilding.h"
 #include "ArmyCampBuilding.h"
@@ -28,6 +29,26 @@
 #include <map>
 
 USING_NS_CC;
+
+namespace
+{
+
+/** @brief 去掉序列化名称中的等级后缀和括号残留，例如 "Gold Mine (Lv.3)" -> "Gold Mine" */
+std::string stripSerialNameSuffix(std::string name)
+{
+    size_t lvPos = name.find(" (Lv.");
+    if (lvPos == std::string::npos)
+        lvPos = name.find(" Lv.");
+    if (lvPos != std::string::npos)
+        name = name.substr(0, lvPos);
+
+    size_t bracketPos = name.find(" (");
+    if (bracketPos != std::string::npos)
+        name = name.substr(0, bracketPos);
+    return name;
+}
+
+} // namespace
 bool BuildingManager::init()
 {
     if (!Node::init()) 
@@ -303,7 +324,7 @@ void BuildingManager::placeBuilding(const cocos2d::Vec2& gridPos)
     // ZOrder 越大越在前面，所以 Y 小的对象会在前面（靠屏幕上方）
     // 这符合 2.5D 游戏的深度逻辑
     building->setLocalZOrder(10000 - static_cast<int>(buildingPos.y));
-    _mapSprite->addChild(building);
+    getBuildingParent()->addChild(building);
     // 5. 播放落地动画
     building->setScale(0.0f);
     auto scaleAction = EaseBackOut::create(ScaleTo::create(0.4f, targetScale));
@@ -499,6 +520,8 @@ void BuildingManager::endPlacing()
 }
 void BuildingManager::update(float dt)
 {
+    PROFILE_SCOPE("BuildingManager::update");
+
     UpgradeManager::getInstance()->update(dt);
 
     // 更新建筑状态和升级UI
@@ -724,7 +747,7 @@ void BuildingManager::showOccupiedGrids(bool autoFadeOut)
         return;
     
     this->stopAllActions();
-    _occupiedGridOverlay->showOccupiedGrids(_buildings);
+    _occupiedGridOverlay->showOccupiedGrids();
 }
 
 void BuildingManager::hideOccupiedGrids()
@@ -738,7 +761,7 @@ void BuildingManager::updateGrassLayer()
 {
     if (!_occupiedGridOverlay)
         return;
-    _occupiedGridOverlay->updateGrassLayer(_buildings);
+    _occupiedGridOverlay->showGrassLayer();
 }
 
 cocos2d::Vec2 BuildingManager::calculateBuildingPositionForMoving(const cocos2d::Vec2& gridPos) const
@@ -949,7 +972,7 @@ void BuildingManager::loadBuildingsFromData(const std::vector<BuildingSerialData
         building->setLocalZOrder(10000 - static_cast<int>(centerPos.y));
         
         // 添加到地图
-        _mapSprite->addChild(building);
+        getBuildingParent()->addChild(building);
         _buildings.pushBack(building);
         
         // 标记网格占用
@@ -1238,21 +1261,10 @@ void BuildingManager::restoreArmyCampTroopDisplays()
 
 BaseBuilding* BuildingManager::createBuildingFromSerialData(const BuildingSerialData& data)
 {
-    std::string name = data.name;
+    // 移除等级后缀和括号残留
+    std::string name = stripSerialNameSuffix(data.name);
     int level = data.level;
     
-    // 移除等级后缀
-    size_t lvPos = name.find(" (Lv.");
-    if (lvPos == std::string::npos)
-        lvPos = name.find(" Lv.");
-    if (lvPos != std::string::npos)
-        name = name.substr(0, lvPos);
-    
-    // 移除括号残留
-    size_t bracketPos = name.find(" (");
-    if (bracketPos != std::string::npos)
-        name = name.substr(0, bracketPos);
-    
     // 根据名称创建建筑
     if (name.find("Town Hall") != std::string::npos || name.find("大本营") != std::string::npos)
     {
@@ -1304,4 +1316,35 @@ BaseBuilding* BuildingManager::createBuildingFromSerialData(const BuildingSerial
     {
         return nullptr;
     }
+}
+
+std::string BuildingManager::getImageFileForSerialData(const BuildingSerialData& data)
+{
+    std::string name = stripSerialNameSuffix(data.name);
+    int level = data.level;
+
+    // 判断顺序与 createBuildingFromSerialData 相同
+    if (name.find("Town Hall") != std::string::npos || name.find("大本营") != std::string::npos)
+        return BaseBuilding::getStaticConfig(BuildingType::kTownHall, level).imageFile;
+    if (name.find("Gold Mine") != std::string::npos || name.find("金矿") != std::string::npos)
+        return ResourceBuilding::getImageFileFor(ResourceBuildingType::kGoldMine, level);
+    if (name.find("Elixir Collector") != std::string::npos || name.find("圣水收集器") != std::string::npos)
+        return ResourceBuilding::getImageFileFor(ResourceBuildingType::kElixirCollector, level);
+    if (name.find("Gold Storage") != std::string::npos || name.find("金币仓库") != std::string::npos)
+        return ResourceBuilding::getImageFileFor(ResourceBuildingType::kGoldStorage, level);
+    if (name.find("Elixir Storage") != std::string::npos || name.find("圣水仓库") != std::string::npos)
+        return ResourceBuilding::getImageFileFor(ResourceBuildingType::kElixirStorage, level);
+    if (name.find("Barracks") != std::string::npos || name.find("兵营") != std::string::npos)
+        return BaseBuilding::getStaticConfig(BuildingType::kArmy, level).imageFile;
+    if (name.find("Army Camp") != std::string::npos || name.find("军营") != std::string::npos)
+        return BaseBuilding::getStaticConfig(BuildingType::kArmyCamp, level).imageFile;
+    if (name.find("Wall") != std::string::npos || name.find("城墙") != std::string::npos)
+        return BaseBuilding::getStaticConfig(BuildingType::kWall, level).imageFile;
+    if (name.find("Builder") != std::string::npos || name.find("建筑工人") != std::string::npos)
+        return BuildersHutBuilding::getImageFileFor(level);
+    if (name.find("Archer Tower") != std::string::npos || name.find("箭塔") != std::string::npos)
+        return DefenseBuilding::getImageFileFor(DefenseType::kArcherTower, level);
+    if (name.find("Cannon") != std::string::npos || name.find("加农炮") != std::string::npos)
+        return DefenseBuilding::getImageFileFor(DefenseType::kCannon, level);
+    return std::string();
 }
\ No newline at end of file
@@ -37,6 +37,12 @@ public:
      */
     void setup(cocos2d::Sprite* mapSprite, GridMap* gridMap);
 
+    /**
+     * @brief 设置建筑节点的父节点（战斗场景使用 DepthSortLayer，为空时直接加入地图精灵）
+     * @param layer 建筑层，坐标系须与地图精灵一致
+     */
+    void setBuildingLayer(cocos2d::Node* layer) { _buildingLayer = layer; }
+
     // ==================== 建造模式 ====================
     /**
      * @brief 进入建造模式
@@ -124,6 +130,13 @@ public:
      */
     void loadBuildingsFromData(const std::vector<BuildingSerialData>& buildingsData, bool isReadOnly = false);
 
+    /**
+     * @brief 获取序列化建筑对应的图片路径（与 createBuildingFromSerialData 的名称匹配规则一致，不创建实体）
+     * @param data 序列化数据
+     * @return std::string 图片路径，未知建筑返回空串
+     */
+    static std::string getImageFileForSerialData(const BuildingSerialData& data);
+
     /**
      * @brief 清空所有建筑（切换账号或加载新地图前调用）
      * @param clearTroops 是否同时清空士兵库存（默认true，攻击别人时设为false）
@@ -206,11 +219,17 @@ public:
     void hideOccupiedGrids();
 
     /**
-     * @brief 更新草坪图层（常态显示）
+     * @brief 显示草坪图层（常态显示，内容随 GridMap::markArea 自动更新）
      */
     void updateGrassLayer();
 
     // ==================== 内部方法 ====================
+    /** @brief 建筑节点的父节点 */
+    cocos2d::Node* getBuildingParent() const
+    {
+        return _buildingLayer ? _buildingLayer : static_cast<cocos2d::Node*>(_mapSprite);
+    }
+
     /**
      * @brief 在指定网格位置放置建筑
      * @param gridPos 网格坐标
@@ -280,8 +299,9 @@ public:
     void PlayBuildingPickupSound(BaseBuilding* building);
 
     // ==================== 成员变量 ====================
-    cocos2d::Sprite* _mapSprite = nullptr; // 地图精灵引用
-    GridMap*         _gridMap   = nullptr; // 网格地图引用
+    cocos2d::Sprite* _mapSprite     = nullptr; // 地图精灵引用
+    cocos2d::Node*   _buildingLayer = nullptr; // 建筑父节点（为空时使用地图精灵）
+    GridMap*         _gridMap       = nullptr; // 网格地图引用
 
     // 建造模式状态
     bool             _isBuildingMode     = false;   // 是否在建造模式
@@ -0,0 +1,746 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     DefenseLogStore.cpp
+ * File Function: 防守日志存储实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "DefenseLogStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+constexpr size_t DefenseLogStore::kDefaultCacheBytes;
+constexpr size_t DefenseLogStore::kSegmentBytes;
+
+namespace
+{
+
+const char     kIndexMagic[4]  = {'D', 'L', 'I', 'X'};
+const char     kRecordMagic[4] = {'D', 'L', 'R', 'B'};
+const uint8_t  kIndexVersion   = 2; ///< 2：增加基地快照列表和日志引用的快照哈希
+const uint64_t kRecordHeader   = 4 + 8 + 4 + 8; ///< 魔数 + 日志ID + 长度 + 校验
+
+const uint64_t kFnvOffset = 14695981039346656037ULL;
+const uint64_t kFnvPrime  = 1099511628211ULL;
+
+uint64_t fnv1a(const std::string& data)
+{
+    uint64_t hash = kFnvOffset;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// ==================== 小端编码 ====================
+
+void putU32(std::string& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+}
+
+void putU64(std::string& out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+}
+
+void putString(std::string& out, const std::string& value)
+{
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+/**
+ * @class ByteReader
+ * @brief 顺序读取小端编码，越界后所有读取失败
+ */
+class ByteReader
+{
+public:
+    ByteReader(const char* data, size_t size) : _data(data), _size(size) {}
+
+    bool ok() const { return _ok; }
+
+    uint8_t u8()
+    {
+        if (!require(1))
+            return 0;
+        return static_cast<uint8_t>(_data[_pos++]);
+    }
+
+    uint32_t u32()
+    {
+        if (!require(4))
+            return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(_data[_pos++])) << (i * 8);
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        if (!require(8))
+            return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(_data[_pos++])) << (i * 8);
+        return value;
+    }
+
+    std::string str()
+    {
+        uint32_t length = u32();
+        if (!require(length))
+            return std::string();
+        std::string value(_data + _pos, length);
+        _pos += length;
+        return value;
+    }
+
+    bool magic(const char (&expected)[4])
+    {
+        if (!require(4) || std::memcmp(_data + _pos, expected, 4) != 0)
+        {
+            _ok = false;
+            return false;
+        }
+        _pos += 4;
+        return true;
+    }
+
+private:
+    bool require(size_t bytes)
+    {
+        if (_ok && _size - _pos >= bytes)
+            return true;
+        _ok = false;
+        return false;
+    }
+
+    const char* _data;
+    size_t      _size;
+    size_t      _pos = 0;
+    bool        _ok  = true;
+};
+
+bool readWholeFile(const std::string& path, std::string& outData)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    outData = oss.str();
+    return true;
+}
+
+uint64_t fileSize(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return 0;
+    std::streamoff size = file.tellg();
+    return size > 0 ? static_cast<uint64_t>(size) : 0;
+}
+
+} // namespace
+
+DefenseLogStore::DefenseLogStore(size_t cacheCapacityBytes) : _cacheCapacity(cacheCapacityBytes) {}
+
+// ==================== 打开/关闭 ====================
+
+bool DefenseLogStore::open(const std::string& directory)
+{
+    close();
+    _directory = directory;
+
+    // 替换索引时中断会只留下临时文件
+    bool existed = readIndex(indexPath());
+    if (!existed && readIndex(indexPath() + ".tmp"))
+    {
+        existed = true;
+        _dirty  = true;
+    }
+
+    // 段文件以实际大小为准：追加回放后、写索引前中断时，段尾的记录没有日志引用
+    for (size_t i = 0; i < _segments.size(); ++i)
+    {
+        uint64_t size = fileSize(segmentPath(_segments[i].id));
+        if (size != _segments[i].size)
+        {
+            _segments[i].size = std::max(size, _segments[i].size);
+            _dirty            = true;
+        }
+    }
+
+    // 写入快照文件前中断时索引中有哈希但没有文件
+    size_t baseCount = _bases.size();
+    _bases.erase(std::remove_if(_bases.begin(), _bases.end(),
+                                [this](uint64_t hash) { return fileSize(basePath(hash)) == 0; }),
+                 _bases.end());
+    if (_bases.size() != baseCount)
+        _dirty = true;
+
+    // 段文件或引用的快照丢失时日志保留，但不再有回放
+    for (size_t i = 0; i < _logs.size(); ++i)
+    {
+        if (_logs[i].replaySize == 0)
+            continue;
+        bool baseMissing = _logs[i].baseSnapshotHash != 0 &&
+                           std::find(_bases.begin(), _bases.end(), _logs[i].baseSnapshotHash) == _bases.end();
+        if (baseMissing || fileSize(segmentPath(_blobs[i].segment)) == 0)
+        {
+            _logs[i].replaySize       = 0;
+            _logs[i].baseSnapshotHash = 0;
+            _blobs[i]                 = BlobLocation();
+            _dirty                    = true;
+        }
+    }
+
+    collectGarbage();
+    flush();
+    return existed;
+}
+
+void DefenseLogStore::close()
+{
+    flush();
+
+    _directory.clear();
+    _logs.clear();
+    _blobs.clear();
+    _segments.clear();
+    _bases.clear();
+    _nextLogId     = 1;
+    _nextSegmentId = 1;
+    _dirty         = false;
+
+    _cache.clear();
+    _cacheIndex.clear();
+    _cacheBytes = 0;
+}
+
+// ==================== 日志 ====================
+
+uint64_t DefenseLogStore::add(const DefenseLog& log, size_t maxLogs)
+{
+    DefenseLog entry = log;
+    entry.id         = _nextLogId++;
+    entry.replaySize = 0;
+    entry.replayData.clear();
+    entry.baseSnapshot.clear();
+
+    // 快照先于回放保存：回放写入失败时快照没有引用，由下一次垃圾回收删除
+    BlobLocation location;
+    bool         baseReady = log.baseSnapshotHash == 0 || storeBase(log.baseSnapshotHash, log.baseSnapshot);
+    if (!log.replayData.empty() && baseReady && appendBlob(entry.id, log.replayData, location))
+        entry.replaySize = location.size;
+    else
+        entry.baseSnapshotHash = 0;
+
+    _logs.insert(_logs.begin(), entry);
+    _blobs.insert(_blobs.begin(), location);
+
+    // 超出保留数量的最旧日志，其回放由垃圾回收处理
+    bool evicted = false;
+    while (_logs.size() > maxLogs)
+    {
+        cacheErase(_logs.back().id);
+        _logs.pop_back();
+        _blobs.pop_back();
+        evicted = true;
+    }
+    if (evicted)
+        collectGarbage();
+
+    _dirty = true;
+    flush();
+    return entry.id;
+}
+
+bool DefenseLogStore::readReplay(uint64_t logId, std::string& outData)
+{
+    auto cached = _cacheIndex.find(logId);
+    if (cached != _cacheIndex.end())
+    {
+        _cache.splice(_cache.begin(), _cache, cached->second);
+        outData = cached->second->second;
+        ++_cacheHits;
+        return true;
+    }
+
+    for (size_t i = 0; i < _logs.size(); ++i)
+    {
+        if (_logs[i].id != logId)
+            continue;
+        if (_logs[i].replaySize == 0 || !readBlob(logId, _blobs[i], outData))
+            return false;
+
+        ++_cacheMisses;
+        cachePut(logId, outData);
+        return true;
+    }
+    return false;
+}
+
+bool DefenseLogStore::readBaseSnapshot(uint64_t logId, std::string& outJson) const
+{
+    for (const auto& log : _logs)
+    {
+        if (log.id != logId)
+            continue;
+        if (log.replaySize == 0 || log.baseSnapshotHash == 0)
+            return false;
+
+        std::string json;
+        if (!readWholeFile(basePath(log.baseSnapshotHash), json) || fnv1a(json) != log.baseSnapshotHash)
+            return false;
+
+        outJson.swap(json);
+        return true;
+    }
+    return false;
+}
+
+void DefenseLogStore::markAllAsViewed()
+{
+    for (auto& log : _logs)
+    {
+        if (!log.isViewed)
+        {
+            log.isViewed = true;
+            _dirty       = true;
+        }
+    }
+    flush();
+}
+
+void DefenseLogStore::clear()
+{
+    _logs.clear();
+    _blobs.clear();
+    _cache.clear();
+    _cacheIndex.clear();
+    _cacheBytes = 0;
+
+    // 没有日志后所有段都不再有存活回放，由垃圾回收先写索引再删除
+    _dirty = true;
+    collectGarbage();
+    flush();
+}
+
+void DefenseLogStore::flush()
+{
+    if (_dirty && isOpen())
+        writeIndex();
+}
+
+DefenseLogStoreStats DefenseLogStore::getStats() const
+{
+    DefenseLogStoreStats stats;
+    stats.segmentCount = _segments.size();
+    for (const auto& segment : _segments)
+    {
+        stats.diskBytes += static_cast<size_t>(segment.size);
+        stats.liveBytes += static_cast<size_t>(segment.liveBytes);
+    }
+    stats.cacheBytes    = _cacheBytes;
+    stats.cacheHits     = _cacheHits;
+    stats.cacheMisses   = _cacheMisses;
+    stats.segmentsFreed = _segmentsFreed;
+    stats.baseSnapshots = _bases.size();
+    return stats;
+}
+
+// ==================== 索引 ====================
+
+std::string DefenseLogStore::segmentPath(uint32_t segment) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "seg_%06u.dat", segment);
+    return _directory + name;
+}
+
+std::string DefenseLogStore::indexPath() const
+{
+    return _directory + "index.dat";
+}
+
+std::string DefenseLogStore::basePath(uint64_t hash) const
+{
+    char name[40];
+    std::snprintf(name, sizeof(name), "base_%016llx.json", static_cast<unsigned long long>(hash));
+    return _directory + name;
+}
+
+bool DefenseLogStore::readIndex(const std::string& path)
+{
+    std::string data;
+    if (!readWholeFile(path, data))
+        return false;
+
+    ByteReader reader(data.data(), data.size());
+    if (!reader.magic(kIndexMagic))
+        return false;
+    uint8_t version = reader.u8();
+    if (version == 0 || version > kIndexVersion)
+        return false;
+
+    uint64_t nextLogId     = reader.u64();
+    uint32_t nextSegmentId = reader.u32();
+
+    std::vector<Segment> segments(reader.ok() ? std::min<uint32_t>(reader.u32(), 1u << 16) : 0);
+    for (auto& segment : segments)
+    {
+        segment.id   = reader.u32();
+        segment.size = reader.u64();
+    }
+
+    std::vector<uint64_t> bases(version >= 2 && reader.ok() ? std::min<uint32_t>(reader.u32(), 1u << 16) : 0);
+    for (auto& hash : bases)
+        hash = reader.u64();
+
+    uint32_t                  logCount = reader.u32();
+    std::vector<DefenseLog>   logs;
+    std::vector<BlobLocation> blobs;
+    for (uint32_t i = 0; i < logCount && reader.ok(); ++i)
+    {
+        DefenseLog log;
+        log.id           = reader.u64();
+        log.attackerId   = reader.str();
+        log.attackerName = reader.str();
+        log.timestamp    = reader.str();
+        log.starsLost    = static_cast<int32_t>(reader.u32());
+        log.goldLost     = static_cast<int32_t>(reader.u32());
+        log.elixirLost   = static_cast<int32_t>(reader.u32());
+        log.trophyChange = static_cast<int32_t>(reader.u32());
+        log.isViewed     = reader.u8() != 0;
+
+        BlobLocation location;
+        location.segment = reader.u32();
+        location.offset  = reader.u64();
+        location.size    = reader.u32();
+        location.hash    = reader.u64();
+        log.replaySize   = location.size;
+        if (version >= 2)
+            log.baseSnapshotHash = reader.u64();
+
+        logs.push_back(log);
+        blobs.push_back(location);
+    }
+    if (!reader.ok())
+        return false;
+
+    _logs.swap(logs);
+    _blobs.swap(blobs);
+    _segments.swap(segments);
+    _bases.swap(bases);
+    _nextLogId     = nextLogId;
+    _nextSegmentId = nextSegmentId;
+    return true;
+}
+
+bool DefenseLogStore::writeIndex()
+{
+    std::string data(kIndexMagic, kIndexMagic + 4);
+    data.push_back(static_cast<char>(kIndexVersion));
+    putU64(data, _nextLogId);
+    putU32(data, _nextSegmentId);
+
+    putU32(data, static_cast<uint32_t>(_segments.size()));
+    for (const auto& segment : _segments)
+    {
+        putU32(data, segment.id);
+        putU64(data, segment.size);
+    }
+
+    putU32(data, static_cast<uint32_t>(_bases.size()));
+    for (uint64_t hash : _bases)
+        putU64(data, hash);
+
+    putU32(data, static_cast<uint32_t>(_logs.size()));
+    for (size_t i = 0; i < _logs.size(); ++i)
+    {
+        const DefenseLog&   log      = _logs[i];
+        const BlobLocation& location = _blobs[i];
+        putU64(data, log.id);
+        putString(data, log.attackerId);
+        putString(data, log.attackerName);
+        putString(data, log.timestamp);
+        putU32(data, static_cast<uint32_t>(log.starsLost));
+        putU32(data, static_cast<uint32_t>(log.goldLost));
+        putU32(data, static_cast<uint32_t>(log.elixirLost));
+        putU32(data, static_cast<uint32_t>(log.trophyChange));
+        data.push_back(log.isViewed ? 1 : 0);
+        putU32(data, location.segment);
+        putU64(data, location.offset);
+        putU32(data, location.size);
+        putU64(data, location.hash);
+        putU64(data, log.baseSnapshotHash);
+    }
+
+    // 先完整写入临时文件再替换，中断时旧索引或临时文件至少有一个完整
+    std::string tmpPath = indexPath() + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file)
+            return false;
+    }
+    std::remove(indexPath().c_str());
+    if (std::rename(tmpPath.c_str(), indexPath().c_str()) != 0)
+        return false;
+
+    _dirty = false;
+    return true;
+}
+
+// ==================== 段文件 ====================
+
+bool DefenseLogStore::appendBlob(uint64_t logId, const std::string& data, BlobLocation& outLocation)
+{
+    if (_segments.empty() || _segments.back().size >= kSegmentBytes)
+    {
+        Segment segment;
+        segment.id = _nextSegmentId++;
+        _segments.push_back(segment);
+        _dirty = true;
+    }
+    Segment& segment = _segments.back();
+
+    std::ofstream file(segmentPath(segment.id), std::ios::binary | std::ios::app);
+    if (!file)
+        return false;
+    file.seekp(0, std::ios::end);
+    std::streamoff offset = file.tellp();
+    if (offset < 0)
+        return false;
+
+    std::string header(kRecordMagic, kRecordMagic + 4);
+    putU64(header, logId);
+    putU32(header, static_cast<uint32_t>(data.size()));
+    uint64_t hash = fnv1a(data);
+    putU64(header, hash);
+
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    file.flush();
+
+    // 写入失败的部分记录留在段尾，作为垃圾计入段大小
+    uint64_t recordBytes = kRecordHeader + data.size();
+    segment.size         = static_cast<uint64_t>(offset) + recordBytes;
+    _dirty               = true;
+    if (!file)
+        return false;
+
+    segment.liveBytes += recordBytes;
+    outLocation.segment = segment.id;
+    outLocation.offset  = static_cast<uint64_t>(offset);
+    outLocation.size    = static_cast<uint32_t>(data.size());
+    outLocation.hash    = hash;
+    return true;
+}
+
+bool DefenseLogStore::readBlob(uint64_t logId, const BlobLocation& location, std::string& outData) const
+{
+    std::ifstream file(segmentPath(location.segment), std::ios::binary);
+    if (!file)
+        return false;
+    file.seekg(static_cast<std::streamoff>(location.offset));
+
+    char header[kRecordHeader];
+    if (!file.read(header, sizeof(header)))
+        return false;
+
+    ByteReader reader(header, sizeof(header));
+    if (!reader.magic(kRecordMagic) || reader.u64() != logId || reader.u32() != location.size ||
+        reader.u64() != location.hash)
+        return false;
+
+    std::string data(location.size, '\0');
+    if (location.size > 0 && !file.read(&data[0], location.size))
+        return false;
+    if (fnv1a(data) != location.hash)
+        return false;
+
+    outData.swap(data);
+    return true;
+}
+
+DefenseLogStore::Segment* DefenseLogStore::findSegment(uint32_t id)
+{
+    for (auto& segment : _segments)
+    {
+        if (segment.id == id)
+            return &segment;
+    }
+    return nullptr;
+}
+
+// ==================== 基地快照 ====================
+
+bool DefenseLogStore::storeBase(uint64_t hash, const std::string& json)
+{
+    // 已登记但文件没写成功的快照重新写入
+    bool listed = std::find(_bases.begin(), _bases.end(), hash) != _bases.end();
+    if (listed && fileSize(basePath(hash)) > 0)
+        return true;
+    if (json.empty() || fnv1a(json) != hash || !isOpen())
+        return false;
+
+    if (!listed)
+    {
+        _bases.push_back(hash);
+        if (!writeIndex())
+        {
+            _bases.pop_back();
+            return false;
+        }
+    }
+
+    std::string path    = basePath(hash);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        if (!file)
+            return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool DefenseLogStore::isBaseReferenced(uint64_t hash) const
+{
+    for (const auto& log : _logs)
+    {
+        if (log.replaySize > 0 && log.baseSnapshotHash == hash)
+            return true;
+    }
+    return false;
+}
+
+// ==================== 垃圾回收 ====================
+
+void DefenseLogStore::collectGarbage()
+{
+    for (auto& segment : _segments)
+        segment.liveBytes = 0;
+    for (size_t i = 0; i < _logs.size(); ++i)
+    {
+        if (_logs[i].replaySize == 0)
+            continue;
+        if (Segment* segment = findSegment(_blobs[i].segment))
+            segment->liveBytes += kRecordHeader + _blobs[i].size;
+    }
+
+    // 存活比例低于一半的旧段：存活回放搬到当前段（appendBlob 可能追加新段，按编号处理）
+    std::vector<uint32_t> sparse;
+    for (size_t s = 0; s + 1 < _segments.size(); ++s)
+    {
+        if (_segments[s].liveBytes > 0 && _segments[s].liveBytes * 2 < _segments[s].size)
+            sparse.push_back(_segments[s].id);
+    }
+    for (uint32_t id : sparse)
+    {
+        for (size_t i = 0; i < _logs.size(); ++i)
+        {
+            if (_logs[i].replaySize == 0 || _blobs[i].segment != id)
+                continue;
+
+            std::string  data;
+            BlobLocation moved;
+            if (readBlob(_logs[i].id, _blobs[i], data) && appendBlob(_logs[i].id, data, moved))
+            {
+                _blobs[i] = moved;
+            }
+            else
+            {
+                _logs[i].replaySize = 0;
+                _blobs[i]           = BlobLocation();
+            }
+        }
+        if (Segment* segment = findSegment(id))
+            segment->liveBytes = 0;
+    }
+
+    // 没有存活回放的段直接删除（包括当前段，下一次追加时新建）
+    std::vector<uint32_t> dead;
+    for (const auto& segment : _segments)
+    {
+        if (segment.liveBytes == 0)
+            dead.push_back(segment.id);
+    }
+
+    std::vector<uint64_t> unusedBases;
+    for (uint64_t hash : _bases)
+    {
+        if (!isBaseReferenced(hash))
+            unusedBases.push_back(hash);
+    }
+
+    // 删除文件之前先让索引指向搬迁后的位置：删除过程中中断时，索引不会引用已删除的段或快照；
+    // 索引写入失败时保留这些文件，下一次回收再处理
+    if ((!dead.empty() || !unusedBases.empty()) && isOpen() && !writeIndex())
+        return;
+    for (uint32_t id : dead)
+        removeSegment(id);
+    for (uint64_t hash : unusedBases)
+    {
+        std::remove(basePath(hash).c_str());
+        _bases.erase(std::find(_bases.begin(), _bases.end(), hash));
+        _dirty = true;
+    }
+}
+
+void DefenseLogStore::removeSegment(uint32_t id)
+{
+    std::remove(segmentPath(id).c_str());
+    _segments.erase(std::remove_if(_segments.begin(), _segments.end(),
+                                   [id](const Segment& segment) { return segment.id == id; }),
+                    _segments.end());
+    ++_segmentsFreed;
+    _dirty = true;
+}
+
+// ==================== 回放缓存 ====================
+
+void DefenseLogStore::cachePut(uint64_t logId, const std::string& data)
+{
+    cacheErase(logId);
+    if (data.size() > _cacheCapacity)
+        return;
+
+    _cache.emplace_front(logId, data);
+    _cacheIndex[logId] = _cache.begin();
+    _cacheBytes += data.size();
+
+    while (_cacheBytes > _cacheCapacity)
+    {
+        _cacheBytes -= _cache.back().second.size();
+        _cacheIndex.erase(_cache.back().first);
+        _cache.pop_back();
+    }
+}
+
+void DefenseLogStore::cacheErase(uint64_t logId)
+{
+    auto it = _cacheIndex.find(logId);
+    if (it == _cacheIndex.end())
+        return;
+
+    _cacheBytes -= it->second->second.size();
+    _cache.erase(it->second);
+    _cacheIndex.erase(it);
+}
@@ -0,0 +1,217 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     DefenseLogStore.h
+ * File Function: 防守日志存储 - 元数据索引 + 追加写的回放段文件，回放带 LRU 缓存和垃圾回收
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __DEFENSE_LOG_STORE_H__
+#define __DEFENSE_LOG_STORE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct DefenseLog
+ * @brief 防守日志记录（元数据，回放数据单独存放）
+ */
+struct DefenseLog
+{
+    uint64_t id = 0;               ///< 日志ID（由存储分配）
+    std::string attackerId;        ///< 攻击者ID
+    std::string attackerName;      ///< 攻击者名称
+    int starsLost = 0;             ///< 失去星数
+    int goldLost = 0;              ///< 失去金币
+    int elixirLost = 0;            ///< 失去圣水
+    int trophyChange = 0;          ///< 奖杯变化
+    std::string timestamp;         ///< 时间戳
+    bool isViewed = false;         ///< 是否已查看
+    uint32_t replaySize = 0;       ///< 回放字节数（0 表示没有回放）
+    std::string replayData;        ///< 回放数据（仅在添加日志时传入，存储后不驻留内存）
+    uint64_t baseSnapshotHash = 0; ///< 回放引用的基地快照哈希（0 表示快照内嵌在回放中）
+    std::string baseSnapshot;      ///< 基地快照 JSON（仅在添加日志时传入，同一哈希只保存一份）
+};
+
+/**
+ * @struct DefenseLogStoreStats
+ * @brief 存储统计
+ */
+struct DefenseLogStoreStats
+{
+    size_t segmentCount  = 0; ///< 段文件数
+    size_t diskBytes     = 0; ///< 段文件总字节数
+    size_t liveBytes     = 0; ///< 仍被日志引用的记录字节数
+    size_t cacheBytes    = 0; ///< 缓存中的回放字节数
+    size_t cacheHits     = 0; ///< 读取回放命中缓存次数
+    size_t cacheMisses   = 0; ///< 读取回放未命中次数（从段文件读取）
+    size_t segmentsFreed = 0; ///< 回收的段文件数
+    size_t baseSnapshots = 0; ///< 基地快照文件数
+};
+
+/**
+ * @class DefenseLogStore
+ * @brief 单个账号的防守日志存储（目录内的文件由本类独占）
+ *
+ * - index.dat：全部日志的元数据和回放位置，每次修改后整体重写（先写临时文件再替换），
+ *   打开日志界面只读取索引，不读取任何回放字节
+ * - seg_<编号>.dat：回放数据只追加写入当前段，每条记录带魔数、日志ID、长度和 FNV-1a 校验，
+ *   当前段超过 kSegmentBytes 后换新段
+ * - 日志超出保留数量或被清空后，其回放成为垃圾：不再有存活回放的段直接删除，
+ *   存活比例低于一半的旧段把存活回放搬到当前段后删除
+ * - base_<哈希>.json：回放按哈希引用的基地快照，多条日志共用一份；
+ *   没有日志引用后随垃圾回收删除
+ * - 最近读取的回放保存在按字节数限制的 LRU 缓存中
+ */
+class DefenseLogStore
+{
+public:
+    /**
+     * @brief 构造
+     * @param cacheCapacityBytes 回放缓存容量（字节）
+     */
+    explicit DefenseLogStore(size_t cacheCapacityBytes = kDefaultCacheBytes);
+
+    /**
+     * @brief 打开存储目录（目录需已存在），只读取索引
+     * @param directory 目录路径（以路径分隔符结尾）
+     * @return bool 目录中已有索引时返回 true，新建的空存储返回 false
+     */
+    bool open(const std::string& directory);
+
+    /** @brief 关闭存储，清空内存中的日志和缓存 */
+    void close();
+
+    /** @brief 是否已打开 */
+    bool isOpen() const { return !_directory.empty(); }
+
+    /** @brief 全部日志（最新在前，不含回放数据） */
+    const std::vector<DefenseLog>& getLogs() const { return _logs; }
+
+    /**
+     * @brief 添加日志，回放追加写入当前段
+     * @param log 日志（replayData 为回放数据，可以为空；baseSnapshotHash 不为 0 时
+     *            baseSnapshot 为回放引用的基地快照，该哈希已保存过时可以为空）
+     * @param maxLogs 最多保留的日志数，超出的最旧日志连同回放被回收
+     * @return uint64_t 新日志的ID，回放或基地快照写入失败时日志不带回放
+     */
+    uint64_t add(const DefenseLog& log, size_t maxLogs);
+
+    /**
+     * @brief 读取回放（优先从缓存读取）
+     * @param logId 日志ID
+     * @param outData 回放数据
+     * @return bool 日志存在、有回放且校验通过
+     */
+    bool readReplay(uint64_t logId, std::string& outData);
+
+    /**
+     * @brief 读取日志回放引用的基地快照
+     * @param logId 日志ID
+     * @param outJson 基地快照 JSON
+     * @return bool 日志引用了快照、文件存在且内容哈希一致
+     */
+    bool readBaseSnapshot(uint64_t logId, std::string& outJson) const;
+
+    /** @brief 标记所有日志为已查看 */
+    void markAllAsViewed();
+
+    /** @brief 删除全部日志并回收所有段文件和基地快照 */
+    void clear();
+
+    /** @brief 有未保存的修改时重写索引 */
+    void flush();
+
+    /** @brief 获取统计数据 */
+    DefenseLogStoreStats getStats() const;
+
+    static constexpr size_t kDefaultCacheBytes = 2 * 1024 * 1024; ///< 默认回放缓存容量
+    static constexpr size_t kSegmentBytes      = 256 * 1024;      ///< 当前段超过该大小后换新段
+
+private:
+    /**
+     * @struct BlobLocation
+     * @brief 回放在段文件中的位置
+     */
+    struct BlobLocation
+    {
+        uint32_t segment = 0; ///< 段编号
+        uint64_t offset  = 0; ///< 记录在段内的偏移（记录头起点）
+        uint32_t size    = 0; ///< 回放字节数
+        uint64_t hash    = 0; ///< 回放 FNV-1a 校验
+    };
+
+    /**
+     * @struct Segment
+     * @brief 段文件信息
+     */
+    struct Segment
+    {
+        uint32_t id        = 0; ///< 段编号
+        uint64_t size      = 0; ///< 文件字节数
+        uint64_t liveBytes = 0; ///< 仍被引用的记录字节数（含记录头）
+    };
+
+    std::string segmentPath(uint32_t segment) const;
+    std::string indexPath() const;
+    std::string basePath(uint64_t hash) const;
+
+    bool readIndex(const std::string& path);
+    bool writeIndex();
+
+    /** @brief 把回放追加到当前段（必要时换新段） */
+    bool appendBlob(uint64_t logId, const std::string& data, BlobLocation& outLocation);
+
+    /** @brief 从段文件读取并校验回放 */
+    bool readBlob(uint64_t logId, const BlobLocation& location, std::string& outData) const;
+
+    Segment* findSegment(uint32_t id);
+
+    /**
+     * @brief 保存基地快照（该哈希已保存时不重复写入）
+     * @note 先把哈希写入索引再写文件，中断时索引中没有文件的快照在打开时丢弃，不会留下无人记录的文件
+     */
+    bool storeBase(uint64_t hash, const std::string& json);
+
+    /** @brief 是否还有带回放的日志引用该基地快照 */
+    bool isBaseReferenced(uint64_t hash) const;
+
+    /**
+     * @brief 按日志重新统计各段的存活字节数，压缩存活比例过低的旧段，
+     *        删除无存活回放的段和不再被引用的基地快照
+     * @note 删除任何文件之前先重写索引，索引写入失败时本次不删除
+     */
+    void collectGarbage();
+
+    /** @brief 删除段文件 */
+    void removeSegment(uint32_t id);
+
+    void cachePut(uint64_t logId, const std::string& data);
+    void cacheErase(uint64_t logId);
+
+    using CacheList = std::list<std::pair<uint64_t, std::string>>;
+
+    std::string               _directory;             ///< 存储目录
+    std::vector<DefenseLog>   _logs;                  ///< 日志（最新在前）
+    std::vector<BlobLocation> _blobs;                 ///< 与 _logs 一一对应的回放位置
+    std::vector<Segment>      _segments;              ///< 段（按编号递增，最后一个为当前段）
+    std::vector<uint64_t>     _bases;                 ///< 已保存的基地快照哈希
+    uint64_t                  _nextLogId     = 1;     ///< 下一个日志ID
+    uint32_t                  _nextSegmentId = 1;     ///< 下一个段编号
+    bool                      _dirty         = false; ///< 索引是否有未保存的修改
+
+    CacheList                                         _cache;             ///< 按最近使用排序，表头最新
+    std::unordered_map<uint64_t, CacheList::iterator> _cacheIndex;        ///< 日志ID -> 缓存节点
+    size_t                                            _cacheBytes    = 0; ///< 缓存中的字节数
+    size_t                                            _cacheCapacity = 0; ///< 缓存容量
+    size_t                                            _cacheHits     = 0; ///< 缓存命中次数
+    size_t                                            _cacheMisses   = 0; ///< 缓存未命中次数
+    size_t                                            _segmentsFreed = 0; ///< 已回收的段数
+};
+
+#endif // __DEFENSE_LOG_STORE_H__
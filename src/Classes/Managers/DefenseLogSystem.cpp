@@ -3,7 +3,7 @@
  * File Name:     DefenseLogSystem.cpp
  * File Function: 防守日志系统 - 记录和管理玩家的防守日志
  * Author:        赵崇治
- * Update Date:   2025/12/14
+ * Update Date:   2026/10/18
  * License:       MIT License
  ****************************************************************/
 #include "DefenseLogSystem.h"
@@ -15,53 +15,23 @@
 #include "base/base64.h"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 #include <exception>
 #include <stdexcept>
 
 USING_NS_CC;
 using namespace ui;
 
-// ==================== DefenseLog 序列化 ====================
+// ==================== 旧版日志格式 ====================
 
-std::string DefenseLog::serialize() const
+namespace
 {
-    try {
-        // Sanitize attackerName
-        std::string safeName = attackerName;
-        std::replace(safeName.begin(), safeName.end(), '|', ' ');
-        std::replace(safeName.begin(), safeName.end(), '\n', ' ');
-        std::replace(safeName.begin(), safeName.end(), '\r', ' ');
-
-        // Encode replayData
-        std::string encodedReplay = "";
-        if (!replayData.empty())
-        {
-            char* encoded = nullptr;
-            base64Encode((const unsigned char*)replayData.c_str(), (unsigned int)replayData.length(), &encoded);
-            if (encoded)
-            {
-                encodedReplay = "B64:" + std::string(encoded);
-                free(encoded);
-            }
-            else
-            {
-                encodedReplay = replayData;
-            }
-        }
 
-        std::ostringstream oss;
-        oss << attackerId << "|" << safeName << "|" << starsLost << "|" 
-            << goldLost << "|" << elixirLost << "|" << trophyChange << "|" 
-            << timestamp << "|" << (isViewed ? "1" : "0") << "|" << encodedReplay;
-        return oss.str();
-    }
-    catch (const std::exception& e) {
-        CCLOG("❌ DefenseLog::serialize 异常: %s", e.what());
-        return "";
-    }
-}
-
-DefenseLog DefenseLog::deserialize(const std::string& data)
+/**
+ * @brief 解析旧版 UserDefault 中的一行日志
+ * @note 回放字段为 "B64:" 前缀的 Base64、"FILE:" 前缀的回放文件名或回放原文
+ */
+DefenseLog parseLegacyLog(const std::string& data)
 {
     DefenseLog log;
     try {
@@ -95,10 +65,6 @@ DefenseLog DefenseLog::deserialize(const std::string& data)
                 log.replayData = std::string((char*)decoded, len);
                 free(decoded);
             }
-            else
-            {
-                log.replayData = ""; // Decode failed
-            }
         }
         else
         {
@@ -106,11 +72,13 @@ DefenseLog DefenseLog::deserialize(const std::string& data)
         }
     }
     catch (const std::exception& e) {
-        CCLOG("❌ DefenseLog::deserialize 异常: %s", e.what());
+        CCLOG("❌ parseLegacyLog 异常: %s", e.what());
     }
     return log;
 }
 
+} // namespace
+
 // ==================== DefenseLogSystem ====================
 
 DefenseLogSystem& DefenseLogSystem::getInstance()
@@ -121,40 +89,17 @@ DefenseLogSystem& DefenseLogSystem::getInstance()
 
 void DefenseLogSystem::addDefenseLog(const DefenseLog& log)
 {
-    DefenseLog newLog = log;
-    
-    // 🆕 Offload replay data to file to avoid UserDefault size limits
-    if (!newLog.replayData.empty() && newLog.replayData.find("FILE:") != 0)
+    if (!_store.isOpen())
     {
-        // Generate unique filename: replay_ATTACKER_TIMESTAMP_RAND.dat
-        std::string timestamp = StringUtils::toString((long)time(nullptr));
-        std::string random = StringUtils::toString(rand() % 1000);
-        std::string filename = "replay_" + newLog.attackerId + "_" + timestamp + "_" + random + ".dat";
-        std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
-        
-        if (FileUtils::getInstance()->writeStringToFile(newLog.replayData, fullPath))
-        {
-            CCLOG("💾 Saved replay data to file: %s (Size: %zu)", filename.c_str(), newLog.replayData.length());
-            newLog.replayData = "FILE:" + filename;
-        }
-        else
-        {
-            CCLOG("❌ Failed to save replay data to file! Falling back to inline storage.");
-        }
+        CCLOG("❌ 防守日志存储未打开，丢弃日志");
+        return;
     }
 
-    _logs.insert(_logs.begin(), newLog);  // 插入到最前面（最新）
-    
-    // 限制日志数量
-    if (_logs.size() > MAX_LOGS)
-    {
-        _logs.resize(MAX_LOGS);
-    }
+    // 回放追加写入段文件，内存中只保留元数据；超出 MAX_LOGS 的旧日志及其回放被回收
+    _store.add(log, static_cast<size_t>(MAX_LOGS));
     
-    save();
-    
-    CCLOG("🛡️ 新增防守日志: 被 %s 攻击，失去 %d 金币，%d 圣水", 
-          log.attackerName.c_str(), log.goldLost, log.elixirLost);
+    CCLOG("🛡️ 新增防守日志: 被 %s 攻击，失去 %d 金币，%d 圣水（回放 %zu 字节）", 
+          log.attackerName.c_str(), log.goldLost, log.elixirLost, log.replayData.size());
     
     // 🆕 同步更新玩家资源（扣除损失）
     auto& accMgr = AccountManager::getInstance();
@@ -188,7 +133,7 @@ void DefenseLogSystem::addDefenseLog(const DefenseLog& log)
 std::vector<DefenseLog> DefenseLogSystem::getUnviewedLogs() const
 {
     std::vector<DefenseLog> unviewed;
-    for (const auto& log : _logs)
+    for (const auto& log : _store.getLogs())
     {
         if (!log.isViewed)
         {
@@ -200,22 +145,17 @@ std::vector<DefenseLog> DefenseLogSystem::getUnviewedLogs() const
 
 void DefenseLogSystem::markAllAsViewed()
 {
-    for (auto& log : _logs)
-    {
-        log.isViewed = true;
-    }
-    save();
+    _store.markAllAsViewed();
 }
 
 void DefenseLogSystem::clearAllLogs()
 {
-    _logs.clear();
-    save();
+    _store.clear();
 }
 
 bool DefenseLogSystem::hasUnviewedLogs() const
 {
-    for (const auto& log : _logs)
+    for (const auto& log : _store.getLogs())
     {
         if (!log.isViewed)
         {
@@ -225,68 +165,133 @@ bool DefenseLogSystem::hasUnviewedLogs() const
     return false;
 }
 
-void DefenseLogSystem::save()
+bool DefenseLogSystem::loadReplay(uint64_t logId, std::string& outData, std::string& outBaseSnapshot)
 {
-    try {
-        auto& accMgr = AccountManager::getInstance();
-        const auto* currentAccount = accMgr.getCurrentAccount();
-        if (!currentAccount)
+    if (!_store.readReplay(logId, outData))
+    {
+        CCLOG("❌ 回放读取失败: 日志 %llu", static_cast<unsigned long long>(logId));
+        return false;
+    }
+
+    outBaseSnapshot.clear();
+    for (const auto& log : _store.getLogs())
+    {
+        if (log.id == logId && log.baseSnapshotHash != 0 && !_store.readBaseSnapshot(logId, outBaseSnapshot))
         {
-            return;
+            CCLOG("❌ 基地快照读取失败: 日志 %llu", static_cast<unsigned long long>(logId));
+            return false;
         }
-        
-        std::string key = "defense_log_" + currentAccount->account.userId;
-        
-        std::ostringstream oss;
-        for (size_t i = 0; i < _logs.size(); ++i)
+    }
+
+    auto stats = _store.getStats();
+    CCLOG("📂 读取回放: 日志 %llu，%zu 字节（缓存命中 %zu / 未命中 %zu）", static_cast<unsigned long long>(logId),
+          outData.size(), stats.cacheHits, stats.cacheMisses);
+    return true;
+}
+
+void DefenseLogSystem::save()
+{
+    _store.flush();
+}
+
+void DefenseLogSystem::load()
+{
+    auto& accMgr = AccountManager::getInstance();
+    const auto* currentAccount = accMgr.getCurrentAccount();
+    if (!currentAccount)
+    {
+        _store.close();
+        return;
+    }
+
+    const std::string& userId = currentAccount->account.userId;
+    std::string directory = getStoreDirectory(userId);
+    FileUtils::getInstance()->createDirectory(directory);
+
+    // 只读取索引；新建的存储先导入旧版数据
+    if (!_store.open(directory))
+    {
+        migrateLegacyLogs(userId);
+    }
+
+    auto stats = _store.getStats();
+    CCLOG("📂 加载了 %zu 条防守日志（%zu 个段文件，%zu 字节，%zu 份基地快照）", _store.getLogs().size(),
+          stats.segmentCount, stats.diskBytes, stats.baseSnapshots);
+}
+
+std::string DefenseLogSystem::getStoreDirectory(const std::string& userId)
+{
+    // 账号ID只保留文件名安全的字符
+    std::string name = userId;
+    for (auto& c : name)
+    {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-')
         {
-            if (i > 0) oss << "\n";
-            oss << _logs[i].serialize();
+            c = '_';
         }
-        
-        UserDefault::getInstance()->setStringForKey(key.c_str(), oss.str());
-        UserDefault::getInstance()->flush();
-    }
-    catch (const std::exception& e) {
-        CCLOG("❌ DefenseLogSystem::save 异常: %s", e.what());
     }
+    return FileUtils::getInstance()->getWritablePath() + "defense_logs/" + name + "/";
 }
 
-void DefenseLogSystem::load()
+void DefenseLogSystem::migrateLegacyLogs(const std::string& userId)
 {
-    try {
-        auto& accMgr = AccountManager::getInstance();
-        const auto* currentAccount = accMgr.getCurrentAccount();
-        if (!currentAccount)
+    std::string key = "defense_log_" + userId;
+    std::string data = UserDefault::getInstance()->getStringForKey(key.c_str(), "");
+    if (data.empty())
+    {
+        return;
+    }
+
+    std::vector<DefenseLog> legacyLogs;
+    std::istringstream iss(data);
+    std::string line;
+    while (std::getline(iss, line))
+    {
+        if (!line.empty())
         {
-            return;
+            legacyLogs.push_back(parseLegacyLog(line));
         }
-        
-        std::string key = "defense_log_" + currentAccount->account.userId;
-        std::string data = UserDefault::getInstance()->getStringForKey(key.c_str(), "");
-        
-        _logs.clear();
-        
-        if (data.empty())
+    }
+
+    // 旧数据最新在前，按从旧到新的顺序加入
+    auto* fileUtils = FileUtils::getInstance();
+    for (auto it = legacyLogs.rbegin(); it != legacyLogs.rend(); ++it)
+    {
+        DefenseLog log = *it;
+        std::string legacyFile;
+        if (log.replayData.find("FILE:") == 0)
         {
-            return;
+            legacyFile = fileUtils->getWritablePath() + log.replayData.substr(5);
+            log.replayData = fileUtils->isFileExist(legacyFile) ? fileUtils->getStringFromFile(legacyFile) : "";
         }
-        
-        std::istringstream iss(data);
-        std::string line;
-        
-        while (std::getline(iss, line))
+
+        _store.add(log, static_cast<size_t>(MAX_LOGS));
+
+        if (!legacyFile.empty())
         {
-            if (!line.empty())
-            {
-                _logs.push_back(DefenseLog::deserialize(line));
-            }
+            fileUtils->removeFile(legacyFile);
         }
-        
-        CCLOG("📂 加载了 %zu 条防守日志", _logs.size());
     }
-    catch (const std::exception& e) {
-        CCLOG("❌ DefenseLogSystem::load 异常: %s", e.what());
+
+    UserDefault::getInstance()->deleteValueForKey(key.c_str());
+    UserDefault::getInstance()->flush();
+    CCLOG("📦 导入了 %zu 条旧版防守日志", legacyLogs.size());
+}
+
+void DefenseLogSystem::playReplay(uint64_t logId)
+{
+    std::string replayData;
+    std::string baseSnapshot;
+    if (!getInstance().loadReplay(logId, replayData, baseSnapshot) || replayData.empty())
+    {
+        CCLOG("⚠️ No replay data available!");
+        return;
+    }
+
+    auto scene = BattleScene::createWithReplayData(replayData, baseSnapshot);
+    if (scene)
+    {
+        Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene, Color3B::BLACK));
     }
 }
 
@@ -347,7 +352,8 @@ void DefenseLogSystem::showDefenseLogUI()
     listView->setItemsMargin(8.0f);
     container->addChild(listView);
     
-    if (_logs.empty())
+    const auto& logs = _store.getLogs();
+    if (logs.empty())
     {
         auto tip = Label::createWithSystemFont("暂无防守记录", "Arial", 24);
         tip->setPosition(Vec2(330, 240));
@@ -360,9 +366,9 @@ void DefenseLogSystem::showDefenseLogUI()
     }
     else
     {
-        for (size_t idx = 0; idx < _logs.size(); ++idx)
+        for (size_t idx = 0; idx < logs.size(); ++idx)
         {
-            const auto& log = _logs[idx];
+            const auto& log = logs[idx];
             
             auto item = Layout::create();
             item->setContentSize(Size(660, 140));
@@ -421,56 +427,11 @@ void DefenseLogSystem::showDefenseLogUI()
             replayBtn->setScale9Enabled(true);
             replayBtn->setContentSize(Size(80, 35));
             replayBtn->setPosition(Vec2(580, 30));
-            replayBtn->addClickEventListener([idx, log](Ref*) {
+            replayBtn->addClickEventListener([log](Ref*) {
                 CCLOG("🎬 Battle replay clicked for attack from: %s", log.attackerName.c_str());
                 
-                std::string replayData = log.replayData;
-                
-                // 🆕 Handle file-based replay data
-                if (replayData.find("FILE:") == 0)
-                {
-                    std::string filename = replayData.substr(5);
-                    std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
-                    if (FileUtils::getInstance()->isFileExist(fullPath))
-                    {
-                        replayData = FileUtils::getInstance()->getStringFromFile(fullPath);
-                        CCLOG("📂 Loaded replay data from file: %s (Size: %zu)", filename.c_str(), replayData.length());
-                    }
-                    else
-                    {
-                        CCLOG("❌ Replay file not found: %s", filename.c_str());
-                        return;
-                    }
-                }
-                // Handle Base64 (legacy or fallback)
-                else if (replayData.find("B64:") == 0)
-                {
-                    std::string b64 = replayData.substr(4);
-                    unsigned char* decoded = nullptr;
-                    int len = base64Decode((const unsigned char*)b64.c_str(), (unsigned int)b64.length(), &decoded);
-                    if (decoded && len > 0)
-                    {
-                        replayData = std::string((char*)decoded, len);
-                        free(decoded);
-                    }
-                }
-                
-                if (replayData.empty())
-                {
-                    CCLOG("⚠️ No replay data available!");
-                    return;
-                }
-                
-                // 切换场景到战斗回放
-                // 注意：我们需要保存当前场景以便返回，或者直接替换
-                // 这里我们使用 pushScene/popScene 机制，但 BattleScene 比较重
-                // 最好是 BattleScene::createWithReplayData
-                
-                auto scene = BattleScene::createWithReplayData(replayData);
-                if (scene)
-                {
-                    Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene, Color3B::BLACK));
-                }
+                // 回放数据在点击时才从存储读取
+                playReplay(log.id);
             });
             item->addChild(replayBtn);
             
@@ -632,37 +593,7 @@ void DefenseLogSystem::showAttackDetailPopup(const cocos2d::Size& visibleSize, c
     replayBtn->setPosition(Vec2(275, labelY));
     replayBtn->addClickEventListener([log](Ref*) {
         CCLOG("🎬 Playing battle replay for attack from: %s", log.attackerName.c_str());
-        
-        std::string replayData = log.replayData;
-        
-        // 🆕 Handle file-based replay data
-        if (replayData.find("FILE:") == 0)
-        {
-            std::string filename = replayData.substr(5);
-            std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
-            if (FileUtils::getInstance()->isFileExist(fullPath))
-            {
-                replayData = FileUtils::getInstance()->getStringFromFile(fullPath);
-                CCLOG("📂 Loaded replay data from file: %s (Size: %zu)", filename.c_str(), replayData.length());
-            }
-            else
-            {
-                CCLOG("❌ Replay file not found: %s", filename.c_str());
-                return;
-            }
-        }
-        
-        if (replayData.empty())
-        {
-            CCLOG("⚠️ No replay data available!");
-            return;
-        }
-        
-        auto scene = BattleScene::createWithReplayData(replayData);
-        if (scene)
-        {
-            Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene, Color3B::BLACK));
-        }
+        playReplay(log.id);
     });
     detailPanel->addChild(replayBtn);
     
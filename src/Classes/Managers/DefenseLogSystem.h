@@ -3,7 +3,7 @@
  * File Name:     DefenseLogSystem.h
  * File Function: 防守日志系统 - 记录和管理玩家的防守日志
  * Author:        赵崇治
- * Update Date:   2025/12/14
+ * Update Date:   2026/10/18
  * License:       MIT License
  ****************************************************************/
 #pragma once
@@ -11,40 +11,17 @@
 #define __DEFENSE_LOG_SYSTEM_H__
 
 #include "cocos2d.h"
+#include "DefenseLogStore.h"
 #include "SocketClient.h"
 #include <string>
 #include <vector>
 
-/**
- * @struct DefenseLog
- * @brief 防守日志记录
- */
-struct DefenseLog
-{
-    std::string attackerId;      ///< 攻击者ID
-    std::string attackerName;    ///< 攻击者名称
-    int starsLost = 0;           ///< 失去星数
-    int goldLost = 0;            ///< 失去金币
-    int elixirLost = 0;          ///< 失去圣水
-    int trophyChange = 0;        ///< 奖杯变化
-    std::string timestamp;       ///< 时间戳
-    bool isViewed = false;       ///< 是否已查看
-    std::string replayData;      ///< 回放数据
-
-    /** @brief 序列化日志 */
-    std::string serialize() const;
-
-    /**
-     * @brief 反序列化日志
-     * @param data 序列化数据
-     * @return DefenseLog 日志对象
-     */
-    static DefenseLog deserialize(const std::string& data);
-};
-
 /**
  * @class DefenseLogSystem
  * @brief 防守日志系统（单例）- 管理被攻击记录
+ *
+ * 每个账号的日志保存在可写目录 defense_logs/<账号>/ 下的 DefenseLogStore 中；
+ * 界面只读取日志元数据，点击回放时才按日志ID读取回放数据。
  */
 class DefenseLogSystem
 {
@@ -57,7 +34,7 @@ public:
 
     /**
      * @brief 添加防守日志
-     * @param log 日志对象
+     * @param log 日志对象（replayData 为回放数据）
      */
     void addDefenseLog(const DefenseLog& log);
 
@@ -67,8 +44,17 @@ public:
      */
     std::vector<DefenseLog> getUnviewedLogs() const;
 
-    /** @brief 获取所有日志 */
-    const std::vector<DefenseLog>& getAllLogs() const { return _logs; }
+    /** @brief 获取所有日志（不含回放数据） */
+    const std::vector<DefenseLog>& getAllLogs() const { return _store.getLogs(); }
+
+    /**
+     * @brief 读取日志的回放数据
+     * @param logId 日志ID
+     * @param outData 回放数据
+     * @param outBaseSnapshot 回放按哈希引用的基地快照（回放内嵌快照时为空）
+     * @return bool 是否读取成功
+     */
+    bool loadReplay(uint64_t logId, std::string& outData, std::string& outBaseSnapshot);
 
     /** @brief 标记所有日志为已查看 */
     void markAllAsViewed();
@@ -76,10 +62,10 @@ public:
     /** @brief 清空所有日志 */
     void clearAllLogs();
 
-    /** @brief 保存日志到本地 */
+    /** @brief 保存未写入的日志索引 */
     void save();
 
-    /** @brief 从本地加载日志 */
+    /** @brief 打开当前账号的日志存储（只读取索引） */
     void load();
 
     /** @brief 检查是否有未查看的日志 */
@@ -102,7 +88,26 @@ private:
     DefenseLogSystem(const DefenseLogSystem&) = delete;
     DefenseLogSystem& operator=(const DefenseLogSystem&) = delete;
 
-    std::vector<DefenseLog> _logs;  ///< 日志列表
+    /**
+     * @brief 账号的日志存储目录
+     * @param userId 账号ID
+     * @return std::string 目录路径（以 / 结尾）
+     */
+    static std::string getStoreDirectory(const std::string& userId);
+
+    /**
+     * @brief 把旧版保存在 UserDefault 中的日志和 replay_*.dat 回放文件导入存储，然后删除旧数据
+     * @param userId 账号ID
+     */
+    void migrateLegacyLogs(const std::string& userId);
+
+    /**
+     * @brief 读取回放并进入回放场景
+     * @param logId 日志ID
+     */
+    static void playReplay(uint64_t logId);
+
+    DefenseLogStore _store;         ///< 当前账号的日志存储
     const int MAX_LOGS = 20;        ///< 最多保留记录数
 };
 
@@ -30,8 +30,8 @@ bool DeploymentValidator::Init(GridMap* grid_map) {
   grid_height_ = grid_map_->getGridHeight();
 
   // 初始化禁止部署地图，默认所有位置都可以部署
-  forbidden_map_.resize(
-      grid_width_, std::vector<bool>(grid_height_, false));
+  footprint_map_.reset(grid_width_, grid_height_);
+  forbidden_map_.reset(grid_width_, grid_height_);
 
   CCLOG("✅ DeploymentValidator 初始化成功: 网格大小 %dx%d",
         grid_width_, grid_height_);
@@ -41,33 +41,27 @@ bool DeploymentValidator::Init(GridMap* grid_map) {
 
 void DeploymentValidator::SetBuildings(
     const std::vector<BaseBuilding*>& buildings) {
-  // 重置禁止部署地图
-  for (auto& row : forbidden_map_) {
-    std::fill(row.begin(), row.end(), false);
-  }
+  // 重置建筑占地
+  footprint_map_.clear();
 
-  // 标记每个建筑及其周围区域
+  // 标记每个建筑的占地
   for (BaseBuilding* building : buildings) {
     if (building) {
-      MarkBuildingForbiddenZone(building);
+      MarkBuildingFootprint(building);
     }
   }
 
+  // 占地向外膨胀一圈即为禁止部署区域
+  RecalculateForbiddenZones();
+
   // 统计禁止区域数量
-  int forbidden_count = 0;
-  for (int x = 0; x < grid_width_; ++x) {
-    for (int y = 0; y < grid_height_; ++y) {
-      if (forbidden_map_[x][y]) {
-        ++forbidden_count;
-      }
-    }
-  }
+  int forbidden_count = forbidden_map_.count();
 
   CCLOG("📊 DeploymentValidator: 已设置 %zu 个建筑，禁止部署区域: %d 个网格",
         buildings.size(), forbidden_count);
 }
 
-void DeploymentValidator::MarkBuildingForbiddenZone(BaseBuilding* building) {
+void DeploymentValidator::MarkBuildingFootprint(BaseBuilding* building) {
   if (!building) {
     return;
   }
@@ -80,30 +74,18 @@ void DeploymentValidator::MarkBuildingForbiddenZone(BaseBuilding* building) {
   int building_width = static_cast<int>(grid_size.width);
   int building_height = static_cast<int>(grid_size.height);
 
-  // 计算禁止区域的范围（建筑区域 + 周围一圈）
-  int forbidden_start_x = std::max(0, start_x - kForbiddenRadius);
-  int forbidden_start_y = std::max(0, start_y - kForbiddenRadius);
-  int forbidden_end_x =
-      std::min(grid_width_ - 1, start_x + building_width - 1 + kForbiddenRadius);
-  int forbidden_end_y =
-      std::min(grid_height_ - 1, start_y + building_height - 1 + kForbiddenRadius);
-
-  // 标记禁止区域
-  for (int x = forbidden_start_x; x <= forbidden_end_x; ++x) {
-    for (int y = forbidden_start_y; y <= forbidden_end_y; ++y) {
-      forbidden_map_[x][y] = true;
-    }
-  }
+  // 标记建筑区域，周围一圈由 RecalculateForbiddenZones 统一膨胀得到
+  footprint_map_.fillRect(start_x, start_y, building_width, building_height,
+                          true);
 
-  CCLOG("🏗️ 标记建筑 %s 禁止区域: (%d,%d) 到 (%d,%d)",
+  CCLOG("🏗️ 标记建筑 %s 占地: (%d,%d) 尺寸 %dx%d",
         building->getDisplayName().c_str(),
-        forbidden_start_x, forbidden_start_y,
-        forbidden_end_x, forbidden_end_y);
+        start_x, start_y, building_width, building_height);
 }
 
 void DeploymentValidator::RecalculateForbiddenZones() {
-  // 此方法在 SetBuildings 中被隐式调用
-  // 保留以供将来需要单独重新计算时使用
+  // 禁止区域 = 建筑区域 + 周围 kForbiddenRadius 圈，按行整体膨胀
+  footprint_map_.dilate(kForbiddenRadius, forbidden_map_);
 }
 
 bool DeploymentValidator::CanDeployAtWorldPosition(
@@ -133,7 +115,7 @@ bool DeploymentValidator::CanDeployAtGrid(int grid_x, int grid_y) const {
   }
 
   // 检查是否在禁止区域内
-  return !forbidden_map_[grid_x][grid_y];
+  return !forbidden_map_.test(grid_x, grid_y);
 }
 
 std::vector<Vec2> DeploymentValidator::GetDeployableGridPositions() const {
@@ -142,7 +124,7 @@ std::vector<Vec2> DeploymentValidator::GetDeployableGridPositions() const {
 
   for (int x = 0; x < grid_width_; ++x) {
     for (int y = 0; y < grid_height_; ++y) {
-      if (!forbidden_map_[x][y]) {
+      if (!forbidden_map_.test(x, y)) {
         deployable_positions.emplace_back(
             static_cast<float>(x), static_cast<float>(y));
       }
@@ -158,7 +140,7 @@ std::vector<Vec2> DeploymentValidator::GetForbiddenGridPositions() const {
 
   for (int x = 0; x < grid_width_; ++x) {
     for (int y = 0; y < grid_height_; ++y) {
-      if (forbidden_map_[x][y]) {
+      if (forbidden_map_.test(x, y)) {
         forbidden_positions.emplace_back(
             static_cast<float>(x), static_cast<float>(y));
       }
@@ -10,6 +10,7 @@
 #define DEPLOYMENT_VALIDATOR_H_
 
 #include "Buildings/BaseBuilding.h"
+#include "GridBitset.h"
 #include "GridMap.h"
 #include "cocos2d.h"
 
@@ -111,15 +112,18 @@ class DeploymentValidator {
   void RecalculateForbiddenZones();
 
   /**
-   * @brief 标记建筑及其周围区域为禁止部署
+   * @brief 将建筑占地标记到 footprint_map_
    * @param building 建筑指针
    */
-  void MarkBuildingForbiddenZone(BaseBuilding* building);
+  void MarkBuildingFootprint(BaseBuilding* building);
 
   GridMap* grid_map_ = nullptr;  ///< 网格地图指针
 
-  // 禁止部署地图：true = 禁止部署, false = 可以部署
-  std::vector<std::vector<bool>> forbidden_map_;
+  // 建筑占地位图，置位 = 被建筑占用
+  GridBitset footprint_map_;
+
+  // 禁止部署地图：footprint_map_ 膨胀 kForbiddenRadius 圈，置位 = 禁止部署
+  GridBitset forbidden_map_;
 
   int grid_width_ = 0;   ///< 网格宽度
   int grid_height_ = 0;  ///< 网格高度
@@ -0,0 +1,110 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     DepthSortService.cpp
+ * File Function: 深度排序实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "DepthSortService.h"
+
+#include "Managers/FrameProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+USING_NS_CC;
+
+constexpr int DepthSortService::kDepthBase;
+constexpr int DepthSortService::kBucketHeight;
+
+// ==================== DepthSortLayer ====================
+
+void DepthSortLayer::sortAllChildren()
+{
+    if (!_reorderChildDirty)
+        return;
+
+    PROFILE_SCOPE("DepthSortLayer::sortAllChildren");
+
+    auto byDepth = [](const Node* a, const Node* b) { return a->getLocalZOrder() < b->getLocalZOrder(); };
+
+    // 插入排序：前缀始终有序，遇到比前一个小的节点时二分查找插入位置并整体右移一格
+    _lastSortMoves = 0;
+    auto first     = _children.begin();
+    for (auto it = first; it != _children.end(); ++it)
+    {
+        if (it == first || !byDepth(*it, *(it - 1)))
+            continue;
+
+        auto target = std::upper_bound(first, it, *it, byDepth);
+        std::rotate(target, it, it + 1);
+        ++_lastSortMoves;
+    }
+
+    _reorderChildDirty = false;
+    _eventDispatcher->setDirtyForNode(this);
+}
+
+// ==================== DepthSortService ====================
+
+int DepthSortService::bucketForY(float y)
+{
+    return static_cast<int>(std::floor(y / kBucketHeight));
+}
+
+void DepthSortService::reset()
+{
+    _dynamic.clear();
+    _depthChangeCount = 0;
+}
+
+void DepthSortService::addStatic(Node* node)
+{
+    if (!node)
+        return;
+
+    node->setLocalZOrder(depthForY(node->getPositionY()));
+    ++_depthChangeCount;
+}
+
+void DepthSortService::setDynamic(int slot, Node* node, float y)
+{
+    if (slot < 0)
+        return;
+    if (slot >= static_cast<int>(_dynamic.size()))
+        _dynamic.resize(slot + 1);
+
+    DynamicEntry& entry = _dynamic[slot];
+    entry.node          = node;
+    entry.bucket        = bucketForY(y);
+    if (node)
+    {
+        node->setLocalZOrder(depthForBucket(entry.bucket));
+        ++_depthChangeCount;
+    }
+}
+
+void DepthSortService::updateDynamic(int slot, float y)
+{
+    if (slot < 0 || slot >= static_cast<int>(_dynamic.size()))
+        return;
+
+    DynamicEntry& entry = _dynamic[slot];
+    if (!entry.node)
+        return;
+
+    int bucket = bucketForY(y);
+    if (bucket == entry.bucket)
+        return;
+
+    entry.bucket = bucket;
+    entry.node->setLocalZOrder(depthForBucket(bucket));
+    ++_depthChangeCount;
+}
+
+void DepthSortService::removeDynamic(int slot)
+{
+    if (slot >= 0 && slot < static_cast<int>(_dynamic.size()))
+        _dynamic[slot] = DynamicEntry();
+}
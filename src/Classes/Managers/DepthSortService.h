@@ -0,0 +1,124 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     DepthSortService.h
+ * File Function: 深度排序 - 建筑层级只设置一次，单位跨越深度桶时才更新层级，每帧一次增量插入排序
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __DEPTH_SORT_SERVICE_H__
+#define __DEPTH_SORT_SERVICE_H__
+
+#include "cocos2d.h"
+
+#include <vector>
+
+/**
+ * @class DepthSortLayer
+ * @brief 参与 2.5D 遮挡排序的节点容器（建筑、单位、投射物）
+ *
+ * cocos2d 的 Node 在任一子节点层级变化后对全部子节点做一次 std::sort。
+ * 这里的子节点在上一帧已经有序，每帧只有少数单位跨越深度桶，
+ * 因此改为增量插入排序：逐个检查相邻节点，只移动乱序的节点（稳定排序，同层级保持原有顺序）。
+ */
+class DepthSortLayer : public cocos2d::Node
+{
+public:
+    CREATE_FUNC(DepthSortLayer);
+
+    /** @brief 子节点层级有变化时增量排序（每个渲染帧在 visit 中最多执行一次） */
+    virtual void sortAllChildren() override;
+
+    /** @brief 最近一次排序中被移动的节点数 */
+    int getLastSortMoves() const { return _lastSortMoves; }
+
+private:
+    int _lastSortMoves = 0; ///< 最近一次排序移动的节点数
+};
+
+/**
+ * @class DepthSortService
+ * @brief 根据 Y 坐标维护节点层级（Y 越小越靠前，层级越大）
+ *
+ * - 静态节点（建筑）加载时按精确 Y 设置一次层级，之后不再改动
+ * - 动态节点（单位）按 kBucketHeight 像素分桶，只有跨越桶边界时才调用 setLocalZOrder，
+ *   避免每帧都把父节点标记为需要重新排序
+ * - 动态节点的层级取所在桶的上边界，与同一高度的建筑相比最多偏前 kBucketHeight 像素
+ */
+class DepthSortService
+{
+public:
+    static constexpr int kDepthBase    = 10000; ///< 层级基准（层级 = kDepthBase - Y）
+    static constexpr int kBucketHeight = 8;     ///< 动态节点的深度桶高度（像素）
+
+    /**
+     * @brief 精确 Y 对应的层级（与建造模式下的建筑层级一致）
+     * @param y 节点 Y 坐标
+     * @return int 层级
+     */
+    static int depthForY(float y) { return kDepthBase - static_cast<int>(y); }
+
+    /**
+     * @brief Y 所在的深度桶
+     * @param y 节点 Y 坐标
+     * @return int 桶编号（向下取整，负坐标同样成立）
+     */
+    static int bucketForY(float y);
+
+    /**
+     * @brief 深度桶对应的层级
+     * @param bucket 桶编号
+     * @return int 层级
+     */
+    static int depthForBucket(int bucket) { return kDepthBase - bucket * kBucketHeight; }
+
+    /** @brief 清空动态节点表和统计 */
+    void reset();
+
+    /**
+     * @brief 加入静态节点，按当前 Y 设置一次层级
+     * @param node 节点
+     */
+    void addStatic(cocos2d::Node* node);
+
+    /**
+     * @brief 绑定动态节点并立即设置层级
+     * @param slot 槽位（战斗中为单位下标）
+     * @param node 节点，为空时解除绑定
+     * @param y 当前 Y 坐标
+     */
+    void setDynamic(int slot, cocos2d::Node* node, float y);
+
+    /**
+     * @brief 更新动态节点位置，只有跨越桶边界时才修改层级
+     * @param slot 槽位
+     * @param y 当前 Y 坐标
+     */
+    void updateDynamic(int slot, float y);
+
+    /**
+     * @brief 解除动态节点绑定（节点被移除前调用，服务不持有引用）
+     * @param slot 槽位
+     */
+    void removeDynamic(int slot);
+
+    /** @brief 累计的层级修改次数（静态 + 动态） */
+    int getDepthChangeCount() const { return _depthChangeCount; }
+
+private:
+    /**
+     * @struct DynamicEntry
+     * @brief 动态节点及其当前所在的深度桶
+     */
+    struct DynamicEntry
+    {
+        cocos2d::Node* node   = nullptr;
+        int            bucket = 0;
+    };
+
+    std::vector<DynamicEntry> _dynamic;              ///< 槽位 -> 动态节点
+    int                       _depthChangeCount = 0; ///< 层级修改次数
+};
+
+#endif // __DEPTH_SORT_SERVICE_H__
@@ -0,0 +1,205 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     FrameProfiler.cpp
+ * File Function: 帧性能分析器实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+constexpr int    FrameProfiler::kWindowFrames;
+constexpr size_t FrameProfiler::kMaxTraceEvents;
+constexpr int    FrameProfiler::kTraceProcessId;
+constexpr int    FrameProfiler::kTraceThreadId;
+
+namespace
+{
+
+/** @brief 写出 JSON 字符串（作用域名来自代码中的字面量，只需处理引号和反斜杠） */
+void writeJsonString(std::ostream& out, const std::string& text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+/** @brief 作用域名中 "::" 之前的部分作为 Trace 分类（"BattleManager::update" -> "BattleManager"） */
+std::string categoryOf(const std::string& name)
+{
+    size_t pos = name.find("::");
+    return pos == std::string::npos ? name : name.substr(0, pos);
+}
+
+} // namespace
+
+FrameProfiler& FrameProfiler::getInstance()
+{
+    static FrameProfiler instance;
+    return instance;
+}
+
+void FrameProfiler::setStatsEnabled(bool enabled)
+{
+    if (_statsEnabled == enabled)
+        return;
+
+    _statsEnabled = enabled;
+
+    // 重新打开时从空窗口开始，避免显示很久以前的数据
+    for (auto& scope : _scopes)
+    {
+        scope->frameMs    = 0.0;
+        scope->frameCalls = 0;
+        std::fill(std::begin(scope->historyMs), std::end(scope->historyMs), 0.0);
+        std::fill(std::begin(scope->historyCalls), std::end(scope->historyCalls), 0);
+    }
+    _historyIndex  = 0;
+    _historyFrames = 0;
+}
+
+int FrameProfiler::findScope(const char* name)
+{
+    auto byPointer = _scopeByPointer.find(name);
+    if (byPointer != _scopeByPointer.end())
+        return byPointer->second;
+
+    int  index  = static_cast<int>(_scopes.size());
+    auto byName = _scopeByName.emplace(name, index);
+    if (byName.second)
+    {
+        _scopes.emplace_back(new ScopeData());
+        _scopes.back()->name = name;
+    }
+    else
+    {
+        index = byName.first->second;
+    }
+
+    _scopeByPointer[name] = index;
+    return index;
+}
+
+void FrameProfiler::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+    int scope = findScope(name);
+
+    if (_statsEnabled)
+    {
+        ScopeData& data = *_scopes[scope];
+        data.frameMs += std::chrono::duration<double, std::milli>(end - start).count();
+        data.frameCalls++;
+    }
+
+    if (_tracing && _traceEvents.size() < kMaxTraceEvents)
+    {
+        TraceEvent event;
+        event.scope      = scope;
+        event.startUs    = std::chrono::duration_cast<std::chrono::microseconds>(start - _traceStart).count();
+        event.durationUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        _traceEvents.push_back(event);
+    }
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!_statsEnabled)
+        return;
+
+    for (auto& scope : _scopes)
+    {
+        scope->historyMs[_historyIndex]    = scope->frameMs;
+        scope->historyCalls[_historyIndex] = scope->frameCalls;
+        scope->frameMs                     = 0.0;
+        scope->frameCalls                  = 0;
+    }
+
+    _historyIndex  = (_historyIndex + 1) % kWindowFrames;
+    _historyFrames = std::min(_historyFrames + 1, kWindowFrames);
+}
+
+std::vector<FrameProfileStats> FrameProfiler::getStats() const
+{
+    std::vector<FrameProfileStats> stats;
+    if (_historyFrames == 0)
+        return stats;
+
+    int lastIndex = (_historyIndex + kWindowFrames - 1) % kWindowFrames;
+    stats.reserve(_scopes.size());
+    for (const auto& scope : _scopes)
+    {
+        FrameProfileStats entry;
+        entry.name   = scope->name.c_str();
+        entry.lastMs = scope->historyMs[lastIndex];
+
+        double totalMs    = 0.0;
+        int    totalCalls = 0;
+        for (int i = 0; i < _historyFrames; ++i)
+        {
+            totalMs += scope->historyMs[i];
+            totalCalls += scope->historyCalls[i];
+            entry.maxMs = std::max(entry.maxMs, scope->historyMs[i]);
+        }
+
+        // 窗口内从未进入过的作用域（例如离开战斗场景后的战斗阶段）不显示
+        if (totalCalls == 0)
+            continue;
+
+        entry.avgMs    = totalMs / _historyFrames;
+        entry.avgCalls = static_cast<double>(totalCalls) / _historyFrames;
+        stats.push_back(entry);
+    }
+
+    std::sort(stats.begin(), stats.end(),
+              [](const FrameProfileStats& a, const FrameProfileStats& b) { return a.avgMs > b.avgMs; });
+    return stats;
+}
+
+void FrameProfiler::startTrace()
+{
+    _traceEvents.clear();
+    _traceEvents.reserve(kMaxTraceEvents / 8);
+    _traceStart = Clock::now();
+    _tracing    = true;
+}
+
+bool FrameProfiler::stopTrace(const std::string& path)
+{
+    if (!_tracing)
+        return false;
+    _tracing = false;
+
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    // Chrome Trace Event 格式：完整事件 "ph":"X"，ts/dur 单位为微秒
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < _traceEvents.size(); ++i)
+    {
+        const TraceEvent&  event = _traceEvents[i];
+        const std::string& name  = _scopes[event.scope]->name;
+
+        out << "{\"name\":";
+        writeJsonString(out, name);
+        out << ",\"cat\":";
+        writeJsonString(out, categoryOf(name));
+        out << ",\"ph\":\"X\",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs
+            << ",\"pid\":" << kTraceProcessId << ",\"tid\":" << kTraceThreadId << "}"
+            << (i + 1 < _traceEvents.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+
+    _traceEvents.clear();
+    _traceEvents.shrink_to_fit();
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,188 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     FrameProfiler.h
+ * File Function: 帧性能分析器 - 作用域计时、滚动统计和 Chrome Trace 导出
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __FRAME_PROFILER_H__
+#define __FRAME_PROFILER_H__
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 编译期开关：定义为 0 时 PROFILE_SCOPE 展开为空，计时代码不进入发布版本
+#ifndef FRAME_PROFILER_ENABLED
+#define FRAME_PROFILER_ENABLED 1
+#endif
+
+/**
+ * @struct FrameProfileStats
+ * @brief 一个作用域在滚动窗口内的统计（毫秒）
+ */
+struct FrameProfileStats
+{
+    const char* name     = nullptr; ///< 作用域名
+    double      avgMs    = 0.0;     ///< 窗口内每帧平均耗时
+    double      maxMs    = 0.0;     ///< 窗口内单帧最大耗时
+    double      lastMs   = 0.0;     ///< 上一帧耗时
+    double      avgCalls = 0.0;     ///< 窗口内每帧平均调用次数
+};
+
+/**
+ * @class FrameProfiler
+ * @brief 帧性能分析器（单例）
+ *
+ * - 作用域计时由 PROFILE_SCOPE 记录，同一作用域在一帧内多次进入时累加
+ * - endFrame() 把本帧累计值写入每个作用域的滚动窗口（最近 kWindowFrames 帧）
+ * - 录制 Trace 期间每次记录都保存为一个 Chrome Trace 的完整事件（"ph":"X"），
+ *   停止时写出 JSON，可直接拖入 chrome://tracing 或 Perfetto 查看
+ * - 仅在主线程使用；未激活（面板隐藏且未录制）时作用域不读取时钟
+ */
+class FrameProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int    kWindowFrames   = 120;    ///< 滚动窗口帧数（约 2 秒）
+    static constexpr size_t kMaxTraceEvents = 500000; ///< 单次录制的事件上限，超出后丢弃
+    static constexpr int    kTraceProcessId = 1;      ///< Trace 中的进程号
+    static constexpr int    kTraceThreadId  = 1;      ///< Trace 中的线程号（主线程）
+
+    /**
+     * @brief 获取单例实例
+     * @return FrameProfiler& 单例引用
+     */
+    static FrameProfiler& getInstance();
+
+    /** @brief 是否需要记录（统计面板显示中或正在录制 Trace） */
+    bool isActive() const { return _statsEnabled || _tracing; }
+
+    /**
+     * @brief 开启/关闭滚动统计
+     * @param enabled 是否开启
+     */
+    void setStatsEnabled(bool enabled);
+
+    bool isStatsEnabled() const { return _statsEnabled; }
+
+    /**
+     * @brief 记录一次作用域耗时
+     * @param name 作用域名（必须是字符串字面量或生命周期足够长的字符串）
+     * @param start 开始时间
+     * @param end 结束时间
+     */
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+    /** @brief 结束一帧：累计值写入滚动窗口并清零 */
+    void endFrame();
+
+    /**
+     * @brief 获取全部作用域的滚动统计（按平均耗时从大到小）
+     * @return std::vector<FrameProfileStats> 统计列表
+     */
+    std::vector<FrameProfileStats> getStats() const;
+
+    /** @brief 开始录制 Trace（清空之前的事件） */
+    void startTrace();
+
+    /**
+     * @brief 停止录制并写出 Chrome Trace JSON
+     * @param path 输出文件路径
+     * @return bool 是否写出成功
+     */
+    bool stopTrace(const std::string& path);
+
+    bool   isTracing() const { return _tracing; }
+    size_t getTraceEventCount() const { return _traceEvents.size(); }
+
+private:
+    FrameProfiler() = default;
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    /**
+     * @struct ScopeData
+     * @brief 一个作用域的累计值和滚动窗口
+     */
+    struct ScopeData
+    {
+        std::string name;                              ///< 作用域名（Trace 和面板共用）
+        double      frameMs                     = 0.0; ///< 本帧累计耗时
+        int         frameCalls                  = 0;   ///< 本帧调用次数
+        double      historyMs[kWindowFrames]    = {};  ///< 滚动窗口：每帧耗时
+        int         historyCalls[kWindowFrames] = {};  ///< 滚动窗口：每帧调用次数
+    };
+
+    /**
+     * @struct TraceEvent
+     * @brief 一个 Trace 完整事件（时间单位为微秒，相对录制开始）
+     */
+    struct TraceEvent
+    {
+        int     scope;
+        int64_t startUs;
+        int64_t durationUs;
+    };
+
+    /** @brief 查找或创建作用域（先按指针查找，同名字符串在不同编译单元中地址可能不同，再按内容查找） */
+    int findScope(const char* name);
+
+    std::vector<std::unique_ptr<ScopeData>> _scopes;
+    std::unordered_map<const char*, int>    _scopeByPointer;
+    std::unordered_map<std::string, int>    _scopeByName;
+
+    int  _historyIndex  = 0;     ///< 滚动窗口写入位置
+    int  _historyFrames = 0;     ///< 窗口内有效帧数
+    bool _statsEnabled  = false;
+
+    bool                    _tracing = false;
+    Clock::time_point       _traceStart;
+    std::vector<TraceEvent> _traceEvents;
+};
+
+/**
+ * @class FrameProfileScope
+ * @brief RAII 作用域计时：构造时读取时钟，析构时记录到 FrameProfiler
+ */
+class FrameProfileScope
+{
+public:
+    explicit FrameProfileScope(const char* name)
+        : _name(FrameProfiler::getInstance().isActive() ? name : nullptr)
+    {
+        if (_name)
+            _start = FrameProfiler::Clock::now();
+    }
+
+    ~FrameProfileScope()
+    {
+        if (_name)
+            FrameProfiler::getInstance().record(_name, _start, FrameProfiler::Clock::now());
+    }
+
+    FrameProfileScope(const FrameProfileScope&) = delete;
+    FrameProfileScope& operator=(const FrameProfileScope&) = delete;
+
+private:
+    const char*                      _name;
+    FrameProfiler::Clock::time_point _start;
+};
+
+#define FRAME_PROFILER_CONCAT_INNER(a, b) a##b
+#define FRAME_PROFILER_CONCAT(a, b) FRAME_PROFILER_CONCAT_INNER(a, b)
+
+#if FRAME_PROFILER_ENABLED
+/** @brief 计时当前作用域，名称建议使用 "类名::函数名" 或 "类名::函数名/阶段" */
+#define PROFILE_SCOPE(name) FrameProfileScope FRAME_PROFILER_CONCAT(_profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
+
+#endif // __FRAME_PROFILER_H__
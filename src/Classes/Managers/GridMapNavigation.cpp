@@ -0,0 +1,236 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridMapNavigation.cpp
+ * File Function: 基于 GridMap 的战斗寻路实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "GridMapNavigation.h"
+
+#include "BattleWorld.h"
+#include "GridMap.h"
+#include "PathFinder.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+constexpr unsigned int GridMapNavigation::kPathLatencyFrames;
+constexpr size_t       GridMapNavigation::kMaxRememberedResults;
+
+namespace
+{
+
+Vec2 toVec2(const SimVec2& v)
+{
+    return Vec2(v.floatX(), v.floatY());
+}
+
+std::vector<SimVec2> toSimPath(const std::vector<Vec2>& path)
+{
+    std::vector<SimVec2> simPath;
+    simPath.reserve(path.size());
+    for (const auto& point : path)
+    {
+        simPath.push_back(SimVec2::fromFloat(point.x, point.y));
+    }
+    return simPath;
+}
+
+} // namespace
+
+GridMapNavigation::GridMapNavigation(GridMap* gridMap) : _gridMap(gridMap), _asyncPathfinder(new AsyncPathfinder()) {}
+
+void GridMapNavigation::setGridMap(GridMap* gridMap)
+{
+    cancelAll();
+    _gridMap = gridMap;
+
+    // 碰撞版本只在同一张地图内唯一
+    _rememberedResults.clear();
+}
+
+void GridMapNavigation::setRememberResults(bool enabled)
+{
+    _rememberResults = enabled;
+    if (!enabled)
+        _rememberedResults.clear();
+}
+
+GridMapNavigation::SearchId GridMapNavigation::makeSearchId(const PendingPath& pending)
+{
+    return SearchId(pending.snapshot->getVersion(), pending.key.pack(), static_cast<int>(pending.mode));
+}
+
+uint64_t GridMapNavigation::submitSearch(const PendingPath& pending)
+{
+    if (_rememberResults && _rememberedResults.count(makeSearchId(pending)) != 0)
+    {
+        _stats.jobsReused++;
+        return 0;
+    }
+    return _asyncPathfinder->submit(pending.snapshot, pending.key, pending.mode);
+}
+
+bool GridMapNavigation::takeResult(const PendingPath& pending, AsyncPathResult& outResult)
+{
+    if (pending.jobId == 0)
+    {
+        auto it = _rememberedResults.find(makeSearchId(pending));
+        if (it == _rememberedResults.end())
+            return false;
+        outResult = it->second;
+        return true;
+    }
+
+    if (!_asyncPathfinder->waitResult(pending.jobId, outResult))
+        return false;
+
+    if (_rememberResults && _rememberedResults.size() < kMaxRememberedResults)
+        _rememberedResults.emplace(makeSearchId(pending), outResult);
+    return true;
+}
+
+void GridMapNavigation::cancelAll()
+{
+    _asyncPathfinder->cancelAll();
+    _pendingPaths.clear();
+}
+
+void GridMapNavigation::requestPath(BattleWorld& world, UnitIndex unit, BuildingIndex target)
+{
+    SimVec2     targetPos  = world.getBuildingPosition(target);
+    Vec2        unitPos    = toVec2(world.getUnitPosition(unit));
+    PathFinder& pathFinder = PathFinder::getInstance();
+
+    _stats.requests++;
+
+    PathCacheKey key;
+    if (!pathFinder.makeCacheKey(_gridMap, unitPos, toVec2(targetPos), false, key))
+    {
+        _stats.directMoves++;
+        world.moveUnitTo(unit, targetPos);
+        return;
+    }
+
+    std::vector<Vec2> path;
+    if (pathFinder.findCachedPath(_gridMap, unitPos, key, path))
+    {
+        _stats.cacheHits++;
+        cancelPath(unit);
+        world.moveUnitAlongPath(unit, toSimPath(path));
+        return;
+    }
+
+    // 已有任务在途：等待结果，不重复提交
+    bool alreadyPending = std::any_of(_pendingPaths.begin(), _pendingPaths.end(),
+                                      [unit](const PendingPath& pending) { return pending.unit == unit; });
+    if (!alreadyPending)
+    {
+        PendingPath pending;
+        pending.snapshot   = _gridMap->getCollisionSnapshot();
+        pending.key        = key;
+        pending.mode       = pathFinder.getMode();
+        pending.jobId      = submitSearch(pending);
+        pending.readyFrame = world.getTick() + kPathLatencyFrames;
+        pending.unit       = unit;
+        pending.target     = target;
+        _pendingPaths.push_back(pending);
+
+        _stats.jobsSubmitted++;
+        _stats.maxPending = std::max(_stats.maxPending, _pendingPaths.size());
+    }
+
+    // 结果到达前先直线走向目标，避免单位原地等待
+    world.moveUnitTo(unit, targetPos);
+}
+
+void GridMapNavigation::beginStep(BattleWorld& world)
+{
+    while (!_pendingPaths.empty() && _pendingPaths.front().readyFrame <= world.getTick())
+    {
+        PendingPath pending = _pendingPaths.front();
+        _pendingPaths.pop_front();
+
+        // 结果未完成时在这里阻塞：应用时机只由步数决定，不受线程调度影响
+        AsyncPathResult result;
+        if (!takeResult(pending, result))
+            continue;
+
+        UnitIndex unit = pending.unit;
+        if (!world.isUnitAlive(unit) || world.getUnitTarget(unit) != pending.target)
+        {
+            _stats.jobsDiscarded++;
+            continue;
+        }
+
+        // 直线移动期间已进入攻击范围，不再需要路径
+        SimVec2 targetPos = world.getBuildingPosition(pending.target);
+        if (world.isBuildingDestroyed(pending.target) || world.isUnitInAttackRange(unit, targetPos))
+        {
+            _stats.jobsDiscarded++;
+            continue;
+        }
+
+        _stats.jobsApplied++;
+        std::vector<Vec2> path = PathFinder::getInstance().completePath(
+            _gridMap, toVec2(world.getUnitPosition(unit)), result.key, result.snapshotVersion, result.cells);
+        world.moveUnitAlongPath(unit, toSimPath(path));
+    }
+}
+
+void GridMapNavigation::cancelPath(UnitIndex unit)
+{
+    for (auto it = _pendingPaths.begin(); it != _pendingPaths.end();)
+    {
+        if (it->unit == unit)
+        {
+            if (it->jobId != 0)
+                _asyncPathfinder->cancel(it->jobId);
+            it = _pendingPaths.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void GridMapNavigation::logStats() const
+{
+    CCLOG("🧭 战斗寻路: 请求=%llu, 缓存命中=%llu, 直线=%llu, 异步任务=%llu (应用=%llu, 作废=%llu, 复用结果=%llu), 最多在途=%zu",
+          static_cast<unsigned long long>(_stats.requests), static_cast<unsigned long long>(_stats.cacheHits),
+          static_cast<unsigned long long>(_stats.directMoves), static_cast<unsigned long long>(_stats.jobsSubmitted),
+          static_cast<unsigned long long>(_stats.jobsApplied), static_cast<unsigned long long>(_stats.jobsDiscarded),
+          static_cast<unsigned long long>(_stats.jobsReused), _stats.maxPending);
+}
+
+void GridMapNavigation::saveSnapshot(Snapshot& out) const
+{
+    out.collision = _gridMap->getCollisionSnapshot();
+    out.pathCache = PathFinder::getInstance().getCache();
+    out.pendingPaths.assign(_pendingPaths.begin(), _pendingPaths.end());
+}
+
+void GridMapNavigation::restoreSnapshot(const Snapshot& snapshot)
+{
+    cancelAll();
+    _gridMap->restoreCollision(snapshot.collision);
+    PathFinder::getInstance().restoreCache(snapshot.pathCache);
+
+    // 搜索结果只取决于快照和键，重新提交后在原来的步按原顺序应用
+    for (PendingPath pending : snapshot.pendingPaths)
+    {
+        pending.jobId = submitSearch(pending);
+        _pendingPaths.push_back(pending);
+    }
+}
+
+void GridMapNavigation::onBuildingDestroyed(BattleWorld& world, BuildingIndex building)
+{
+    int x, y, width, height;
+    world.getBuildingGridRect(building, x, y, width, height);
+    _gridMap->markArea(Vec2(static_cast<float>(x), static_cast<float>(y)),
+                       Size(static_cast<float>(width), static_cast<float>(height)), false);
+}
@@ -0,0 +1,154 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridMapNavigation.h
+ * File Function: 基于 GridMap 的战斗寻路 - 缓存命中立即生效，未命中异步搜索
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __GRID_MAP_NAVIGATION_H__
+#define __GRID_MAP_NAVIGATION_H__
+
+#include "AsyncPathfinder.h"
+#include "BattleNavigation.h"
+#include "PathCache.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+class GridMap;
+
+/**
+ * @class GridMapNavigation
+ * @brief BattleWorld 的 GridMap 寻路实现
+ *
+ * - PathFinder 缓存命中时立即给单位路径
+ * - 未命中时提交 AsyncPathfinder 任务，结果到达前单位先直线走向目标
+ * - 结果固定在提交后 kPathLatencyFrames 步按任务编号顺序应用，与线程完成时间无关
+ */
+class GridMapNavigation : public BattleNavigation
+{
+public:
+    /**
+     * @struct PendingPath
+     * @brief 等待应用的异步寻路任务
+     */
+    struct PendingPath
+    {
+        uint64_t        jobId      = 0;                        ///< 任务编号（0 表示使用记住的结果，未提交任务）
+        unsigned int    readyFrame = 0;                        ///< 应用结果的步（提交步 + 固定延迟）
+        UnitIndex       unit       = kInvalidIndex;            ///< 请求寻路的单位
+        BuildingIndex   target     = kInvalidIndex;            ///< 提交时的目标，目标变化后结果作废
+        PathCacheKey    key;                                   ///< 搜索的起点和终点格子
+        PathfindingMode mode       = PathfindingMode::kAStar; ///< 搜索模式
+        std::shared_ptr<const CollisionSnapshot> snapshot;     ///< 搜索所用的碰撞快照（恢复时重新提交）
+    };
+
+    /**
+     * @struct Snapshot
+     * @brief 影响模拟结果的寻路状态（回放关键帧）
+     *
+     * 缓存命中与否决定路径立即生效还是延迟 kPathLatencyFrames 步生效，
+     * 所以碰撞地图、路径缓存和在途任务必须和 BattleWorld 一起恢复。
+     */
+    struct Snapshot
+    {
+        std::shared_ptr<const CollisionSnapshot> collision;    ///< 碰撞地图（含版本号）
+        PathCache                                pathCache;    ///< 路径缓存
+        std::vector<PendingPath>                 pendingPaths; ///< 在途任务
+    };
+
+    /**
+     * @struct Stats
+     * @brief 寻路请求统计（不属于模拟状态，不进入快照）
+     */
+    struct Stats
+    {
+        uint64_t requests      = 0; ///< requestPath 调用次数
+        uint64_t cacheHits     = 0; ///< 缓存命中、立即生效的次数
+        uint64_t directMoves   = 0; ///< 起点或终点不在网格内、直线移动的次数
+        uint64_t jobsSubmitted = 0; ///< 提交的异步任务数
+        uint64_t jobsApplied   = 0; ///< 结果应用到单位的任务数
+        uint64_t jobsDiscarded = 0; ///< 结果到达时已不需要（单位死亡、换目标或已到位）的任务数
+        uint64_t jobsReused    = 0; ///< 其中使用记住的结果、未提交到线程的任务数（含恢复快照时的在途任务）
+        size_t   maxPending    = 0; ///< 同时在途任务数的最大值
+    };
+
+    explicit GridMapNavigation(GridMap* gridMap);
+
+    /** @brief 更换地图并丢弃所有未应用的任务 */
+    void setGridMap(GridMap* gridMap);
+
+    /** @brief 取消所有任务 */
+    void cancelAll();
+
+    /** @brief 寻路请求统计 */
+    const Stats& getStats() const { return _stats; }
+
+    /** @brief 清零统计（新战斗开始时调用） */
+    void resetStats() { _stats = Stats(); }
+
+    /** @brief 输出统计到日志 */
+    void logStats() const;
+
+    /**
+     * @brief 是否记住异步搜索的结果（回放模式开启）
+     *
+     * 回放定位回到关键帧后会重新走一遍同样的寻路请求，记住的结果直接使用，不再提交任务。
+     * 搜索结果只取决于 (碰撞版本, 键, 模式)，应用时机仍由 readyFrame 决定，不影响确定性。
+     * 关闭时清空已记住的结果。
+     */
+    void setRememberResults(bool enabled);
+
+    void requestPath(BattleWorld& world, UnitIndex unit, BuildingIndex target) override;
+    void cancelPath(UnitIndex unit) override;
+    void beginStep(BattleWorld& world) override;
+    void onBuildingDestroyed(BattleWorld& world, BuildingIndex building) override;
+
+    /**
+     * @brief 保存寻路状态
+     * @param out 输出快照
+     */
+    void saveSnapshot(Snapshot& out) const;
+
+    /**
+     * @brief 恢复寻路状态：恢复碰撞地图和路径缓存，在途任务用原快照重新提交
+     * @param snapshot 之前保存的快照
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
+    /// 异步寻路结果固定在提交后第几步应用，与线程完成时间无关，回放时结果一致
+    static constexpr unsigned int kPathLatencyFrames = 6;
+
+    static constexpr size_t kMaxRememberedResults = 4096; ///< 最多记住的搜索结果数（满后不再新增）
+
+private:
+    /// 搜索的唯一标识：碰撞版本 + 打包的缓存键 + 模式
+    using SearchId = std::tuple<unsigned int, uint64_t, int>;
+
+    /**
+     * @brief 提交搜索任务，已记住结果时不提交
+     * @return uint64_t 任务编号，0 表示使用记住的结果
+     */
+    uint64_t submitSearch(const PendingPath& pending);
+
+    /** @brief 取出任务结果（等待任务完成或读取记住的结果） */
+    bool takeResult(const PendingPath& pending, AsyncPathResult& outResult);
+
+    /** @brief 任务的搜索标识 */
+    static SearchId makeSearchId(const PendingPath& pending);
+
+    GridMap*                            _gridMap         = nullptr; ///< 碰撞地图
+    std::unique_ptr<AsyncPathfinder>    _asyncPathfinder;           ///< 异步寻路任务队列
+    std::deque<PendingPath>             _pendingPaths;              ///< 按任务编号排序的待应用任务
+    Stats                               _stats;                     ///< 寻路请求统计
+    bool                                _rememberResults = false;   ///< 是否记住搜索结果
+    std::map<SearchId, AsyncPathResult> _rememberedResults;         ///< 记住的搜索结果（回放定位后复用）
+};
+
+#endif // __GRID_MAP_NAVIGATION_H__
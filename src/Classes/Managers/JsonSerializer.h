@@ -11,7 +11,13 @@
 #include "json/document.h"
 #include "json/writer.h"
 #include "json/stringbuffer.h"
+
+// 无界面战斗模拟（BATTLE_HEADLESS）不链接 cocos2d，日志直接丢弃
+#ifndef BATTLE_HEADLESS
 #include "cocos2d.h"
+#elif !defined(CCLOG)
+#define CCLOG(...) do {} while (0)
+#endif
 
 #include <string>
 #include <vector>
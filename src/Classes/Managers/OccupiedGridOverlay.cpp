@@ -3,18 +3,26 @@
  * File Name:     OccupiedGridOverlay.cpp
  * File Function: 占用网格覆盖层实现
  * Author:        赵崇治
- * Update Date:   2025/12/15
+ * Update Date:   2026/10/18
  * License:       MIT License
  ****************************************************************/
 #include "OccupiedGridOverlay.h"
 #include "GridMap.h"
-#include "Buildings/BaseBuilding.h"
-#include <set>
+#include "GridMap/GridCellLayer.h"
+#include "Managers/FrameProfiler.h"
+#include <algorithm>
 #include <exception>
 #include <stdexcept>
 
 USING_NS_CC;
 
+namespace
+{
+const Color4F kHighlightColor(1.0f, 1.0f, 1.0f, 0.15f); ///< 占用及周围一格（淡白色）
+const Color4F kGrassColor(0.4f, 0.8f, 0.4f, 0.15f);     ///< 建筑占用（淡绿色半透明）
+const Color4F kEmptyColor(0.0f, 0.0f, 0.0f, 0.0f);
+} // namespace
+
 OccupiedGridOverlay* OccupiedGridOverlay::create(GridMap* gridMap)
 {
     OccupiedGridOverlay* ret = new (std::nothrow) OccupiedGridOverlay();
@@ -27,23 +35,43 @@ OccupiedGridOverlay* OccupiedGridOverlay::create(GridMap* gridMap)
     return nullptr;
 }
 
+OccupiedGridOverlay::~OccupiedGridOverlay()
+{
+    if (_gridMap)
+    {
+        _gridMap->setOnAreaChanged(nullptr);
+        _gridMap->release();
+    }
+}
+
 bool OccupiedGridOverlay::init(GridMap* gridMap)
 {
     try {
-        if (!Node::init())
+        if (!Node::init() || !gridMap)
         {
             return false;
         }
         
         _gridMap = gridMap;
+        _gridMap->retain();
         
-        // 创建草坪图层（底层，淡绿色）
-        _grassDrawNode = DrawNode::create();
-        this->addChild(_grassDrawNode, 0);
+        // 创建草坪图层（底层，淡绿色），由 showGrassLayer 显示
+        _grassLayer = GridCellLayer::create(gridMap);
+        if (!_grassLayer)
+            return false;
+        _grassLayer->setVisible(false);
+        this->addChild(_grassLayer, 0);
         
         // 创建高亮图层（上层，淡白色）
-        _highlightDrawNode = DrawNode::create();
-        this->addChild(_highlightDrawNode, 1);
+        _highlightLayer = GridCellLayer::create(gridMap);
+        if (!_highlightLayer)
+            return false;
+        _highlightLayer->setVisible(false);
+        this->addChild(_highlightLayer, 1);
+        
+        // 先按当前碰撞地图填满，之后只跟随 markArea 的变化
+        onAreaChanged(0, 0, gridMap->getGridWidth(), gridMap->getGridHeight());
+        _gridMap->setOnAreaChanged([this](int x, int y, int w, int h) { onAreaChanged(x, y, w, h); });
         
         return true;
     }
@@ -53,135 +81,91 @@ bool OccupiedGridOverlay::init(GridMap* gridMap)
     }
 }
 
-void OccupiedGridOverlay::showOccupiedGrids(const cocos2d::Vector<BaseBuilding*>& buildings)
+void OccupiedGridOverlay::onAreaChanged(int x, int y, int w, int h)
 {
-    try {
-        if (!_gridMap || !_highlightDrawNode)
-            return;
-        
-        // 停止之前的动作
-        this->stopAllActions();
-        
-        // 清除高亮图层
-        _highlightDrawNode->clear();
-        
-        // 使用集合去重，避免重复绘制
-        std::set<std::pair<int, int>> occupiedGrids;
-        
-        // 遍历所有建筑，收集占用的网格及其周围一格
-        for (auto* building : buildings)
+    if (!_gridMap || !_grassLayer || !_highlightLayer)
+        return;
+
+    PROFILE_SCOPE("OccupiedGridOverlay::onAreaChanged");
+    
+    const GridBitset& occupied = _gridMap->getCollisionBitset();
+    int gridWidth = _gridMap->getGridWidth();
+    int gridHeight = _gridMap->getGridHeight();
+    
+    // 草坪：矩形内的格子
+    int minX = std::max(0, x);
+    int minY = std::max(0, y);
+    int maxX = std::min(gridWidth, x + w);
+    int maxY = std::min(gridHeight, y + h);
+    for (int gx = minX; gx < maxX; ++gx)
+    {
+        for (int gy = minY; gy < maxY; ++gy)
         {
-            if (!building)
-                continue;
-            
-            Vec2 gridPos = building->getGridPosition();
-            Size gridSize = building->getGridSize();
-            
-            int startX = static_cast<int>(gridPos.x);
-            int startY = static_cast<int>(gridPos.y);
-            int width = static_cast<int>(gridSize.width);
-            int height = static_cast<int>(gridSize.height);
-            
-            // 建筑占用的网格及其周围一格
-            for (int x = startX - 1; x < startX + width + 1; ++x)
-            {
-                for (int y = startY - 1; y < startY + height + 1; ++y)
-                {
-                    if (isValidGrid(x, y))
-                    {
-                        occupiedGrids.insert(std::make_pair(x, y));
-                    }
-                }
-            }
+            _grassLayer->setCell(gx, gy, occupied.test(gx, gy) ? kGrassColor : kEmptyColor);
         }
-        
-        // 绘制所有占用的网格（淡白色）
-        Color4F highlightColor(1.0f, 1.0f, 1.0f, 0.15f);
-        for (const auto& grid : occupiedGrids)
+    }
+    
+    // 高亮：周围一格内有占用的格子，受影响范围是矩形外扩一格
+    minX = std::max(0, x - 1);
+    minY = std::max(0, y - 1);
+    maxX = std::min(gridWidth, x + w + 1);
+    maxY = std::min(gridHeight, y + h + 1);
+    for (int gx = minX; gx < maxX; ++gx)
+    {
+        for (int gy = minY; gy < maxY; ++gy)
         {
-            drawGrid(_highlightDrawNode, grid.first, grid.second, highlightColor);
+            bool highlighted = occupied.anyInRect(gx - 1, gy - 1, 3, 3);
+            _highlightLayer->setCell(gx, gy, highlighted ? kHighlightColor : kEmptyColor);
         }
-        
-        // 淡入效果
-        _highlightDrawNode->setOpacity(0);
-        _highlightDrawNode->setVisible(true);
-        auto fadeIn = FadeIn::create(0.3f);
-        _highlightDrawNode->runAction(fadeIn);
-    }
-    catch (const std::exception& e) {
-        CCLOG("❌ OccupiedGridOverlay::showOccupiedGrids 异常: %s", e.what());
     }
 }
 
+void OccupiedGridOverlay::showOccupiedGrids()
+{
+    if (!_highlightLayer)
+        return;
+    
+    // 停止之前的动作
+    this->stopAllActions();
+    
+    // 淡入效果
+    auto* sprite = _highlightLayer->getSprite();
+    sprite->stopAllActions();
+    sprite->setOpacity(0);
+    _highlightLayer->setVisible(true);
+    sprite->runAction(FadeIn::create(0.3f));
+}
+
 void OccupiedGridOverlay::fadeOutAndHide(float duration)
 {
-    if (!_highlightDrawNode)
+    if (!_highlightLayer)
         return;
     
     // 停止之前的动作
     this->stopAllActions();
     
     // 淡出效果
+    auto* sprite = _highlightLayer->getSprite();
+    sprite->stopAllActions();
     auto fadeOut = FadeOut::create(duration);
-    auto clear = CallFunc::create([this]() {
-        if (_highlightDrawNode)
+    auto hide = CallFunc::create([this]() {
+        if (_highlightLayer)
         {
-            _highlightDrawNode->clear();
-            _highlightDrawNode->setVisible(false);
+            _highlightLayer->setVisible(false);
         }
     });
     
-    _highlightDrawNode->runAction(Sequence::create(fadeOut, clear, nullptr));
+    sprite->runAction(Sequence::create(fadeOut, hide, nullptr));
 }
 
-void OccupiedGridOverlay::updateGrassLayer(const cocos2d::Vector<BaseBuilding*>& buildings)
+void OccupiedGridOverlay::showGrassLayer()
 {
-    if (!_gridMap || !_grassDrawNode)
+    if (!_grassLayer)
         return;
     
-    // 清除草坪图层
-    _grassDrawNode->clear();
-    
-    // 使用集合去重，避免重复绘制
-    std::set<std::pair<int, int>> buildingGrids;
-    
-    // 遍历所有建筑，收集占用的网格（不包含周围一格）
-    for (auto* building : buildings)
-    {
-        if (!building)
-            continue;
-        
-        Vec2 gridPos = building->getGridPosition();
-        Size gridSize = building->getGridSize();
-        
-        int startX = static_cast<int>(gridPos.x);
-        int startY = static_cast<int>(gridPos.y);
-        int width = static_cast<int>(gridSize.width);
-        int height = static_cast<int>(gridSize.height);
-        
-        // 仅收集建筑实际占用的网格
-        for (int x = startX; x < startX + width; ++x)
-        {
-            for (int y = startY; y < startY + height; ++y)
-            {
-                if (isValidGrid(x, y))
-                {
-                    buildingGrids.insert(std::make_pair(x, y));
-                }
-            }
-        }
-    }
-    
-    // 绘制草坪（淡绿色）
-    Color4F grassColor(0.4f, 0.8f, 0.4f, 0.15f); // 淡绿色半透明
-    for (const auto& grid : buildingGrids)
-    {
-        drawGrid(_grassDrawNode, grid.first, grid.second, grassColor);
-    }
-    
     // 草坪图层始终可见
-    _grassDrawNode->setOpacity(255);
-    _grassDrawNode->setVisible(true);
+    _grassLayer->getSprite()->setOpacity(255);
+    _grassLayer->setVisible(true);
 }
 
 void OccupiedGridOverlay::hide()
@@ -189,47 +173,14 @@ void OccupiedGridOverlay::hide()
     // 停止所有动作
     this->stopAllActions();
     
-    if (_highlightDrawNode)
+    if (_highlightLayer)
     {
-        _highlightDrawNode->clear();
-        _highlightDrawNode->setVisible(false);
+        _highlightLayer->getSprite()->stopAllActions();
+        _highlightLayer->setVisible(false);
     }
     
-    if (_grassDrawNode)
+    if (_grassLayer)
     {
-        _grassDrawNode->clear();
-        _grassDrawNode->setVisible(false);
+        _grassLayer->setVisible(false);
     }
 }
-
-void OccupiedGridOverlay::drawGrid(cocos2d::DrawNode* drawNode, int gridX, int gridY, const cocos2d::Color4F& color)
-{
-    if (!_gridMap || !drawNode)
-        return;
-    
-    // 获取网格中心位置
-    Vec2 center = _gridMap->getPositionFromGrid(Vec2(gridX, gridY));
-    
-    // 计算菱形网格的四个顶点
-    float tileSize = _gridMap->getTileSize();
-    float halfW = tileSize / 2.0f;
-    float halfH = halfW * 0.75f; // 等距投影比例
-    
-    Vec2 vertices[4];
-    vertices[0] = Vec2(center.x, center.y + halfH);        // 上
-    vertices[1] = Vec2(center.x + halfW, center.y);         // 右
-    vertices[2] = Vec2(center.x, center.y - halfH);        // 下
-    vertices[3] = Vec2(center.x - halfW, center.y);         // 左
-    
-    // 绘制填充的菱形（无边界）
-    drawNode->drawSolidPoly(vertices, 4, color);
-}
-
-bool OccupiedGridOverlay::isValidGrid(int x, int y) const
-{
-    if (!_gridMap)
-        return false;
-    
-    return (x >= 0 && x < _gridMap->getGridWidth() && 
-            y >= 0 && y < _gridMap->getGridHeight());
-}
@@ -1,9 +1,9 @@
 ﻿/****************************************************************
  * Project Name:  Clash_of_Clans
  * File Name:     OccupiedGridOverlay.h
- * File Function: 占用网格覆盖层 - 显示已有建筑占用的网格及其周围一格
+ * File Function: 占用网格覆盖层 - 显示已有建筑占用的网格及其周围一格，按 markArea 的变化增量更新
  * Author:        赵崇治
- * Update Date:   2025/12/15
+ * Update Date:   2026/10/18
  * License:       MIT License
  ****************************************************************/
 #pragma once
@@ -13,11 +13,15 @@
 #include <vector>
 
 class GridMap;
-class BaseBuilding;
+class GridCellLayer;
 
 /**
  * @class OccupiedGridOverlay
  * @brief 显示已有建筑占用的网格及其周围一格的覆盖层
+ *
+ * 草坪（建筑占用的格子）和高亮（占用格子及周围一格，即不可部署区域）各是一张每格一像素的
+ * GridCellLayer。覆盖层监听 GridMap::markArea，只重算变化矩形（高亮再向外扩一格）内的格子，
+ * 显示时不再遍历建筑列表或重新生成几何。
  */
 class OccupiedGridOverlay : public cocos2d::Node
 {
@@ -29,6 +33,8 @@ public:
      */
     static OccupiedGridOverlay* create(GridMap* gridMap);
 
+    virtual ~OccupiedGridOverlay();
+
     /**
      * @brief 初始化
      * @param gridMap 网格地图
@@ -36,11 +42,8 @@ public:
      */
     virtual bool init(GridMap* gridMap);
 
-    /**
-     * @brief 显示所有已有建筑的占用网格
-     * @param buildings 建筑列表
-     */
-    void showOccupiedGrids(const cocos2d::Vector<BaseBuilding*>& buildings);
+    /** @brief 淡入显示所有已有建筑的占用网格（内容已随 markArea 保持最新） */
+    void showOccupiedGrids();
 
     /**
      * @brief 淡出并隐藏覆盖层
@@ -48,34 +51,23 @@ public:
      */
     void fadeOutAndHide(float duration = 0.5f);
 
-    /**
-     * @brief 更新草坪图层
-     * @param buildings 建筑列表
-     */
-    void updateGrassLayer(const cocos2d::Vector<BaseBuilding*>& buildings);
+    /** @brief 显示草坪图层（内容已随 markArea 保持最新） */
+    void showGrassLayer();
 
     /** @brief 立即隐藏覆盖层 */
     void hide();
 
 private:
-    GridMap* _gridMap = nullptr;                       ///< 网格地图
-    cocos2d::DrawNode* _highlightDrawNode = nullptr;   ///< 高亮图层
-    cocos2d::DrawNode* _grassDrawNode = nullptr;       ///< 草坪图层
-
-    /**
-     * @brief 绘制单个网格到指定图层
-     * @param drawNode 绘制节点
-     * @param gridX 网格X坐标
-     * @param gridY 网格Y坐标
-     * @param color 填充颜色
-     */
-    void drawGrid(cocos2d::DrawNode* drawNode, int gridX, int gridY, const cocos2d::Color4F& color);
+    GridMap*       _gridMap        = nullptr; ///< 网格地图（持有引用）
+    GridCellLayer* _highlightLayer = nullptr; ///< 高亮图层
+    GridCellLayer* _grassLayer     = nullptr; ///< 草坪图层
 
     /**
-     * @brief 检查网格是否在有效范围内
-     * @param x X坐标
-     * @param y Y坐标
-     * @return bool 是否有效
+     * @brief 占用变化回调：重算矩形内的草坪和外扩一格内的高亮
+     * @param x 起始网格X坐标
+     * @param y 起始网格Y坐标
+     * @param w X方向格子数
+     * @param h Y方向格子数
      */
-    bool isValidGrid(int x, int y) const;
+    void onAreaChanged(int x, int y, int w, int h);
 };
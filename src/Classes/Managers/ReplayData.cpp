@@ -0,0 +1,459 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     ReplayData.cpp
+ * File Function: 回放数据序列化实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "ReplayData.h"
+
+#include "Battle/FixedPoint.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+constexpr unsigned int ReplayData::kChecksumInterval;
+constexpr uint8_t      ReplayData::kBinaryVersion;
+
+namespace
+{
+
+const char kMagic[4] = {'C', 'R', 'P', 'L'}; ///< 二进制回放魔数
+
+constexpr uint64_t kFlagInlineBase = 1; ///< 头部标志：内嵌基地快照 JSON
+
+constexpr uint64_t kHashOffsetBasis = 14695981039346656037ULL; ///< FNV-1a 初始值
+constexpr uint64_t kHashPrime       = 1099511628211ULL;        ///< FNV-1a 乘数
+
+void writeVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void writeFixed64(std::string& out, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+void writeString(std::string& out, const std::string& value)
+{
+    writeVarint(out, value.size());
+    out.append(value);
+}
+
+/** @brief 有符号数映射为无符号数，绝对值小的数编码短 */
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+// ==================== ReplayEvent 序列化 ====================
+
+std::string ReplayEvent::serialize() const
+{
+    std::ostringstream oss;
+    // 坐标按 float 的完整精度写出，回放时得到与录制时完全相同的部署位置
+    oss << std::setprecision(std::numeric_limits<float>::max_digits10);
+    oss << frameIndex << "," << static_cast<int>(type) << "," << unitType << "," << x << "," << y;
+    return oss.str();
+}
+
+ReplayEvent ReplayEvent::deserialize(const std::string& data)
+{
+    ReplayEvent event;
+    std::istringstream iss(data);
+    std::string token;
+    
+    std::getline(iss, token, ',');
+    event.frameIndex = std::stoul(token);
+    
+    std::getline(iss, token, ',');
+    event.type = static_cast<ReplayEventType>(std::stoi(token));
+    
+    std::getline(iss, token, ',');
+    event.unitType = std::stoi(token);
+    
+    std::getline(iss, token, ',');
+    event.x = std::stof(token);
+    
+    std::getline(iss, token, ',');
+    event.y = std::stof(token);
+    
+    return event;
+}
+
+// ==================== ReplayData 序列化 ====================
+
+std::string ReplayData::serialize(bool inlineBase) const
+{
+    std::string out;
+    out.reserve(64 + enemyUserId.size() + (inlineBase ? enemyGameDataJson.size() : 0) + events.size() * 8 +
+                checksums.size() * 10);
+
+    out.append(kMagic, sizeof(kMagic));
+    out.push_back(static_cast<char>(kBinaryVersion));
+    writeVarint(out, inlineBase ? kFlagInlineBase : 0);
+    writeVarint(out, simRulesVersion);
+    writeString(out, enemyUserId);
+    writeVarint(out, randomSeed);
+    writeFixed64(out, baseSnapshotHash != 0 ? baseSnapshotHash : hashBaseSnapshot(enemyGameDataJson));
+    if (inlineBase)
+        writeString(out, enemyGameDataJson);
+
+    // 帧数递增，写增量；部署坐标相对上一个部署，连续拖动部署时增量很小
+    writeVarint(out, events.size());
+    unsigned int lastFrame = 0;
+    int32_t      lastX     = 0;
+    int32_t      lastY     = 0;
+    for (const auto& event : events)
+    {
+        writeVarint(out, event.frameIndex - lastFrame);
+        lastFrame = event.frameIndex;
+        out.push_back(static_cast<char>(event.type));
+
+        if (event.type == ReplayEventType::DEPLOY_UNIT)
+        {
+            int32_t x = Fixed::fromFloat(event.x).raw();
+            int32_t y = Fixed::fromFloat(event.y).raw();
+            writeVarint(out, static_cast<uint32_t>(event.unitType));
+            writeVarint(out, zigzag(static_cast<int64_t>(x) - lastX));
+            writeVarint(out, zigzag(static_cast<int64_t>(y) - lastY));
+            lastX = x;
+            lastY = y;
+        }
+    }
+
+    writeVarint(out, checksums.size());
+    lastFrame = 0;
+    for (const auto& checksum : checksums)
+    {
+        writeVarint(out, checksum.frameIndex - lastFrame);
+        lastFrame = checksum.frameIndex;
+        writeFixed64(out, checksum.hash);
+    }
+
+    return out;
+}
+
+ReplayData ReplayData::deserialize(const std::string& data)
+{
+    if (!isBinary(data))
+        return deserializeLegacy(data);
+
+    ReplayData   replayData;
+    ReplayReader reader(data.data(), data.size());
+    if (!reader.readHeader(replayData))
+        throw std::runtime_error("bad replay header");
+
+    replayData.events.reserve(std::min<size_t>(reader.getEventCount(), data.size()));
+    ReplayEvent event;
+    while (reader.nextEvent(event))
+        replayData.events.push_back(event);
+
+    ReplayChecksum checksum;
+    while (reader.nextChecksum(checksum))
+        replayData.checksums.push_back(checksum);
+
+    if (reader.hasError())
+        throw std::runtime_error("truncated replay");
+    return replayData;
+}
+
+std::string ReplayData::convertLegacy(const std::string& data, bool inlineBase)
+{
+    if (isBinary(data) && inlineBase)
+        return data;
+    return deserialize(data).serialize(inlineBase);
+}
+
+bool ReplayData::isBinary(const std::string& data)
+{
+    return data.size() > sizeof(kMagic) && data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) == 0;
+}
+
+uint64_t ReplayData::hashBaseSnapshot(const std::string& json)
+{
+    uint64_t hash = kHashOffsetBasis;
+    for (unsigned char c : json)
+    {
+        hash ^= c;
+        hash *= kHashPrime;
+    }
+    return hash;
+}
+
+ReplayData ReplayData::deserializeLegacy(const std::string& data)
+{
+    ReplayData replayData;
+    std::istringstream iss(data);
+    std::string token;
+    
+    std::getline(iss, replayData.enemyUserId, '|');
+    
+    std::getline(iss, token, '|');
+    if (!token.empty())
+    {
+        replayData.randomSeed = std::stoul(token);
+    }
+    
+    size_t jsonLength = 0;
+    std::getline(iss, token, '|');
+    if (!token.empty())
+    {
+        jsonLength = std::stoul(token);
+    }
+    
+    if (jsonLength > 0)
+    {
+        std::vector<char> buffer(jsonLength);
+        iss.read(buffer.data(), jsonLength);
+        replayData.enemyGameDataJson.assign(buffer.data(), jsonLength);
+    }
+
+    char delimiter;
+    iss.get(delimiter); 
+    
+    std::string eventsStr;
+    std::getline(iss, eventsStr, '|');
+    
+    if (!eventsStr.empty())
+    {
+        std::istringstream eventsIss(eventsStr);
+        std::string eventStr;
+        
+        while (std::getline(eventsIss, eventStr, ';'))
+        {
+            if (!eventStr.empty())
+            {
+                replayData.events.push_back(ReplayEvent::deserialize(eventStr));
+            }
+        }
+    }
+
+    std::string checksumsStr;
+    std::getline(iss, checksumsStr);
+
+    if (!checksumsStr.empty())
+    {
+        std::istringstream checksumsIss(checksumsStr);
+        std::string checksumStr;
+
+        while (std::getline(checksumsIss, checksumStr, ';'))
+        {
+            size_t colon = checksumStr.find(':');
+            if (colon == std::string::npos) continue;
+
+            ReplayChecksum checksum;
+            checksum.frameIndex = static_cast<unsigned int>(std::stoul(checksumStr.substr(0, colon)));
+            checksum.hash = std::stoull(checksumStr.substr(colon + 1), nullptr, 16);
+            replayData.checksums.push_back(checksum);
+        }
+    }
+    
+    replayData.baseSnapshotHash = hashBaseSnapshot(replayData.enemyGameDataJson);
+    return replayData;
+}
+
+// ==================== 流式读取 ====================
+
+ReplayReader::ReplayReader(const char* data, size_t size)
+    : _cursor(reinterpret_cast<const uint8_t*>(data)), _end(reinterpret_cast<const uint8_t*>(data) + size)
+{
+}
+
+bool ReplayReader::readHeader(ReplayData& out)
+{
+    if (static_cast<size_t>(_end - _cursor) < sizeof(kMagic) + 1 ||
+        std::memcmp(_cursor, kMagic, sizeof(kMagic)) != 0)
+        return fail();
+    _cursor += sizeof(kMagic);
+
+    uint8_t  version;
+    uint64_t flags, rules = 0, seed, eventCount;
+    if (!readByte(version) || version < 1 || version > ReplayData::kBinaryVersion)
+        return fail();
+    if (!readVarint(flags) || (version >= 2 && !readVarint(rules)) || !readString(out.enemyUserId) ||
+        !readVarint(seed) || !readFixed64(out.baseSnapshotHash))
+        return false;
+    out.randomSeed      = static_cast<unsigned int>(seed);
+    out.simRulesVersion = static_cast<uint32_t>(rules);
+
+    out.enemyGameDataJson.clear();
+    if ((flags & kFlagInlineBase) && !readString(out.enemyGameDataJson))
+        return false;
+
+    if (!readVarint(eventCount) || eventCount > UINT32_MAX)
+        return fail();
+    _eventCount = static_cast<uint32_t>(eventCount);
+    return true;
+}
+
+bool ReplayReader::nextEvent(ReplayEvent& out)
+{
+    if (_error || _eventsRead >= _eventCount)
+        return false;
+
+    uint64_t frameDelta;
+    uint8_t  type;
+    if (!readVarint(frameDelta) || !readByte(type))
+        return false;
+
+    _lastEventFrame += static_cast<unsigned int>(frameDelta);
+    out.frameIndex = _lastEventFrame;
+    out.type       = static_cast<ReplayEventType>(type);
+    out.unitType   = 0;
+    out.x          = 0.0f;
+    out.y          = 0.0f;
+
+    if (out.type == ReplayEventType::DEPLOY_UNIT)
+    {
+        uint64_t unitType, dx, dy;
+        if (!readVarint(unitType) || !readVarint(dx) || !readVarint(dy))
+            return false;
+        _lastX += static_cast<int32_t>(unzigzag(dx));
+        _lastY += static_cast<int32_t>(unzigzag(dy));
+        out.unitType = static_cast<int>(unitType);
+        out.x        = Fixed::fromRaw(_lastX).toFloat();
+        out.y        = Fixed::fromRaw(_lastY).toFloat();
+    }
+    else if (out.type != ReplayEventType::END_BATTLE)
+    {
+        return fail();
+    }
+
+    ++_eventsRead;
+    return true;
+}
+
+bool ReplayReader::nextChecksum(ReplayChecksum& out)
+{
+    if (!_checksumsStarted)
+    {
+        ReplayEvent skipped;
+        while (nextEvent(skipped))
+        {
+        }
+        if (_error)
+            return false;
+
+        uint64_t count;
+        if (!readVarint(count) || count > UINT32_MAX)
+            return fail();
+        _checksumCount    = static_cast<uint32_t>(count);
+        _checksumsStarted = true;
+    }
+
+    if (_error || _checksumsRead >= _checksumCount)
+        return false;
+
+    uint64_t frameDelta;
+    if (!readVarint(frameDelta) || !readFixed64(out.hash))
+        return false;
+
+    _lastChecksumFrame += static_cast<unsigned int>(frameDelta);
+    out.frameIndex = _lastChecksumFrame;
+    ++_checksumsRead;
+    return true;
+}
+
+bool ReplayReader::readByte(uint8_t& out)
+{
+    if (_cursor >= _end)
+        return fail();
+    out = *_cursor++;
+    return true;
+}
+
+bool ReplayReader::readVarint(uint64_t& out)
+{
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte;
+        if (!readByte(byte))
+            return false;
+        out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return fail();
+}
+
+bool ReplayReader::readFixed64(uint64_t& out)
+{
+    if (_end - _cursor < 8)
+        return fail();
+    out = 0;
+    for (int i = 0; i < 8; ++i)
+        out |= static_cast<uint64_t>(_cursor[i]) << (8 * i);
+    _cursor += 8;
+    return true;
+}
+
+bool ReplayReader::readString(std::string& out)
+{
+    uint64_t length;
+    if (!readVarint(length))
+        return false;
+    if (length > static_cast<uint64_t>(_end - _cursor))
+        return fail();
+    out.assign(reinterpret_cast<const char*>(_cursor), static_cast<size_t>(length));
+    _cursor += length;
+    return true;
+}
+
+bool ReplayReader::fail()
+{
+    _error = true;
+    return false;
+}
+
+// ==================== 不同步检测 ====================
+
+void ReplayDesyncDetector::reset(const std::vector<ReplayChecksum>* checksums)
+{
+    _checksums = checksums;
+    _nextIndex = 0;
+    _desyncFrame = 0;
+    _expectedHash = 0;
+    _actualHash = 0;
+}
+
+bool ReplayDesyncDetector::check(unsigned int frameIndex, uint64_t hash)
+{
+    if (!_checksums || hasDesync()) return true;
+
+    // 摘要按帧递增，跳过已经错过的帧
+    while (_nextIndex < _checksums->size() && (*_checksums)[_nextIndex].frameIndex < frameIndex)
+    {
+        _nextIndex++;
+    }
+    if (_nextIndex >= _checksums->size() || (*_checksums)[_nextIndex].frameIndex != frameIndex) return true;
+
+    const ReplayChecksum& expected = (*_checksums)[_nextIndex++];
+    if (expected.hash == hash) return true;
+
+    _desyncFrame = frameIndex;
+    _expectedHash = expected.hash;
+    _actualHash = hash;
+    return false;
+}
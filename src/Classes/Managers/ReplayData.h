@@ -0,0 +1,239 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     ReplayData.h
+ * File Function: 回放数据 - 回放事件与回放数据的定义、二进制序列化和流式读取（不依赖 cocos2d）
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#ifndef REPLAY_DATA_H_
+#define REPLAY_DATA_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @enum ReplayEventType
+ * @brief 战斗回放事件类型
+ */
+enum class ReplayEventType {
+    DEPLOY_UNIT,  ///< 部署士兵
+    END_BATTLE    ///< 结束战斗
+};
+
+/**
+ * @struct ReplayEvent
+ * @brief 单个回放事件
+ */
+struct ReplayEvent {
+    unsigned int frameIndex;  ///< 事件发生的帧数
+    ReplayEventType type;     ///< 事件类型
+    int unitType;             ///< 士兵类型
+    float x;                  ///< X坐标
+    float y;                  ///< Y坐标
+
+    /** @brief 序列化为旧版文本格式（frame,type,unit,x,y） */
+    std::string serialize() const;
+
+    /**
+     * @brief 从旧版文本格式反序列化
+     * @param data 序列化数据
+     * @return ReplayEvent 事件对象
+     */
+    static ReplayEvent deserialize(const std::string& data);
+};
+
+/**
+ * @struct ReplayChecksum
+ * @brief 某一帧推进完成后的模拟状态摘要
+ */
+struct ReplayChecksum {
+    unsigned int frameIndex;  ///< 帧数
+    uint64_t hash;            ///< BattleWorld::computeStateHash()
+};
+
+/**
+ * @struct ReplayData
+ * @brief 完整的回放数据
+ *
+ * 二进制格式（版本 2，整数均为小端）：
+ * - 头部：魔数 "CRPL"、版本字节、varint 标志（bit0 表示内嵌基地快照）、varint 模拟规则版本、
+ *   敌方ID（varint 长度 + 字节）、varint 随机种子、8 字节基地快照哈希，内嵌时再跟快照 JSON
+ *   （版本 1 没有模拟规则版本字段，读取时记为 0）
+ * - 事件：varint 数量；每个事件为 varint 帧增量、类型字节，
+ *   部署事件再跟 varint 兵种和 zigzag varint 坐标增量（相对上一个部署，单位为模拟使用的 Q16.16 定点数）
+ * - 状态摘要：varint 数量；每个为 varint 帧增量 + 8 字节摘要
+ *
+ * 坐标按模拟的定点数精度量化，解码后经 SimVec2::fromFloat 得到与录制时完全相同的部署位置。
+ * 基地快照可以只写哈希，由调用方按哈希单独保存一份，多场回放共用。
+ * 模拟规则版本与当前 BattleWorld::kRulesVersion 不同的回放无法逐帧复现，由调用方跳过摘要校验并提示。
+ */
+struct ReplayData {
+    static constexpr unsigned int kChecksumInterval = 30;  ///< 每隔多少帧记录一次状态摘要（0.5 秒）
+    static constexpr uint8_t kBinaryVersion = 2;           ///< 二进制格式版本（读取兼容版本 1）
+
+    std::string enemyUserId;                ///< 敌方ID
+    std::string enemyGameDataJson;          ///< 敌方基地数据快照（按哈希引用的回放反序列化后为空）
+    uint64_t baseSnapshotHash = 0;          ///< 基地快照内容哈希（hashBaseSnapshot）
+    unsigned int randomSeed = 0;            ///< 随机种子
+    uint32_t simRulesVersion = 0;           ///< 录制时的模拟规则版本（BattleWorld::kRulesVersion），0 表示未记录（旧版本回放）
+    std::vector<ReplayEvent> events;        ///< 事件列表
+    std::vector<ReplayChecksum> checksums;  ///< 状态摘要（按帧递增，旧版本回放为空）
+
+    /**
+     * @brief 序列化为二进制回放
+     * @param inlineBase 是否内嵌基地快照 JSON；为 false 时只写 baseSnapshotHash
+     * @return std::string 二进制数据
+     */
+    std::string serialize(bool inlineBase = true) const;
+
+    /**
+     * @brief 反序列化回放数据（自动识别二进制格式和旧版文本格式）
+     * @param data 序列化数据
+     * @return ReplayData 回放数据对象
+     * @throw std::exception 数据损坏
+     */
+    static ReplayData deserialize(const std::string& data);
+
+    /**
+     * @brief 把旧版文本回放转换为二进制格式（二进制输入原样返回）
+     * @param data 回放数据
+     * @param inlineBase 是否内嵌基地快照 JSON
+     * @return std::string 二进制数据
+     * @throw std::exception 数据损坏
+     */
+    static std::string convertLegacy(const std::string& data, bool inlineBase = true);
+
+    /** @brief 是否为二进制格式 */
+    static bool isBinary(const std::string& data);
+
+    /**
+     * @brief 基地快照内容哈希（FNV-1a 64）
+     * @param json 基地快照 JSON
+     * @return uint64_t 哈希值
+     */
+    static uint64_t hashBaseSnapshot(const std::string& json);
+
+private:
+    /** @brief 解析旧版文本格式 */
+    static ReplayData deserializeLegacy(const std::string& data);
+};
+
+/**
+ * @class ReplayReader
+ * @brief 二进制回放的流式读取
+ *
+ * 依次调用 readHeader、nextEvent、nextChecksum，直接从缓冲区解码，不构造中间字符串；
+ * 只需要头部或事件时不必解码后面的部分。缓冲区需在读取期间保持有效。
+ */
+class ReplayReader {
+public:
+    /**
+     * @brief 构造
+     * @param data 二进制回放
+     * @param size 字节数
+     */
+    ReplayReader(const char* data, size_t size);
+
+    /**
+     * @brief 读取头部
+     * @param out 写入模拟规则版本、敌方ID、随机种子、基地快照哈希和（内嵌时的）快照 JSON
+     * @return bool 魔数、版本或长度不正确时返回 false
+     */
+    bool readHeader(ReplayData& out);
+
+    /**
+     * @brief 读取下一个事件
+     * @param out 事件
+     * @return bool 事件已读完或数据损坏时返回 false
+     */
+    bool nextEvent(ReplayEvent& out);
+
+    /**
+     * @brief 读取下一个状态摘要（先跳过未读取的事件）
+     * @param out 状态摘要
+     * @return bool 摘要已读完或数据损坏时返回 false
+     */
+    bool nextChecksum(ReplayChecksum& out);
+
+    /** @brief 事件数量（readHeader 之后有效） */
+    uint32_t getEventCount() const { return _eventCount; }
+
+    /** @brief 状态摘要数量（事件读完之后有效） */
+    uint32_t getChecksumCount() const { return _checksumCount; }
+
+    /** @brief 数据是否损坏 */
+    bool hasError() const { return _error; }
+
+private:
+    bool readByte(uint8_t& out);
+    bool readVarint(uint64_t& out);
+    bool readFixed64(uint64_t& out);
+    bool readString(std::string& out);
+    bool fail();
+
+    const uint8_t* _cursor;
+    const uint8_t* _end;
+    bool _error = false;
+
+    uint32_t _eventCount = 0;        ///< 事件数量
+    uint32_t _eventsRead = 0;        ///< 已读取的事件数
+    uint32_t _checksumCount = 0;     ///< 状态摘要数量
+    uint32_t _checksumsRead = 0;     ///< 已读取的摘要数
+    bool _checksumsStarted = false;  ///< 是否已读取摘要数量
+    unsigned int _lastEventFrame = 0;     ///< 上一个事件的帧
+    unsigned int _lastChecksumFrame = 0;  ///< 上一个摘要的帧
+    int32_t _lastX = 0;                   ///< 上一个部署的 X（定点数底层整数）
+    int32_t _lastY = 0;                   ///< 上一个部署的 Y（定点数底层整数）
+};
+
+/**
+ * @class ReplayDesyncDetector
+ * @brief 回放不同步检测
+ *
+ * 回放推进到录制时记录过摘要的帧时比较两者，记录第一个不一致的帧。
+ * 录制中没有的帧（包括旧版本回放）不做比较。
+ */
+class ReplayDesyncDetector {
+public:
+    /**
+     * @brief 开始检测
+     * @param checksums 录制时的状态摘要（需在检测期间保持有效）
+     */
+    void reset(const std::vector<ReplayChecksum>* checksums);
+
+    /**
+     * @brief 比较一帧的状态摘要
+     * @param frameIndex 帧数
+     * @param hash 本次模拟得到的摘要
+     * @return bool 本帧第一次出现不一致时返回 false
+     */
+    bool check(unsigned int frameIndex, uint64_t hash);
+
+    /**
+     * @brief 回放定位后从头查找下一个要比较的摘要（保留已发现的不一致）
+     */
+    void rewind() { _nextIndex = 0; }
+
+    /** @brief 是否已发现不一致 */
+    bool hasDesync() const { return _desyncFrame != 0; }
+
+    /** @brief 第一个不一致的帧（0 表示没有） */
+    unsigned int getDesyncFrame() const { return _desyncFrame; }
+
+    /** @brief 录制时该帧的摘要 */
+    uint64_t getExpectedHash() const { return _expectedHash; }
+
+    /** @brief 本次模拟该帧的摘要 */
+    uint64_t getActualHash() const { return _actualHash; }
+
+private:
+    const std::vector<ReplayChecksum>* _checksums = nullptr;
+    size_t _nextIndex = 0;
+    unsigned int _desyncFrame = 0;
+    uint64_t _expectedHash = 0;
+    uint64_t _actualHash = 0;
+};
+
+#endif  // REPLAY_DATA_H_
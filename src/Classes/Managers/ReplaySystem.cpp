@@ -7,112 +7,13 @@
  * License:       MIT License
  ****************************************************************/
 #include "ReplaySystem.h"
+#include "Battle/BattleWorld.h"
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 
 USING_NS_CC;
 
-// ==================== ReplayEvent 序列化 ====================
-
-std::string ReplayEvent::serialize() const
-{
-    std::ostringstream oss;
-    oss << frameIndex << "," << static_cast<int>(type) << "," << unitType << "," << x << "," << y;
-    return oss.str();
-}
-
-ReplayEvent ReplayEvent::deserialize(const std::string& data)
-{
-    ReplayEvent event;
-    std::istringstream iss(data);
-    std::string token;
-    
-    std::getline(iss, token, ',');
-    event.frameIndex = std::stoul(token);
-    
-    std::getline(iss, token, ',');
-    event.type = static_cast<ReplayEventType>(std::stoi(token));
-    
-    std::getline(iss, token, ',');
-    event.unitType = std::stoi(token);
-    
-    std::getline(iss, token, ',');
-    event.x = std::stof(token);
-    
-    std::getline(iss, token, ',');
-    event.y = std::stof(token);
-    
-    return event;
-}
-
-// ==================== ReplayData 序列化 ====================
-
-std::string ReplayData::serialize() const
-{
-    std::ostringstream oss;
-    // 使用长度前缀来存储JSON数据，防止分隔符冲突
-    oss << enemyUserId << "|" << randomSeed << "|" << enemyGameDataJson.length() << "|" << enemyGameDataJson << "|";
-    
-    for (size_t i = 0; i < events.size(); ++i)
-    {
-        if (i > 0) oss << ";";
-        oss << events[i].serialize();
-    }
-    
-    return oss.str();
-}
-
-ReplayData ReplayData::deserialize(const std::string& data)
-{
-    ReplayData replayData;
-    std::istringstream iss(data);
-    std::string token;
-    
-    std::getline(iss, replayData.enemyUserId, '|');
-    
-    std::getline(iss, token, '|');
-    if (!token.empty())
-    {
-        replayData.randomSeed = std::stoul(token);
-    }
-    
-    size_t jsonLength = 0;
-    std::getline(iss, token, '|');
-    if (!token.empty())
-    {
-        jsonLength = std::stoul(token);
-    }
-    
-    if (jsonLength > 0)
-    {
-        std::vector<char> buffer(jsonLength);
-        iss.read(buffer.data(), jsonLength);
-        replayData.enemyGameDataJson.assign(buffer.data(), jsonLength);
-    }
-
-    char delimiter;
-    iss.get(delimiter); 
-    
-    std::string eventsStr;
-    std::getline(iss, eventsStr);
-    
-    if (!eventsStr.empty())
-    {
-        std::istringstream eventsIss(eventsStr);
-        std::string eventStr;
-        
-        while (std::getline(eventsIss, eventStr, ';'))
-        {
-            if (!eventStr.empty())
-            {
-                replayData.events.push_back(ReplayEvent::deserialize(eventStr));
-            }
-        }
-    }
-    
-    return replayData;
-}
-
 // ==================== ReplaySystem 实现 ====================
 
 ReplaySystem& ReplaySystem::getInstance()
@@ -125,8 +26,10 @@ void ReplaySystem::reset()
 {
     _isRecording = false;
     _isReplaying = false;
+    _rulesMismatch = false;
     _currentReplayData = ReplayData();
     _nextEventIndex = 0;
+    _desyncDetector.reset(nullptr);
     _deployUnitCallback = nullptr;
     _endBattleCallback = nullptr;
 }
@@ -138,6 +41,7 @@ void ReplaySystem::startRecording(const std::string& enemyUserId, const std::str
     _currentReplayData.enemyUserId = enemyUserId;
     _currentReplayData.enemyGameDataJson = enemyGameDataJson;
     _currentReplayData.randomSeed = seed;
+    _currentReplayData.simRulesVersion = BattleWorld::kRulesVersion;
     CCLOG("🎥 ReplaySystem: Started recording (Enemy: %s, Seed: %u)", enemyUserId.c_str(), seed);
 }
 
@@ -171,26 +75,90 @@ void ReplaySystem::recordEndBattle(unsigned int frameIndex)
     CCLOG("🎥 ReplaySystem: Recorded end battle at frame %u", frameIndex);
 }
 
-std::string ReplaySystem::stopRecording()
+void ReplaySystem::recordChecksum(unsigned int frameIndex, uint64_t hash)
+{
+    if (!_isRecording) return;
+
+    ReplayChecksum checksum;
+    checksum.frameIndex = frameIndex;
+    checksum.hash = hash;
+    _currentReplayData.checksums.push_back(checksum);
+}
+
+bool ReplaySystem::verifyChecksum(unsigned int frameIndex, uint64_t hash)
+{
+    if (!_isReplaying) return true;
+
+    return _desyncDetector.check(frameIndex, hash);
+}
+
+std::string ReplaySystem::stopRecording(std::string* outBaseSnapshot)
 {
     if (!_isRecording) return "";
     
     _isRecording = false;
-    std::string data = _currentReplayData.serialize();
-    CCLOG("🎥 ReplaySystem: Stopped recording. Data size: %zu bytes", data.size());
+
+    // 同一个基地的多场回放共用一份快照
+    auto& replayData = _currentReplayData;
+    replayData.baseSnapshotHash = ReplayData::hashBaseSnapshot(replayData.enemyGameDataJson);
+    bool shareBase = outBaseSnapshot && !replayData.enemyGameDataJson.empty();
+    if (shareBase)
+    {
+        *outBaseSnapshot = replayData.enemyGameDataJson;
+    }
+
+    std::string data = replayData.serialize(!shareBase);
+    CCLOG("🎥 ReplaySystem: Stopped recording. Data size: %zu bytes (base %016llx %s)", data.size(),
+          static_cast<unsigned long long>(replayData.baseSnapshotHash), shareBase ? "shared" : "inline");
     return data;
 }
 
-void ReplaySystem::loadReplay(const std::string& replayDataStr)
+void ReplaySystem::loadReplay(const std::string& replayDataStr, const std::string& baseSnapshotJson)
 {
     reset();
     if (replayDataStr.empty()) return;
-    
-    _currentReplayData = ReplayData::deserialize(replayDataStr);
+
+    try
+    {
+        _currentReplayData = ReplayData::deserialize(replayDataStr);
+    }
+    catch (const std::exception& e)
+    {
+        CCLOG("❌ ReplaySystem: Malformed replay (%s)", e.what());
+        _currentReplayData = ReplayData();
+        return;
+    }
+
+    // 按哈希引用的快照由调用方从防守日志存储读出后传入
+    if (_currentReplayData.enemyGameDataJson.empty() && !baseSnapshotJson.empty() &&
+        ReplayData::hashBaseSnapshot(baseSnapshotJson) == _currentReplayData.baseSnapshotHash)
+    {
+        _currentReplayData.enemyGameDataJson = baseSnapshotJson;
+    }
+    if (_currentReplayData.enemyGameDataJson.empty())
+    {
+        CCLOG("❌ ReplaySystem: Base snapshot %016llx not found",
+              static_cast<unsigned long long>(_currentReplayData.baseSnapshotHash));
+    }
+
     _isReplaying = true;
     _nextEventIndex = 0;
+
+    // 其他规则版本录制的回放照常播放，但摘要必然对不上，不再报告不同步
+    _rulesMismatch = _currentReplayData.simRulesVersion != BattleWorld::kRulesVersion;
+    if (_rulesMismatch)
+    {
+        CCLOG("⚠️ ReplaySystem: Replay recorded with sim rules v%u (current v%u), result may differ, checksums skipped",
+              _currentReplayData.simRulesVersion, BattleWorld::kRulesVersion);
+        _desyncDetector.reset(nullptr);
+    }
+    else
+    {
+        _desyncDetector.reset(&_currentReplayData.checksums);
+    }
     
-    CCLOG("🎬 ReplaySystem: Loaded replay with %zu events", _currentReplayData.events.size());
+    CCLOG("🎬 ReplaySystem: Loaded replay with %zu events, %zu checksums", _currentReplayData.events.size(),
+          _currentReplayData.checksums.size());
 }
 
 void ReplaySystem::updateFrame(unsigned int currentFrame)
@@ -231,6 +199,35 @@ void ReplaySystem::updateFrame(unsigned int currentFrame)
     }
 }
 
+void ReplaySystem::seekToFrame(unsigned int frame)
+{
+    if (!_isReplaying) return;
+
+    const auto& events = _currentReplayData.events;
+    auto it = std::upper_bound(events.begin(), events.end(), frame,
+                               [](unsigned int f, const ReplayEvent& event) { return f < event.frameIndex; });
+    _nextEventIndex = static_cast<size_t>(it - events.begin());
+    _desyncDetector.rewind();
+}
+
+unsigned int ReplaySystem::getReplayEndFrame() const
+{
+    if (!_isReplaying) return 0;
+
+    unsigned int endFrame = 0;
+    for (const auto& event : _currentReplayData.events)
+    {
+        if (event.type == ReplayEventType::END_BATTLE) return event.frameIndex;
+        endFrame = std::max(endFrame, event.frameIndex);
+    }
+    if (!_currentReplayData.checksums.empty())
+    {
+        endFrame = std::max(endFrame, _currentReplayData.checksums.back().frameIndex);
+    }
+    return endFrame;
+}
+
+
 void ReplaySystem::setDeployUnitCallback(std::function<void(UnitType, const cocos2d::Vec2&)> callback)
 {
     _deployUnitCallback = callback;
@@ -10,6 +10,7 @@
 #define REPLAY_SYSTEM_H_
 
 #include "cocos2d.h"
+#include "ReplayData.h"
 #include "Unit/UnitTypes.h"
 
 #include <functional>
@@ -17,58 +18,6 @@
 #include <string>
 #include <vector>
 
-/**
- * @enum ReplayEventType
- * @brief 战斗回放事件类型
- */
-enum class ReplayEventType {
-    DEPLOY_UNIT,  ///< 部署士兵
-    END_BATTLE    ///< 结束战斗
-};
-
-/**
- * @struct ReplayEvent
- * @brief 单个回放事件
- */
-struct ReplayEvent {
-    unsigned int frameIndex;  ///< 事件发生的帧数
-    ReplayEventType type;     ///< 事件类型
-    int unitType;             ///< 士兵类型
-    float x;                  ///< X坐标
-    float y;                  ///< Y坐标
-
-    /** @brief 序列化事件 */
-    std::string serialize() const;
-
-    /**
-     * @brief 反序列化事件
-     * @param data 序列化数据
-     * @return ReplayEvent 事件对象
-     */
-    static ReplayEvent deserialize(const std::string& data);
-};
-
-/**
- * @struct ReplayData
- * @brief 完整的回放数据
- */
-struct ReplayData {
-    std::string enemyUserId;         ///< 敌方ID
-    std::string enemyGameDataJson;   ///< 敌方基地数据快照
-    unsigned int randomSeed;         ///< 随机种子
-    std::vector<ReplayEvent> events; ///< 事件列表
-
-    /** @brief 序列化回放数据 */
-    std::string serialize() const;
-
-    /**
-     * @brief 反序列化回放数据
-     * @param data 序列化数据
-     * @return ReplayData 回放数据对象
-     */
-    static ReplayData deserialize(const std::string& data);
-};
-
 /**
  * @class ReplaySystem
  * @brief 战斗回放系统（单例）
@@ -106,20 +55,45 @@ public:
      */
     void recordEndBattle(unsigned int frameIndex);
 
+    /**
+     * @brief 记录状态摘要
+     * @param frameIndex 帧索引（该帧推进完成后）
+     * @param hash 状态摘要
+     */
+    void recordChecksum(unsigned int frameIndex, uint64_t hash);
+
+    /**
+     * @brief 回放时校验状态摘要
+     * @param frameIndex 帧索引（该帧推进完成后）
+     * @param hash 本次回放得到的状态摘要
+     * @return bool 第一次与录制时不一致时返回 false
+     */
+    bool verifyChecksum(unsigned int frameIndex, uint64_t hash);
+
+    /** @brief 回放不同步检测结果 */
+    const ReplayDesyncDetector& getDesyncDetector() const { return _desyncDetector; }
+
+    /** @brief 回放是否由其他模拟规则版本录制（结果可能与录制时不同，不做摘要校验） */
+    bool isRulesMismatch() const { return _rulesMismatch; }
+
     /**
      * @brief 停止录制并获取序列化数据
-     * @return std::string 序列化的回放数据
+     * @param outBaseSnapshot 不为空时敌方基地快照不内嵌，回放中只写内容哈希，
+     *                        快照 JSON 通过它返回，由调用方按哈希保存（同一基地的多场回放共用一份）
+     * @return std::string 二进制回放数据
      */
-    std::string stopRecording();
+    std::string stopRecording(std::string* outBaseSnapshot = nullptr);
 
     /** @brief 获取当前录制的数据 */
     const ReplayData& getCurrentReplayData() const { return _currentReplayData; }
 
     /**
      * @brief 加载回放数据并准备回放
-     * @param replayDataStr 序列化的回放数据
+     * @param replayDataStr 序列化的回放数据（二进制或旧版文本）
+     * @param baseSnapshotJson 回放按哈希引用的基地快照（回放内嵌快照时忽略）
+     * @note 引用的快照缺失或内容哈希不符时 getReplayEnemyGameDataJson 为空
      */
-    void loadReplay(const std::string& replayDataStr);
+    void loadReplay(const std::string& replayDataStr, const std::string& baseSnapshotJson = "");
 
     /**
      * @brief 更新回放逻辑
@@ -127,6 +101,18 @@ public:
      */
     void updateFrame(unsigned int currentFrame);
 
+    /**
+     * @brief 回放定位：把事件进度设为第 frame 帧推进完成之后
+     * @param frame 帧索引，frameIndex 不大于它的事件视为已执行
+     */
+    void seekToFrame(unsigned int frame);
+
+    /**
+     * @brief 回放的最后一帧（结束事件所在帧，没有结束事件时取最后一个事件或摘要的帧）
+     * @return unsigned int 帧索引，未在回放时返回 0
+     */
+    unsigned int getReplayEndFrame() const;
+
     /** @brief 设置部署士兵的回调 */
     void setDeployUnitCallback(std::function<void(UnitType, const cocos2d::Vec2&)> callback);
 
@@ -159,9 +145,11 @@ private:
 
     bool _isRecording = false;  ///< 是否正在录制
     bool _isReplaying = false;  ///< 是否正在回放
+    bool _rulesMismatch = false;  ///< 回放的模拟规则版本与当前不同
 
     ReplayData _currentReplayData;  ///< 当前回放数据
     size_t _nextEventIndex = 0;     ///< 下一个事件索引
+    ReplayDesyncDetector _desyncDetector;  ///< 回放不同步检测
 
     std::function<void(UnitType, const cocos2d::Vec2&)> _deployUnitCallback;  ///< 部署回调
     std::function<void()> _endBattleCallback;  ///< 结束回调
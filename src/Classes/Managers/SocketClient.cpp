@@ -7,6 +7,7 @@
  * License:       MIT License
  ****************************************************************/
 #include "SocketClient.h"
+#include "FrameProfiler.h"
 
 #include <algorithm>
 #include <sstream>
@@ -265,6 +266,7 @@ void SocketClient::recvThreadFunc() {
 // ============================================================================
 
 void SocketClient::processCallbacks() {
+    PROFILE_SCOPE("SocketClient::processCallbacks");
     std::queue<ReceivedPacket> packets;
     {
         std::lock_guard<std::mutex> lock(callback_mutex_);
@@ -506,7 +508,7 @@ void SocketClient::handlePvpAction(const std::string& data) {
         return;
     }
 
-    // 格式: unitType,x,y（逗号分隔）
+    // 格式: unitType,x,y[,checksumFrame,checksum[,frame]]（逗号分隔）
     try {
         std::istringstream iss(data);
         std::string token;
@@ -532,9 +534,25 @@ void SocketClient::handlePvpAction(const std::string& data) {
         }
         float y = std::stof(token);
 
-        cocos2d::log("[SocketClient] PVP_ACTION: type=%d, pos=(%.1f,%.1f)", 
-                     unit_type, x, y);
-        on_pvp_action_(unit_type, x, y);
+        // 可选的攻击方状态摘要：远程操作到达后才部署，双方帧数不同，只用于排查日志
+        std::string checksum_frame;
+        std::string checksum;
+        if (std::getline(iss, checksum_frame, kActionSeparator) &&
+            std::getline(iss, checksum, kActionSeparator) &&
+            checksum_frame != "0") {
+            cocos2d::log("[SocketClient] PVP_ACTION: 攻击方第 %s 帧摘要=%s",
+                         checksum_frame.c_str(), checksum.c_str());
+        }
+
+        // 可选的部署帧：旧客户端不发送时为 0（收到即部署）
+        unsigned int frame = 0;
+        if (std::getline(iss, token, kActionSeparator) && !token.empty()) {
+            frame = static_cast<unsigned int>(std::stoul(token));
+        }
+
+        cocos2d::log("[SocketClient] PVP_ACTION: type=%d, pos=(%.1f,%.1f), frame=%u", 
+                     unit_type, x, y, frame);
+        on_pvp_action_(unit_type, x, y, frame);
         
     } catch (const std::exception& e) {
         cocos2d::log("[SocketClient] PVP_ACTION 解析错误: %s (data=%s)", 
@@ -786,10 +804,20 @@ void SocketClient::requestPvp(const std::string& target_id) {
     cocos2d::log("[SocketClient] 请求 PVP: target=%s", target_id.c_str());
 }
 
-void SocketClient::sendPvpAction(int unit_type, float x, float y) {
-    // 格式: unitType,x,y
+void SocketClient::sendPvpAction(int unit_type, float x, float y,
+                                 unsigned int checksum_frame, uint64_t checksum,
+                                 unsigned int frame) {
+    // 格式: unitType,x,y[,checksumFrame,checksum[,frame]]（服务器原样转发，旧客户端只读前三项）
+    // 附带部署帧时摘要字段占位（0 表示没有摘要），保证字段位置固定
     std::ostringstream oss;
     oss << unit_type << kActionSeparator << x << kActionSeparator << y;
+    if (checksum_frame > 0 || frame > 0) {
+        oss << kActionSeparator << checksum_frame << kActionSeparator
+            << std::hex << checksum << std::dec;
+    }
+    if (frame > 0) {
+        oss << kActionSeparator << frame;
+    }
     sendPacket(PACKET_PVP_ACTION, oss.str());
     cocos2d::log("[SocketClient] 发送 PVP 操作: type=%d, pos=(%.1f,%.1f)", 
                  unit_type, x, y);
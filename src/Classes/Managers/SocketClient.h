@@ -185,7 +185,7 @@ namespace SocketCallback {
     using OnPvpStart = std::function<void(const std::string& role, 
                                           const std::string& opponent_id, 
                                           const std::string& map_data)>;
-    using OnPvpAction = std::function<void(int unit_type, float x, float y)>;
+    using OnPvpAction = std::function<void(int unit_type, float x, float y, unsigned int frame)>;
     using OnPvpEnd = std::function<void(const std::string& reason)>;
     
     // 观战相关
@@ -317,8 +317,13 @@ class SocketClient {
      * @param unit_type 单位类型
      * @param x 部署 X 坐标
      * @param y 部署 Y 坐标
+     * @param checksum_frame 附带的状态摘要所在帧（0 表示不附带）
+     * @param checksum 攻击方在该帧的状态摘要
+     * @param frame 部署生效的模拟帧（0 表示不附带），观战者据此在原帧重放
      */
-    void sendPvpAction(int unit_type, float x, float y);
+    void sendPvpAction(int unit_type, float x, float y,
+                       unsigned int checksum_frame = 0, uint64_t checksum = 0,
+                       unsigned int frame = 0);
     
     /**
      * @brief 结束 PVP 战斗
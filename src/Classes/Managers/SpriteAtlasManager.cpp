@@ -0,0 +1,127 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     SpriteAtlasManager.cpp
+ * File Function: 图集管理器实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "SpriteAtlasManager.h"
+
+#include "json/document.h"
+
+USING_NS_CC;
+
+SpriteAtlasManager& SpriteAtlasManager::getInstance()
+{
+    static SpriteAtlasManager instance;
+    return instance;
+}
+
+bool SpriteAtlasManager::loadManifest(const std::string& manifestFile)
+{
+    _atlasPlists.clear();
+    _frameToAtlas.clear();
+
+    auto* fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(manifestFile))
+    {
+        CCLOG("🧩 未找到图集清单 %s，全部使用散图（运行 pack_atlases 生成）", manifestFile.c_str());
+        return false;
+    }
+
+    rapidjson::Document doc;
+    doc.Parse(fileUtils->getStringFromFile(manifestFile).c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("atlases") || !doc["atlases"].IsArray())
+    {
+        CCLOG("❌ 图集清单解析失败: %s", manifestFile.c_str());
+        return false;
+    }
+
+    for (const auto& atlas : doc["atlases"].GetArray())
+    {
+        if (!atlas.HasMember("plist") || !atlas["plist"].IsString() || !atlas.HasMember("frames") ||
+            !atlas["frames"].IsArray())
+            continue;
+
+        int index = static_cast<int>(_atlasPlists.size());
+        _atlasPlists.push_back(atlas["plist"].GetString());
+        for (const auto& frame : atlas["frames"].GetArray())
+        {
+            if (frame.IsString())
+                _frameToAtlas[frame.GetString()] = index;
+        }
+    }
+
+    CCLOG("🧩 图集清单: %zu 张图集, %zu 帧", _atlasPlists.size(), _frameToAtlas.size());
+    return true;
+}
+
+std::string SpriteAtlasManager::getAtlasPlist(const std::string& imageFile) const
+{
+    auto it = _frameToAtlas.find(imageFile);
+    return it != _frameToAtlas.end() ? _atlasPlists[it->second] : std::string();
+}
+
+void SpriteAtlasManager::ensureAtlasLoaded(int atlasIndex)
+{
+    const std::string& plist = _atlasPlists[atlasIndex];
+    auto*              cache = SpriteFrameCache::getInstance();
+    if (cache->isSpriteFramesWithFileLoaded(plist))
+        return;
+
+    cache->addSpriteFramesWithFile(plist);
+    _stats.atlasPagesLoaded++;
+}
+
+SpriteFrame* SpriteAtlasManager::getSpriteFrame(const std::string& imageFile)
+{
+    auto it = _frameToAtlas.find(imageFile);
+    if (it != _frameToAtlas.end())
+    {
+        ensureAtlasLoaded(it->second);
+        SpriteFrame* frame = SpriteFrameCache::getInstance()->getSpriteFrameByName(imageFile);
+        if (frame)
+        {
+            _stats.atlasFrameHits++;
+            return frame;
+        }
+    }
+
+    auto* texture = Director::getInstance()->getTextureCache()->addImage(imageFile);
+    if (!texture)
+        return nullptr;
+
+    if (_looseFiles.insert(imageFile).second)
+        _stats.looseTextures++;
+    return SpriteFrame::createWithTexture(texture, Rect(Vec2::ZERO, texture->getContentSize()));
+}
+
+void SpriteAtlasManager::beginScene(const std::string& sceneName)
+{
+    _sceneName       = sceneName;
+    _sceneStartStats = _stats;
+    _sceneStartTime  = std::chrono::high_resolution_clock::now();
+}
+
+void SpriteAtlasManager::endScene()
+{
+    if (_sceneName.empty())
+        return;
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() -
+                                                                 _sceneStartTime)
+                           .count();
+    int pages = _stats.atlasPagesLoaded - _sceneStartStats.atlasPagesLoaded;
+    int loose = _stats.looseTextures - _sceneStartStats.looseTextures;
+    int hits  = _stats.atlasFrameHits - _sceneStartStats.atlasFrameHits;
+    CCLOG("🧩 %s 加载 %.1f ms: 新纹理 %d 张（图集 %d + 散图 %d），图集帧命中 %d 次", _sceneName.c_str(), elapsedMs,
+          pages + loose, pages, loose, hits);
+    _sceneName.clear();
+}
+
+void SpriteAtlasManager::logStats() const
+{
+    CCLOG("🧩 纹理累计: 图集 %d 张, 散图 %d 张, 图集帧命中 %d 次", _stats.atlasPagesLoaded, _stats.looseTextures,
+          _stats.atlasFrameHits);
+}
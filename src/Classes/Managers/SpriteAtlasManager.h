@@ -0,0 +1,103 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     SpriteAtlasManager.h
+ * File Function: 图集管理器 - 按清单把散图路径解析到离线打包的图集帧，未打包时回退到散图
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __SPRITE_ATLAS_MANAGER_H__
+#define __SPRITE_ATLAS_MANAGER_H__
+
+#include "cocos2d.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @struct SpriteAtlasStats
+ * @brief 纹理加载统计（累计值）
+ */
+struct SpriteAtlasStats
+{
+    int atlasPagesLoaded = 0; ///< 已加载的图集页（每页一张纹理）
+    int looseTextures    = 0; ///< 以散图方式加载的纹理
+    int atlasFrameHits   = 0; ///< 从图集解析到的帧
+};
+
+/**
+ * @class SpriteAtlasManager
+ * @brief 图集管理器（单例）
+ *
+ * 清单由 atlas_packer 生成（Resources/atlas/atlas_manifest.json），帧名即原散图路径。
+ * 调用方始终传入散图路径：清单中有该帧时按需加载所在图集页并返回图集帧，
+ * 否则（未打包、清单缺失）退回 TextureCache 加载散图，行为与打包前一致。
+ */
+class SpriteAtlasManager
+{
+public:
+    static SpriteAtlasManager& getInstance();
+
+    /**
+     * @brief 读取图集清单（只建立 帧 -> 图集 索引，图集页在首次使用时加载）
+     * @param manifestFile 清单路径（相对 Resources）
+     * @return bool 是否读取成功；失败时全部走散图
+     */
+    bool loadManifest(const std::string& manifestFile = "atlas/atlas_manifest.json");
+
+    /**
+     * @brief 获取散图路径对应的精灵帧
+     * @param imageFile 散图路径（相对 Resources）
+     * @return cocos2d::SpriteFrame* 图集帧或整张散图的帧（自动释放），图片不存在时返回 nullptr
+     */
+    cocos2d::SpriteFrame* getSpriteFrame(const std::string& imageFile);
+
+    /** @brief 散图是否已打入图集 */
+    bool isPacked(const std::string& imageFile) const { return _frameToAtlas.count(imageFile) > 0; }
+
+    /**
+     * @brief 获取散图所在图集的 plist（供资源预加载改为加载整页图集）
+     * @param imageFile 散图路径
+     * @return std::string plist 路径，未打包时为空
+     */
+    std::string getAtlasPlist(const std::string& imageFile) const;
+
+    /**
+     * @brief 开始统计一个场景的加载（记录起始时间和计数）
+     * @param sceneName 场景名
+     */
+    void beginScene(const std::string& sceneName);
+
+    /** @brief 结束场景加载统计，输出耗时以及该场景新加载的图集页/散图纹理数 */
+    void endScene();
+
+    const SpriteAtlasStats& getStats() const { return _stats; }
+
+    /** @brief 输出累计统计 */
+    void logStats() const;
+
+private:
+    SpriteAtlasManager() = default;
+
+    /**
+     * @brief 确保图集页已加入 SpriteFrameCache
+     * @param atlasIndex 图集下标
+     */
+    void ensureAtlasLoaded(int atlasIndex);
+
+    std::vector<std::string>             _atlasPlists;  ///< 图集 plist 路径
+    std::unordered_map<std::string, int> _frameToAtlas; ///< 帧名（散图路径）-> 图集下标
+    std::unordered_set<std::string>      _looseFiles;   ///< 已加载的散图（去重计数）
+
+    SpriteAtlasStats _stats;
+
+    std::string                                    _sceneName;       ///< 正在统计的场景
+    SpriteAtlasStats                               _sceneStartStats; ///< 场景开始时的计数
+    std::chrono::high_resolution_clock::time_point _sceneStartTime;  ///< 场景开始时间
+};
+
+#endif // __SPRITE_ATLAS_MANAGER_H__
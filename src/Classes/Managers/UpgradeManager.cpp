@@ -8,6 +8,7 @@
  ****************************************************************/
 #include "UpgradeManager.h"
 #include "ResourceManager.h"
+#include "FrameProfiler.h"
 #include "Buildings/BaseBuilding.h"
 #include <algorithm>
 #include <cmath>
@@ -324,6 +325,8 @@ void UpgradeManager::completeUpgrade(UpgradeTask& task)
 
 void UpgradeManager::update(float dt)
 {
+    PROFILE_SCOPE("UpgradeManager::update");
+
     try {
         if (_upgradeTasks.empty()) return;
 
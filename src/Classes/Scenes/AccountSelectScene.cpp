@@ -11,6 +11,7 @@
 #include "Audio/AudioManager.h"
 #include "DraggableMapScene.h"
 #include "Managers/AccountManager.h"
+#include "Managers/AssetPreloader.h"
 #include "Managers/MusicManager.h"
 #include "UI/LoadingLayer.h"
 #include "audio/include/AudioEngine.h"
@@ -594,7 +595,18 @@ void AccountSelectScene::showLoadingAndEnterGame()
     if (_loadingLayer)
     {
         this->addChild(_loadingLayer, 1000);
-        
+
+        // 村庄清单 + 当前账号的地图和基地建筑外观，进度按实际加载字节显示
+        AssetManifest manifest      = AssetPreloader::loadManifest("preload/village.json");
+        const auto*   currentAccount = AccountManager::getInstance().getCurrentAccount();
+        if (currentAccount)
+        {
+            if (!currentAccount->assignedMapName.empty())
+                manifest.textures.push_back(currentAccount->assignedMapName);
+            manifest.merge(AssetPreloader::manifestForBase(currentAccount->gameState.buildings));
+        }
+        _loadingLayer->setPreloadManifest("village", manifest);
+
         // 显示加载界面，完成后切换到主场景
         _loadingLayer->show([]() {
             auto scene = DraggableMapScene::createScene();
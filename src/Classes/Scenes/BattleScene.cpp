@@ -13,10 +13,14 @@
 #include "Buildings/DefenseBuilding.h"
 #include "DraggableMapScene.h"
 #include "GridMap.h"
+#include "Managers/AssetPreloader.h"
 #include "Managers/DefenseLogSystem.h"
+#include "Managers/FrameProfiler.h"
 #include "Managers/MusicManager.h"
 #include "Managers/SocketClient.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Managers/TroopInventory.h"
+#include "UI/HealthBarLayer.h"
 #include "ResourceManager.h"
 #include "Unit/UnitTypes.h"
 #include <ctime>
@@ -49,10 +53,10 @@ BattleScene* BattleScene::createWithEnemyData(const AccountGameData& enemyData,
     return nullptr;
 }
 
-BattleScene* BattleScene::createWithReplayData(const std::string& replayDataStr)
+BattleScene* BattleScene::createWithReplayData(const std::string& replayDataStr, const std::string& baseSnapshotJson)
 {
     BattleScene* scene = new (std::nothrow) BattleScene();
-    if (scene && scene->initWithReplayData(replayDataStr))
+    if (scene && scene->initWithReplayData(replayDataStr, baseSnapshotJson))
     {
         scene->autorelease();
         return scene;
@@ -75,6 +79,8 @@ BattleScene::~BattleScene()
 
 bool BattleScene::init()
 {
+    PROFILE_SCOPE("BattleScene::init");
+
     if (!Scene::init())
     {
         return false;
@@ -100,11 +106,15 @@ bool BattleScene::initWithEnemyData(const AccountGameData& enemyData)
 
 bool BattleScene::initWithEnemyData(const AccountGameData& enemyData, const std::string& enemyUserId)
 {
+    PROFILE_SCOPE("BattleScene::initWithEnemyData");
+
     if (!Scene::init())
     {
         return false;
     }
 
+    SpriteAtlasManager::getInstance().beginScene("BattleScene::initWithEnemyData");
+
     _visibleSize = Director::getInstance()->getVisibleSize();
 
     setupMap();
@@ -114,7 +124,7 @@ bool BattleScene::initWithEnemyData(const AccountGameData& enemyData, const std:
     // 初始化战斗管理器
     if (_battleManager)
     {
-        _battleManager->init(_mapSprite, enemyData, enemyUserId, false);
+        _battleManager->init(_mapSprite, _gridMap, enemyData, enemyUserId, false);
 
         // 设置UI更新回调
         _battleManager->setUIUpdateCallback([this]() {
@@ -300,11 +310,15 @@ bool BattleScene::initWithEnemyData(const AccountGameData& enemyData, const std:
 
     scheduleUpdate();
 
+    SpriteAtlasManager::getInstance().endScene();
+
     return true;
 }
 
-bool BattleScene::initWithReplayData(const std::string& replayDataStr)
+bool BattleScene::initWithReplayData(const std::string& replayDataStr, const std::string& baseSnapshotJson)
 {
+    PROFILE_SCOPE("BattleScene::initWithReplayData");
+
     if (!Scene::init())
     {
         return false;
@@ -314,7 +328,7 @@ bool BattleScene::initWithReplayData(const std::string& replayDataStr)
 
     // 加载回放数据
     auto& replaySystem = ReplaySystem::getInstance();
-    replaySystem.loadReplay(replayDataStr);
+    replaySystem.loadReplay(replayDataStr, baseSnapshotJson);
 
     std::string enemyUserId = replaySystem.getReplayEnemyUserId();
     std::string enemyJson   = replaySystem.getReplayEnemyGameDataJson();
@@ -337,7 +351,7 @@ bool BattleScene::initWithReplayData(const std::string& replayDataStr)
     // 初始化战斗管理器
     if (_battleManager)
     {
-        _battleManager->init(_mapSprite, enemyData, enemyUserId, true);
+        _battleManager->init(_mapSprite, _gridMap, enemyData, enemyUserId, true);
 
         _battleManager->setUIUpdateCallback([this]() {
             if (_battleUI && _battleManager)
@@ -345,16 +359,23 @@ bool BattleScene::initWithReplayData(const std::string& replayDataStr)
                 _battleUI->updateTimer(static_cast<int>(_battleManager->getRemainingTime()));
                 _battleUI->updateStars(_battleManager->getStars());
                 _battleUI->updateDestruction(_battleManager->getDestructionPercent());
+                _battleUI->updateReplayScrubber(_battleManager->getCurrentFrame() *
+                                                _battleManager->getFrameDuration());
             }
         });
 
         _battleManager->setBattleEndCallback([this]() {
+            // 结算画面按正常速度播放表现和音效
+            setTimeScale(1.0f);
+
             if (_battleUI && _battleManager)
             {
                 int trophyChange = _battleManager->getStars() * 10 - (3 - _battleManager->getStars()) * 3;
                 _battleUI->showResultPanel(_battleManager->getStars(), _battleManager->getDestructionPercent(),
                                            _battleManager->getGoldLooted(), _battleManager->getElixirLooted(),
                                            trophyChange, true);
+                _battleUI->updateReplayScrubber(_battleManager->getCurrentFrame() *
+                                                _battleManager->getFrameDuration());
             }
         });
     }
@@ -397,6 +418,29 @@ bool BattleScene::initWithReplayData(const std::string& replayDataStr)
         _battleUI->setEndBattleButtonText("退出回放");
         _battleUI->setReplayMode(true);
         _battleUI->showBattleHUD(true);
+
+        // 进度条：拖动或点击定位，从结算画面定位回战斗中时恢复战斗HUD
+        if (_battleManager)
+        {
+            _battleUI->showReplayScrubber(replaySystem.getReplayEndFrame() * _battleManager->getFrameDuration());
+            _battleUI->setReplaySeekCallback([this](float seconds) {
+                if (!_battleManager || !_battleUI)
+                    return;
+
+                bool wasFinished = _battleManager->getState() == BattleManager::BattleState::FINISHED;
+                _battleManager->seekReplay(static_cast<unsigned int>(seconds / _battleManager->getFrameDuration()));
+                if (wasFinished && _battleManager->getState() != BattleManager::BattleState::FINISHED)
+                {
+                    _battleUI->hideResultPanel();
+                    _battleUI->updateStatus("🔴 战斗回放中", Color4B::RED);
+                }
+            });
+            _battleUI->setReplaySpeedCallbacks([this]() { toggleSpeed(); },
+                                               [this]() {
+                                                   if (_battleManager)
+                                                       _battleManager->skipReplayToResult();
+                                               });
+        }
     }
 
     // 回放模式：立即开始战斗，跳过准备阶段
@@ -443,10 +487,26 @@ void BattleScene::setupMap()
         _gridMap->setStartPixel(Vec2(1406.0f, 2107.2f));
         _mapSprite->addChild(_gridMap, 999);
 
+        // 建筑和单位放在同一个深度排序层中：位于网格之上、部署提示之下，
+        // 层级变化时只做增量插入排序，不再对整张地图的子节点全量排序
+        _depthLayer = DepthSortLayer::create();
+        _depthLayer->setContentSize(mapSize);
+        _mapSprite->addChild(_depthLayer, 1000);
+        if (_battleManager)
+            _battleManager->setDepthLayer(_depthLayer);
+
+        // 所有血条由一个血条层统一绘制，位于建筑和单位之上
+        _healthBarLayer = HealthBarLayer::create();
+        _healthBarLayer->setContentSize(mapSize);
+        _mapSprite->addChild(_healthBarLayer, 1001);
+        if (_battleManager)
+            _battleManager->setHealthBarLayer(_healthBarLayer);
+
         // 创建建筑管理器
         _buildingManager = BuildingManager::create();
         this->addChild(_buildingManager);
         _buildingManager->setup(_mapSprite, _gridMap);
+        _buildingManager->setBuildingLayer(_depthLayer);
 
         updateBoundary();
     }
@@ -454,13 +514,12 @@ void BattleScene::setupMap()
 
 void BattleScene::disableAllBuildingsBattleMode()
 {
-    if (!_mapSprite)
+    if (!_buildingManager)
         return;
 
-    auto& children = _mapSprite->getChildren();
-    for (auto child : children)
+    for (auto* building : _buildingManager->getBuildings())
     {
-        auto* defenseBuilding = dynamic_cast<DefenseBuilding*>(child);
+        auto* defenseBuilding = dynamic_cast<DefenseBuilding*>(building);
         if (defenseBuilding)
         {
             defenseBuilding->disableBattleMode();
@@ -473,14 +532,9 @@ void BattleScene::enableAllBuildingsBattleMode()
     if (!_buildingManager)
         return;
 
-    auto buildingSprite = _mapSprite;
-    if (!buildingSprite)
-        return;
-
-    auto& children = buildingSprite->getChildren();
-    for (auto child : children)
+    for (auto* building : _buildingManager->getBuildings())
     {
-        auto* defenseBuilding = dynamic_cast<DefenseBuilding*>(child);
+        auto* defenseBuilding = dynamic_cast<DefenseBuilding*>(building);
         if (defenseBuilding)
         {
             defenseBuilding->enableBattleMode();
@@ -685,6 +739,8 @@ void BattleScene::showDeployFailedFeedback(const cocos2d::Vec2& worldPos,
 
 void BattleScene::update(float dt)
 {
+    PROFILE_SCOPE("BattleScene::update");
+
     // 主线程处理网络回调
     SocketClient::getInstance().processCallbacks();
 
@@ -721,19 +777,38 @@ void BattleScene::update(float dt)
     if (_battleManager)
     {
         _battleManager->update(scaledDt);
+
+        // 追上实时进度后恢复观战状态显示
+        if (_spectateCatchingUp && !_battleManager->isCatchingUp())
+        {
+            _spectateCatchingUp = false;
+            if (_battleUI && _battleManager->getState() != BattleManager::BattleState::FINISHED)
+            {
+                _battleUI->updateStatus(StringUtils::format("📺 观战中: %s vs %s", _spectateAttackerId.c_str(),
+                                                            _spectateDefenderId.c_str()),
+                                        Color4B::ORANGE);
+            }
+        }
     }
 }
 
 void BattleScene::toggleSpeed()
 {
-    if (_timeScale >= 4.0f)
-    {
-        _timeScale = 1.0f;
-    }
-    else
-    {
-        _timeScale *= 2.0f;
-    }
+    // 1x -> 2x -> 4x -> 8x -> 16x（8x 起仅回放）
+    bool  isReplay = _battleManager && _battleManager->isReplayMode();
+    float maxScale = isReplay ? kMaxReplayTimeScale : kMaxFullRenderTimeScale;
+    setTimeScale(_timeScale >= maxScale ? 1.0f : _timeScale * 2.0f);
+}
+
+void BattleScene::setTimeScale(float timeScale)
+{
+    _timeScale = timeScale;
+
+    // 更高倍率下逐帧表现的渲染开销大于模拟，只保留模拟的完整精度
+    if (_battleManager)
+        _battleManager->setFastForward(_timeScale > kMaxFullRenderTimeScale);
+    if (_battleUI)
+        _battleUI->setReplaySpeedText(StringUtils::format("%dx", static_cast<int>(_timeScale)));
 }
 
 // ==================== PVP/观战模式 ====================
@@ -788,12 +863,7 @@ void BattleScene::setSpectateMode(const std::string& attackerId,
     {
         _battleManager->setNetworkMode(true, false);
         _battleManager->setBattleMode(BattleMode::SPECTATE);
-        
-        // 设置时间偏移，同步战斗进度
-        if (elapsedMs > 0)
-        {
-            _battleManager->setTimeOffset(elapsedMs);
-        }
+        // 战斗进度在回放历史时通过追帧同步（见 replaySpectateHistory）
     }
 
     if (_battleUI)
@@ -853,7 +923,7 @@ void BattleScene::replaySpectateHistory()
         // 🔧 将操作添加到已处理集合（用于后续去重）
 //         _processedActionSet.insert(action);
         
-        // 格式解析: "unitType,x,y"
+        // 格式解析: "unitType,x,y[,checksumFrame,checksum,frame]"
         std::vector<std::string> parts;
         std::stringstream        ss(action);
         std::string              item;
@@ -866,12 +936,13 @@ void BattleScene::replaySpectateHistory()
         {
             try
             {
-                int   type = std::stoi(parts[0]);
-                float x    = std::stof(parts[1]);
-                float y    = std::stof(parts[2]);
+                int          type  = std::stoi(parts[0]);
+                float        x     = std::stof(parts[1]);
+                float        y     = std::stof(parts[2]);
+                unsigned int frame = parts.size() >= 6 ? static_cast<unsigned int>(std::stoul(parts[5])) : 0;
 
-                CCLOG("📺 回放历史操作[%zu]: type=%d, pos=(%.1f,%.1f)", i, type, x, y);
-                _battleManager->deployUnitRemote(static_cast<UnitType>(type), Vec2(x, y));
+                CCLOG("📺 回放历史操作[%zu]: type=%d, pos=(%.1f,%.1f), frame=%u", i, type, x, y, frame);
+                _battleManager->deployUnitRemote(static_cast<UnitType>(type), Vec2(x, y), frame);
             }
             catch (const std::exception& e)
             {
@@ -888,6 +959,28 @@ void BattleScene::replaySpectateHistory()
     _spectateHistoryProcessed = true;
     _spectateHistoryIndex = _spectateHistory.size();
     CCLOG("📺 历史回放完成，已处理操作数: %zu", _processedActionSet.size());
+
+    // 历史回放期间缓存的实时操作按各自的帧排队
+    for (const auto& pending : _pendingRemoteActions)
+    {
+        std::ostringstream oss;
+        oss << std::get<0>(pending) << "," << std::get<1>(pending) << "," << std::get<2>(pending);
+        if (!_processedActionSet.insert(oss.str()).second)
+            continue;
+
+        _spectateReceivedActionCount++;
+        _battleManager->deployUnitRemote(static_cast<UnitType>(std::get<0>(pending)),
+                                         Vec2(std::get<1>(pending), std::get<2>(pending)), std::get<3>(pending));
+    }
+    _pendingRemoteActions.clear();
+
+    // 从第 1 帧开始按原始帧重放所有部署，无渲染地追到实时进度
+    _battleManager->startCatchUp(_spectateElapsedMs);
+    _spectateCatchingUp = _battleManager->isCatchingUp();
+    if (_spectateCatchingUp && _battleUI)
+    {
+        _battleUI->updateStatus("📺 正在同步战斗进度...", Color4B::YELLOW);
+    }
     
     // 🔧 处理在历史回放期间收到了结束信号的情况
     checkSpectateEndCondition();
@@ -943,10 +1036,10 @@ void BattleScene::onEnter()
         auto& client = SocketClient::getInstance();
 
         // 接收远程操作
-        client.setOnPvpAction([this](int unitType, float x, float y) {
+        client.setOnPvpAction([this](int unitType, float x, float y, unsigned int frame) {
             if (_battleManager)
             {
-                Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, unitType, x, y]() {
+                Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, unitType, x, y, frame]() {
                     if (!_battleManager)
                         return;
                         
@@ -958,7 +1051,7 @@ void BattleScene::onEnter()
                         {
                             CCLOG("📺 历史回放未完成，缓存远程操作: type=%d, pos=(%.1f,%.1f)", 
                                   unitType, x, y);
-                            _pendingRemoteActions.push_back(std::make_tuple(unitType, x, y));
+                            _pendingRemoteActions.push_back(std::make_tuple(unitType, x, y, frame));
                             return;
                         }
                         
@@ -996,7 +1089,7 @@ void BattleScene::onEnter()
                         CCLOG("📥 收到远程部署: type=%d, pos=(%.1f,%.1f)", unitType, x, y);
                     }
                     
-                    _battleManager->deployUnitRemote((UnitType)unitType, Vec2(x, y));
+                    _battleManager->deployUnitRemote((UnitType)unitType, Vec2(x, y), frame);
                     
                     // 🔧 检查是否所有操作都已接收完毕
                     checkSpectateEndCondition();
@@ -1051,7 +1144,11 @@ void BattleScene::onEnter()
         {
             _battleManager->setNetworkDeployCallback([this](UnitType type, const Vec2& pos) {
                 CCLOG("📤 发送远程部署: type=%d, pos=(%.1f,%.1f)", (int)type, pos.x, pos.y);
-                SocketClient::getInstance().sendPvpAction((int)type, pos.x, pos.y);
+                // 部署在下一帧推进之前生效（与录制回放一致），观战者据此在原帧重放
+                SocketClient::getInstance().sendPvpAction((int)type, pos.x, pos.y,
+                                                          _battleManager->getLastChecksumFrame(),
+                                                          _battleManager->getLastChecksum(),
+                                                          _battleManager->getCurrentFrame() + 1);
             });
         }
     }
@@ -1078,6 +1175,9 @@ void BattleScene::onExit()
         }
     }
 
+    // 战斗资源不再需要：超出纹理预算时在下一帧回收
+    AssetPreloader::getInstance().releaseScene("battle");
+
     Scene::onExit();
 }
 
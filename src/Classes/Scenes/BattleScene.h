@@ -65,14 +65,16 @@ class BattleScene : public cocos2d::Scene {
     /**
      * @brief 创建战斗回放场景
      * @param replayDataStr 序列化的回放数据
+     * @param baseSnapshotJson 回放按哈希引用的基地快照（回放内嵌快照时为空）
      */
-    static BattleScene* createWithReplayData(const std::string& replayDataStr);
+    static BattleScene* createWithReplayData(const std::string& replayDataStr,
+                                             const std::string& baseSnapshotJson = "");
 
     virtual bool init() override;
     virtual bool initWithEnemyData(const GameStateData& enemyData);
     virtual bool initWithEnemyData(const GameStateData& enemyData, 
                                    const std::string& enemyUserId);
-    virtual bool initWithReplayData(const std::string& replayDataStr);
+    virtual bool initWithReplayData(const std::string& replayDataStr, const std::string& baseSnapshotJson);
 
     virtual void update(float dt) override;
     virtual void onEnter() override;
@@ -117,6 +119,8 @@ class BattleScene : public cocos2d::Scene {
     cocos2d::Size    _visibleSize;
     cocos2d::Sprite* _mapSprite       = nullptr;
     GridMap*         _gridMap         = nullptr;
+    DepthSortLayer*  _depthLayer      = nullptr; ///< 建筑、单位和投射物的深度排序层
+    HealthBarLayer*  _healthBarLayer  = nullptr; ///< 建筑和单位的血条层
     BuildingManager* _buildingManager = nullptr;
     BattleUI*        _battleUI        = nullptr;
     BattleManager*   _battleManager   = nullptr;
@@ -145,6 +149,15 @@ class BattleScene : public cocos2d::Scene {
     void returnToMainScene();
     void toggleSpeed();
 
+    /**
+     * @brief 设置时间倍率
+     * @param timeScale 倍率，超过 kMaxFullRenderTimeScale 时战斗管理器进入高倍速播放
+     */
+    void setTimeScale(float timeScale);
+
+    static constexpr float kMaxFullRenderTimeScale = 4.0f;  ///< 逐帧播放表现的最高倍率
+    static constexpr float kMaxReplayTimeScale     = 16.0f; ///< 回放最高倍率
+
     // ==================== 地图控制 ====================
     cocos2d::Rect _mapBoundary;
     void          updateBoundary();
@@ -183,12 +196,13 @@ class BattleScene : public cocos2d::Scene {
     int64_t     _spectateElapsedMs = 0;     ///< 观战时已经过的时间
     std::vector<std::string> _spectateHistory;  ///< 观战历史操作
     bool        _historyReplayed = false;   ///< 历史是否已回放
+    bool        _spectateCatchingUp = false; ///< 是否正在追赶战斗进度
     size_t      _spectateHistoryIndex = 0;  ///< 已处理的历史操作索引（用于跳过重复）
 
     // 🔧 新增：用于防止重复部署的同步机制
     bool _spectateHistoryProcessed = false;  // 历史操作是否已完全处理
     std::set<std::string> _processedActionSet;  // 已处理的操作集合（用于去重）
-    std::vector<std::tuple<int, float, float>> _pendingRemoteActions;  // 缓存的远程操作
+    std::vector<std::tuple<int, float, float, unsigned int>> _pendingRemoteActions;  // 缓存的远程操作（含部署帧）
 
     // 🔧 新增：观战同步结束机制
     bool   _spectatePendingEnd = false;       ///< 是否收到结束信号但等待同步
@@ -20,9 +20,12 @@
 #include "BuildingUpgradeUI.h"
 #include "HUDLayer.h"
 #include "InputController.h"
+#include "Managers/AssetPreloader.h"
 #include "Managers/DefenseLogSystem.h"
+#include "Managers/FrameProfiler.h"
 #include "Managers/MusicManager.h"
 #include "Managers/ResourceCollectionManager.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Managers/TroopInventory.h"
 #include "Managers/UpgradeManager.h"
 #include "MapController.h"
@@ -31,6 +34,7 @@
 #include "ShopLayer.h"
 #include "SocketClient.h"
 #include "UI/ClanPanel.h"
+#include "UI/LoadingLayer.h"
 #include "UI/PlayerListLayer.h"
 #include "Unit/UnitTypes.h"
 #include "ui/CocosGUI.h"
@@ -59,6 +63,8 @@ cocos2d::Scene* createDraggableMapScene()
 
 bool DraggableMapScene::init()
 {
+    PROFILE_SCOPE("DraggableMapScene::init");
+
     if (!Scene::init())
     {
         return false;
@@ -91,8 +97,14 @@ bool DraggableMapScene::init()
     _eventDispatcher->addEventListenerWithFixedPriority(listener, 1);
     _sceneResumeListener = listener;
 
-    // 延迟加载游戏状态
-    this->scheduleOnce([this](float) { loadGameState(); }, 0.1f, "load_game_state");
+    // 延迟加载游戏状态（建筑纹理在此加载，统计耗时与纹理数）
+    this->scheduleOnce(
+        [this](float) {
+            SpriteAtlasManager::getInstance().beginScene("DraggableMapScene::loadGameState");
+            loadGameState();
+            SpriteAtlasManager::getInstance().endScene();
+        },
+        0.1f, "load_game_state");
     
     // 延迟检测并显示防守日志
     this->scheduleOnce([this](float) {
@@ -116,6 +128,8 @@ void DraggableMapScene::onEnter()
 
 void DraggableMapScene::initializeManagers()
 {
+    PROFILE_SCOPE("DraggableMapScene::initializeManagers");
+
     // 获取账号分配地图
     std::string assignedMap = "map/Map1.png";
     auto& accMgr = AccountManager::getInstance();
@@ -839,6 +853,7 @@ void DraggableMapScene::startPlacingBuilding(const BuildingData& data)
 
 void DraggableMapScene::update(float dt)
 {
+    PROFILE_SCOPE("DraggableMapScene::update");
     SocketClient::getInstance().processCallbacks();
 }
 
@@ -1057,9 +1072,16 @@ void DraggableMapScene::startAttack(const std::string& targetUserId)
     }
 
     CCLOG("Loading battle scene (TH Level=%d, Buildings=%zu)", enemyGameData.townHallLevel, enemyGameData.buildings.size());
-    auto battleScene = BattleScene::createWithEnemyData(enemyGameData, targetUserId);
-    if (battleScene)
-        Director::getInstance()->pushScene(TransitionFade::create(0.3f, battleScene));
-    else
-        _uiController->showHint("创建战斗场景失败！");
+
+    // 先异步预加载战斗资源和敌方基地的建筑外观，避免首次部署/首次点击时同步加载卡顿
+    AssetManifest manifest = AssetPreloader::loadManifest("preload/battle.json");
+    manifest.merge(AssetPreloader::manifestForBase(enemyGameData.buildings));
+
+    LoadingLayer::preloadAndRun(this, "battle", manifest, [this, enemyGameData, targetUserId]() {
+        auto battleScene = BattleScene::createWithEnemyData(enemyGameData, targetUserId);
+        if (battleScene)
+            Director::getInstance()->pushScene(TransitionFade::create(0.3f, battleScene));
+        else
+            _uiController->showHint("创建战斗场景失败！");
+    });
 }
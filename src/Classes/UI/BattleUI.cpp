@@ -10,6 +10,9 @@
 #include "BattleUI.h"
 #include "Audio/AudioManager.h"
 
+#include <algorithm>
+#include <cmath>
+
 USING_NS_CC;
 using namespace ui;
 
@@ -750,6 +753,175 @@ void BattleUI::showReturnButton(bool visible)
         _returnButton->setVisible(visible);
 }
 
+void BattleUI::setReplaySeekCallback(const std::function<void(float)>& callback)
+{
+    _onReplaySeek = callback;
+}
+
+void BattleUI::showReplayScrubber(float durationSeconds)
+{
+    _replayDuration = std::max(durationSeconds, 1.0f);
+    if (_scrubberPanel)
+    {
+        _scrubberPanel->setVisible(true);
+        setScrubberPosition(0.0f);
+        return;
+    }
+
+    const float trackHeight = 10.0f;
+    const float knobSize    = 24.0f;
+    _scrubberWidth          = _visibleSize.width * 0.6f;
+
+    _scrubberPanel = Node::create();
+    _scrubberPanel->setContentSize(Size(_scrubberWidth, knobSize));
+    _scrubberPanel->setPosition(Vec2((_visibleSize.width - _scrubberWidth) / 2, 120));
+    this->addChild(_scrubberPanel, 100);
+
+    // 轨道
+    auto track = LayerColor::create(Color4B(0, 0, 0, 160), _scrubberWidth, trackHeight);
+    track->setPosition(Vec2(0, (knobSize - trackHeight) / 2));
+    _scrubberPanel->addChild(track);
+
+    // 已播放部分
+    _scrubberFill = LayerColor::create(Color4B(255, 200, 50, 255), 0, trackHeight);
+    _scrubberFill->setPosition(track->getPosition());
+    _scrubberPanel->addChild(_scrubberFill, 1);
+
+    // 滑块
+    _scrubberKnob = LayerColor::create(Color4B::WHITE, knobSize, knobSize);
+    _scrubberKnob->setIgnoreAnchorPointForPosition(false);
+    _scrubberKnob->setAnchorPoint(Vec2(0.5f, 0.5f));
+    _scrubberPanel->addChild(_scrubberKnob, 2);
+
+    // 时间文本
+    _scrubberTimeLabel = Label::createWithSystemFont("0:00 / 0:00", "Arial", 20);
+    _scrubberTimeLabel->setAnchorPoint(Vec2(0.0f, 0.5f));
+    _scrubberTimeLabel->setPosition(Vec2(_scrubberWidth + 15, knobSize / 2));
+    _scrubberTimeLabel->setTextColor(Color4B::WHITE);
+    _scrubberPanel->addChild(_scrubberTimeLabel, 2);
+
+    // 拖动时只移动滑块，松手时定位一次；点击轨道直接定位
+    auto touchListener = EventListenerTouchOneByOne::create();
+    touchListener->setSwallowTouches(true);
+
+    touchListener->onTouchBegan = [this, knobSize](Touch* touch, Event* event) {
+        if (!_scrubberPanel->isVisible())
+            return false;
+
+        Vec2 locationInNode = _scrubberPanel->convertToNodeSpace(touch->getLocation());
+        Rect rect           = Rect(-knobSize / 2, -knobSize / 2, _scrubberWidth + knobSize, knobSize * 2);
+        if (!rect.containsPoint(locationInNode))
+            return false;
+
+        _isScrubbing = true;
+        setScrubberPosition(scrubberTimeAt(touch->getLocation()));
+        return true;
+    };
+
+    touchListener->onTouchMoved = [this](Touch* touch, Event* event) {
+        setScrubberPosition(scrubberTimeAt(touch->getLocation()));
+    };
+
+    touchListener->onTouchEnded = [this](Touch* touch, Event* event) {
+        _isScrubbing  = false;
+        float seconds = scrubberTimeAt(touch->getLocation());
+        setScrubberPosition(seconds);
+        if (_onReplaySeek)
+            _onReplaySeek(seconds);
+    };
+
+    touchListener->onTouchCancelled = [this](Touch* touch, Event* event) { _isScrubbing = false; };
+
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(touchListener, _scrubberPanel);
+
+    // 倍速和跳到结果按钮
+    const float buttonHeight     = 36.0f;
+    auto        createTextButton = [buttonHeight](const std::string& title, float width, const Color4B& color) {
+        auto button = Button::create();
+        button->ignoreContentAdaptWithSize(false);
+        button->setContentSize(Size(width, buttonHeight));
+        button->setTitleText(title);
+        button->setTitleFontSize(20);
+
+        auto bg = LayerColor::create(color, width, buttonHeight);
+        bg->setPosition(Vec2::ZERO);
+        button->addChild(bg, -1);
+
+        if (button->getTitleRenderer())
+        {
+            button->getTitleRenderer()->setPosition(Vec2(width / 2, buttonHeight / 2));
+        }
+        return button;
+    };
+
+    _replaySpeedButton = createTextButton("1x", 60, Color4B(60, 60, 60, 220));
+    _replaySpeedButton->setPosition(Vec2(-50, knobSize / 2));
+    _replaySpeedButton->addClickEventListener([this](Ref*) {
+        AudioManager::GetInstance().PlayEffect(SoundEffectId::kUiButtonClick);
+        if (_onReplaySpeed)
+            _onReplaySpeed();
+    });
+    _scrubberPanel->addChild(_replaySpeedButton, 2);
+
+    _replaySkipButton = createTextButton("跳到结果", 100, Color4B(200, 120, 40, 220));
+    _replaySkipButton->setPosition(Vec2(-140, knobSize / 2));
+    _replaySkipButton->addClickEventListener([this](Ref*) {
+        AudioManager::GetInstance().PlayEffect(SoundEffectId::kUiButtonClick);
+        if (_onReplaySkip)
+            _onReplaySkip();
+    });
+    _scrubberPanel->addChild(_replaySkipButton, 2);
+
+    setScrubberPosition(0.0f);
+}
+
+void BattleUI::setReplaySpeedCallbacks(const std::function<void()>& onSpeed, const std::function<void()>& onSkip)
+{
+    _onReplaySpeed = onSpeed;
+    _onReplaySkip  = onSkip;
+}
+
+void BattleUI::setReplaySpeedText(const std::string& text)
+{
+    if (_replaySpeedButton)
+        _replaySpeedButton->setTitleText(text);
+}
+
+void BattleUI::updateReplayScrubber(float seconds)
+{
+    if (!_scrubberPanel || _isScrubbing)
+        return;
+
+    setScrubberPosition(seconds);
+}
+
+float BattleUI::scrubberTimeAt(const Vec2& worldLocation) const
+{
+    float x = _scrubberPanel->convertToNodeSpace(worldLocation).x;
+    return clampf(x / _scrubberWidth, 0.0f, 1.0f) * _replayDuration;
+}
+
+void BattleUI::setScrubberPosition(float seconds)
+{
+    seconds     = clampf(seconds, 0.0f, _replayDuration);
+    float width = _scrubberWidth * seconds / _replayDuration;
+
+    _scrubberFill->setContentSize(Size(width, _scrubberFill->getContentSize().height));
+    _scrubberKnob->setPosition(Vec2(width, _scrubberPanel->getContentSize().height / 2));
+
+    int current = static_cast<int>(seconds);
+    int total   = static_cast<int>(std::ceil(_replayDuration));
+    _scrubberTimeLabel->setString(
+        StringUtils::format("%d:%02d / %d:%02d", current / 60, current % 60, total / 60, total % 60));
+}
+
+void BattleUI::hideResultPanel()
+{
+    this->removeChildByName("result_panel");
+    showReturnButton(false);
+    showBattleHUD(true);
+}
+
 void BattleUI::highlightTroopButton(UnitType type)
 {
     // 更新所有卡片的高亮状态
@@ -906,6 +1078,9 @@ void BattleUI::showResultPanel(int stars, int destructionPercent, int goldLooted
     showTroopButtons(false);
     showReadyPhaseUI(false);
 
+    // 回放定位后再次结束时替换旧面板
+    this->removeChildByName("result_panel");
+
     // 创建结果面板
     auto panel = LayerColor::create(Color4B(0, 0, 0, 220));
     panel->setContentSize(Size(500, 400));
@@ -117,6 +117,40 @@ public:
     void showResultPanel(int stars, int destructionPercent, int goldLooted, int elixirLooted, int trophyChange,
                          bool isReplayMode);
 
+    /** @brief 移除结果面板并恢复战斗HUD（回放从结束处定位回战斗中） */
+    void hideResultPanel();
+
+    /**
+     * @brief 显示回放进度条（拖动或点击定位）
+     * @param durationSeconds 回放总时长（秒）
+     */
+    void showReplayScrubber(float durationSeconds);
+
+    /**
+     * @brief 更新回放进度条位置（拖动中不更新）
+     * @param seconds 当前回放时间（秒）
+     */
+    void updateReplayScrubber(float seconds);
+
+    /**
+     * @brief 设置回放定位回调
+     * @param callback 参数为目标回放时间（秒）
+     */
+    void setReplaySeekCallback(const std::function<void(float)>& callback);
+
+    /**
+     * @brief 设置回放倍速按钮和跳到结果按钮的回调（按钮位于进度条左侧）
+     * @param onSpeed 切换倍速
+     * @param onSkip 跳到结果
+     */
+    void setReplaySpeedCallbacks(const std::function<void()>& onSpeed, const std::function<void()>& onSkip);
+
+    /**
+     * @brief 更新倍速按钮文本
+     * @param text 文本（如 "8x"）
+     */
+    void setReplaySpeedText(const std::string& text);
+
     /**
      * @brief 高亮部队按钮
      * @param type 单位类型
@@ -144,6 +178,12 @@ private:
     void setupTroopButtons();  ///< 设置部队按钮
     void setupReadyPhaseUI();  ///< 设置准备阶段UI
 
+    /** @brief 进度条上的触摸点对应的回放时间（秒） */
+    float scrubberTimeAt(const cocos2d::Vec2& worldLocation) const;
+
+    /** @brief 按回放时间设置进度条填充、滑块和时间文本 */
+    void setScrubberPosition(float seconds);
+
     cocos2d::Node* createTroopCard(UnitType type, const std::string& iconPath, const std::string& name);
     void updateTroopCardCount(UnitType type, int count);
     void onTroopCardClicked(UnitType type);
@@ -170,6 +210,17 @@ private:
 
     cocos2d::Node* _troopPanel = nullptr;  ///< 部队面板
 
+    // 回放进度条
+    cocos2d::Node* _scrubberPanel = nullptr;       ///< 进度条容器
+    cocos2d::LayerColor* _scrubberFill = nullptr;  ///< 已播放部分
+    cocos2d::LayerColor* _scrubberKnob = nullptr;  ///< 滑块
+    cocos2d::Label* _scrubberTimeLabel = nullptr;  ///< 当前时间 / 总时长
+    float _scrubberWidth = 0.0f;                   ///< 进度条宽度
+    float _replayDuration = 0.0f;                  ///< 回放总时长（秒）
+    bool _isScrubbing = false;                     ///< 是否正在拖动
+    cocos2d::ui::Button* _replaySpeedButton = nullptr;  ///< 倍速按钮
+    cocos2d::ui::Button* _replaySkipButton = nullptr;   ///< 跳到结果按钮
+
     cocos2d::Node* _barbarianCard = nullptr;     ///< 野蛮人卡片
     cocos2d::Node* _archerCard = nullptr;        ///< 弓箭手卡片
     cocos2d::Node* _giantCard = nullptr;         ///< 巨人卡片
@@ -193,6 +244,9 @@ private:
     std::function<void()> _onReturn;              ///< 返回回调
     std::function<void(UnitType)> _onTroopSelected;   ///< 部队选择回调
     std::function<void()> _onTroopDeselected;     ///< 部队取消选择回调
+    std::function<void(float)> _onReplaySeek;     ///< 回放定位回调
+    std::function<void()> _onReplaySpeed;         ///< 回放倍速回调
+    std::function<void()> _onReplaySkip;          ///< 跳到结果回调
 };
 
 #endif // BATTLE_UI_H_
\ No newline at end of file
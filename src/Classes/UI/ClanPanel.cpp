@@ -10,10 +10,12 @@
 #include "Audio/AudioManager.h"
 #include "ClanDataCache.h"
 #include "Managers/AccountManager.h"
+#include "Managers/AssetPreloader.h"
 #include "Managers/SocketClient.h"
 #include "PlayerListItem.h"
 #include "Scenes/BattleScene.h"
 #include "Services/ClanService.h"
+#include "UI/LoadingLayer.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -1138,16 +1140,24 @@ void ClanPanel::enterBattleScene(const std::string& targetId, const std::string&
 {
     _isTransitioningToBattle = true;
     
-    AccountGameData enemyData   = AccountGameData::fromJson(mapData);
-    auto            scene       = BattleScene::createWithEnemyData(enemyData, targetId);
-    auto            battleScene = dynamic_cast<BattleScene*>(scene);
-    if (battleScene)
-    {
-        battleScene->setPvpMode(true);
-    }
-
-    // 使用 pushScene 而不是 replaceScene，以便返回时能恢复 ClanPanel
-    Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene));
+    AccountGameData enemyData = AccountGameData::fromJson(mapData);
+
+    // 预加载战斗资源后再进入（加载层挂在当前场景上，不依赖 ClanPanel 的生命周期）
+    AssetManifest manifest = AssetPreloader::loadManifest("preload/battle.json");
+    manifest.merge(AssetPreloader::manifestForBase(enemyData.buildings));
+
+    LoadingLayer::preloadAndRun(Director::getInstance()->getRunningScene(), "battle", manifest,
+                                [enemyData, targetId]() {
+                                    auto scene       = BattleScene::createWithEnemyData(enemyData, targetId);
+                                    auto battleScene = dynamic_cast<BattleScene*>(scene);
+                                    if (battleScene)
+                                    {
+                                        battleScene->setPvpMode(true);
+                                    }
+
+                                    // 使用 pushScene 而不是 replaceScene，以便返回时能恢复 ClanPanel
+                                    Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene));
+                                });
 }
 
 void ClanPanel::enterSpectateScene(const std::string& attackerId, const std::string& defenderId,
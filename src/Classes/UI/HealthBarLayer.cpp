@@ -0,0 +1,340 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     HealthBarLayer.cpp
+ * File Function: 血条层实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "HealthBarLayer.h"
+
+#include "Buildings/BaseBuilding.h"
+#include "Managers/FrameProfiler.h"
+#include "Unit/BaseUnit.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+constexpr float HealthBarLayer::kFadeInTime;
+constexpr float HealthBarLayer::kFadeOutTime;
+constexpr float HealthBarLayer::kHideDelay;
+constexpr float HealthBarLayer::kBuildingBarWidth;
+constexpr float HealthBarLayer::kBuildingBarHeight;
+constexpr float HealthBarLayer::kBuildingBarGap;
+constexpr float HealthBarLayer::kUnitBarWidth;
+constexpr float HealthBarLayer::kUnitBarHeight;
+constexpr float HealthBarLayer::kUnitBarOffsetY;
+
+namespace
+{
+
+/** @brief DrawNode 使用预乘 alpha 混合，颜色需要先乘以透明度 */
+Color4F premultiplied(const Color4F& color, float alpha)
+{
+    float a = color.a * alpha;
+    return Color4F(color.r * a, color.g * a, color.b * a, a);
+}
+
+/** @brief 填充颜色：绿 -> 黄 -> 红 */
+Color4F fillColor(float healthPercent)
+{
+    if (healthPercent > 0.5f)
+        return Color4F(Color4B(50, 200, 50, 255));
+    if (healthPercent > 0.25f)
+        return Color4F(Color4B(255, 200, 50, 255));
+    return Color4F(Color4B(255, 50, 50, 255));
+}
+
+} // namespace
+
+HealthBarLayer::~HealthBarLayer()
+{
+    clear();
+}
+
+bool HealthBarLayer::init()
+{
+    if (!Node::init())
+        return false;
+
+    _drawNode = DrawNode::create();
+    this->addChild(_drawNode);
+
+    // 整个战斗只有这一个血条调度项
+    this->scheduleUpdate();
+    return true;
+}
+
+// ==================== 槽位管理 ====================
+
+int HealthBarLayer::allocateSlot()
+{
+    int slot;
+    if (!_freeSlots.empty())
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<int>(_bars.size());
+        _bars.emplace_back();
+    }
+
+    _bars[slot]       = Bar();
+    _bars[slot].inUse = true;
+    return slot;
+}
+
+bool HealthBarLayer::isValidSlot(int slot) const
+{
+    return slot >= 0 && slot < static_cast<int>(_bars.size()) && _bars[slot].inUse;
+}
+
+void HealthBarLayer::addVisible(int slot)
+{
+    Bar& bar = _bars[slot];
+    if (bar.visibleIndex >= 0)
+        return;
+
+    bar.visibleIndex = static_cast<int>(_visible.size());
+    _visible.push_back(slot);
+    _dirty = true;
+}
+
+void HealthBarLayer::removeVisible(int slot)
+{
+    Bar& bar = _bars[slot];
+    if (bar.visibleIndex < 0)
+        return;
+
+    // 与末尾交换后删除，O(1)
+    int last                   = _visible.back();
+    _visible[bar.visibleIndex] = last;
+    _bars[last].visibleIndex   = bar.visibleIndex;
+    _visible.pop_back();
+    bar.visibleIndex = -1;
+    _dirty           = true;
+}
+
+int HealthBarLayer::addBuilding(BaseBuilding* building)
+{
+    int  slot = allocateSlot();
+    Bar& bar  = _bars[slot];
+
+    bar.building   = building;
+    bar.background = Color4F(Color4B(80, 0, 0, 255));
+    bar.width      = kBuildingBarWidth;
+    bar.height     = kBuildingBarHeight;
+
+    // 建筑是 Sprite，位置对应锚点：血条放在图片顶部上方
+    float topOffset = building->getContentSize().height * (1.0f - building->getAnchorPoint().y);
+    bar.offset      = Vec2(0.0f, topOffset + kBuildingBarGap + kBuildingBarHeight / 2.0f);
+
+    bar.hitpoints    = building->getHitpoints();
+    bar.maxHitpoints = std::max(1, building->getMaxHitpoints());
+
+    // 默认隐藏，首次受伤后显示
+    return slot;
+}
+
+int HealthBarLayer::addUnit(BaseUnit* unit)
+{
+    int  slot = allocateSlot();
+    Bar& bar  = _bars[slot];
+
+    bar.unit       = unit;
+    bar.background = Color4F(Color4B(80, 80, 80, 255));
+    bar.width      = kUnitBarWidth;
+    bar.height     = kUnitBarHeight;
+    bar.offset     = Vec2(0.0f, kUnitBarOffsetY + kUnitBarHeight / 2.0f);
+
+    bar.hitpoints     = unit->getCurrentHP();
+    bar.maxHitpoints  = std::max(1, unit->getMaxHP());
+    bar.alpha         = 1.0f;
+    bar.alwaysVisible = true;
+
+    // 战斗中单位血条始终显示
+    addVisible(slot);
+    return slot;
+}
+
+void HealthBarLayer::removeBar(int slot)
+{
+    if (!isValidSlot(slot))
+        return;
+
+    removeVisible(slot);
+    _bars[slot] = Bar();
+    _freeSlots.push_back(slot);
+}
+
+void HealthBarLayer::clear()
+{
+    for (auto& bar : _bars)
+    {
+        if (!bar.inUse)
+            continue;
+        if (bar.building)
+            bar.building->detachHealthBar();
+        else if (bar.unit)
+            bar.unit->detachHealthBar();
+    }
+
+    _bars.clear();
+    _freeSlots.clear();
+    _visible.clear();
+    _dirty = false;
+    if (_drawNode)
+        _drawNode->clear();
+}
+
+// ==================== 状态通知 ====================
+
+void HealthBarLayer::setHitpoints(int slot, int hitpoints, int maxHitpoints)
+{
+    if (!isValidSlot(slot))
+        return;
+
+    Bar& bar         = _bars[slot];
+    bar.hitpoints    = std::max(0, hitpoints);
+    bar.maxHitpoints = std::max(1, maxHitpoints);
+    bar.hideTimer    = 0.0f;
+
+    // 未显示或正在淡出时淡入
+    if (bar.visibleIndex < 0)
+    {
+        bar.alpha     = 0.0f;
+        bar.fadeSpeed = 1.0f / kFadeInTime;
+        addVisible(slot);
+    }
+    else if (bar.fadeSpeed < 0.0f)
+    {
+        bar.fadeSpeed = 1.0f / kFadeInTime;
+    }
+    _dirty = true;
+}
+
+void HealthBarLayer::show(int slot)
+{
+    if (!isValidSlot(slot))
+        return;
+
+    Bar& bar      = _bars[slot];
+    bar.alpha     = 1.0f;
+    bar.fadeSpeed = 0.0f;
+    bar.hideTimer = 0.0f;
+    addVisible(slot);
+    _dirty = true;
+}
+
+void HealthBarLayer::setAlwaysVisible(int slot, bool always)
+{
+    if (!isValidSlot(slot))
+        return;
+
+    _bars[slot].alwaysVisible = always;
+    if (always && _bars[slot].visibleIndex < 0)
+        show(slot);
+}
+
+// ==================== 绘制 ====================
+
+bool HealthBarLayer::barCenter(const Bar& bar, Vec2* center, Vec2* scale) const
+{
+    Node* owner = bar.building ? static_cast<Node*>(bar.building) : static_cast<Node*>(bar.unit);
+    if (!owner || !owner->isVisible())
+        return false;
+
+    *scale  = Vec2(owner->getScaleX(), owner->getScaleY());
+    *center = owner->getPosition() + Vec2(bar.offset.x * scale->x, bar.offset.y * scale->y);
+    return true;
+}
+
+void HealthBarLayer::update(float dt)
+{
+    if (_visible.empty() && !_dirty)
+        return;
+
+    PROFILE_SCOPE("HealthBarLayer::update");
+
+    bool redraw = _dirty;
+    for (size_t i = 0; i < _visible.size();)
+    {
+        int  slot = _visible[i];
+        Bar& bar  = _bars[slot];
+
+        if (bar.fadeSpeed != 0.0f)
+        {
+            redraw = true;
+            bar.alpha += bar.fadeSpeed * dt;
+            if (bar.alpha >= 1.0f)
+            {
+                bar.alpha     = 1.0f;
+                bar.fadeSpeed = 0.0f;
+            }
+            else if (bar.alpha <= 0.0f)
+            {
+                // 淡出结束：移出显示列表（末尾元素换到 i，下一轮继续检查 i）
+                bar.alpha     = 0.0f;
+                bar.fadeSpeed = 0.0f;
+                removeVisible(slot);
+                continue;
+            }
+        }
+
+        // 非始终可见的血条在满血 kHideDelay 秒后淡出
+        if (!bar.alwaysVisible && bar.hitpoints >= bar.maxHitpoints && bar.fadeSpeed >= 0.0f)
+        {
+            bar.hideTimer += dt;
+            if (bar.hideTimer >= kHideDelay)
+            {
+                bar.hideTimer = 0.0f;
+                bar.fadeSpeed = -1.0f / kFadeOutTime;
+            }
+        }
+
+        // 建筑不会移动，只有单位需要检查位置
+        if (!redraw && bar.unit)
+        {
+            Vec2 center, scale;
+            if (!barCenter(bar, &center, &scale) || !center.equals(bar.lastPosition))
+                redraw = true;
+        }
+        ++i;
+    }
+
+    if (redraw)
+        rebuild();
+}
+
+void HealthBarLayer::rebuild()
+{
+    _drawNode->clear();
+
+    for (int slot : _visible)
+    {
+        Bar& bar = _bars[slot];
+        Vec2 center, scale;
+        if (!barCenter(bar, &center, &scale))
+            continue;
+        bar.lastPosition = center;
+
+        float width  = bar.width * scale.x;
+        float height = bar.height * scale.y;
+        Vec2  origin(center.x - width / 2.0f, center.y - height / 2.0f);
+
+        _drawNode->drawSolidRect(origin, origin + Vec2(width, height), premultiplied(bar.background, bar.alpha));
+
+        float healthPercent = static_cast<float>(bar.hitpoints) / bar.maxHitpoints;
+        healthPercent       = std::max(0.0f, std::min(1.0f, healthPercent));
+        if (healthPercent > 0.0f)
+        {
+            _drawNode->drawSolidRect(origin, origin + Vec2(width * healthPercent, height),
+                                     premultiplied(fillColor(healthPercent), bar.alpha));
+        }
+    }
+
+    _dirty = false;
+}
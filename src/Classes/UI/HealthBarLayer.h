@@ -0,0 +1,147 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     HealthBarLayer.h
+ * File Function: 血条层 - 战斗中所有建筑和单位的血条由一个节点统一绘制，受伤时由 takeDamage 通知
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __HEALTH_BAR_LAYER_H__
+#define __HEALTH_BAR_LAYER_H__
+
+#include "cocos2d.h"
+
+#include <vector>
+
+class BaseBuilding;
+class BaseUnit;
+
+/**
+ * @class HealthBarLayer
+ * @brief 血条层（与建筑/单位所在的深度排序层同一坐标系，位于其上方）
+ *
+ * - 血条不再是建筑/单位的子节点，也不再每帧轮询生命值：生命值变化时由 takeDamage 等调用 setHitpoints 通知
+ * - 所有可见血条写入同一个 DrawNode，一帧最多重建一次顶点（有变化或单位移动时），一次绘制
+ * - 淡入淡出和满血自动隐藏由本层的计时器推进，不给每个血条创建 Action
+ * - 整个战斗只有本层的一个 update 调度项，与建筑和单位数量无关
+ */
+class HealthBarLayer : public cocos2d::Node
+{
+public:
+    CREATE_FUNC(HealthBarLayer);
+
+    virtual ~HealthBarLayer();
+
+    virtual bool init() override;
+
+    /**
+     * @brief 每帧推进计时器，有变化时重建血条几何
+     * @param dt 时间增量
+     */
+    virtual void update(float dt) override;
+
+    /**
+     * @brief 为建筑添加血条（初始隐藏，首次受伤后显示）
+     * @param building 建筑
+     * @return int 血条槽位
+     */
+    int addBuilding(BaseBuilding* building);
+
+    /**
+     * @brief 为单位添加血条（立即显示）
+     * @param unit 单位
+     * @return int 血条槽位
+     */
+    int addUnit(BaseUnit* unit);
+
+    /**
+     * @brief 移除血条（不回调持有者）
+     * @param slot 血条槽位
+     */
+    void removeBar(int slot);
+
+    /** @brief 移除全部血条，并通知持有者解除绑定 */
+    void clear();
+
+    /**
+     * @brief 生命值变化通知：更新填充比例，重置隐藏计时，未显示时淡入
+     * @param slot 血条槽位
+     * @param hitpoints 当前生命值
+     * @param maxHitpoints 最大生命值
+     */
+    void setHitpoints(int slot, int hitpoints, int maxHitpoints);
+
+    /**
+     * @brief 立即显示血条（不淡入）
+     * @param slot 血条槽位
+     */
+    void show(int slot);
+
+    /**
+     * @brief 设置血条是否始终可见（否则满血 kHideDelay 秒后淡出）
+     * @param slot 血条槽位
+     * @param always 是否始终可见
+     */
+    void setAlwaysVisible(int slot, bool always);
+
+    /** @brief 当前显示中的血条数 */
+    int getVisibleCount() const { return static_cast<int>(_visible.size()); }
+
+    static constexpr float kFadeInTime  = 0.2f; ///< 淡入时间（秒）
+    static constexpr float kFadeOutTime = 0.3f; ///< 淡出时间（秒）
+    static constexpr float kHideDelay   = 3.0f; ///< 满血后自动隐藏的延迟（秒）
+
+private:
+    /**
+     * @struct Bar
+     * @brief 一个血条的状态（持有者二选一）
+     */
+    struct Bar
+    {
+        BaseBuilding*    building = nullptr; ///< 所属建筑
+        BaseUnit*        unit     = nullptr; ///< 所属单位
+        cocos2d::Color4F background;         ///< 背景色（已损伤部分）
+        cocos2d::Vec2    offset;             ///< 血条中心相对持有者位置的偏移（持有者本地坐标）
+        float            width         = 0.0f;
+        float            height        = 0.0f;
+        int              hitpoints     = 0;
+        int              maxHitpoints  = 1;
+        float            alpha         = 0.0f;  ///< 当前透明度（0~1）
+        float            fadeSpeed     = 0.0f;  ///< 每秒透明度变化，>0 淡入，<0 淡出，0 静止
+        float            hideTimer     = 0.0f;  ///< 满血计时
+        bool             alwaysVisible = false; ///< 是否始终可见
+        int              visibleIndex  = -1;    ///< 在 _visible 中的下标，-1 表示未显示
+        cocos2d::Vec2    lastPosition;          ///< 上次绘制时的中心位置
+        bool             inUse         = false;
+    };
+
+    HealthBarLayer() = default;
+
+    int  allocateSlot();
+    bool isValidSlot(int slot) const;
+    void addVisible(int slot);
+    void removeVisible(int slot);
+
+    /** @brief 血条中心在本层坐标系中的位置和持有者的缩放，持有者不可见时返回 false */
+    bool barCenter(const Bar& bar, cocos2d::Vec2* center, cocos2d::Vec2* scale) const;
+
+    /** @brief 用所有可见血条重建 DrawNode 的顶点 */
+    void rebuild();
+
+    cocos2d::DrawNode* _drawNode = nullptr; ///< 全部血条共用的几何
+
+    std::vector<Bar> _bars;      ///< 槽位 -> 血条
+    std::vector<int> _freeSlots; ///< 空闲槽位
+    std::vector<int> _visible;   ///< 显示中的槽位
+    bool             _dirty = false;
+
+    static constexpr float kBuildingBarWidth  = 60.0f; ///< 建筑血条宽度
+    static constexpr float kBuildingBarHeight = 8.0f;  ///< 建筑血条高度
+    static constexpr float kBuildingBarGap    = 5.0f;  ///< 建筑血条与建筑顶部的间距
+    static constexpr float kUnitBarWidth      = 40.0f; ///< 单位血条宽度
+    static constexpr float kUnitBarHeight     = 4.0f;  ///< 单位血条高度
+    static constexpr float kUnitBarOffsetY    = 30.0f; ///< 单位血条高度偏移
+};
+
+#endif // __HEALTH_BAR_LAYER_H__
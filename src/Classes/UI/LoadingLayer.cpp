@@ -3,7 +3,7 @@
  * File Name:     LoadingLayer.cpp
  * File Function: 加载界面层实现
  * Author:        赵崇治
- * Update Date:   2025/12/28
+ * Update Date:   2026/10/18
  * License:       MIT License
  ****************************************************************/
 
@@ -24,6 +24,31 @@ LoadingLayer* LoadingLayer::create() {
   return nullptr;
 }
 
+LoadingLayer* LoadingLayer::preloadAndRun(
+    Node* parent, const std::string& scene_name, const AssetManifest& manifest,
+    const std::function<void()>& on_complete) {
+  auto layer = LoadingLayer::create();
+  if (!parent || !layer) {
+    if (on_complete) {
+      on_complete();
+    }
+    return nullptr;
+  }
+
+  layer->setPreloadManifest(scene_name, manifest);
+  layer->setIntroAudioEnabled(false);
+  parent->addChild(layer, 10000);
+  layer->show([layer, on_complete]() {
+    if (on_complete) {
+      on_complete();
+    }
+    // pushScene 后本场景的动作会暂停，先隐藏，避免返回时加载层再闪一下
+    layer->setVisible(false);
+    layer->hide();
+  });
+  return layer;
+}
+
 bool LoadingLayer::init() {
   if (!Layer::init()) {
     return false;
@@ -38,6 +63,20 @@ bool LoadingLayer::init() {
   return true;
 }
 
+void LoadingLayer::onExit() {
+  if (is_loading_ && has_preload_ && !preload_done_) {
+    AssetPreloader::getInstance().cancel();
+  }
+  Layer::onExit();
+}
+
+void LoadingLayer::setPreloadManifest(const std::string& scene_name,
+                                      const AssetManifest& manifest) {
+  preload_scene_ = scene_name;
+  preload_manifest_ = manifest;
+  has_preload_ = true;
+}
+
 void LoadingLayer::createBackground() {
   auto visible_size = Director::getInstance()->getVisibleSize();
   auto origin = Director::getInstance()->getVisibleOrigin();
@@ -163,8 +202,11 @@ void LoadingLayer::show(const std::function<void()>& on_complete) {
   is_loading_ = true;
   loading_stage_ = 0;
   current_progress_ = 0.0f;
-  first_audio_done_ = false;
-  second_audio_done_ = false;
+  target_progress_ = 0.0f;
+  first_audio_done_ = !intro_audio_enabled_;
+  second_audio_done_ = !intro_audio_enabled_;
+  preload_done_ = !has_preload_;
+  preload_progress_ = AssetPreloadProgress();
 
   this->setVisible(true);
 
@@ -181,7 +223,28 @@ void LoadingLayer::show(const std::function<void()>& on_complete) {
   this->schedule(CC_SCHEDULE_SELECTOR(LoadingLayer::updateProgress), 1.0f / 60.0f);
   this->schedule(CC_SCHEDULE_SELECTOR(LoadingLayer::updateLoadingText), kTextAnimInterval);
 
-  startAudioSequence();
+  startPreload();
+  if (intro_audio_enabled_) {
+    startAudioSequence();
+  } else {
+    loading_stage_ = 1;
+  }
+}
+
+void LoadingLayer::startPreload() {
+  if (!has_preload_) {
+    return;
+  }
+
+  // 回调在预加载器完成前可能遇到本层被移除，onExit 中会 cancel
+  AssetPreloader::getInstance().preload(
+      preload_scene_, preload_manifest_,
+      [this](const AssetPreloadProgress& progress) {
+        preload_progress_ = progress;
+      },
+      [this]() {
+        preload_done_ = true;
+      });
 }
 
 void LoadingLayer::hide() {
@@ -253,29 +316,22 @@ void LoadingLayer::updateProgress(float dt) {
     return;
   }
 
-  // 根据音效完成状态决定进度速度
-  // 音效完成后快速推进，未完成时缓慢前进（避免卡顿）
-  float speed = kBaseProgressSpeed;
-  
-  if (current_progress_ < 50.0f) {
-    // 第一阶段：0-50%
-    if (first_audio_done_) {
-      speed = kFastProgressSpeed;
-    }
-  } else if (current_progress_ < 85.0f) {
-    // 第二阶段：50-85%
-    if (second_audio_done_) {
-      speed = kFastProgressSpeed;
-    }
-  } else {
-    // 第三阶段：85-100%
-    if (second_audio_done_) {
-      speed = kFastProgressSpeed;
-    }
+  // 目标进度 = 实际加载的字节比例；音效未播完时停在 kWaitAudioProgress
+  float target = preload_done_ ? 100.0f : preload_progress_.getPercent();
+  if (!second_audio_done_) {
+    target = std::min(target, static_cast<float>(kWaitAudioProgress));
   }
+  // 进度只增不减（plist 读到后纹理字节才计入总数，比例可能回落）
+  target_progress_ = std::max(target_progress_, target);
+
+  // 平滑追赶目标进度
+  float step = kProgressCatchUpSpeed * dt;
+  current_progress_ = std::min(current_progress_ + step, target_progress_);
 
-  // 持续更新进度（不会在阶段切换处停止）
-  current_progress_ = std::min(current_progress_ + speed * dt, 100.0f);
+  // 音效先播完时仍显示"正在加载资源"，直到资源也加载完成
+  loading_stage_ = (preload_done_ && second_audio_done_)
+                       ? 2
+                       : std::min(loading_stage_, 1);
 
   // 更新进度条显示
   auto progress_fill = this->getChildByName<DrawNode*>("progress_fill");
@@ -300,8 +356,8 @@ void LoadingLayer::updateProgress(float dt) {
     }
   }
 
-  // 进度完成且音效都已结束时触发完成
-  if (current_progress_ >= 100.0f && second_audio_done_) {
+  // 资源加载完成、音效都已结束且进度条走满时触发完成
+  if (current_progress_ >= 100.0f && preload_done_ && second_audio_done_) {
     finishLoading();
   }
 }
@@ -323,6 +379,13 @@ void LoadingLayer::updateLoadingText(float dt) {
       break;
     case 1:
       text = "正在加载资源" + dots;
+      if (has_preload_ && preload_progress_.totalBytes > 0) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), " %.1f/%.1f MB",
+                 preload_progress_.loadedBytes / (1024.0 * 1024.0),
+                 preload_progress_.totalBytes / (1024.0 * 1024.0));
+        text += buffer;
+      }
       break;
     default:
       text = "即将进入游戏" + dots;
@@ -13,6 +13,7 @@
 #include <functional>
 #include <string>
 
+#include "Managers/AssetPreloader.h"
 #include "cocos2d.h"
 #include "ui/CocosGUI.h"
 
@@ -21,7 +22,8 @@
  * @brief 加载界面层
  *
  * 用于在场景切换时显示加载动画、进度条和背景图片。
- * 进度条会持续平滑前进，音效播放完成时加速进度。
+ * 设置了预加载清单时，进度条按 AssetPreloader 实际加载的字节数前进；
+ * 开场音效未播完时进度停在 95%，资源与音效都完成后进入下一场景。
  */
 class LoadingLayer : public cocos2d::Layer {
  public:
@@ -31,21 +33,50 @@ class LoadingLayer : public cocos2d::Layer {
    */
   static LoadingLayer* create();
 
+  /**
+   * @brief 在 parent 上显示加载层（不播放开场音效），预加载完成后执行回调并淡出
+   * @param parent 父节点（通常是当前场景）
+   * @param scene_name 预加载归属的场景名
+   * @param manifest 资源清单
+   * @param on_complete 预加载完成后的回调（例如创建并切换到目标场景）
+   * @return LoadingLayer* 加载层，创建失败时直接执行回调并返回 nullptr
+   */
+  static LoadingLayer* preloadAndRun(cocos2d::Node* parent,
+                                     const std::string& scene_name,
+                                     const AssetManifest& manifest,
+                                     const std::function<void()>& on_complete);
+
   /**
    * @brief 初始化
    * @return bool 是否成功
    */
   bool init() override;
 
+  /** @brief 退出时取消未完成的预加载回调 */
+  void onExit() override;
+
+  /**
+   * @brief 设置预加载清单（在 show 之前调用）
+   * @param scene_name 预加载归属的场景名
+   * @param manifest 资源清单
+   */
+  void setPreloadManifest(const std::string& scene_name,
+                          const AssetManifest& manifest);
+
+  /**
+   * @brief 是否播放开场音效（默认播放）
+   * @param enabled 是否播放
+   */
+  void setIntroAudioEnabled(bool enabled) { intro_audio_enabled_ = enabled; }
+
   /**
    * @brief 显示加载界面并开始加载流程
    * @param on_complete 加载完成后的回调函数
    *
    * 加载流程：
-   * 1. 显示加载背景和进度条
-   * 2. 播放 supercell_logo 音效
-   * 3. 播放 loading_enter 音效
-   * 4. 进度条完成后调用回调
+   * 1. 显示加载背景和进度条，开始异步预加载清单中的资源
+   * 2. 播放 supercell_logo、loading_enter 音效（可关闭）
+   * 3. 资源加载完成、音效播放完毕且进度条到达 100% 后调用回调
    */
   void show(const std::function<void()>& on_complete);
 
@@ -61,6 +92,7 @@ class LoadingLayer : public cocos2d::Layer {
   void createProgressBar();
   void createLoadingText();
   void createDecorations();
+  void startPreload();
   void startAudioSequence();
   void playFirstAudio();
   void playSecondAudio();
@@ -74,26 +106,35 @@ class LoadingLayer : public cocos2d::Layer {
   cocos2d::Sprite* background_sprite_ = nullptr;
   cocos2d::Label* loading_label_ = nullptr;
   float current_progress_ = 0.0f;
+  float target_progress_ = 0.0f;
   bool is_loading_ = false;
   int loading_stage_ = 0;
   float bar_width_ = 0.0f;
   float bar_height_ = 0.0f;
 
   // 音效完成标记
+  bool intro_audio_enabled_ = true;
   bool first_audio_done_ = false;
   bool second_audio_done_ = false;
 
+  // 预加载
+  std::string preload_scene_;
+  AssetManifest preload_manifest_;
+  bool has_preload_ = false;
+  bool preload_done_ = false;
+  AssetPreloadProgress preload_progress_;
+
   // ==================== 常量 ====================
 
   /// 加载背景图片路径
   static constexpr const char* kLoadingBackgroundPath =
       "loading/loading_picture_christmas.jpg";
 
-  // 基础进度速度（每秒百分比）- 音效未完成时的缓慢速度
-  static constexpr float kBaseProgressSpeed = 25.0f;
+  /// 进度条追赶实际进度的最大速度（每秒百分比）
+  static constexpr float kProgressCatchUpSpeed = 200.0f;
 
-  // 加速进度速度（每秒百分比）- 音效完成后的快速速度
-  static constexpr float kFastProgressSpeed = 200.0f;
+  /// 开场音效未播完时进度条停留的位置（百分比）
+  static constexpr float kWaitAudioProgress = 95.0f;
 
   /// 文本动画间隔（秒）
   static constexpr float kTextAnimInterval = 0.2f;
@@ -0,0 +1,224 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     ProfilerOverlay.cpp
+ * File Function: 性能面板实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "ProfilerOverlay.h"
+
+#include <ctime>
+
+USING_NS_CC;
+
+constexpr float ProfilerOverlay::kRefreshInterval;
+constexpr float ProfilerOverlay::kStatusDuration;
+constexpr int   ProfilerOverlay::kMaxLines;
+
+ProfilerOverlay* ProfilerOverlay::s_instance = nullptr;
+
+namespace
+{
+
+/** @brief 生成带时间戳的 Trace 文件路径 */
+std::string makeTracePath()
+{
+    char        stamp[32] = {};
+    std::time_t now       = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+    return FileUtils::getInstance()->getWritablePath() + "frame_trace_" + stamp + ".json";
+}
+
+} // namespace
+
+void ProfilerOverlay::install()
+{
+#if FRAME_PROFILER_ENABLED
+    if (s_instance)
+        return;
+
+    auto overlay = ProfilerOverlay::create();
+    if (!overlay)
+        return;
+
+    // 通知节点不属于任何场景，由 Director 持有并在场景之后绘制；需要手动进入运行状态才能执行定时器
+    auto director = Director::getInstance();
+    director->setNotificationNode(overlay);
+    overlay->onEnter();
+    overlay->onEnterTransitionDidFinish();
+    s_instance = overlay;
+#endif
+}
+
+void ProfilerOverlay::toggle()
+{
+    if (!s_instance)
+    {
+        CCLOG("⚠️ 性能面板未启用（FRAME_PROFILER_ENABLED=0）");
+        return;
+    }
+
+    auto& profiler = FrameProfiler::getInstance();
+    profiler.setStatsEnabled(!profiler.isStatsEnabled());
+    s_instance->updateVisibility();
+}
+
+bool ProfilerOverlay::toggleTrace()
+{
+    if (!s_instance)
+        return false;
+
+    auto& profiler = FrameProfiler::getInstance();
+    if (!profiler.isTracing())
+    {
+        profiler.startTrace();
+        s_instance->_frameStarted = false;
+        s_instance->showStatus("● Trace 录制中 (F4 停止)");
+        CCLOG("📊 开始录制 Trace");
+        return true;
+    }
+
+    size_t      eventCount = profiler.getTraceEventCount();
+    std::string path       = makeTracePath();
+    if (profiler.stopTrace(path))
+    {
+        CCLOG("📊 Trace 已保存: %s (%zu 个事件)", path.c_str(), eventCount);
+        s_instance->showStatus(StringUtils::format("Trace 已保存 (%zu 个事件):\n%s", eventCount, path.c_str()));
+    }
+    else
+    {
+        CCLOG("❌ Trace 写入失败: %s", path.c_str());
+        s_instance->showStatus("Trace 写入失败: " + path);
+    }
+    return false;
+}
+
+bool ProfilerOverlay::init()
+{
+    if (!Node::init())
+        return false;
+
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    auto origin      = Director::getInstance()->getVisibleOrigin();
+
+    _background = LayerColor::create(Color4B(0, 0, 0, 170), 560, 100);
+    this->addChild(_background);
+
+    _label = Label::createWithSystemFont("", "Consolas", 14);
+    _label->setAnchorPoint(Vec2(0, 1));
+    _label->setAlignment(TextHAlignment::LEFT);
+    _label->setTextColor(Color4B(180, 255, 180, 255));
+    this->addChild(_label, 1);
+
+    // 左上角，留出一点边距
+    this->setPosition(Vec2(origin.x + 10, origin.y + visibleSize.height - 10));
+    this->setVisible(false);
+
+    registerListeners();
+    this->schedule([this](float dt) { refreshText(dt); }, kRefreshInterval, "profiler_refresh");
+    return true;
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (_beforeUpdateListener)
+        dispatcher->removeEventListener(_beforeUpdateListener);
+    if (_afterDrawListener)
+        dispatcher->removeEventListener(_afterDrawListener);
+    if (_keyboardListener)
+        dispatcher->removeEventListener(_keyboardListener);
+
+    if (s_instance == this)
+        s_instance = nullptr;
+}
+
+void ProfilerOverlay::registerListeners()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+
+    _beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*) {
+        _frameStarted = FrameProfiler::getInstance().isActive();
+        if (_frameStarted)
+            _frameStart = FrameProfiler::Clock::now();
+    });
+
+    _afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) {
+        auto& profiler = FrameProfiler::getInstance();
+        if (_frameStarted && profiler.isActive())
+            profiler.record("Frame", _frameStart, FrameProfiler::Clock::now());
+        _frameStarted = false;
+        profiler.endFrame();
+    });
+
+    // 固定优先级监听不依赖场景，在任何场景中都能响应
+    _keyboardListener               = EventListenerKeyboard::create();
+    _keyboardListener->onKeyPressed = [](EventKeyboard::KeyCode keyCode, Event*) {
+        if (keyCode == EventKeyboard::KeyCode::KEY_F3)
+            ProfilerOverlay::toggle();
+        else if (keyCode == EventKeyboard::KeyCode::KEY_F4)
+            ProfilerOverlay::toggleTrace();
+    };
+    dispatcher->addEventListenerWithFixedPriority(_keyboardListener, 1);
+}
+
+void ProfilerOverlay::updateVisibility()
+{
+    this->setVisible(FrameProfiler::getInstance().isActive() || _statusRemaining > 0.0f);
+    refreshText(0.0f);
+}
+
+void ProfilerOverlay::showStatus(const std::string& message)
+{
+    _statusMessage   = message;
+    _statusRemaining = kStatusDuration;
+    updateVisibility();
+}
+
+void ProfilerOverlay::refreshText(float dt)
+{
+    auto& profiler = FrameProfiler::getInstance();
+
+    if (_statusRemaining > 0.0f)
+    {
+        _statusRemaining -= dt;
+        if (_statusRemaining <= 0.0f && !profiler.isTracing())
+        {
+            _statusMessage.clear();
+            this->setVisible(profiler.isActive());
+        }
+    }
+
+    if (!this->isVisible())
+        return;
+
+    std::string text;
+    if (profiler.isStatsEnabled())
+    {
+        text = StringUtils::format("%-34s %7s %7s %6s\n", "作用域 (F3 关闭, F4 Trace)", "avg ms", "max ms", "calls");
+
+        auto stats = profiler.getStats();
+        int  lines = 0;
+        for (const auto& entry : stats)
+        {
+            if (lines++ >= kMaxLines)
+                break;
+            text += StringUtils::format("%-34.34s %7.2f %7.2f %6.1f\n", entry.name, entry.avgMs, entry.maxMs,
+                                        entry.avgCalls);
+        }
+    }
+
+    if (profiler.isTracing())
+        text += StringUtils::format("● Trace 录制中: %zu 个事件\n", profiler.getTraceEventCount());
+    else if (!_statusMessage.empty())
+        text += _statusMessage + "\n";
+
+    _label->setString(text);
+
+    // 背景随文本高度伸缩，锚点在左上角
+    Size textSize = _label->getContentSize();
+    _background->setContentSize(Size(std::max(560.0f, textSize.width + 16), textSize.height + 12));
+    _background->setPosition(Vec2(-8, -textSize.height - 6));
+    _label->setPosition(Vec2(0, 0));
+}
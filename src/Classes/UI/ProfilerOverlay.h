@@ -0,0 +1,79 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     ProfilerOverlay.h
+ * File Function: 性能面板 - 显示各计时作用域的滚动耗时，控制 Trace 录制
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+
+#include "cocos2d.h"
+#include "Managers/FrameProfiler.h"
+
+#include <string>
+
+/**
+ * @class ProfilerOverlay
+ * @brief 性能面板（全局唯一，作为 Director 的通知节点绘制在所有场景之上）
+ *
+ * - F3 / 设置面板按钮：显示或隐藏滚动统计
+ * - F4：开始/停止录制 Trace，停止时写入可写目录下的 frame_trace_*.json
+ * - 每帧在 EVENT_BEFORE_UPDATE 和 EVENT_AFTER_DRAW 之间记录 "Frame" 作用域，
+ *   并在 EVENT_AFTER_DRAW 结束一帧的统计
+ */
+class ProfilerOverlay : public cocos2d::Node
+{
+public:
+    /** @brief 创建面板并挂到 Director 上（AppDelegate 中调用一次） */
+    static void install();
+
+    /** @brief 显示/隐藏滚动统计 */
+    static void toggle();
+
+    /**
+     * @brief 开始/停止录制 Trace
+     * @return bool 调用后是否处于录制中
+     */
+    static bool toggleTrace();
+
+    CREATE_FUNC(ProfilerOverlay);
+
+    virtual bool init() override;
+
+    virtual ~ProfilerOverlay();
+
+private:
+    static constexpr float kRefreshInterval = 0.25f; ///< 文本刷新间隔（秒）
+    static constexpr float kStatusDuration  = 5.0f;  ///< 状态提示显示时长（秒）
+    static constexpr int   kMaxLines        = 24;    ///< 最多显示的作用域数
+
+    /** @brief 注册帧边界事件和快捷键 */
+    void registerListeners();
+
+    /** @brief 刷新面板文本 */
+    void refreshText(float dt);
+
+    /** @brief 根据是否激活更新可见性，并立即刷新一次 */
+    void updateVisibility();
+
+    /**
+     * @brief 显示一条状态提示（Trace 开始/保存结果）
+     * @param message 提示内容
+     */
+    void showStatus(const std::string& message);
+
+    static ProfilerOverlay* s_instance;
+
+    cocos2d::LayerColor* _background = nullptr; ///< 半透明背景
+    cocos2d::Label*      _label      = nullptr; ///< 统计文本
+
+    cocos2d::EventListenerCustom*   _beforeUpdateListener = nullptr; ///< 帧开始
+    cocos2d::EventListenerCustom*   _afterDrawListener    = nullptr; ///< 帧结束
+    cocos2d::EventListenerKeyboard* _keyboardListener     = nullptr; ///< F3/F4 快捷键
+
+    FrameProfiler::Clock::time_point _frameStart;             ///< 本帧开始时间
+    bool                             _frameStarted    = false; ///< 本帧是否已记录开始时间
+    std::string                      _statusMessage;           ///< 状态提示
+    float                            _statusRemaining = 0.0f;  ///< 状态提示剩余时间
+};
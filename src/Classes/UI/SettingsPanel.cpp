@@ -12,6 +12,7 @@
 #include "Audio/AudioManager.h"
 #include "Managers/GlobalAudioManager.h"
 #include "Managers/MusicManager.h"
+#include "UI/ProfilerOverlay.h"
 #include "ResourceManager.h"
 
 USING_NS_CC;
@@ -277,6 +278,12 @@ void SettingsPanel::setupFunctionButtons(float startY)
         AudioManager::GetInstance().PlayEffect(SoundEffectId::kUiButtonClick);
         onFullResourceClicked();
     });
+
+    _profilerButton = createButton("📊 性能面板 (测试)", startY - 280);
+    _profilerButton->addClickEventListener([this](Ref*) {
+        AudioManager::GetInstance().PlayEffect(SoundEffectId::kUiButtonClick);
+        onProfilerClicked();
+    });
 }
 
 void SettingsPanel::onCloseClicked()
@@ -324,6 +331,13 @@ void SettingsPanel::onLogoutClicked()
     }
 }
 
+void SettingsPanel::onProfilerClicked()
+{
+    // 面板在所有场景之上绘制，关闭设置面板后仍然显示；桌面端也可以用 F3/F4
+    ProfilerOverlay::toggle();
+    hide();
+}
+
 void SettingsPanel::onFullResourceClicked()
 {
     CCLOG("📊 点击了资源全满按钮");
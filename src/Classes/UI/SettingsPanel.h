@@ -61,6 +61,7 @@ private:
     cocos2d::ui::Button* _accountSwitchButton = nullptr; ///< 账号切换按钮
     cocos2d::ui::Button* _logoutButton = nullptr;        ///< 登出按钮
     cocos2d::ui::Button* _fullResourceButton = nullptr;  ///< 资源全满按钮
+    cocos2d::ui::Button* _profilerButton = nullptr;      ///< 性能面板按钮
 
     std::function<void()> _onAccountSwitched;  ///< 账号切换回调
     std::function<void()> _onLogout;           ///< 登出回调
@@ -77,6 +78,7 @@ private:
     void onAccountSwitchClicked();
     void onLogoutClicked();
     void onFullResourceClicked();
+    void onProfilerClicked();
 
     void showMapSelectionPanel();
     void showAccountList();
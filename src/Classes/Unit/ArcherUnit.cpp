@@ -9,6 +9,7 @@
 #include "ArcherUnit.h"
 
 #include "Audio/AudioManager.h"
+#include "Managers/SpriteAtlasManager.h"
 #include "Unit/CombatStats.h"
 
 USING_NS_CC;
@@ -39,16 +40,12 @@ bool ArcherUnit::init(int level) {
 }
 
 void ArcherUnit::loadAnimations() {
-  // 弓箭手使用单独的PNG文件，不需要plist
+  // 弓箭手使用单独的PNG文件（打包图集后由 SpriteAtlasManager 解析到图集帧）
 
   // 先加载一帧作为初始精灵
-  auto texture = Director::getInstance()->getTextureCache()->addImage(
+  auto frame = SpriteAtlasManager::getInstance().getSpriteFrame(
       "units/archer/archer_side_walk_01.png");
-  if (texture) {
-    auto frame = SpriteFrame::createWithTexture(
-        texture,
-        Rect(0, 0, texture->getContentSize().width,
-             texture->getContentSize().height));
+  if (frame) {
     _sprite = Sprite::createWithSpriteFrame(frame);
   }
 
@@ -58,31 +55,33 @@ void ArcherUnit::loadAnimations() {
   }
 
   // 加载跑步动画
-  addAnimFromFiles("units/archer/", "archer_upper_walk_%02d.png", "run_up_right",
-                   1, 8, 0.1f);
-  addAnimFromFiles("units/archer/", "archer_side_walk_%02d.png", "run_right", 1,
-                   8, 0.1f);
+  addAnimFromFiles("units/archer/", "archer_upper_walk_%02d.png",
+                   UnitAction::kRun, UnitAnimFacing::kUpRight, 1, 8, 0.1f);
+  addAnimFromFiles("units/archer/", "archer_side_walk_%02d.png",
+                   UnitAction::kRun, UnitAnimFacing::kRight, 1, 8, 0.1f);
   addAnimFromFiles("units/archer/", "archer_under_walk_%02d.png",
-                   "run_down_right", 1, 8, 0.1f);
+                   UnitAction::kRun, UnitAnimFacing::kDownRight, 1, 8, 0.1f);
 
   // 加载待机动画
   addAnimFromFiles("units/archer/", "archer_upper_walk_%02d.png",
-                   "idle_up_right", 1, 3, 0.3f);
-  addAnimFromFiles("units/archer/", "archer_side_walk_%02d.png", "idle_right", 1,
-                   3, 0.3f);
+                   UnitAction::kIdle, UnitAnimFacing::kUpRight, 1, 3, 0.3f);
+  addAnimFromFiles("units/archer/", "archer_side_walk_%02d.png",
+                   UnitAction::kIdle, UnitAnimFacing::kRight, 1, 3, 0.3f);
   addAnimFromFiles("units/archer/", "archer_under_walk_%02d.png",
-                   "idle_down_right", 1, 3, 0.3f);
+                   UnitAction::kIdle, UnitAnimFacing::kDownRight, 1, 3, 0.3f);
 
   // 加载攻击动画
   addAnimFromFiles("units/archer/", "archer_upper_attack_%02d.png",
-                   "attack_up_right", 1, 9, 0.08f);
+                   UnitAction::kAttack, UnitAnimFacing::kUpRight, 1, 9, 0.08f);
   addAnimFromFiles("units/archer/", "archer_side_attack_%02d.png",
-                   "attack_right", 1, 10, 0.08f);
+                   UnitAction::kAttack, UnitAnimFacing::kRight, 1, 10, 0.08f);
   addAnimFromFiles("units/archer/", "archer_under_attack_%02d.png",
-                   "attack_down_right", 1, 9, 0.08f);
+                   UnitAction::kAttack, UnitAnimFacing::kDownRight, 1, 9,
+                   0.08f);
 
   // 加载死亡动画
-  addAnimFromFiles("units/archer/", "archer%d.0.png", "death", 53, 54, 0.5f);
+  addAnimFromFiles("units/archer/", "archer%d.0.png", UnitAction::kDeath,
+                   UnitAnimFacing::kRight, 53, 54, 0.5f);
 
   // 播放待机动画
   playAnimation(UnitAction::kIdle, UnitDirection::kRight);
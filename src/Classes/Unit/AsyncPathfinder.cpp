@@ -0,0 +1,144 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AsyncPathfinder.cpp
+ * File Function: 异步寻路任务队列实现
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "AsyncPathfinder.h"
+
+#include <algorithm>
+
+constexpr int AsyncPathfinder::kMaxWorkers;
+
+AsyncPathfinder::AsyncPathfinder(int workerCount)
+{
+    if (workerCount <= 0)
+    {
+        // 留一个核心给主线程
+        int cores   = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(kMaxWorkers, cores - 1));
+    }
+
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers.push_back(std::thread(&AsyncPathfinder::workerLoop, this));
+    }
+}
+
+AsyncPathfinder::~AsyncPathfinder()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        _queue.clear();
+    }
+    _jobAvailable.notify_all();
+    _jobFinished.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+uint64_t AsyncPathfinder::submit(std::shared_ptr<const CollisionSnapshot> snapshot, const PathCacheKey& key,
+                                 PathfindingMode mode)
+{
+    uint64_t jobId = 0;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Job job;
+        job.id       = _nextJobId++;
+        job.snapshot = std::move(snapshot);
+        job.key      = key;
+        job.mode     = mode;
+        jobId        = job.id;
+        _queue.push_back(std::move(job));
+    }
+    _jobAvailable.notify_one();
+    return jobId;
+}
+
+bool AsyncPathfinder::waitResult(uint64_t jobId, AsyncPathResult& outResult)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto isQueued = [&]() {
+        return std::any_of(_queue.begin(), _queue.end(), [jobId](const Job& job) { return job.id == jobId; });
+    };
+
+    _jobFinished.wait(lock, [&]() {
+        return _stopping || _finished.count(jobId) > 0 || (_running.count(jobId) == 0 && !isQueued());
+    });
+
+    auto it = _finished.find(jobId);
+    if (it == _finished.end())
+        return false;
+
+    outResult = std::move(it->second);
+    _finished.erase(it);
+    return true;
+}
+
+void AsyncPathfinder::cancel(uint64_t jobId)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto queued = std::find_if(_queue.begin(), _queue.end(), [jobId](const Job& job) { return job.id == jobId; });
+    if (queued != _queue.end())
+    {
+        _queue.erase(queued);
+        return;
+    }
+
+    if (_running.count(jobId) > 0)
+        _cancelled.insert(jobId);
+    else
+        _finished.erase(jobId);
+}
+
+void AsyncPathfinder::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.clear();
+    _finished.clear();
+    _cancelled.insert(_running.begin(), _running.end());
+}
+
+void AsyncPathfinder::workerLoop()
+{
+    // 搜索缓冲区属于线程自身，不需要加锁
+    GridPathSearcher searcher;
+
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobAvailable.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+            if (_stopping)
+                return;
+
+            job = std::move(_queue.front());
+            _queue.pop_front();
+            _running.insert(job.id);
+        }
+
+        AsyncPathResult result;
+        result.key             = job.key;
+        result.snapshotVersion = job.snapshot->getVersion();
+        result.found =
+            searcher.search(job.mode, *job.snapshot, job.key.start, job.key.goal, job.key.ignoreWalls, result.cells);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running.erase(job.id);
+            if (_cancelled.erase(job.id) == 0)
+                _finished[job.id] = std::move(result);
+        }
+        _jobFinished.notify_all();
+    }
+}
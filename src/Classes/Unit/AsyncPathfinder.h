@@ -0,0 +1,114 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     AsyncPathfinder.h
+ * File Function: 异步寻路任务队列 - 在工作线程上执行网格搜索
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __ASYNC_PATHFINDER_H__
+#define __ASYNC_PATHFINDER_H__
+
+#include "CollisionSnapshot.h"
+#include "GridPathSearcher.h"
+#include "PathCache.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @struct AsyncPathResult
+ * @brief 异步寻路结果
+ */
+struct AsyncPathResult
+{
+    PathCacheKey          key;                     ///< 请求的缓存键
+    unsigned int          snapshotVersion = 0;     ///< 搜索所用快照的碰撞版本号
+    bool                  found           = false; ///< 是否找到路径
+    std::vector<GridCell> cells;                   ///< 格子路径，不可达时为空
+};
+
+/**
+ * @class AsyncPathfinder
+ * @brief 异步寻路任务队列
+ *
+ * - submit() 把请求放入队列，工作线程在不可变的 CollisionSnapshot 上搜索，不接触 cocos2d 节点
+ * - 每个工作线程持有自己的 GridPathSearcher
+ * - 搜索结果只取决于 (快照, 起点, 终点, 模式)，与线程调度无关；
+ *   调用方在约定的帧按任务编号顺序调用 waitResult() 取结果，即可保证回放确定性
+ */
+class AsyncPathfinder
+{
+public:
+    /**
+     * @brief 构造并启动工作线程
+     * @param workerCount 工作线程数，0 表示按 CPU 核心数自动选择
+     */
+    explicit AsyncPathfinder(int workerCount = 0);
+
+    /** @brief 停止并等待所有工作线程退出，未完成的任务被丢弃 */
+    ~AsyncPathfinder();
+
+    AsyncPathfinder(const AsyncPathfinder&) = delete;
+    AsyncPathfinder& operator=(const AsyncPathfinder&) = delete;
+
+    /**
+     * @brief 提交寻路任务
+     * @param snapshot 碰撞地图快照
+     * @param key 起点/终点格子
+     * @param mode 搜索模式
+     * @return uint64_t 任务编号（递增）
+     */
+    uint64_t submit(std::shared_ptr<const CollisionSnapshot> snapshot, const PathCacheKey& key, PathfindingMode mode);
+
+    /**
+     * @brief 等待任务完成并取出结果
+     * @param jobId 任务编号
+     * @param outResult 输出：搜索结果
+     * @return bool 任务不存在或已取消时返回 false
+     */
+    bool waitResult(uint64_t jobId, AsyncPathResult& outResult);
+
+    /** @brief 取消任务（排队中的直接移除，执行中的结果被丢弃） */
+    void cancel(uint64_t jobId);
+
+    /** @brief 取消所有任务 */
+    void cancelAll();
+
+    /** @brief 获取工作线程数 */
+    int getWorkerCount() const { return static_cast<int>(_workers.size()); }
+
+    static constexpr int kMaxWorkers = 4; ///< 自动选择时的最大线程数
+
+private:
+    struct Job
+    {
+        uint64_t                                 id = 0;
+        std::shared_ptr<const CollisionSnapshot> snapshot;
+        PathCacheKey                             key;
+        PathfindingMode                          mode = PathfindingMode::kAStar;
+    };
+
+    void workerLoop();
+
+    std::vector<std::thread>                      _workers;           ///< 工作线程
+    std::mutex                                    _mutex;             ///< 保护以下所有成员
+    std::condition_variable                       _jobAvailable;      ///< 有新任务或需要退出
+    std::condition_variable                       _jobFinished;       ///< 有任务完成
+    std::deque<Job>                               _queue;             ///< 排队中的任务
+    std::unordered_set<uint64_t>                  _running;           ///< 执行中的任务
+    std::unordered_set<uint64_t>                  _cancelled;         ///< 执行中被取消的任务
+    std::unordered_map<uint64_t, AsyncPathResult> _finished;          ///< 已完成未取走的结果
+    uint64_t                                      _nextJobId = 1;     ///< 下一个任务编号
+    bool                                          _stopping  = false; ///< 是否正在析构
+};
+
+#endif // __ASYNC_PATHFINDER_H__
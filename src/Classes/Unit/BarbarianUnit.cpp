@@ -51,27 +51,40 @@ void BarbarianUnit::loadAnimations() {
   }
 
   // 加载跑步动画
-  addAnimFromFrames("barbarian", "run_down_right", 1, 8, 0.1f);
-  addAnimFromFrames("barbarian", "run_right", 9, 16, 0.1f);
-  addAnimFromFrames("barbarian", "run_up_right", 17, 24, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kRun, UnitAnimFacing::kDownRight,
+                    1, 8, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kRun, UnitAnimFacing::kRight, 9,
+                    16, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kRun, UnitAnimFacing::kUpRight, 17,
+                    24, 0.1f);
 
   // 加载待机动画
-  addAnimFromFrames("barbarian", "idle_down_right", 25, 25, 1.0f);
-  addAnimFromFrames("barbarian", "idle_right", 26, 26, 1.0f);
-  addAnimFromFrames("barbarian", "idle_up_right", 27, 27, 1.0f);
+  addAnimFromFrames("barbarian", UnitAction::kIdle, UnitAnimFacing::kDownRight,
+                    25, 25, 1.0f);
+  addAnimFromFrames("barbarian", UnitAction::kIdle, UnitAnimFacing::kRight, 26,
+                    26, 1.0f);
+  addAnimFromFrames("barbarian", UnitAction::kIdle, UnitAnimFacing::kUpRight,
+                    27, 27, 1.0f);
 
   // 加载攻击动画
-  addAnimFromFrames("barbarian", "attack_down_right", 31, 38, 0.1f);
-  addAnimFromFrames("barbarian", "attack_right", 39, 46, 0.1f);
-  addAnimFromFrames("barbarian", "attack_up_right", 47, 54, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack,
+                    UnitAnimFacing::kDownRight, 31, 38, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack, UnitAnimFacing::kRight,
+                    39, 46, 0.1f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack, UnitAnimFacing::kUpRight,
+                    47, 54, 0.1f);
 
   // 加载第二套攻击动画
-  addAnimFromFrames("barbarian", "attack2_down_right", 55, 65, 0.09f);
-  addAnimFromFrames("barbarian", "attack2_right", 66, 76, 0.09f);
-  addAnimFromFrames("barbarian", "attack2_up_right", 77, 87, 0.09f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack2,
+                    UnitAnimFacing::kDownRight, 55, 65, 0.09f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack2, UnitAnimFacing::kRight,
+                    66, 76, 0.09f);
+  addAnimFromFrames("barbarian", UnitAction::kAttack2, UnitAnimFacing::kUpRight,
+                    77, 87, 0.09f);
 
   // 加载死亡动画
-  addAnimFromFrames("barbarian", "death", 175, 176, 0.5f);
+  addAnimFromFrames("barbarian", UnitAction::kDeath, UnitAnimFacing::kRight,
+                    175, 176, 0.5f);
 
   // 播放待机动画
   playAnimation(UnitAction::kIdle, UnitDirection::kRight);
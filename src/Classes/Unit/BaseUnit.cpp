@@ -8,7 +8,10 @@
  ****************************************************************/
 #include "BaseUnit.h"
 
-#include "UI/UnitHealthBarUI.h"
+#include "Managers/FrameProfiler.h"
+#include "Managers/SpriteAtlasManager.h"
+#include "UI/HealthBarLayer.h"
+#include "Unit/UnitAnimationLibrary.h"
 
 USING_NS_CC;
 
@@ -26,18 +29,14 @@ BaseUnit::BaseUnit()
     , _attackCooldown(0.0f)  // 将在 init 中根据攻击速度设置
     , _unitLevel(1)
     , _isDead(false)
-    , _healthBarUI(nullptr)
     , _battleModeEnabled(false)
 {}
 
 BaseUnit::~BaseUnit()
 {
-    // 释放动画缓存
-    for (auto& pair : _animCache)
-    {
-        pair.second->release();
-    }
-    _animCache.clear();
+    // 动画集由 UnitAnimationLibrary 持有，这里不释放
+    attachHealthBarLayer(nullptr);
+    CC_SAFE_RELEASE_NULL(_hitTint);
 }
 
 bool BaseUnit::init(int level)
@@ -47,16 +46,34 @@ bool BaseUnit::init(int level)
 
     _unitLevel = level;
 
-    // 子类在loadAnimations()中创建精灵和加载动画
-    loadAnimations();
+    // 同类型同等级的动画只由第一个实例构建，之后的实例共享同一份
+    auto& library = UnitAnimationLibrary::getInstance();
+    _animations   = library.find(getUnitType(), level);
+    if (!_animations)
+    {
+        _animationsBuilding = &library.create(getUnitType(), level);
+        _animations         = _animationsBuilding;
+    }
+
+    // 子类在loadAnimations()中创建精灵和加载动画；
+    // 分开计时：首个实例构建共享动画集，之后的实例只创建精灵（即每次部署的耗时）
+    if (_animationsBuilding)
+    {
+        PROFILE_SCOPE("BaseUnit::buildAnimationSet");
+        loadAnimations();
+    }
+    else
+    {
+        PROFILE_SCOPE("BaseUnit::loadAnimations");
+        loadAnimations();
+    }
+    _animationsBuilding = nullptr;
 
     // 🔴 修复：初始化攻击冷却，防止新部署的单位立即攻击
     // 设置为攻击速度的一半，给予单位时间移动到目标
     _attackCooldown = _combatStats.attackSpeed * 0.5f;
 
-    // 初始化血条UI
-    initHealthBarUI();
-
+    // 血条在进入战斗时由 BattleWorldView 挂到血条层，村庄中的单位不显示血条
     return true;
 }
 
@@ -183,9 +200,40 @@ bool BaseUnit::takeDamage(float damage)
     CCLOG("%s took %.1f damage, HP: %d/%d", getDisplayName().c_str(), actualDamage, _combatStats.currentHitpoints,
           _combatStats.maxHitpoints);
 
+    if (_healthBarLayer)
+        _healthBarLayer->setHitpoints(_healthBarSlot, _combatStats.currentHitpoints, _combatStats.maxHitpoints);
+
     // 调用子类钩子
     onTakeDamage(actualDamage);
 
+    playHitEffect();
+
+    if (_combatStats.currentHitpoints <= 0)
+    {
+        die();
+        return true;
+    }
+
+    return false;
+}
+
+void BaseUnit::syncHitpoints(int hitpoints)
+{
+    if (_isDead || hitpoints >= _combatStats.currentHitpoints)
+        return;
+
+    int lost                      = _combatStats.currentHitpoints - hitpoints;
+    _combatStats.currentHitpoints = hitpoints;
+
+    if (_healthBarLayer)
+        _healthBarLayer->setHitpoints(_healthBarSlot, hitpoints, _combatStats.maxHitpoints);
+
+    onTakeDamage(static_cast<float>(lost));
+    playHitEffect();
+}
+
+void BaseUnit::playHitEffect()
+{
     // 播放受击效果
     // 🔴 修复：使用带 tag 的动作，避免被 stopAllActions 中断
     // 同时在动作开始前先恢复颜色，确保状态一致
@@ -194,20 +242,16 @@ bool BaseUnit::takeDamage(float damage)
         // 先停止之前的受击动画（如果有）
         _sprite->stopActionByTag(kDamageEffectTag);
         
-        // 立即设置为红色，然后渐变恢复
+        // 立即设置为红色，然后渐变恢复（动作对象复用，每次受击不再新建）
+        if (!_hitTint)
+        {
+            _hitTint = TintTo::create(0.15f, 255, 255, 255);
+            _hitTint->setTag(kDamageEffectTag);
+            _hitTint->retain();
+        }
         _sprite->setColor(Color3B(255, 100, 100));
-        auto restore = TintTo::create(0.15f, 255, 255, 255);
-        restore->setTag(kDamageEffectTag);
-        _sprite->runAction(restore);
+        _sprite->runAction(_hitTint);
     }
-
-    if (_combatStats.currentHitpoints <= 0)
-    {
-        die();
-        return true;
-    }
-
-    return false;
 }
 
 void BaseUnit::die()
@@ -218,6 +262,9 @@ void BaseUnit::die()
     _isDead = true;
     stopMoving();
 
+    // 死亡后不再显示血条
+    attachHealthBarLayer(nullptr);
+
     // 调用子类钩子
     onDeathBefore();
 
@@ -232,19 +279,58 @@ void BaseUnit::die()
     auto removeAction = Sequence::create(
         DelayTime::create(3.0f), 
         FadeOut::create(1.0f), 
-        CallFunc::create([this]() {
-            // 标记为等待移除状态，通知 BattleManager 可以安全清理
-            _pendingRemoval = true;
-            this->removeFromParent();
-            // 释放之前 retain 的引用，BattleManager 清理时会再次 release
-            this->release();
-        }),
+        CallFunc::create([this]() { finishRemoval(); }),
         nullptr);
     this->runAction(removeAction);
 
     CCLOG("%s died", getDisplayName().c_str());
 }
 
+void BaseUnit::finishRemoval()
+{
+    // 标记为等待移除状态，通知 BattleWorldView 可以安全回收
+    _pendingRemoval = true;
+    this->removeFromParent();
+    // 释放 die() 中 retain 的引用，BattleWorldView 回收时接管自己持有的引用
+    this->release();
+}
+
+void BaseUnit::resetForReuse()
+{
+    // 死亡动画播放中被回收（回放定位）时 finishRemoval 不会再执行，由这里释放 die() 的引用
+    if (_isDead && !_pendingRemoval)
+        this->release();
+
+    // removeFromParent 已停止动作和定时器，这里再清理一次，防止未经移除就被回收
+    this->stopAllActions();
+    this->setOpacity(255);
+    this->setVisible(true);
+
+    _isDead           = false;
+    _pendingRemoval   = false;
+    _isMoving         = false;
+    _moveVelocity     = Vec2::ZERO;
+    _targetPos        = Vec2::ZERO;
+    _currentPathIndex = 0;
+    _currentDir       = UnitDirection::kRight;
+    _currentTarget    = nullptr;
+    _pathPoints.clear();
+
+    _combatStats.currentHitpoints = _combatStats.maxHitpoints;
+    _attackCooldown               = _combatStats.attackSpeed * 0.5f;
+
+    if (_sprite)
+    {
+        _sprite->stopAllActions();
+        _sprite->setColor(Color3B::WHITE);
+        _sprite->setOpacity(255);
+    }
+    playAnimation(UnitAction::kIdle, _currentDir);
+
+    // 血条在死亡时已移除，再次部署时由 BattleWorldView 重新创建
+    attachHealthBarLayer(nullptr);
+}
+
 bool BaseUnit::isInAttackRange(const cocos2d::Vec2& targetPos) const
 {
     float distance = this->getPosition().distance(targetPos);
@@ -268,116 +354,90 @@ void BaseUnit::resetAttackCooldown()
 
 void BaseUnit::playAnimation(UnitAction action, UnitDirection dir)
 {
-    if (!_sprite)
+    if (!_sprite || !_animations)
         return;
 
-    std::string anim_key = "";
-    bool        flip_x   = false;
+    // 死亡动画不区分方向
+    if (action == UnitAction::kDeath)
+    {
+        Animation* death = _animations->get(UnitAction::kDeath, UnitAnimFacing::kRight);
+        if (death)
+        {
+            _sprite->stopAllActions();
+            _sprite->setFlippedX(false);
+            _sprite->runAction(Animate::create(death));
+        }
+        return;
+    }
 
-    // 计算动画键和翻转
+    // 计算素材朝向和翻转
+    UnitAnimFacing facing = UnitAnimFacing::kRight;
+    bool           flip_x = false;
     switch (dir)
     {
     case UnitDirection::kRight:
-        anim_key = "right";
-        flip_x   = false;
+        facing = UnitAnimFacing::kRight;
         break;
     case UnitDirection::kUpRight:
-        anim_key = "up_right";
-        flip_x   = false;
+    case UnitDirection::kUp:
+        facing = UnitAnimFacing::kUpRight;
         break;
     case UnitDirection::kDownRight:
-        anim_key = "down_right";
-        flip_x   = false;
+    case UnitDirection::kDown:
+        facing = UnitAnimFacing::kDownRight;
         break;
     case UnitDirection::kLeft:
-        anim_key = "right";
-        flip_x   = true;
+        facing = UnitAnimFacing::kRight;
+        flip_x = true;
         break;
     case UnitDirection::kUpLeft:
-        anim_key = "up_right";
-        flip_x   = true;
+        facing = UnitAnimFacing::kUpRight;
+        flip_x = true;
         break;
     case UnitDirection::kDownLeft:
-        anim_key = "down_right";
-        flip_x   = true;
-        break;
-    case UnitDirection::kUp:
-        anim_key = "up_right";
-        flip_x   = false;
-        break;
-    case UnitDirection::kDown:
-        anim_key = "down_right";
-        flip_x   = false;
+        facing = UnitAnimFacing::kDownRight;
+        flip_x = true;
         break;
     }
 
-    // 拼接动作前缀
-    std::string prefix = "";
-    if (action == UnitAction::kRun)
-        prefix = "run_";
-    else if (action == UnitAction::kIdle)
-        prefix = "idle_";
-    else if (action == UnitAction::kAttack)
-        prefix = "attack_";
-    else if (action == UnitAction::kAttack2)
-        prefix = "attack2_";
-    else if (action == UnitAction::kDeath)
-    {
-        // 死亡动画不区分方向
-        std::string final_key = "death";
-        if (_animCache.count(final_key))
-        {
-            _sprite->stopAllActions();
-            _sprite->setFlippedX(false);
-            _sprite->runAction(Animate::create(_animCache[final_key]));
-        }
+    Animation* anim = _animations->get(action, facing);
+    if (!anim)
         return;
-    }
 
-    std::string final_key = prefix + anim_key;
+    // 🔴 修复：停止动画动作但保留受击颜色动作
+    _sprite->stopActionByTag(kAnimationTag);
+    _sprite->setFlippedX(flip_x);
 
-    // 播放动画
-    if (_animCache.count(final_key))
+    if (action == UnitAction::kAttack || action == UnitAction::kAttack2)
     {
-        // 🔴 修复：停止动画动作但保留受击颜色动作
-        _sprite->stopActionByTag(kAnimationTag);
-        _sprite->setFlippedX(flip_x);
-
-        if (action == UnitAction::kAttack || action == UnitAction::kAttack2)
-        {
-            // 攻击动画播放一次
-            auto animate  = Animate::create(_animCache[final_key]);
-            auto callback = CallFunc::create([this]() {
-                if (!_isDead && !_isMoving)
-                {
-                    playAnimation(UnitAction::kIdle, _currentDir);
-                }
-            });
-            auto seq = Sequence::create(animate, callback, nullptr);
-            seq->setTag(kAnimationTag);
-            _sprite->runAction(seq);
-        }
-        else
-        {
-            // 其他动画循环播放
-            auto repeatAnim = RepeatForever::create(Animate::create(_animCache[final_key]));
-            repeatAnim->setTag(kAnimationTag);
-            _sprite->runAction(repeatAnim);
-        }
+        // 攻击动画播放一次
+        auto animate  = Animate::create(anim);
+        auto callback = CallFunc::create([this]() {
+            if (!_isDead && !_isMoving)
+            {
+                playAnimation(UnitAction::kIdle, _currentDir);
+            }
+        });
+        auto seq = Sequence::create(animate, callback, nullptr);
+        seq->setTag(kAnimationTag);
+        _sprite->runAction(seq);
     }
-}
-
-void BaseUnit::addAnimation(const std::string& key, cocos2d::Animation* anim)
-{
-    if (anim)
+    else
     {
-        anim->retain();
-        _animCache[key] = anim;
+        // 其他动画循环播放
+        auto repeatAnim = RepeatForever::create(Animate::create(anim));
+        repeatAnim->setTag(kAnimationTag);
+        _sprite->runAction(repeatAnim);
     }
 }
 
-void BaseUnit::addAnimFromFrames(const std::string& unitName, const std::string& key, int start, int end, float delay)
+void BaseUnit::addAnimFromFrames(const std::string& unitName, UnitAction action, UnitAnimFacing facing, int start,
+                                 int end, float delay)
 {
+    // 共享动画集已构建，后续实例无需再查找帧
+    if (!_animationsBuilding)
+        return;
+
     Vector<SpriteFrame*> frames;
     for (int i = start; i <= end; ++i)
     {
@@ -389,14 +449,17 @@ void BaseUnit::addAnimFromFrames(const std::string& unitName, const std::string&
 
     if (!frames.empty())
     {
-        auto anim = Animation::createWithSpriteFrames(frames, delay);
-        addAnimation(key, anim);
+        _animationsBuilding->set(action, facing, Animation::createWithSpriteFrames(frames, delay));
     }
 }
 
-void BaseUnit::addAnimFromFiles(const std::string& basePath, const std::string& namePattern, const std::string& key,
-                                int start, int end, float delay)
+void BaseUnit::addAnimFromFiles(const std::string& basePath, const std::string& namePattern, UnitAction action,
+                                UnitAnimFacing facing, int start, int end, float delay)
 {
+    // 共享动画集已构建，后续实例不再逐帧查询纹理缓存和创建 SpriteFrame
+    if (!_animationsBuilding)
+        return;
+
     Vector<SpriteFrame*> frames;
 
     for (int i = start; i <= end; ++i)
@@ -405,51 +468,51 @@ void BaseUnit::addAnimFromFiles(const std::string& basePath, const std::string&
         snprintf(buffer, sizeof(buffer), namePattern.c_str(), i);
         std::string fullPath = basePath + buffer;
 
-        auto texture = Director::getInstance()->getTextureCache()->addImage(fullPath);
-        if (texture)
-        {
-            auto frame = SpriteFrame::createWithTexture(
-                texture, Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height));
-            if (frame)
-                frames.pushBack(frame);
-        }
+        // 已打入图集的帧直接取图集帧，否则按散图加载
+        auto frame = SpriteAtlasManager::getInstance().getSpriteFrame(fullPath);
+        if (frame)
+            frames.pushBack(frame);
     }
 
     if (!frames.empty())
     {
-        auto anim = Animation::createWithSpriteFrames(frames, delay);
-        addAnimation(key, anim);
+        _animationsBuilding->set(action, facing, Animation::createWithSpriteFrames(frames, delay));
     }
 }
 
 // ==================== UI系统 ====================
 
-void BaseUnit::initHealthBarUI()
+void BaseUnit::attachHealthBarLayer(HealthBarLayer* layer)
 {
-    auto* healthBarUI = UnitHealthBarUI::create(this);
-    if (healthBarUI)
-    {
-        this->addChild(healthBarUI, 1000);
-        _healthBarUI = healthBarUI;
-    }
+    if (_healthBarLayer)
+        _healthBarLayer->removeBar(_healthBarSlot);
+
+    _healthBarLayer = layer;
+    _healthBarSlot  = layer ? layer->addUnit(this) : -1;
+}
+
+void BaseUnit::detachHealthBar()
+{
+    _healthBarLayer = nullptr;
+    _healthBarSlot  = -1;
 }
 
 void BaseUnit::enableBattleMode()
 {
     _battleModeEnabled = true;
-    if (_healthBarUI)
+    if (_healthBarLayer)
     {
-        _healthBarUI->setAlwaysVisible(true);
-        _healthBarUI->show();
+        _healthBarLayer->setAlwaysVisible(_healthBarSlot, true);
+        _healthBarLayer->show(_healthBarSlot);
     }
 }
 
 void BaseUnit::disableBattleMode()
 {
     _battleModeEnabled = false;
-    if (_healthBarUI)
+    if (_healthBarLayer)
     {
-        _healthBarUI->setAlwaysVisible(false);
+        _healthBarLayer->setAlwaysVisible(_healthBarSlot, false);
     }
 }
 
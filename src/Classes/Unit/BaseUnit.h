@@ -13,12 +13,12 @@
 #include "Unit/UnitTypes.h"
 #include "cocos2d.h"
 
-#include <map>
 #include <string>
 #include <vector>
 
 class BaseBuilding;
-class UnitHealthBarUI;
+class UnitAnimationSet;
+class HealthBarLayer;
 
 // 动作 Tag 常量，用于区分不同类型的动作以便单独停止
 constexpr int kAnimationTag = 1001;     ///< 动画动作 Tag
@@ -83,6 +83,13 @@ class BaseUnit : public cocos2d::Node {
      */
     virtual bool takeDamage(float damage);
 
+    /**
+     * @brief 同步战斗模拟计算出的生命值（只播放受击表现，不判定死亡）
+     * @param hitpoints 模拟中的当前生命值
+     * @note 死亡由 BattleWorld 的单位死亡事件单独触发 die()
+     */
+    void syncHitpoints(int hitpoints);
+
     /** @brief 死亡 */
     virtual void die();
 
@@ -95,6 +102,12 @@ class BaseUnit : public cocos2d::Node {
     /** @brief 标记为等待移除状态 */
     void markPendingRemoval() { _pendingRemoval = true; }
 
+    /**
+     * @brief 复用前重置（对象池回收时调用）
+     * @note 节点必须已从父节点移除；恢复满血、存活、待机动画和血条，精灵和血条节点原样复用
+     */
+    void resetForReuse();
+
     /** @brief 设置攻击目标 */
     void setTarget(BaseBuilding* target) { _currentTarget = target; }
 
@@ -150,8 +163,14 @@ class BaseUnit : public cocos2d::Node {
     /** @brief 获取等级 */
     int getLevel() const { return _unitLevel; }
 
-    /** @brief 初始化血条UI */
-    void initHealthBarUI();
+    /**
+     * @brief 在战斗血条层中创建血条（替换之前的血条）
+     * @param layer 血条层，为空时只移除血条
+     */
+    void attachHealthBarLayer(HealthBarLayer* layer);
+
+    /** @brief 血条层清空时回调：只清除引用，不再通知血条层 */
+    void detachHealthBar();
 
     /** @brief 启用战斗模式 */
     void enableBattleMode();
@@ -180,7 +199,11 @@ class BaseUnit : public cocos2d::Node {
      */
     virtual bool init(int level);
 
-    /** @brief 加载动画（子类实现） */
+    /**
+     * @brief 创建精灵并加载动画（子类实现）
+     * @note 动画由 UnitAnimationLibrary 按 类型 + 等级 共享，只有第一个实例真正构建；
+     *       之后的实例调用 addAnimFrom* 时直接跳过
+     */
     virtual void loadAnimations() = 0;
 
     /**
@@ -191,23 +214,23 @@ class BaseUnit : public cocos2d::Node {
     void playAnimation(UnitAction action, UnitDirection dir);
 
     /**
-     * @brief 添加动画到缓存
-     * @param key 动画键
-     * @param anim 动画对象
-     */
-    void addAnimation(const std::string& key, cocos2d::Animation* anim);
-
-    /**
-     * @brief 从帧添加动画
+     * @brief 从图集帧添加动画（仅在构建共享动画集时生效）
+     * @param unitName 帧名前缀
+     * @param action 动作
+     * @param facing 素材朝向（死亡动画使用 kRight）
      */
-    void addAnimFromFrames(const std::string& unitName, const std::string& key, 
+    void addAnimFromFrames(const std::string& unitName, UnitAction action, UnitAnimFacing facing,
                            int start, int end, float delay);
 
     /**
-     * @brief 从文件添加动画
+     * @brief 从单独的图片文件添加动画（仅在构建共享动画集时生效）
+     * @param basePath 图片目录
+     * @param namePattern 文件名格式
+     * @param action 动作
+     * @param facing 素材朝向（死亡动画使用 kRight）
      */
-    void addAnimFromFiles(const std::string& basePath, const std::string& namePattern, 
-                          const std::string& key, int start, int end, float delay);
+    void addAnimFromFiles(const std::string& basePath, const std::string& namePattern,
+                          UnitAction action, UnitAnimFacing facing, int start, int end, float delay);
 
     virtual void onAttackBefore() {}   ///< 攻击前回调
     virtual void onAttackAfter() {}    ///< 攻击后回调
@@ -221,9 +244,16 @@ class BaseUnit : public cocos2d::Node {
      */
     UnitDirection calculateDirection(const cocos2d::Vec2& direction);
 
+    /** @brief 播放受击变色效果 */
+    void playHitEffect();
+
+    /** @brief 死亡表现结束：标记等待移除、从父节点移除并释放 die() 中的引用 */
+    void finishRemoval();
+
  protected:
     cocos2d::Sprite* _sprite = nullptr;                      ///< 精灵
-    std::map<std::string, cocos2d::Animation*> _animCache;   ///< 动画缓存
+    const UnitAnimationSet* _animations = nullptr;           ///< 共享动画集（由 UnitAnimationLibrary 持有）
+    UnitAnimationSet* _animationsBuilding = nullptr;         ///< 正在构建的动画集（仅第一个实例的 init 期间非空）
 
     bool _isMoving = false;                    ///< 是否正在移动
     cocos2d::Vec2 _targetPos;                  ///< 目标位置
@@ -240,7 +270,9 @@ class BaseUnit : public cocos2d::Node {
     bool _isDead = false;                      ///< 是否死亡
     bool _pendingRemoval = false;              ///< 是否等待移除（防止野指针访问）
 
-    UnitHealthBarUI* _healthBarUI = nullptr;   ///< 血条UI
+    HealthBarLayer* _healthBarLayer = nullptr; ///< 血条层（死亡时移除血条）
+    int _healthBarSlot = -1;                   ///< 在血条层中的槽位
+    cocos2d::TintTo* _hitTint = nullptr;       ///< 受击恢复颜色动作（复用，持有引用）
     bool _battleModeEnabled = false;           ///< 战斗模式是否启用
 };
 
@@ -10,6 +10,8 @@
 #ifndef COMBAT_STATS_H_
 #define COMBAT_STATS_H_
 
+#include "Battle/FixedPoint.h"
+
 /**
  * @struct CombatStats
  * @brief 战斗属性结构体，适用于建筑和单位
@@ -62,17 +64,39 @@ struct CombatStats
      */
     float takeDamage(float dmg)
     {
-        float actualDamage = dmg - armor;
-        if (actualDamage < 1.0f)
-            actualDamage = 1.0f; // 至少造成1点伤害
+        Fixed actualDamage = computeDamage(Fixed::fromFloat(dmg), armor);
+
+        currentHitpoints = applyDamage(currentHitpoints, actualDamage);
 
-        currentHitpoints -= static_cast<int>(actualDamage + 0.5f); // 四舍五入
-        if (currentHitpoints < 0)
-            currentHitpoints = 0;
+        return actualDamage.toFloat();
+    }
 
+    /**
+     * @brief 计算护甲减免后的伤害
+     * @param dmg 原始伤害
+     * @param armor 护甲
+     * @return Fixed 实际伤害（至少 1 点）
+     */
+    static Fixed computeDamage(Fixed dmg, int armor)
+    {
+        Fixed actualDamage = dmg - Fixed::fromInt(armor);
+        if (actualDamage < Fixed::fromInt(1))
+            actualDamage = Fixed::fromInt(1); // 至少造成1点伤害
         return actualDamage;
     }
 
+    /**
+     * @brief 扣除伤害后的生命值（四舍五入，不低于 0）
+     * @note 战斗模拟（BattleWorld）与节点共用这一取整规则，定点数取整在所有平台上一致
+     */
+    static int applyDamage(int hitpoints, Fixed actualDamage)
+    {
+        hitpoints -= actualDamage.roundToInt(); // 四舍五入
+        if (hitpoints < 0)
+            hitpoints = 0;
+        return hitpoints;
+    }
+
     /**
      * @brief 治疗
      */
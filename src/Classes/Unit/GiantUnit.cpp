@@ -51,27 +51,40 @@ void GiantUnit::loadAnimations() {
   }
 
   // 加载跑步动画
-  addAnimFromFrames("giant", "run_down_right", 1, 12, 0.12f);
-  addAnimFromFrames("giant", "run_right", 13, 24, 0.12f);
-  addAnimFromFrames("giant", "run_up_right", 25, 36, 0.12f);
+  addAnimFromFrames("giant", UnitAction::kRun, UnitAnimFacing::kDownRight, 1,
+                    12, 0.12f);
+  addAnimFromFrames("giant", UnitAction::kRun, UnitAnimFacing::kRight, 13, 24,
+                    0.12f);
+  addAnimFromFrames("giant", UnitAction::kRun, UnitAnimFacing::kUpRight, 25, 36,
+                    0.12f);
 
   // 加载待机动画
-  addAnimFromFrames("giant", "idle_down_right", 37, 37, 1.0f);
-  addAnimFromFrames("giant", "idle_right", 38, 38, 1.0f);
-  addAnimFromFrames("giant", "idle_up_right", 39, 39, 1.0f);
+  addAnimFromFrames("giant", UnitAction::kIdle, UnitAnimFacing::kDownRight, 37,
+                    37, 1.0f);
+  addAnimFromFrames("giant", UnitAction::kIdle, UnitAnimFacing::kRight, 38, 38,
+                    1.0f);
+  addAnimFromFrames("giant", UnitAction::kIdle, UnitAnimFacing::kUpRight, 39,
+                    39, 1.0f);
 
   // 加载第一套攻击动画
-  addAnimFromFrames("giant", "attack_down_right", 46, 54, 0.11f);
-  addAnimFromFrames("giant", "attack_right", 55, 63, 0.11f);
-  addAnimFromFrames("giant", "attack_up_right", 64, 71, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack, UnitAnimFacing::kDownRight,
+                    46, 54, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack, UnitAnimFacing::kRight, 55,
+                    63, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack, UnitAnimFacing::kUpRight, 64,
+                    71, 0.11f);
 
   // 加载第二套攻击动画
-  addAnimFromFrames("giant", "attack2_down_right", 72, 80, 0.11f);
-  addAnimFromFrames("giant", "attack2_right", 81, 89, 0.11f);
-  addAnimFromFrames("giant", "attack2_up_right", 90, 97, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack2, UnitAnimFacing::kDownRight,
+                    72, 80, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack2, UnitAnimFacing::kRight, 81,
+                    89, 0.11f);
+  addAnimFromFrames("giant", UnitAction::kAttack2, UnitAnimFacing::kUpRight, 90,
+                    97, 0.11f);
 
   // 加载死亡动画
-  addAnimFromFrames("giant", "death", 99, 100, 0.5f);
+  addAnimFromFrames("giant", UnitAction::kDeath, UnitAnimFacing::kRight, 99,
+                    100, 0.5f);
 
   // 播放待机动画
   playAnimation(UnitAction::kIdle, UnitDirection::kRight);
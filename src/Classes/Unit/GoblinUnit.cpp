@@ -51,22 +51,32 @@ void GoblinUnit::loadAnimations() {
   }
 
   // 加载跑步动画
-  addAnimFromFrames("goblin", "run_down_right", 1, 8, 0.09f);
-  addAnimFromFrames("goblin", "run_right", 9, 16, 0.09f);
-  addAnimFromFrames("goblin", "run_up_right", 17, 24, 0.09f);
+  addAnimFromFrames("goblin", UnitAction::kRun, UnitAnimFacing::kDownRight, 1,
+                    8, 0.09f);
+  addAnimFromFrames("goblin", UnitAction::kRun, UnitAnimFacing::kRight, 9, 16,
+                    0.09f);
+  addAnimFromFrames("goblin", UnitAction::kRun, UnitAnimFacing::kUpRight, 17,
+                    24, 0.09f);
 
   // 加载待机动画
-  addAnimFromFrames("goblin", "idle_down_right", 25, 25, 1.0f);
-  addAnimFromFrames("goblin", "idle_right", 26, 26, 1.0f);
-  addAnimFromFrames("goblin", "idle_up_right", 27, 27, 1.0f);
+  addAnimFromFrames("goblin", UnitAction::kIdle, UnitAnimFacing::kDownRight, 25,
+                    25, 1.0f);
+  addAnimFromFrames("goblin", UnitAction::kIdle, UnitAnimFacing::kRight, 26, 26,
+                    1.0f);
+  addAnimFromFrames("goblin", UnitAction::kIdle, UnitAnimFacing::kUpRight, 27,
+                    27, 1.0f);
 
   // 加载攻击动画
-  addAnimFromFrames("goblin", "attack_down_right", 28, 31, 0.08f);
-  addAnimFromFrames("goblin", "attack_right", 32, 36, 0.08f);
-  addAnimFromFrames("goblin", "attack_up_right", 37, 40, 0.08f);
+  addAnimFromFrames("goblin", UnitAction::kAttack, UnitAnimFacing::kDownRight,
+                    28, 31, 0.08f);
+  addAnimFromFrames("goblin", UnitAction::kAttack, UnitAnimFacing::kRight, 32,
+                    36, 0.08f);
+  addAnimFromFrames("goblin", UnitAction::kAttack, UnitAnimFacing::kUpRight, 37,
+                    40, 0.08f);
 
   // 加载死亡动画
-  addAnimFromFrames("goblin", "death", 41, 42, 0.5f);
+  addAnimFromFrames("goblin", UnitAction::kDeath, UnitAnimFacing::kRight, 41,
+                    42, 0.5f);
 
   // 播放待机动画
   playAnimation(UnitAction::kIdle, UnitDirection::kRight);
@@ -0,0 +1,172 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridPathSearcher.cpp
+ * File Function: 网格路径搜索器实现（A* / JPS / HPA*）
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "GridPathSearcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+int GridPathSearcher::getDistance(const PathNode* nodeA, const PathNode* nodeB)
+{
+    // 切比雪夫距离 (适合8方向) 或 欧几里得距离估算
+    int dstX = std::abs(nodeA->x - nodeB->x);
+    int dstY = std::abs(nodeA->y - nodeB->y);
+
+    // 对角线移动优化：min(dx, dy) 步走斜线(14)，剩余走直线(10)
+    if (dstX > dstY)
+        return 14 * dstY + 10 * (dstX - dstY);
+    return 14 * dstX + 10 * (dstY - dstX);
+}
+
+bool GridPathSearcher::isValid(int x, int y, int width, int height)
+{
+    return x >= 0 && x < width && y >= 0 && y < height;
+}
+
+bool GridPathSearcher::searchAStar(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                                   bool ignoreWalls, std::vector<GridCell>& outCells)
+{
+    outCells.clear();
+    _lastExpanded = 0;
+
+    int width  = grid.getGridWidth();
+    int height = grid.getGridHeight();
+
+    auto cmp = [](PathNode* a, PathNode* b) { return a->fCost() > b->fCost(); };
+    std::priority_queue<PathNode*, std::vector<PathNode*>, decltype(cmp)> openSet(cmp);
+
+    std::vector<std::vector<bool>>      closedSet(width, std::vector<bool>(height, false));
+    std::vector<std::vector<PathNode*>> allNodes(width, std::vector<PathNode*>(height, nullptr));
+
+    PathNode  goalNode(goal.x, goal.y);
+    PathNode* startNode        = new PathNode(start.x, start.y);
+    allNodes[start.x][start.y] = startNode;
+    openSet.push(startNode);
+
+    bool      pathFound  = false;
+    PathNode* targetNode = nullptr;
+
+    while (!openSet.empty())
+    {
+        PathNode* currentNode = openSet.top();
+        openSet.pop();
+
+        if (closedSet[currentNode->x][currentNode->y])
+            continue;
+        closedSet[currentNode->x][currentNode->y] = true;
+        _lastExpanded++;
+
+        if (currentNode->x == goal.x && currentNode->y == goal.y)
+        {
+            pathFound  = true;
+            targetNode = currentNode;
+            break;
+        }
+
+        // 🆕 8方向移动：上下左右 + 对角线
+        int dx[]    = {0, 1, 0, -1, 1, 1, -1, -1};
+        int dy[]    = {1, 0, -1, 0, 1, -1, 1, -1};
+        int costs[] = {10, 10, 10, 10, 14, 14, 14, 14}; // 直线10，斜线14
+
+        for (int i = 0; i < 8; i++)
+        {
+            int nx = currentNode->x + dx[i];
+            int ny = currentNode->y + dy[i];
+
+            if (!isValid(nx, ny, width, height) || closedSet[nx][ny])
+                continue;
+            if (grid.isBlocked(nx, ny)) // isBlocked 返回 _collisionMap[nx][ny]
+            {
+                continue; // 跳过这个点，不加入寻路队列
+            }
+            // 碰撞检测
+            bool isTargetPos = (nx == goal.x && ny == goal.y);
+            if (!ignoreWalls && !isTargetPos && grid.isBlocked(nx, ny))
+            {
+                // 对角线移动时的额外检查：防止“穿墙角”
+                // 如果是斜走(i>=4)，且两个相邻的直线格子都是墙，则不能穿过
+                if (i >= 4)
+                {
+                    if (grid.isBlocked(currentNode->x + dx[i], currentNode->y) ||
+                        grid.isBlocked(currentNode->x, currentNode->y + dy[i]))
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    continue;
+                }
+            }
+
+            int       newCost  = currentNode->gCost + costs[i];
+            PathNode* neighbor = allNodes[nx][ny];
+
+            if (neighbor == nullptr)
+            {
+                neighbor         = new PathNode(nx, ny);
+                allNodes[nx][ny] = neighbor;
+                neighbor->gCost  = newCost;
+                neighbor->hCost  = getDistance(neighbor, &goalNode);
+                neighbor->parent = currentNode;
+                openSet.push(neighbor);
+            }
+            else if (newCost < neighbor->gCost)
+            {
+                neighbor->gCost  = newCost;
+                neighbor->parent = currentNode;
+                openSet.push(neighbor);
+            }
+        }
+    }
+
+    if (pathFound && targetNode)
+    {
+        for (PathNode* current = targetNode; current != nullptr; current = current->parent)
+        {
+            outCells.push_back(GridCell(current->x, current->y));
+        }
+        std::reverse(outCells.begin(), outCells.end());
+    }
+
+    for (int i = 0; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            if (allNodes[i][j])
+                delete allNodes[i][j];
+        }
+    }
+
+    return pathFound;
+}
+
+bool GridPathSearcher::search(PathfindingMode mode, const CollisionSnapshot& grid, const GridCell& start,
+                              const GridCell& goal, bool ignoreWalls, std::vector<GridCell>& outCells)
+{
+    bool found = false;
+
+    switch (mode)
+    {
+    case PathfindingMode::kJumpPoint:
+        found         = _jumpPoint.findPath(grid, start, goal, outCells);
+        _lastExpanded = _jumpPoint.getLastExpandedNodes();
+        break;
+    case PathfindingMode::kHierarchical:
+        found         = _hierarchical.findPath(grid, start, goal, outCells);
+        _lastExpanded = _hierarchical.getLastExpandedNodes();
+        break;
+    case PathfindingMode::kAStar:
+    default:
+        found = searchAStar(grid, start, goal, ignoreWalls, outCells);
+        break;
+    }
+
+    return found;
+}
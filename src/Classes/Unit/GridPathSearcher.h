@@ -0,0 +1,102 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     GridPathSearcher.h
+ * File Function: 网格路径搜索器 - 在碰撞快照上执行 A* / JPS / HPA*
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __GRID_PATH_SEARCHER_H__
+#define __GRID_PATH_SEARCHER_H__
+
+#include "CollisionSnapshot.h"
+#include "HierarchicalPathGraph.h"
+#include "JumpPointSearch.h"
+#include "PathCache.h"
+
+#include <vector>
+
+/**
+ * @struct PathNode
+ * @brief 寻路节点
+ */
+struct PathNode
+{
+    int x, y;              ///< 节点坐标
+    int gCost;             ///< 起点到当前节点的代价
+    int hCost;             ///< 当前节点到终点的估算代价
+    PathNode* parent;      ///< 父节点
+
+    /** @brief 获取总代价 */
+    int fCost() const { return gCost + hCost; }
+
+    /** @brief 比较运算符 */
+    bool operator>(const PathNode& other) const { return fCost() > other.fCost(); }
+
+    PathNode(int _x, int _y) : x(_x), y(_y), gCost(0), hCost(0), parent(nullptr) {}
+};
+
+/**
+ * @enum PathfindingMode
+ * @brief 网格搜索算法
+ */
+enum class PathfindingMode
+{
+    kAStar,       ///< 逐格扩展的 A*（默认）
+    kJumpPoint,   ///< 跳点搜索，路径代价与 A* 相同
+    kHierarchical ///< HPA* 分块抽象图，适合大地图，路径近似最优
+};
+
+/**
+ * @class GridPathSearcher
+ * @brief 网格路径搜索器
+ *
+ * 只读取 CollisionSnapshot，不接触 cocos2d 节点，因此可以在寻路线程中使用。
+ * 内部持有各算法的搜索缓冲区，不是线程安全的：主线程和每个寻路线程各持有一个实例。
+ */
+class GridPathSearcher
+{
+public:
+    /**
+     * @brief 按指定模式搜索格子路径
+     * @param mode 搜索模式
+     * @param grid 碰撞地图快照
+     * @param start 起点格子
+     * @param goal 终点格子
+     * @param ignoreWalls 是否忽略城墙
+     * @param outCells 输出：起点到终点的格子序列（含两端）
+     * @return bool 是否找到路径
+     */
+    bool search(PathfindingMode mode, const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                bool ignoreWalls, std::vector<GridCell>& outCells);
+
+    /** @brief 上一次搜索扩展的节点数 */
+    int getLastExpandedNodes() const { return _lastExpanded; }
+
+    /** @brief 设置 HPA* 区块边长（格子） */
+    void setClusterSize(int clusterSize) { _hierarchical.setClusterSize(clusterSize); }
+
+    /** @brief 预先构建 HPA* 抽象图（基准测试时避免把构建耗时计入查询） */
+    void prepareHierarchical(const CollisionSnapshot& grid)
+    {
+        if (_hierarchical.needsRebuild(grid))
+            _hierarchical.rebuild(grid);
+    }
+
+private:
+    /**
+     * @brief 在网格上执行 A* 搜索
+     */
+    bool searchAStar(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal, bool ignoreWalls,
+                     std::vector<GridCell>& outCells);
+
+    int  getDistance(const PathNode* nodeA, const PathNode* nodeB);
+    bool isValid(int x, int y, int width, int height);
+
+    JumpPointSearch       _jumpPoint;        ///< 跳点搜索器
+    HierarchicalPathGraph _hierarchical;     ///< HPA* 抽象图
+    int                   _lastExpanded = 0; ///< 上一次扩展的节点数
+};
+
+#endif // __GRID_PATH_SEARCHER_H__
@@ -0,0 +1,429 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     HierarchicalPathGraph.cpp
+ * File Function: 分层寻路（HPA*）实现
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "HierarchicalPathGraph.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+constexpr int HierarchicalPathGraph::kDefaultClusterSize;
+
+namespace
+{
+
+typedef std::pair<int, int> OpenEntry; ///< (代价, 下标)
+typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> OpenQueue;
+
+// 八方向距离：min(dx, dy) 步走斜线(14)，剩余走直线(10)
+int octile(const GridCell& a, const GridCell& b)
+{
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    return dx > dy ? 14 * dy + 10 * (dx - dy) : 14 * dx + 10 * (dy - dx);
+}
+
+const int kDirX[]  = {0, 1, 0, -1, 1, 1, -1, -1};
+const int kDirY[]  = {1, 0, -1, 0, 1, -1, 1, -1};
+const int kCosts[] = {10, 10, 10, 10, 14, 14, 14, 14};
+
+// 入口长度达到该值时在两端各放一个过渡点，否则只放中点
+const int kLongEntranceLength = 6;
+
+} // namespace
+
+HierarchicalPathGraph::HierarchicalPathGraph(int clusterSize) : _clusterSize(std::max(2, clusterSize)) {}
+
+void HierarchicalPathGraph::setClusterSize(int clusterSize)
+{
+    clusterSize = std::max(2, clusterSize);
+    if (clusterSize != _clusterSize)
+    {
+        _clusterSize = clusterSize;
+        _built       = false;
+    }
+}
+
+bool HierarchicalPathGraph::needsRebuild(const CollisionSnapshot& grid) const
+{
+    return !_built || grid.getOwner() != _owner || grid.getVersion() != _version || grid.getGridWidth() != _width ||
+           grid.getGridHeight() != _height;
+}
+
+int HierarchicalPathGraph::clusterOf(int x, int y) const
+{
+    return (x / _clusterSize) * _clustersY + (y / _clusterSize);
+}
+
+int HierarchicalPathGraph::addNode(const GridCell& cell)
+{
+    int cellIdx = cell.x * _height + cell.y;
+    if (_cellToNode[cellIdx] >= 0)
+        return _cellToNode[cellIdx];
+
+    Node node;
+    node.cell    = cell;
+    node.cluster = clusterOf(cell.x, cell.y);
+    _nodes.push_back(node);
+
+    int id               = static_cast<int>(_nodes.size()) - 1;
+    _cellToNode[cellIdx] = id;
+    _clusterNodes[node.cluster].push_back(id);
+    return id;
+}
+
+void HierarchicalPathGraph::addEntrances(bool vertical, int clusterA)
+{
+    // vertical = true：A 在左、B 在右，沿 y 方向扫描共享边界；否则 A 在上、B 在下，沿 x 方向扫描
+    int ax = clusterA / _clustersY;
+    int ay = clusterA % _clustersY;
+
+    int  borderA   = vertical ? (ax + 1) * _clusterSize - 1 : (ay + 1) * _clusterSize - 1;
+    int  scanBegin = vertical ? ay * _clusterSize : ax * _clusterSize;
+    int  scanEnd   = std::min(scanBegin + _clusterSize, vertical ? _height : _width);
+    auto cellAt    = [vertical](int border, int t) { return vertical ? GridCell(border, t) : GridCell(t, border); };
+    auto isOpenAt  = [&](int t) {
+        GridCell a = cellAt(borderA, t);
+        GridCell b = cellAt(borderA + 1, t);
+        return !_grid->isBlocked(a.x, a.y) && !_grid->isBlocked(b.x, b.y);
+    };
+    auto connect = [&](int t, int tb, int cost) {
+        int a = addNode(cellAt(borderA, t));
+        int b = addNode(cellAt(borderA + 1, tb));
+
+        Edge ab;
+        ab.to   = b;
+        ab.cost = cost;
+        ab.cells.push_back(_nodes[b].cell);
+        _nodes[a].edges.push_back(ab);
+
+        Edge ba;
+        ba.to   = a;
+        ba.cost = cost;
+        ba.cells.push_back(_nodes[a].cell);
+        _nodes[b].edges.push_back(ba);
+    };
+
+    int t = scanBegin;
+    while (t < scanEnd)
+    {
+        if (!isOpenAt(t))
+        {
+            ++t;
+            continue;
+        }
+
+        int runBegin = t;
+        while (t < scanEnd && isOpenAt(t))
+            ++t;
+        int runEnd = t - 1;
+
+        if (runEnd - runBegin + 1 >= kLongEntranceLength)
+        {
+            connect(runBegin, runBegin, 10);
+            connect(runEnd, runEnd, 10);
+        }
+        else
+        {
+            connect((runBegin + runEnd) / 2, (runBegin + runEnd) / 2, 10);
+        }
+    }
+
+    // 斜向穿过边界：与格子搜索一致，斜走只要求目标格可通行（允许切角）。
+    // 两侧的直线格子任一可通行时，这次斜走已经能由上面的直线入口加区块内移动替代；
+    // 只有两侧都被挡时才需要单独的斜向入口。
+    // 竖直边界额外检查越过扫描段两端的斜走，它们连接的是斜对角的区块。
+    int diagBegin = vertical ? std::max(scanBegin - 1, 0) : scanBegin;
+    int diagEnd   = vertical ? std::min(scanEnd + 1, _height) : scanEnd;
+    for (t = scanBegin; t < scanEnd; ++t)
+    {
+        GridCell a = cellAt(borderA, t);
+        if (_grid->isBlocked(a.x, a.y))
+            continue;
+
+        for (int step = -1; step <= 1; step += 2)
+        {
+            int tb = t + step;
+            if (tb < diagBegin || tb >= diagEnd)
+                continue;
+
+            GridCell b     = cellAt(borderA + 1, tb);
+            GridCell sideA = cellAt(borderA, tb);
+            GridCell sideB = cellAt(borderA + 1, t);
+            if (!_grid->isBlocked(b.x, b.y) && _grid->isBlocked(sideA.x, sideA.y) &&
+                _grid->isBlocked(sideB.x, sideB.y))
+            {
+                connect(t, tb, 14);
+            }
+        }
+    }
+}
+
+void HierarchicalPathGraph::rebuild(const CollisionSnapshot& grid)
+{
+    _grid      = &grid;
+    _owner     = grid.getOwner();
+    _version   = grid.getVersion();
+    _width     = grid.getGridWidth();
+    _height    = grid.getGridHeight();
+    _clustersX = (_width + _clusterSize - 1) / _clusterSize;
+    _clustersY = (_height + _clusterSize - 1) / _clusterSize;
+
+    _nodes.clear();
+    _cellToNode.assign(static_cast<size_t>(_width * _height), -1);
+    _clusterNodes.assign(static_cast<size_t>(_clustersX * _clustersY), std::vector<int>());
+
+    // 1. 相邻区块之间的入口（斜对角区块在竖直边界扫描中连接）
+    for (int cx = 0; cx < _clustersX; ++cx)
+    {
+        for (int cy = 0; cy < _clustersY; ++cy)
+        {
+            int cluster = cx * _clustersY + cy;
+            if (cx + 1 < _clustersX)
+                addEntrances(true, cluster);
+            if (cy + 1 < _clustersY)
+                addEntrances(false, cluster);
+        }
+    }
+
+    // 2. 区块内部入口两两之间的最短路径
+    ClusterSearch search;
+    for (size_t cluster = 0; cluster < _clusterNodes.size(); ++cluster)
+    {
+        const std::vector<int>& members = _clusterNodes[cluster];
+        for (int from : members)
+        {
+            searchCluster(static_cast<int>(cluster), _nodes[from].cell, search);
+            for (int to : members)
+            {
+                if (to == from)
+                    continue;
+                int dist = search.dist[localIndex(search, _nodes[to].cell)];
+                if (dist == INT_MAX)
+                    continue;
+
+                Edge edge;
+                edge.to   = to;
+                edge.cost = dist;
+                tracePath(search, _nodes[to].cell, edge.cells);
+                _nodes[from].edges.push_back(edge);
+            }
+        }
+    }
+
+    _built = true;
+}
+
+int HierarchicalPathGraph::localIndex(const ClusterSearch& search, const GridCell& cell) const
+{
+    return (cell.x - search.originX) * search.height + (cell.y - search.originY);
+}
+
+void HierarchicalPathGraph::searchCluster(int cluster, const GridCell& source, ClusterSearch& out)
+{
+    out.originX = (cluster / _clustersY) * _clusterSize;
+    out.originY = (cluster % _clustersY) * _clusterSize;
+    out.width   = std::min(_clusterSize, _width - out.originX);
+    out.height  = std::min(_clusterSize, _height - out.originY);
+    out.dist.assign(static_cast<size_t>(out.width * out.height), INT_MAX);
+    out.parent.assign(static_cast<size_t>(out.width * out.height), -1);
+
+    OpenQueue openSet;
+    int       sourceIdx = localIndex(out, source);
+    out.dist[sourceIdx] = 0;
+    openSet.push(OpenEntry(0, sourceIdx));
+
+    while (!openSet.empty())
+    {
+        OpenEntry top = openSet.top();
+        openSet.pop();
+        if (top.first > out.dist[top.second])
+            continue;
+        _lastExpanded++;
+
+        int lx = top.second / out.height;
+        int ly = top.second % out.height;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            int nx = lx + kDirX[i];
+            int ny = ly + kDirY[i];
+            if (nx < 0 || ny < 0 || nx >= out.width || ny >= out.height)
+                continue;
+            if (_grid->isBlocked(out.originX + nx, out.originY + ny))
+                continue;
+
+            int nIdx    = nx * out.height + ny;
+            int newCost = top.first + kCosts[i];
+            if (newCost < out.dist[nIdx])
+            {
+                out.dist[nIdx]   = newCost;
+                out.parent[nIdx] = top.second;
+                openSet.push(OpenEntry(newCost, nIdx));
+            }
+        }
+    }
+}
+
+void HierarchicalPathGraph::tracePath(const ClusterSearch& search, const GridCell& cell,
+                                      std::vector<GridCell>& outCells) const
+{
+    // 沿父指针回溯到搜索源点，输出 源点(不含) -> cell(含)
+    size_t begin = outCells.size();
+    for (int idx = localIndex(search, cell); search.parent[idx] >= 0; idx = search.parent[idx])
+    {
+        outCells.push_back(GridCell(search.originX + idx / search.height, search.originY + idx % search.height));
+    }
+    std::reverse(outCells.begin() + begin, outCells.end());
+}
+
+bool HierarchicalPathGraph::findPath(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                                     std::vector<GridCell>& outCells)
+{
+    outCells.clear();
+    if (needsRebuild(grid))
+        rebuild(grid);
+    _grid = &grid;
+
+    _lastExpanded = 0;
+
+    if (start == goal)
+    {
+        outCells.push_back(start);
+        return true;
+    }
+
+    // 与 A* 一致：被阻挡的终点不可进入
+    if (grid.isBlocked(goal.x, goal.y))
+        return false;
+
+    int startCluster = clusterOf(start.x, start.y);
+    int goalCluster  = clusterOf(goal.x, goal.y);
+
+    ClusterSearch fromStart;
+    searchCluster(startCluster, start, fromStart);
+
+    // 同一区块内可直达时不经过抽象图
+    if (startCluster == goalCluster && fromStart.dist[localIndex(fromStart, goal)] != INT_MAX)
+    {
+        outCells.push_back(start);
+        tracePath(fromStart, goal, outCells);
+        return true;
+    }
+
+    // 移动规则对称，从终点出发的距离即到终点的距离
+    ClusterSearch fromGoal;
+    searchCluster(goalCluster, goal, fromGoal);
+
+    const int nodeCount = static_cast<int>(_nodes.size());
+    const int startId   = nodeCount;
+    const int goalId    = nodeCount + 1;
+
+    std::vector<int>  g(nodeCount + 2, INT_MAX);
+    std::vector<int>  parent(nodeCount + 2, -1);
+    std::vector<int>  parentEdge(nodeCount + 2, -1);
+    std::vector<char> closed(nodeCount + 2, 0);
+
+    auto heuristic = [&](int id) {
+        if (id == goalId)
+            return 0;
+        return octile(id == startId ? start : _nodes[id].cell, goal);
+    };
+
+    OpenQueue openSet;
+    auto      relax = [&](int from, int to, int cost, int edgeIdx) {
+        if (closed[to] || cost >= g[to])
+            return;
+        g[to]          = cost;
+        parent[to]     = from;
+        parentEdge[to] = edgeIdx;
+        openSet.push(OpenEntry(cost + heuristic(to), to));
+    };
+
+    g[startId] = 0;
+    openSet.push(OpenEntry(heuristic(startId), startId));
+
+    while (!openSet.empty())
+    {
+        int current = openSet.top().second;
+        openSet.pop();
+        if (closed[current])
+            continue;
+        closed[current] = 1;
+        _lastExpanded++;
+
+        if (current == goalId)
+            break;
+
+        if (current == startId)
+        {
+            for (int id : _clusterNodes[startCluster])
+            {
+                int dist = fromStart.dist[localIndex(fromStart, _nodes[id].cell)];
+                if (dist != INT_MAX)
+                    relax(startId, id, dist, -1);
+            }
+            continue;
+        }
+
+        const Node& node = _nodes[current];
+        for (size_t e = 0; e < node.edges.size(); ++e)
+        {
+            relax(current, node.edges[e].to, g[current] + node.edges[e].cost, static_cast<int>(e));
+        }
+
+        if (node.cluster == goalCluster)
+        {
+            int dist = fromGoal.dist[localIndex(fromGoal, node.cell)];
+            if (dist != INT_MAX)
+                relax(current, goalId, g[current] + dist, -1);
+        }
+    }
+
+    if (!closed[goalId])
+        return false;
+
+    std::vector<int> chain;
+    for (int id = goalId; id >= 0; id = parent[id])
+    {
+        chain.push_back(id);
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    // 细化：起点段和终点段来自区块内搜索，中间段来自预存的边
+    outCells.push_back(start);
+    for (size_t i = 1; i < chain.size(); ++i)
+    {
+        int from = chain[i - 1];
+        int to   = chain[i];
+
+        if (from == startId)
+        {
+            tracePath(fromStart, _nodes[to].cell, outCells);
+        }
+        else if (to == goalId)
+        {
+            // fromGoal 的父指针指向终点，沿其前进即为 入口 -> 终点
+            for (int idx = fromGoal.parent[localIndex(fromGoal, _nodes[from].cell)]; idx >= 0;
+                 idx     = fromGoal.parent[idx])
+            {
+                outCells.push_back(
+                    GridCell(fromGoal.originX + idx / fromGoal.height, fromGoal.originY + idx % fromGoal.height));
+            }
+        }
+        else
+        {
+            const Edge& edge = _nodes[from].edges[parentEdge[to]];
+            outCells.insert(outCells.end(), edge.cells.begin(), edge.cells.end());
+        }
+    }
+
+    return true;
+}
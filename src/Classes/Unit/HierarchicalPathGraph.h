@@ -0,0 +1,124 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     HierarchicalPathGraph.h
+ * File Function: 分层寻路（HPA*）- 基于网格分块的抽象图
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __HIERARCHICAL_PATH_GRAPH_H__
+#define __HIERARCHICAL_PATH_GRAPH_H__
+
+#include "CollisionSnapshot.h"
+#include "PathCache.h"
+
+#include <vector>
+
+/**
+ * @class HierarchicalPathGraph
+ * @brief HPA* 风格的分层寻路图
+ *
+ * - 将网格切成 clusterSize x clusterSize 的区块
+ * - 相邻区块边界上连续可通行的一段形成入口（短入口取中点，长入口取两端）
+ * - 只能斜走穿过的边界（含区块四角）单独建立斜向入口，保证与格子搜索的连通性一致
+ * - 区块内部的入口两两之间预先计算最短路径，作为抽象图的边
+ * - 查询时把起点和终点接入所在区块的入口，在抽象图上跑 A*，再拼接预存的格子路径
+ *
+ * 抽象图绑定快照的来源地图和碰撞版本号，版本变化后在下一次查询前重建。
+ * 实例不是线程安全的，每个寻路线程需要各自的实例。
+ * 结果是近似最优路径，适合大地图上的长距离寻路。
+ */
+class HierarchicalPathGraph
+{
+public:
+    explicit HierarchicalPathGraph(int clusterSize = kDefaultClusterSize);
+
+    /** @brief 设置区块边长（格子），会使抽象图失效 */
+    void setClusterSize(int clusterSize);
+
+    /** @brief 获取区块边长 */
+    int getClusterSize() const { return _clusterSize; }
+
+    /**
+     * @brief 抽象图是否需要针对该地图重建
+     * @param grid 碰撞地图快照
+     */
+    bool needsRebuild(const CollisionSnapshot& grid) const;
+
+    /**
+     * @brief 重建抽象图
+     * @param grid 碰撞地图快照
+     */
+    void rebuild(const CollisionSnapshot& grid);
+
+    /**
+     * @brief 搜索格子路径（需要时自动重建抽象图）
+     * @param grid 碰撞地图快照
+     * @param start 起点格子
+     * @param goal 终点格子
+     * @param outCells 输出：起点到终点的逐格路径（含两端）
+     * @return bool 是否找到路径
+     */
+    bool findPath(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                  std::vector<GridCell>& outCells);
+
+    /** @brief 上一次搜索扩展的节点数（区块内搜索 + 抽象图搜索） */
+    int getLastExpandedNodes() const { return _lastExpanded; }
+
+    /** @brief 抽象图节点数 */
+    size_t getNodeCount() const { return _nodes.size(); }
+
+    static constexpr int kDefaultClusterSize = 10; ///< 默认区块边长
+
+private:
+    /** @brief 抽象边：到达节点 to 的代价以及途经的格子（不含起点，含终点） */
+    struct Edge
+    {
+        int                   to   = -1;
+        int                   cost = 0;
+        std::vector<GridCell> cells;
+    };
+
+    /** @brief 抽象节点：位于区块边界上的入口格子 */
+    struct Node
+    {
+        GridCell          cell;
+        int               cluster = 0;
+        std::vector<Edge> edges;
+    };
+
+    /** @brief 区块内 Dijkstra 的结果，下标为区块内局部坐标 */
+    struct ClusterSearch
+    {
+        int              originX = 0;
+        int              originY = 0;
+        int              width   = 0;
+        int              height  = 0;
+        std::vector<int> dist;
+        std::vector<int> parent;
+    };
+
+    int  clusterOf(int x, int y) const;
+    int  addNode(const GridCell& cell);
+    void addEntrances(bool vertical, int clusterA);
+    void searchCluster(int cluster, const GridCell& source, ClusterSearch& out);
+    int  localIndex(const ClusterSearch& search, const GridCell& cell) const;
+    void tracePath(const ClusterSearch& search, const GridCell& cell, std::vector<GridCell>& outCells) const;
+
+    int                           _clusterSize;          ///< 区块边长
+    const CollisionSnapshot*      _grid      = nullptr;  ///< 当前构建/搜索使用的快照
+    const void*                   _owner     = nullptr;  ///< 抽象图对应的来源地图
+    unsigned int                  _version   = 0;        ///< 抽象图对应的碰撞版本号
+    bool                          _built     = false;    ///< 抽象图是否有效
+    int                           _width     = 0;        ///< 网格宽度
+    int                           _height    = 0;        ///< 网格高度
+    int                           _clustersX = 0;        ///< X 方向区块数
+    int                           _clustersY = 0;        ///< Y 方向区块数
+    std::vector<Node>             _nodes;                ///< 抽象节点
+    std::vector<int>              _cellToNode;           ///< 格子下标 -> 抽象节点，-1 表示不是入口
+    std::vector<std::vector<int>> _clusterNodes;         ///< 区块 -> 入口节点列表
+    int                           _lastExpanded = 0;     ///< 上一次扩展的节点数
+};
+
+#endif // __HIERARCHICAL_PATH_GRAPH_H__
@@ -0,0 +1,259 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     JumpPointSearch.cpp
+ * File Function: 跳点搜索（JPS）实现
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "JumpPointSearch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+namespace
+{
+
+int sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// 八方向距离：min(dx, dy) 步走斜线(14)，剩余走直线(10)
+int octile(int x0, int y0, int x1, int y1)
+{
+    int dx = std::abs(x0 - x1);
+    int dy = std::abs(y0 - y1);
+    return dx > dy ? 14 * dy + 10 * (dx - dy) : 14 * dx + 10 * (dy - dx);
+}
+
+} // namespace
+
+bool JumpPointSearch::walkable(int x, int y) const
+{
+    return !_grid->isBlocked(x, y);
+}
+
+void JumpPointSearch::prepare(int width, int height)
+{
+    if (_width != width || _height != height || _nodes.size() != static_cast<size_t>(width * height))
+    {
+        _width  = width;
+        _height = height;
+        _nodes.assign(static_cast<size_t>(width * height), Node());
+        _stamp = 0;
+    }
+
+    // 批次号回绕时清空，避免旧数据被误认为本次搜索的结果
+    if (++_stamp == 0)
+    {
+        std::fill(_nodes.begin(), _nodes.end(), Node());
+        _stamp = 1;
+    }
+}
+
+bool JumpPointSearch::jump(int x, int y, int dx, int dy, int& outX, int& outY) const
+{
+    while (true)
+    {
+        x += dx;
+        y += dy;
+
+        if (!walkable(x, y))
+            return false;
+
+        if (x == _goal.x && y == _goal.y)
+        {
+            outX = x;
+            outY = y;
+            return true;
+        }
+
+        bool forced = false;
+        if (dx != 0 && dy != 0)
+        {
+            // 斜向：身后两侧被挡而斜前方可走时出现强迫邻居
+            forced = (!walkable(x - dx, y) && walkable(x - dx, y + dy)) ||
+                     (!walkable(x, y - dy) && walkable(x + dx, y - dy));
+
+            // 斜向每一步都要先尝试两个直线分量
+            int tx = 0;
+            int ty = 0;
+            if (!forced && (jump(x, y, dx, 0, tx, ty) || jump(x, y, 0, dy, tx, ty)))
+                forced = true;
+        }
+        else if (dx != 0)
+        {
+            forced = (!walkable(x, y + 1) && walkable(x + dx, y + 1)) ||
+                     (!walkable(x, y - 1) && walkable(x + dx, y - 1));
+        }
+        else
+        {
+            forced = (!walkable(x + 1, y) && walkable(x + 1, y + dy)) ||
+                     (!walkable(x - 1, y) && walkable(x - 1, y + dy));
+        }
+
+        if (forced)
+        {
+            outX = x;
+            outY = y;
+            return true;
+        }
+    }
+}
+
+bool JumpPointSearch::findPath(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                               std::vector<GridCell>& outCells)
+{
+    outCells.clear();
+    _lastExpanded = 0;
+
+    _grid = &grid;
+    _goal = goal;
+    prepare(grid.getGridWidth(), grid.getGridHeight());
+
+    auto index = [this](int x, int y) { return x * _height + y; };
+
+    // 开放列表：(f, 节点下标)，重复入队的旧条目在出队时跳过
+    typedef std::pair<int, int> OpenEntry;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openSet;
+
+    int   startIdx = index(start.x, start.y);
+    Node& startNd  = _nodes[startIdx];
+    startNd.g      = 0;
+    startNd.parent = -1;
+    startNd.stamp  = _stamp;
+    startNd.closed = false;
+    openSet.push(OpenEntry(octile(start.x, start.y, goal.x, goal.y), startIdx));
+
+    int goalIdx = index(goal.x, goal.y);
+
+    while (!openSet.empty())
+    {
+        int currentIdx = openSet.top().second;
+        openSet.pop();
+
+        Node& current = _nodes[currentIdx];
+        if (current.closed)
+            continue;
+        current.closed = true;
+        _lastExpanded++;
+
+        if (currentIdx == goalIdx)
+            break;
+
+        int cx = currentIdx / _height;
+        int cy = currentIdx % _height;
+
+        // 计算需要探索的方向（起点探索全部8个方向，其余节点按父方向剪枝）
+        int dirs[8][2];
+        int dirCount = 0;
+        auto addDir  = [&](int dx, int dy) {
+            dirs[dirCount][0] = dx;
+            dirs[dirCount][1] = dy;
+            dirCount++;
+        };
+
+        if (current.parent < 0)
+        {
+            for (int dx = -1; dx <= 1; ++dx)
+                for (int dy = -1; dy <= 1; ++dy)
+                    if (dx != 0 || dy != 0)
+                        addDir(dx, dy);
+        }
+        else
+        {
+            int px = current.parent / _height;
+            int py = current.parent % _height;
+            int dx = sign(cx - px);
+            int dy = sign(cy - py);
+
+            if (dx != 0 && dy != 0)
+            {
+                addDir(dx, 0);
+                addDir(0, dy);
+                addDir(dx, dy);
+                if (!walkable(cx - dx, cy))
+                    addDir(-dx, dy);
+                if (!walkable(cx, cy - dy))
+                    addDir(dx, -dy);
+            }
+            else if (dx != 0)
+            {
+                addDir(dx, 0);
+                if (!walkable(cx, cy + 1))
+                    addDir(dx, 1);
+                if (!walkable(cx, cy - 1))
+                    addDir(dx, -1);
+            }
+            else
+            {
+                addDir(0, dy);
+                if (!walkable(cx + 1, cy))
+                    addDir(1, dy);
+                if (!walkable(cx - 1, cy))
+                    addDir(-1, dy);
+            }
+        }
+
+        for (int i = 0; i < dirCount; ++i)
+        {
+            int jx = 0;
+            int jy = 0;
+            if (!jump(cx, cy, dirs[i][0], dirs[i][1], jx, jy))
+                continue;
+
+            int   jumpIdx = index(jx, jy);
+            Node& next    = _nodes[jumpIdx];
+            int   newCost = current.g + octile(cx, cy, jx, jy);
+
+            if (next.stamp != _stamp)
+            {
+                next.stamp  = _stamp;
+                next.closed = false;
+                next.g      = newCost;
+                next.parent = currentIdx;
+                openSet.push(OpenEntry(newCost + octile(jx, jy, goal.x, goal.y), jumpIdx));
+            }
+            else if (!next.closed && newCost < next.g)
+            {
+                next.g      = newCost;
+                next.parent = currentIdx;
+                openSet.push(OpenEntry(newCost + octile(jx, jy, goal.x, goal.y), jumpIdx));
+            }
+        }
+    }
+
+    const Node& goalNode = _nodes[goalIdx];
+    if (goalNode.stamp != _stamp || !goalNode.closed)
+        return false;
+
+    // 回溯跳点，并把相邻跳点之间的直线/斜线段展开成逐格路径
+    std::vector<int> jumpPoints;
+    for (int idx = goalIdx; idx >= 0; idx = _nodes[idx].parent)
+    {
+        jumpPoints.push_back(idx);
+    }
+    std::reverse(jumpPoints.begin(), jumpPoints.end());
+
+    outCells.push_back(start);
+    for (size_t i = 1; i < jumpPoints.size(); ++i)
+    {
+        int x  = jumpPoints[i - 1] / _height;
+        int y  = jumpPoints[i - 1] % _height;
+        int tx = jumpPoints[i] / _height;
+        int ty = jumpPoints[i] % _height;
+        int dx = sign(tx - x);
+        int dy = sign(ty - y);
+        while (x != tx || y != ty)
+        {
+            x += dx;
+            y += dy;
+            outCells.push_back(GridCell(x, y));
+        }
+    }
+
+    return true;
+}
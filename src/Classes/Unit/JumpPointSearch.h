@@ -0,0 +1,70 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     JumpPointSearch.h
+ * File Function: 跳点搜索（JPS）- 均匀代价8方向网格上的快速寻路
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __JUMP_POINT_SEARCH_H__
+#define __JUMP_POINT_SEARCH_H__
+
+#include "CollisionSnapshot.h"
+#include "PathCache.h"
+
+#include <vector>
+
+/**
+ * @class JumpPointSearch
+ * @brief 跳点搜索
+ *
+ * 与 PathFinder 的 A* 使用同一套移动规则：
+ * - 8方向移动，直线代价 10，斜线代价 14
+ * - 只要求目标格子可通行，斜向移动允许贴着墙角穿过（与 findPath 的现有行为一致）
+ *
+ * 在该规则下 JPS 与 A* 得到的路径代价相同，但只把跳点放入开放列表，
+ * 大片空地上扩展的节点数远少于 A*。
+ *
+ * 实例内部复用搜索缓冲区，不是线程安全的，每个寻路线程需要各自的实例。
+ */
+class JumpPointSearch
+{
+public:
+    /**
+     * @brief 搜索格子路径
+     * @param grid 碰撞地图快照
+     * @param start 起点格子
+     * @param goal 终点格子
+     * @param outCells 输出：起点到终点的逐格路径（含两端）
+     * @return bool 是否找到路径
+     */
+    bool findPath(const CollisionSnapshot& grid, const GridCell& start, const GridCell& goal,
+                  std::vector<GridCell>& outCells);
+
+    /** @brief 上一次搜索扩展的节点数 */
+    int getLastExpandedNodes() const { return _lastExpanded; }
+
+private:
+    struct Node
+    {
+        int          g      = 0;     ///< 起点到该节点的代价
+        int          parent = -1;    ///< 父跳点下标
+        unsigned int stamp  = 0;     ///< 所属搜索批次，批次不同视为未访问
+        bool         closed = false; ///< 是否已关闭
+    };
+
+    bool walkable(int x, int y) const;
+    bool jump(int x, int y, int dx, int dy, int& outX, int& outY) const;
+    void prepare(int width, int height);
+
+    const CollisionSnapshot* _grid   = nullptr; ///< 当前搜索使用的快照
+    int                      _width  = 0;
+    int                      _height = 0;
+    GridCell                 _goal;
+    std::vector<Node>        _nodes;            ///< 按 x * height + y 存放，跨搜索复用
+    unsigned int             _stamp        = 0; ///< 当前搜索批次
+    int                      _lastExpanded = 0; ///< 上一次扩展的节点数
+};
+
+#endif // __JUMP_POINT_SEARCH_H__
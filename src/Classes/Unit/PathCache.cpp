@@ -0,0 +1,217 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     PathCache.cpp
+ * File Function: 寻路结果缓存实现
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "PathCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+constexpr size_t PathCache::kDefaultCapacity;
+constexpr int    PathCache::kMaxJoinProbes;
+
+namespace
+{
+/** @brief 终点索引键：终点格子 + ignoreWalls */
+uint64_t goalKey(const PathCacheKey& key)
+{
+    auto field = [](int v) -> uint64_t { return static_cast<uint64_t>(v) & 0x7FFFu; };
+    return (field(key.goal.x) << 16) | (field(key.goal.y) << 1) | (key.ignoreWalls ? 1u : 0u);
+}
+} // namespace
+
+uint64_t PathCacheKey::pack() const
+{
+    // 每个坐标 15 位，足够覆盖任何战斗地图尺寸
+    auto field = [](int v) -> uint64_t { return static_cast<uint64_t>(v) & 0x7FFFu; };
+    return (field(start.x) << 46) | (field(start.y) << 31) | (field(goal.x) << 16) | (field(goal.y) << 1) |
+           (ignoreWalls ? 1u : 0u);
+}
+
+PathCache::PathCache(size_t capacity) : _capacity(std::max<size_t>(1, capacity)) {}
+
+PathCache::PathCache(const PathCache& other)
+    : _entries(other._entries)
+    , _capacity(other._capacity)
+    , _gridMap(other._gridMap)
+    , _version(other._version)
+    , _stats(other._stats)
+{
+    rebuildIndex();
+}
+
+PathCache& PathCache::operator=(const PathCache& other)
+{
+    if (this == &other)
+        return *this;
+
+    _entries  = other._entries;
+    _capacity = other._capacity;
+    _gridMap  = other._gridMap;
+    _version  = other._version;
+    _stats    = other._stats;
+    rebuildIndex();
+    return *this;
+}
+
+void PathCache::syncVersion(const GridMap* gridMap, unsigned int version)
+{
+    if (gridMap == _gridMap && version == _version)
+        return;
+
+    if (!_entries.empty())
+    {
+        _stats.invalidations++;
+        clear();
+    }
+
+    _gridMap = gridMap;
+    _version = version;
+}
+
+const PathCacheEntry* PathCache::find(const PathCacheKey& key)
+{
+    auto it = _index.find(key.pack());
+    if (it == _index.end())
+        return nullptr;
+
+    touch(it->second);
+    return &(*it->second);
+}
+
+const PathCacheEntry* PathCache::findJoinable(const PathCacheKey& key, int radius,
+                                              const std::function<bool(const GridCell&)>& canReach,
+                                              size_t& joinIndex)
+{
+    auto bucket = _goalIndex.find(goalKey(key));
+    if (bucket == _goalIndex.end())
+        return nullptr;
+
+    // 只看同终点的条目，从最近使用的开始（桶顺序与链表顺序一致，复制关键帧后不变）
+    const std::vector<EntryList::iterator>& candidates = bucket->second;
+
+    int probes = 0;
+    for (size_t c = candidates.size(); c-- > 0;)
+    {
+        EntryList::iterator   it    = candidates[c];
+        const PathCacheEntry& entry = *it;
+        if (entry.cells.empty())
+            continue;
+
+        // 从终点侧往回找：越靠后的汇入点剩余路程越短
+        for (size_t i = entry.cells.size(); i-- > 0;)
+        {
+            const GridCell& cell = entry.cells[i];
+            int             dist = std::max(std::abs(cell.x - key.start.x), std::abs(cell.y - key.start.y));
+            if (dist > radius)
+                continue;
+            if (canReach)
+            {
+                // 视线检测是主要开销，超过探测上限就放弃复用，交给完整寻路
+                if (probes >= kMaxJoinProbes)
+                    return nullptr;
+                ++probes;
+                if (!canReach(cell))
+                    continue;
+            }
+
+            joinIndex = i;
+            touch(it);
+            return &_entries.front();
+        }
+    }
+    return nullptr;
+}
+
+void PathCache::insert(PathCacheEntry entry)
+{
+    uint64_t packed = entry.key.pack();
+    auto     it     = _index.find(packed);
+    if (it != _index.end())
+    {
+        // 同键条目的终点相同，终点索引不变
+        *it->second = std::move(entry);
+        touch(it->second);
+        return;
+    }
+
+    _entries.push_front(std::move(entry));
+    _index[packed] = _entries.begin();
+    _goalIndex[goalKey(_entries.front().key)].push_back(_entries.begin());
+    evictOverflow();
+}
+
+void PathCache::clear()
+{
+    _entries.clear();
+    _index.clear();
+    _goalIndex.clear();
+}
+
+void PathCache::setCapacity(size_t capacity)
+{
+    _capacity = std::max<size_t>(1, capacity);
+    evictOverflow();
+}
+
+void PathCache::rebuildIndex()
+{
+    // 索引保存的是链表迭代器，复制后必须指向自己的节点
+    _index.clear();
+    _goalIndex.clear();
+    _index.reserve(_entries.size());
+    for (auto it = _entries.begin(); it != _entries.end(); ++it)
+    {
+        _index[it->key.pack()] = it;
+    }
+    // 终点索引桶按从旧到新排列
+    for (auto it = _entries.end(); it != _entries.begin();)
+    {
+        --it;
+        _goalIndex[goalKey(it->key)].push_back(it);
+    }
+}
+
+void PathCache::touch(EntryList::iterator it)
+{
+    _entries.splice(_entries.begin(), _entries, it);
+
+    auto bucket = _goalIndex.find(goalKey(it->key));
+    if (bucket == _goalIndex.end())
+        return;
+
+    std::vector<EntryList::iterator>& nodes = bucket->second;
+    auto                              pos   = std::find(nodes.begin(), nodes.end(), it);
+    if (pos != nodes.end())
+        std::rotate(pos, pos + 1, nodes.end());
+}
+
+void PathCache::unlinkGoal(EntryList::iterator it)
+{
+    auto bucket = _goalIndex.find(goalKey(it->key));
+    if (bucket == _goalIndex.end())
+        return;
+
+    std::vector<EntryList::iterator>& nodes = bucket->second;
+    auto                              pos   = std::find(nodes.begin(), nodes.end(), it);
+    if (pos != nodes.end())
+        nodes.erase(pos);
+    if (nodes.empty())
+        _goalIndex.erase(bucket);
+}
+
+void PathCache::evictOverflow()
+{
+    while (_entries.size() > _capacity)
+    {
+        _index.erase(_entries.back().key.pack());
+        unlinkGoal(std::prev(_entries.end()));
+        _entries.pop_back();
+        _stats.evictions++;
+    }
+}
@@ -0,0 +1,182 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     PathCache.h
+ * File Function: 寻路结果缓存 - 按碰撞地图版本失效的 LRU 缓存
+ * Author:        刘相成
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#pragma once
+#ifndef __PATH_CACHE_H__
+#define __PATH_CACHE_H__
+
+#include "math/Vec2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class GridMap;
+
+/**
+ * @struct GridCell
+ * @brief 网格坐标（整数）
+ */
+struct GridCell
+{
+    int x = 0; ///< 网格X坐标
+    int y = 0; ///< 网格Y坐标
+
+    GridCell() = default;
+    GridCell(int _x, int _y) : x(_x), y(_y) {}
+
+    bool operator==(const GridCell& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const GridCell& other) const { return !(*this == other); }
+};
+
+/**
+ * @struct PathCacheKey
+ * @brief 缓存键：起点格子 + 终点格子 + 是否无视城墙
+ * @note 碰撞地图版本由缓存整体维护，版本变化时整个缓存失效
+ */
+struct PathCacheKey
+{
+    GridCell start;              ///< 起点格子
+    GridCell goal;               ///< 终点格子
+    bool     ignoreWalls = false; ///< 是否无视城墙
+
+    /** @brief 打包为 64 位整数，用作哈希表键 */
+    uint64_t pack() const;
+};
+
+/**
+ * @struct PathCacheEntry
+ * @brief 缓存条目
+ */
+struct PathCacheEntry
+{
+    PathCacheKey               key;          ///< 缓存键
+    std::vector<GridCell>      cells;        ///< A* 原始格子路径（起点 -> 终点），为空表示不可达
+    std::vector<cocos2d::Vec2> smoothedPath; ///< 平滑后的世界坐标路径
+};
+
+/**
+ * @struct PathCacheStats
+ * @brief 缓存命中统计
+ */
+struct PathCacheStats
+{
+    uint64_t lookups       = 0; ///< 查询总次数
+    uint64_t hits          = 0; ///< 完全命中次数
+    uint64_t partialHits   = 0; ///< 部分路径复用次数
+    uint64_t misses        = 0; ///< 未命中次数（执行了完整 A*）
+    uint64_t evictions     = 0; ///< LRU 淘汰次数
+    uint64_t invalidations = 0; ///< 因碰撞地图变化导致的整体失效次数
+
+    /** @brief 完全命中率 (0.0 ~ 1.0) */
+    float getHitRate() const { return lookups > 0 ? static_cast<float>(hits) / lookups : 0.0f; }
+
+    /** @brief 完全命中 + 部分复用的命中率 (0.0 ~ 1.0) */
+    float getReuseRate() const { return lookups > 0 ? static_cast<float>(hits + partialHits) / lookups : 0.0f; }
+};
+
+/**
+ * @class PathCache
+ * @brief 寻路结果的 LRU 缓存
+ *
+ * - 以 (起点格子, 终点格子, ignoreWalls) 为键，保存 A* 的原始格子路径和平滑路径
+ * - 缓存绑定一个 GridMap 及其碰撞版本号，GridMap::markArea 改变版本号后整个缓存失效
+ * - 支持部分路径复用：新起点靠近某条同终点的缓存路径时，可以直接汇入该路径
+ */
+class PathCache
+{
+public:
+    explicit PathCache(size_t capacity = kDefaultCapacity);
+
+    /** @brief 复制条目（保持 LRU 顺序）并重建索引，用于回放关键帧 */
+    PathCache(const PathCache& other);
+    PathCache& operator=(const PathCache& other);
+
+    /**
+     * @brief 绑定网格地图与碰撞版本，版本或地图变化时清空缓存
+     * @param gridMap 网格地图
+     * @param version 碰撞地图版本号
+     */
+    void syncVersion(const GridMap* gridMap, unsigned int version);
+
+    /**
+     * @brief 精确查找
+     * @param key 缓存键
+     * @return const PathCacheEntry* 命中的条目，未命中返回 nullptr
+     */
+    const PathCacheEntry* find(const PathCacheKey& key);
+
+    /**
+     * @brief 查找可汇入的同终点缓存路径
+     * @note 只检查同终点索引中的条目，按最近使用顺序尝试，canReach 最多调用 kMaxJoinProbes 次
+     * @param key 当前请求的键
+     * @param radius 允许汇入的最大切比雪夫距离（格子）
+     * @param canReach 判断起点能否直达候选格子（例如视线检测）
+     * @param joinIndex 输出：汇入点在 cells 中的下标
+     * @return const PathCacheEntry* 可汇入的条目，不存在返回 nullptr
+     */
+    const PathCacheEntry* findJoinable(const PathCacheKey& key, int radius,
+                                       const std::function<bool(const GridCell&)>& canReach, size_t& joinIndex);
+
+    /**
+     * @brief 插入或更新条目
+     * @param entry 缓存条目
+     */
+    void insert(PathCacheEntry entry);
+
+    /** @brief 清空缓存（不重置统计） */
+    void clear();
+
+    /** @brief 设置容量，超出部分按 LRU 淘汰 */
+    void setCapacity(size_t capacity);
+
+    /** @brief 获取容量 */
+    size_t getCapacity() const { return _capacity; }
+
+    /** @brief 获取当前条目数 */
+    size_t size() const { return _entries.size(); }
+
+    /** @brief 获取统计数据 */
+    const PathCacheStats& getStats() const { return _stats; }
+
+    /** @brief 获取可写统计数据（由 PathFinder 记录命中类型） */
+    PathCacheStats& getStats() { return _stats; }
+
+    /** @brief 重置统计数据 */
+    void resetStats() { _stats = PathCacheStats(); }
+
+    static constexpr size_t kDefaultCapacity = 256; ///< 默认容量
+    static constexpr int    kMaxJoinProbes   = 8;   ///< 单次汇入查找最多的 canReach 调用次数
+
+private:
+    void evictOverflow();
+
+    /** @brief 按条目链表重建键索引和终点索引 */
+    void rebuildIndex();
+
+    using EntryList = std::list<PathCacheEntry>;
+
+    /** @brief 把条目移到表头，并移到终点索引桶的末尾 */
+    void touch(EntryList::iterator it);
+
+    /** @brief 从终点索引中移除条目 */
+    void unlinkGoal(EntryList::iterator it);
+
+    EntryList                                                      _entries;     ///< 按最近使用排序，表头最新
+    std::unordered_map<uint64_t, EntryList::iterator>              _index;       ///< 键 -> 链表节点
+    std::unordered_map<uint64_t, std::vector<EntryList::iterator>> _goalIndex;   ///< (终点, ignoreWalls) -> 链表节点，桶内末尾最新
+    size_t                                                         _capacity;    ///< 最大条目数
+    const GridMap*                                                 _gridMap = nullptr; ///< 绑定的网格地图
+    unsigned int                                                   _version = 0; ///< 绑定的碰撞版本号
+    PathCacheStats                                                 _stats;       ///< 统计数据
+};
+
+#endif // __PATH_CACHE_H__
@@ -8,8 +8,9 @@
  ****************************************************************/
 #include "PathFinder.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <queue>
+#include <random>
 
 USING_NS_CC;
 
@@ -19,18 +20,6 @@ PathFinder& PathFinder::getInstance()
     return instance;
 }
 
-int PathFinder::getDistance(const PathNode* nodeA, const PathNode* nodeB)
-{
-    // 切比雪夫距离 (适合8方向) 或 欧几里得距离估算
-    int dstX = std::abs(nodeA->x - nodeB->x);
-    int dstY = std::abs(nodeA->y - nodeB->y);
-
-    // 对角线移动优化：min(dx, dy) 步走斜线(14)，剩余走直线(10)
-    if (dstX > dstY)
-        return 14 * dstY + 10 * (dstX - dstY);
-    return 14 * dstX + 10 * (dstY - dstX);
-}
-
 bool PathFinder::isValid(int x, int y, int width, int height)
 {
     return x >= 0 && x < width && y >= 0 && y < height;
@@ -42,28 +31,8 @@ bool PathFinder::hasLineOfSight(GridMap* gridMap, const Vec2& start, const Vec2&
     if (ignoreWalls)
         return true; // 炸弹人无视阻挡
 
-    float dist = start.distance(end);
-    if (dist < 1.0f)
-        return true;
-
-    Vec2 dir = (end - start).getNormalized();
-
-    // 步长设为格子的一半，防止漏检
-    float stepSize = gridMap->getTileSize() * 0.5f;
-    int   steps    = static_cast<int>(dist / stepSize);
-
-    for (int i = 1; i < steps; ++i)
-    { // 从1开始，跳过起点
-        Vec2 checkPos = start + dir * (i * stepSize);
-        Vec2 gridPos  = gridMap->getGridPosition(checkPos);
-
-        // 如果中间有点被阻挡，则视线不通
-        if (gridMap->isBlocked((int)gridPos.x, (int)gridPos.y))
-        {
-            return false;
-        }
-    }
-    return true;
+    // 逐格遍历连线经过的网格（DDA）
+    return gridMap->hasLineOfSight(start, end);
 }
 
 // 路径平滑算法
@@ -102,9 +71,28 @@ std::vector<Vec2> PathFinder::findPath(GridMap* gridMap, const Vec2& startWorldU
                                        bool ignoreWalls)
 {
     std::vector<Vec2> path;
-    if (!gridMap)
+
+    PathCacheKey key;
+    if (!makeCacheKey(gridMap, startWorldUnit, endWorldTarget, ignoreWalls, key))
+        return path;
+
+    if (findCachedPath(gridMap, startWorldUnit, key, path))
         return path;
 
+    // 3. 未命中：按当前模式在快照上完整搜索
+    std::shared_ptr<const CollisionSnapshot> snapshot = gridMap->getCollisionSnapshot();
+    std::vector<GridCell>                    cells;
+    _searcher.search(_mode, *snapshot, key.start, key.goal, ignoreWalls, cells);
+
+    return completePath(gridMap, startWorldUnit, key, snapshot->getVersion(), cells);
+}
+
+bool PathFinder::makeCacheKey(GridMap* gridMap, const Vec2& startWorldUnit, const Vec2& endWorldTarget,
+                              bool ignoreWalls, PathCacheKey& outKey)
+{
+    if (!gridMap)
+        return false;
+
     Vec2 startGrid = gridMap->getGridPosition(startWorldUnit);
     Vec2 endGrid   = gridMap->getGridPosition(endWorldTarget);
 
@@ -114,128 +102,233 @@ std::vector<Vec2> PathFinder::findPath(GridMap* gridMap, const Vec2& startWorldU
     if (!isValid((int)startGrid.x, (int)startGrid.y, width, height) ||
         !isValid((int)endGrid.x, (int)endGrid.y, width, height))
     {
-        return path;
+        return false;
     }
 
-    auto cmp = [](PathNode* a, PathNode* b) { return a->fCost() > b->fCost(); };
-    std::priority_queue<PathNode*, std::vector<PathNode*>, decltype(cmp)> openSet(cmp);
-
-    std::vector<std::vector<bool>>      closedSet(width, std::vector<bool>(height, false));
-    std::vector<std::vector<PathNode*>> allNodes(width, std::vector<PathNode*>(height, nullptr));
+    outKey.start       = GridCell((int)startGrid.x, (int)startGrid.y);
+    outKey.goal        = GridCell((int)endGrid.x, (int)endGrid.y);
+    outKey.ignoreWalls = ignoreWalls;
+    return true;
+}
 
-    PathNode* startNode                          = new PathNode((int)startGrid.x, (int)startGrid.y);
-    allNodes[(int)startGrid.x][(int)startGrid.y] = startNode;
-    openSet.push(startNode);
+bool PathFinder::findCachedPath(GridMap* gridMap, const Vec2& startWorldUnit, const PathCacheKey& key,
+                                std::vector<Vec2>& outPath)
+{
+    if (!gridMap || !_cacheEnabled)
+        return false;
 
-    bool      pathFound  = false;
-    PathNode* targetNode = nullptr;
+    _cache.syncVersion(gridMap, gridMap->getCollisionVersion());
+    PathCacheStats& stats = _cache.getStats();
+    stats.lookups++;
 
-    while (!openSet.empty())
+    // 1. 完全命中：同一起点格子、同一终点格子
+    if (const PathCacheEntry* entry = _cache.find(key))
     {
-        PathNode* currentNode = openSet.top();
-        openSet.pop();
-
-        if (closedSet[currentNode->x][currentNode->y])
-            continue;
-        closedSet[currentNode->x][currentNode->y] = true;
-
-        if (currentNode->x == (int)endGrid.x && currentNode->y == (int)endGrid.y)
-        {
-            pathFound  = true;
-            targetNode = currentNode;
-            break;
-        }
-
-        // 🆕 8方向移动：上下左右 + 对角线
-        int dx[]    = {0, 1, 0, -1, 1, 1, -1, -1};
-        int dy[]    = {1, 0, -1, 0, 1, -1, 1, -1};
-        int costs[] = {10, 10, 10, 10, 14, 14, 14, 14}; // 直线10，斜线14
+        stats.hits++;
+        outPath = entry->smoothedPath;
+        // 缓存路径的起点是上一次请求者的位置，替换为当前单位的真实位置
+        if (!outPath.empty())
+            outPath[0] = startWorldUnit;
+        return true;
+    }
 
-        for (int i = 0; i < 8; i++)
+    // 2. 部分复用：从附近格子汇入一条同终点的缓存路径
+    if (_joinRadius > 0)
+    {
+        size_t joinIndex = 0;
+        auto   canReach  = [&](const GridCell& cell) {
+            return hasLineOfSight(gridMap, startWorldUnit, gridMap->getPositionFromGrid(Vec2(cell.x, cell.y)),
+                                  key.ignoreWalls);
+        };
+        if (const PathCacheEntry* entry = _cache.findJoinable(key, _joinRadius, canReach, joinIndex))
         {
-            int nx = currentNode->x + dx[i];
-            int ny = currentNode->y + dy[i];
+            stats.partialHits++;
 
-            if (!isValid(nx, ny, width, height) || closedSet[nx][ny])
-                continue;
-            if (gridMap->isBlocked(nx, ny)) // isBlocked 返回 _collisionMap[nx][ny]
-            {
-                continue; // 跳过这个点，不加入寻路队列
-            }
-            // 碰撞检测
-            bool isTargetPos = (nx == (int)endGrid.x && ny == (int)endGrid.y);
-            if (!ignoreWalls && !isTargetPos && gridMap->isBlocked(nx, ny))
+            PathCacheEntry joined;
+            joined.key = key;
+            joined.cells.push_back(key.start);
+            for (size_t i = joinIndex; i < entry->cells.size(); ++i)
             {
-                // 对角线移动时的额外检查：防止“穿墙角”
-                // 如果是斜走(i>=4)，且两个相邻的直线格子都是墙，则不能穿过
-                if (i >= 4)
-                {
-                    if (gridMap->isBlocked(currentNode->x + dx[i], currentNode->y) ||
-                        gridMap->isBlocked(currentNode->x, currentNode->y + dy[i]))
-                    {
-                        continue;
-                    }
-                }
-                else
-                {
-                    continue;
-                }
+                if (entry->cells[i] != key.start)
+                    joined.cells.push_back(entry->cells[i]);
             }
+            joined.smoothedPath = buildWorldPath(gridMap, startWorldUnit, joined.cells, 0, key.ignoreWalls);
+            outPath             = joined.smoothedPath;
+            _cache.insert(std::move(joined));
+            return true;
+        }
+    }
 
-            int       newCost  = currentNode->gCost + costs[i];
-            PathNode* neighbor = allNodes[nx][ny];
+    stats.misses++;
+    return false;
+}
 
-            if (neighbor == nullptr)
-            {
-                neighbor         = new PathNode(nx, ny);
-                allNodes[nx][ny] = neighbor;
-                neighbor->gCost  = newCost;
-                neighbor->hCost  = getDistance(neighbor, new PathNode((int)endGrid.x, (int)endGrid.y));
-                neighbor->parent = currentNode;
-                openSet.push(neighbor);
-            }
-            else if (newCost < neighbor->gCost)
-            {
-                neighbor->gCost  = newCost;
-                neighbor->parent = currentNode;
-                openSet.push(neighbor);
-            }
-        }
+std::vector<Vec2> PathFinder::completePath(GridMap* gridMap, const Vec2& startWorldUnit, const PathCacheKey& key,
+                                           unsigned int snapshotVersion, const std::vector<GridCell>& cells)
+{
+    if (!gridMap)
+        return std::vector<Vec2>();
+
+    PathCacheEntry entry;
+    entry.key   = key;
+    entry.cells = cells;
+    if (!entry.cells.empty())
+    {
+        entry.smoothedPath = buildWorldPath(gridMap, startWorldUnit, entry.cells, 0, key.ignoreWalls);
     }
+    std::vector<Vec2> path = entry.smoothedPath;
 
-    if (pathFound && targetNode)
+    // 不可达的结果同样缓存：失败的 A* 会遍历整张地图，代价最高
+    // 搜索期间地图已变化（异步寻路）时结果只给本次请求使用，不写入缓存
+    if (_cacheEnabled && snapshotVersion == gridMap->getCollisionVersion())
     {
-        PathNode*         current = targetNode;
-        std::vector<Vec2> rawPath;
-        while (current != nullptr)
-        {
-            rawPath.push_back(gridMap->getPositionFromGrid(Vec2(current->x, current->y)));
-            current = current->parent;
-        }
-        std::reverse(rawPath.begin(), rawPath.end());
+        _cache.syncVersion(gridMap, snapshotVersion);
+        _cache.insert(std::move(entry));
+    }
 
-        // 🆕 关键：执行路径平滑
-        // 如果单位在地图外，rawPath[0] 是边界点。
-        // smoothPath 会检查 "startWorldUnit" 到 "rawPath[i]" 的连线
-        // 所以我们需要把 startWorldUnit 插到路径最前面，再平滑
-        if (!rawPath.empty())
-        {
-            std::vector<Vec2> fullPath;
-            fullPath.push_back(startWorldUnit); // 真正的起点
-            fullPath.insert(fullPath.end(), rawPath.begin(), rawPath.end());
+    return path;
+}
 
-            path = smoothPath(gridMap, fullPath, ignoreWalls);
-        }
+std::vector<Vec2> PathFinder::buildWorldPath(GridMap* gridMap, const Vec2& startWorldUnit,
+                                             const std::vector<GridCell>& cells, size_t from, bool ignoreWalls)
+{
+    if (from >= cells.size())
+        return std::vector<Vec2>();
+
+    // 🆕 关键：执行路径平滑
+    // 如果单位在地图外，cells[0] 是边界点。
+    // smoothPath 会检查 "startWorldUnit" 到 "rawPath[i]" 的连线
+    // 所以我们需要把 startWorldUnit 插到路径最前面，再平滑
+    std::vector<Vec2> fullPath;
+    fullPath.reserve(cells.size() - from + 1);
+    fullPath.push_back(startWorldUnit); // 真正的起点
+    for (size_t i = from; i < cells.size(); ++i)
+    {
+        fullPath.push_back(gridMap->getPositionFromGrid(Vec2(cells[i].x, cells[i].y)));
+    }
+
+    return smoothPath(gridMap, fullPath, ignoreWalls);
+}
+
+void PathFinder::setMode(PathfindingMode mode)
+{
+    if (mode == _mode)
+        return;
+
+    // 不同模式得到的路径不同（HPA* 为近似最优），旧缓存不再代表当前模式的结果
+    _mode = mode;
+    _cache.clear();
+    CCLOG("🧭 寻路模式切换为: %s", getModeName(mode).c_str());
+}
+
+std::string PathFinder::getModeName(PathfindingMode mode)
+{
+    switch (mode)
+    {
+    case PathfindingMode::kAStar:
+        return "A*";
+    case PathfindingMode::kJumpPoint:
+        return "JPS";
+    case PathfindingMode::kHierarchical:
+        return "HPA*";
     }
+    return "Unknown";
+}
+
+std::vector<PathBenchmarkResult> PathFinder::benchmarkModes(GridMap* gridMap, int queryCount, unsigned int seed)
+{
+    std::vector<PathBenchmarkResult> results;
+    if (!gridMap || queryCount <= 0)
+        return results;
+
+    std::shared_ptr<const CollisionSnapshot> snapshot = gridMap->getCollisionSnapshot();
+    int                                      width    = snapshot->getGridWidth();
+    int                                      height   = snapshot->getGridHeight();
+
+    // 生成查询：起点和终点都取可通行格子，所有模式使用同一组查询
+    std::mt19937                               rng(seed);
+    std::uniform_int_distribution<int>         randX(0, width - 1);
+    std::uniform_int_distribution<int>         randY(0, height - 1);
+    std::vector<std::pair<GridCell, GridCell>> queries;
+    auto                                       randomFreeCell = [&]() {
+        GridCell cell(randX(rng), randY(rng));
+        for (int attempt = 0; attempt < 64 && snapshot->isBlocked(cell.x, cell.y); ++attempt)
+            cell = GridCell(randX(rng), randY(rng));
+        return cell;
+    };
+    for (int i = 0; i < queryCount; ++i)
+    {
+        GridCell start = randomFreeCell();
+        GridCell goal  = randomFreeCell();
+        queries.push_back(std::make_pair(start, goal));
+    }
+
+    // 预先构建 HPA* 抽象图，构建耗时不计入查询
+    _searcher.prepareHierarchical(*snapshot);
 
-    for (int i = 0; i < width; i++)
+    const PathfindingMode modes[] = {PathfindingMode::kAStar, PathfindingMode::kJumpPoint,
+                                     PathfindingMode::kHierarchical};
+    std::vector<GridCell> cells;
+    for (PathfindingMode mode : modes)
     {
-        for (int j = 0; j < height; j++)
+        PathBenchmarkResult result;
+        result.mode    = mode;
+        result.queries = queryCount;
+
+        double totalMicros   = 0.0;
+        double totalExpanded = 0.0;
+        double totalCost     = 0.0;
+
+        for (const auto& query : queries)
         {
-            if (allNodes[i][j])
-                delete allNodes[i][j];
+            auto begin    = std::chrono::steady_clock::now();
+            bool found    = _searcher.search(mode, *snapshot, query.first, query.second, false, cells);
+            auto end      = std::chrono::steady_clock::now();
+            int  expanded = _searcher.getLastExpandedNodes();
+
+            double micros = std::chrono::duration<double, std::micro>(end - begin).count();
+            totalMicros += micros;
+            totalExpanded += expanded;
+            result.maxMicros = std::max(result.maxMicros, micros);
+
+            if (found)
+            {
+                result.found++;
+                for (size_t i = 1; i < cells.size(); ++i)
+                {
+                    bool diagonal = cells[i].x != cells[i - 1].x && cells[i].y != cells[i - 1].y;
+                    totalCost += diagonal ? 14 : 10;
+                }
+            }
         }
+
+        result.avgMicros   = totalMicros / queryCount;
+        result.avgExpanded = totalExpanded / queryCount;
+        result.avgPathCost = result.found > 0 ? totalCost / result.found : 0.0;
+        results.push_back(result);
+
+        CCLOG("🧭 寻路基准 [%s] 查询=%d, 找到=%d, 平均=%.1fus, 最大=%.1fus, 平均扩展=%.0f, 平均代价=%.1f",
+              getModeName(mode).c_str(), result.queries, result.found, result.avgMicros, result.maxMicros,
+              result.avgExpanded, result.avgPathCost);
     }
 
-    return path;
-}
\ No newline at end of file
+    return results;
+}
+
+void PathFinder::restoreCache(const PathCache& cache)
+{
+    PathCacheStats stats = _cache.getStats();
+    _cache               = cache;
+    _cache.getStats()    = stats;
+}
+
+void PathFinder::logCacheStats() const
+{
+    const PathCacheStats& stats = _cache.getStats();
+    CCLOG("🧭 寻路缓存: 查询=%llu, 命中=%llu, 部分复用=%llu, 未命中=%llu, 淘汰=%llu, 失效=%llu, 命中率=%.1f%%, "
+          "复用率=%.1f%%",
+          static_cast<unsigned long long>(stats.lookups), static_cast<unsigned long long>(stats.hits),
+          static_cast<unsigned long long>(stats.partialHits), static_cast<unsigned long long>(stats.misses),
+          static_cast<unsigned long long>(stats.evictions), static_cast<unsigned long long>(stats.invalidations),
+          stats.getHitRate() * 100.0f, stats.getReuseRate() * 100.0f);
+}
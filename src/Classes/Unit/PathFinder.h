@@ -11,33 +11,34 @@
 #define __PATH_FINDER_H__
 
 #include "GridMap.h"
+#include "GridPathSearcher.h"
+#include "PathCache.h"
 #include "cocos2d.h"
 
+#include <string>
 #include <vector>
 
 /**
- * @struct PathNode
- * @brief 寻路节点
+ * @struct PathBenchmarkResult
+ * @brief 单个寻路模式的基准测试结果
  */
-struct PathNode
+struct PathBenchmarkResult
 {
-    int x, y;              ///< 节点坐标
-    int gCost;             ///< 起点到当前节点的代价
-    int hCost;             ///< 当前节点到终点的估算代价
-    PathNode* parent;      ///< 父节点
-
-    /** @brief 获取总代价 */
-    int fCost() const { return gCost + hCost; }
-
-    /** @brief 比较运算符 */
-    bool operator>(const PathNode& other) const { return fCost() > other.fCost(); }
-
-    PathNode(int _x, int _y) : x(_x), y(_y), gCost(0), hCost(0), parent(nullptr) {}
+    PathfindingMode mode        = PathfindingMode::kAStar; ///< 搜索模式
+    int             queries     = 0;                       ///< 查询次数
+    int             found       = 0;                       ///< 找到路径的次数
+    double          avgMicros   = 0.0;                     ///< 平均耗时（微秒）
+    double          maxMicros   = 0.0;                     ///< 最大耗时（微秒）
+    double          avgExpanded = 0.0;                     ///< 平均扩展节点数
+    double          avgPathCost = 0.0;                     ///< 平均路径代价（直线10，斜线14）
 };
 
 /**
  * @class PathFinder
  * @brief A*寻路器（单例）
+ *
+ * 寻路结果按 (起点格子, 终点格子, 碰撞地图版本) 缓存，GridMap::markArea 会使缓存失效。
+ * 起点不同但靠近已缓存路径时，直接从最近的可见格子汇入该路径，避免重复 A*。
  */
 class PathFinder
 {
@@ -59,8 +60,104 @@ public:
     std::vector<cocos2d::Vec2> findPath(GridMap* gridMap, const cocos2d::Vec2& startWorldUnit,
                                         const cocos2d::Vec2& endWorldTarget, bool ignoreWalls = false);
 
+    // --- 搜索模式 ---
+
+    /**
+     * @brief 设置网格搜索算法（会清空路径缓存）
+     * @param mode 搜索模式
+     */
+    void setMode(PathfindingMode mode);
+
+    /** @brief 获取网格搜索算法 */
+    PathfindingMode getMode() const { return _mode; }
+
+    /** @brief 设置 HPA* 区块边长（格子） */
+    void setClusterSize(int clusterSize) { _searcher.setClusterSize(clusterSize); }
+
+    /** @brief 获取模式名称 */
+    static std::string getModeName(PathfindingMode mode);
+
+    /**
+     * @brief 在同一组随机查询上对比各搜索模式
+     * @param gridMap 网格地图
+     * @param queryCount 查询数量
+     * @param seed 随机种子（相同种子生成相同的查询）
+     * @return std::vector<PathBenchmarkResult> 每个模式一条结果，第一条为 A* 基准
+     * @note 不经过路径缓存，也不做路径平滑，只测量网格搜索本身
+     */
+    std::vector<PathBenchmarkResult> benchmarkModes(GridMap* gridMap, int queryCount, unsigned int seed);
+
+    // --- 路径缓存 ---
+
+    /** @brief 启用或禁用路径缓存 */
+    void setCacheEnabled(bool enabled) { _cacheEnabled = enabled; }
+
+    /** @brief 路径缓存是否启用 */
+    bool isCacheEnabled() const { return _cacheEnabled; }
+
+    /** @brief 设置缓存容量（条目数） */
+    void setCacheCapacity(size_t capacity) { _cache.setCapacity(capacity); }
+
+    /** @brief 设置部分路径复用的汇入半径（格子），0 表示关闭部分复用 */
+    void setJoinRadius(int radius) { _joinRadius = radius; }
+
+    /** @brief 清空路径缓存 */
+    void clearCache() { _cache.clear(); }
+
+    /** @brief 获取路径缓存（回放关键帧保存） */
+    const PathCache& getCache() const { return _cache; }
+
+    /**
+     * @brief 恢复路径缓存（回放定位时使用，保留当前的命中统计）
+     * @param cache 关键帧中保存的缓存
+     */
+    void restoreCache(const PathCache& cache);
+
+    /** @brief 获取缓存命中统计 */
+    const PathCacheStats& getCacheStats() const { return _cache.getStats(); }
+
+    /** @brief 重置缓存命中统计 */
+    void resetCacheStats() { _cache.resetStats(); }
+
+    /** @brief 输出缓存命中统计到日志 */
+    void logCacheStats() const;
+
+    // --- 分步接口（供异步寻路使用：查缓存和收尾在主线程，网格搜索在寻路线程） ---
+
+    /**
+     * @brief 计算寻路请求的缓存键
+     * @return bool 起点或终点不在地图内时返回 false
+     */
+    bool makeCacheKey(GridMap* gridMap, const cocos2d::Vec2& startWorldUnit, const cocos2d::Vec2& endWorldTarget,
+                      bool ignoreWalls, PathCacheKey& outKey);
+
+    /**
+     * @brief 查询路径缓存（完全命中或部分复用）
+     * @param outPath 输出：命中时的世界坐标路径
+     * @return bool 是否命中
+     */
+    bool findCachedPath(GridMap* gridMap, const cocos2d::Vec2& startWorldUnit, const PathCacheKey& key,
+                        std::vector<cocos2d::Vec2>& outPath);
+
+    /**
+     * @brief 将网格搜索结果转换为世界坐标路径并写入缓存
+     * @param snapshotVersion 搜索所用快照的碰撞版本号，与地图当前版本不同时不写入缓存
+     * @param cells 搜索得到的格子路径，空表示不可达
+     */
+    std::vector<cocos2d::Vec2> completePath(GridMap* gridMap, const cocos2d::Vec2& startWorldUnit,
+                                            const PathCacheKey& key, unsigned int snapshotVersion,
+                                            const std::vector<GridCell>& cells);
+
 private:
-    int getDistance(const PathNode* nodeA, const PathNode* nodeB);
+    /**
+     * @brief 将格子路径转换为平滑后的世界坐标路径
+     * @param startWorldUnit 单位真实起点
+     * @param cells 格子路径
+     * @param from 从 cells 的第几个格子开始
+     */
+    std::vector<cocos2d::Vec2> buildWorldPath(GridMap* gridMap, const cocos2d::Vec2& startWorldUnit,
+                                              const std::vector<GridCell>& cells, size_t from, bool ignoreWalls);
+
     bool isValid(int x, int y, int width, int height);
 
     /**
@@ -74,6 +171,12 @@ private:
     std::vector<cocos2d::Vec2> smoothPath(GridMap* gridMap, const std::vector<cocos2d::Vec2>& rawPath,
                                           bool ignoreWalls);
 
+    PathCache        _cache;                                  ///< 路径缓存
+    bool             _cacheEnabled = true;                    ///< 是否启用路径缓存
+    int              _joinRadius   = 2;                       ///< 部分路径复用的汇入半径（格子）
+    PathfindingMode  _mode         = PathfindingMode::kAStar; ///< 当前搜索模式
+    GridPathSearcher _searcher;                               ///< 主线程使用的网格搜索器
+
     PathFinder() = default;
     ~PathFinder() = default;
     PathFinder(const PathFinder&) = delete;
@@ -0,0 +1,87 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     UnitAnimationLibrary.cpp
+ * File Function: 单位动画库实现
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#include "UnitAnimationLibrary.h"
+
+USING_NS_CC;
+
+constexpr int UnitAnimationSet::kFacingCount;
+constexpr int UnitAnimationSet::kSlotCount;
+
+// ==================== UnitAnimationSet ====================
+
+UnitAnimationSet::~UnitAnimationSet()
+{
+    for (auto* anim : _slots)
+    {
+        CC_SAFE_RELEASE(anim);
+    }
+}
+
+void UnitAnimationSet::set(UnitAction action, UnitAnimFacing facing, Animation* anim)
+{
+    Animation*& slot = _slots[slotOf(action, facing)];
+    CC_SAFE_RETAIN(anim);
+    CC_SAFE_RELEASE(slot);
+    slot = anim;
+}
+
+int UnitAnimationSet::getAnimationCount() const
+{
+    int count = 0;
+    for (auto* anim : _slots)
+    {
+        if (anim)
+            count++;
+    }
+    return count;
+}
+
+int UnitAnimationSet::getFrameCount() const
+{
+    int count = 0;
+    for (auto* anim : _slots)
+    {
+        if (anim)
+            count += static_cast<int>(anim->getFrames().size());
+    }
+    return count;
+}
+
+// ==================== UnitAnimationLibrary ====================
+
+UnitAnimationLibrary& UnitAnimationLibrary::getInstance()
+{
+    static UnitAnimationLibrary instance;
+    return instance;
+}
+
+const UnitAnimationSet* UnitAnimationLibrary::find(UnitType type, int level) const
+{
+    auto it = _sets.find(Key(type, level));
+    return it != _sets.end() ? it->second.get() : nullptr;
+}
+
+UnitAnimationSet& UnitAnimationLibrary::create(UnitType type, int level)
+{
+    auto& set = _sets[Key(type, level)];
+    set.reset(new UnitAnimationSet());
+    return *set;
+}
+
+void UnitAnimationLibrary::logStats() const
+{
+    int animations = 0;
+    int frames     = 0;
+    for (const auto& pair : _sets)
+    {
+        animations += pair.second->getAnimationCount();
+        frames += pair.second->getFrameCount();
+    }
+    CCLOG("🎞️ 单位动画库: %zu 组, %d 个动画, %d 帧（所有单位实例共享）", _sets.size(), animations, frames);
+}
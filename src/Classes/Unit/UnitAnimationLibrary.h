@@ -0,0 +1,107 @@
+﻿/****************************************************************
+ * Project Name:  Clash_of_Clans
+ * File Name:     UnitAnimationLibrary.h
+ * File Function: 单位动画库 - 同类型同等级的单位共享一份动画，按动作/朝向枚举下标查找
+ * Author:        赵崇治
+ * Update Date:   2026/10/18
+ * License:       MIT License
+ ****************************************************************/
+#ifndef UNIT_ANIMATION_LIBRARY_H_
+#define UNIT_ANIMATION_LIBRARY_H_
+
+#include "Unit/UnitTypes.h"
+#include "cocos2d.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <utility>
+
+/**
+ * @class UnitAnimationSet
+ * @brief 一种单位（类型 + 等级）的全部动画，按 动作 x 朝向 的下标存放
+ * @note 死亡动画不区分方向，存放在 UnitAnimFacing::kRight
+ */
+class UnitAnimationSet {
+ public:
+    static constexpr int kFacingCount = static_cast<int>(UnitAnimFacing::kCount);           ///< 朝向数量
+    static constexpr int kSlotCount   = (static_cast<int>(UnitAction::kDeath) + 1) * kFacingCount;  ///< 槽位数量
+
+    UnitAnimationSet() = default;
+    ~UnitAnimationSet();
+
+    UnitAnimationSet(const UnitAnimationSet&) = delete;
+    UnitAnimationSet& operator=(const UnitAnimationSet&) = delete;
+
+    /**
+     * @brief 获取动画
+     * @param action 动作
+     * @param facing 素材朝向
+     * @return cocos2d::Animation* 动画，未加载时返回 nullptr
+     */
+    cocos2d::Animation* get(UnitAction action, UnitAnimFacing facing) const { return _slots[slotOf(action, facing)]; }
+
+    /**
+     * @brief 设置动画（持有引用，替换已有的动画）
+     * @param action 动作
+     * @param facing 素材朝向
+     * @param anim 动画
+     */
+    void set(UnitAction action, UnitAnimFacing facing, cocos2d::Animation* anim);
+
+    /** @brief 已加载的动画数 */
+    int getAnimationCount() const;
+
+    /** @brief 已加载的动画帧总数 */
+    int getFrameCount() const;
+
+ private:
+    static int slotOf(UnitAction action, UnitAnimFacing facing) {
+        return static_cast<int>(action) * kFacingCount + static_cast<int>(facing);
+    }
+
+    std::array<cocos2d::Animation*, kSlotCount> _slots{};  ///< 槽位 -> 动画
+};
+
+/**
+ * @class UnitAnimationLibrary
+ * @brief 全局单位动画库（单例）
+ *
+ * 每种 类型 + 等级 的动画在第一次创建该单位时构建（战斗加载时对象池预热即会触发），
+ * 之后的实例直接引用同一份 Animation，不再重复创建动画帧或查询纹理缓存。
+ */
+class UnitAnimationLibrary {
+ public:
+    static UnitAnimationLibrary& getInstance();
+
+    /**
+     * @brief 查找已构建的动画集
+     * @param type 单位类型
+     * @param level 单位等级
+     * @return const UnitAnimationSet* 动画集，尚未构建时返回 nullptr
+     */
+    const UnitAnimationSet* find(UnitType type, int level) const;
+
+    /**
+     * @brief 创建空的动画集，由第一个该类型的单位在 loadAnimations 中填充
+     * @param type 单位类型
+     * @param level 单位等级
+     * @return UnitAnimationSet& 动画集（已存在时先清空）
+     */
+    UnitAnimationSet& create(UnitType type, int level);
+
+    /** @brief 释放全部动画 */
+    void clear() { _sets.clear(); }
+
+    /** @brief 输出已构建的动画集和帧数 */
+    void logStats() const;
+
+ private:
+    UnitAnimationLibrary() = default;
+
+    using Key = std::pair<UnitType, int>;
+
+    std::map<Key, std::unique_ptr<UnitAnimationSet>> _sets;  ///< (类型, 等级) -> 动画集
+};
+
+#endif  // UNIT_ANIMATION_LIBRARY_H_
@@ -13,8 +13,13 @@
 #include "GoblinUnit.h"
 #include "WallBreakerUnit.h"
 
+#include "Managers/FrameProfiler.h"
+
 BaseUnit* UnitFactory::createUnit(UnitType type, int level)
 {
+    // 单个单位的创建耗时（首个实例包含共享动画的构建）
+    PROFILE_SCOPE("UnitFactory::createUnit");
+
     switch (type)
     {
     case UnitType::kBarbarian:
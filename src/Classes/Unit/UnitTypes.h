@@ -49,4 +49,15 @@ enum class UnitDirection {
     kUpLeft      ///< 左上
 };
 
+/**
+ * @enum UnitAnimFacing
+ * @brief 动画素材朝向（向左的方向由向右的素材水平翻转得到，上/下分别复用右上/右下）
+ */
+enum class UnitAnimFacing {
+    kRight,      ///< 右
+    kUpRight,    ///< 右上
+    kDownRight,  ///< 右下
+    kCount       ///< 朝向数量
+};
+
 #endif  // UNIT_TYPES_H_
\ No newline at end of file
@@ -51,17 +51,24 @@ void WallBreakerUnit::loadAnimations() {
   }
 
   // 加载跑步动画
-  addAnimFromFrames("wall_breaker", "run_down_right", 49, 56, 0.10f);
-  addAnimFromFrames("wall_breaker", "run_right", 41, 48, 0.10f);
-  addAnimFromFrames("wall_breaker", "run_up_right", 33, 40, 0.10f);
+  addAnimFromFrames("wall_breaker", UnitAction::kRun,
+                    UnitAnimFacing::kDownRight, 49, 56, 0.10f);
+  addAnimFromFrames("wall_breaker", UnitAction::kRun, UnitAnimFacing::kRight,
+                    41, 48, 0.10f);
+  addAnimFromFrames("wall_breaker", UnitAction::kRun, UnitAnimFacing::kUpRight,
+                    33, 40, 0.10f);
 
   // 加载待机动画
-  addAnimFromFrames("wall_breaker", "idle_down_right", 27, 27, 1.0f);
-  addAnimFromFrames("wall_breaker", "idle_right", 21, 21, 1.0f);
-  addAnimFromFrames("wall_breaker", "idle_up_right", 20, 20, 1.0f);
+  addAnimFromFrames("wall_breaker", UnitAction::kIdle,
+                    UnitAnimFacing::kDownRight, 27, 27, 1.0f);
+  addAnimFromFrames("wall_breaker", UnitAction::kIdle, UnitAnimFacing::kRight,
+                    21, 21, 1.0f);
+  addAnimFromFrames("wall_breaker", UnitAction::kIdle, UnitAnimFacing::kUpRight,
+                    20, 20, 1.0f);
 
   // 加载死亡动画（爆炸）
-  addAnimFromFrames("wall_breaker", "death", 2, 1, 0.5f);
+  addAnimFromFrames("wall_breaker", UnitAction::kDeath, UnitAnimFacing::kRight,
+                    2, 1, 0.5f);
 
   // 播放待机动画
   playAnimation(UnitAction::kIdle, UnitDirection::kRight);
@@ -96,9 +103,10 @@ void WallBreakerUnit::onDeathBefore() {
   // 创建爆炸视觉效果
   createExplosionEffect();
 
-  // 延迟后移除自身
-  auto removeAction =
-      Sequence::create(DelayTime::create(0.5f), RemoveSelf::create(), nullptr);
+  // 延迟后移除自身（走基类的移除流程，标记等待移除后才能被对象池回收）
+  auto removeAction = Sequence::create(
+      DelayTime::create(0.5f), CallFunc::create([this]() { finishRemoval(); }),
+      nullptr);
   this->runAction(removeAction);
 
   CCLOG("💣 炸弹人爆炸！");
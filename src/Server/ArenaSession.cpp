@@ -172,7 +172,11 @@ void ArenaSession::HandlePvpAction(SOCKET client_socket,
         
         auto it = sessions_.find(player_id);
         if (it != sessions_.end() && it->second.isActive) {
-            // 记录操作历史
+            // 记录操作历史；首次部署时攻击方的战斗计时开始
+            if (!it->second.battleStarted) {
+                it->second.battleStarted = true;
+                it->second.battleStartTime = std::chrono::steady_clock::now();
+            }
             it->second.actionHistory.push_back(action_data);
             
             defender_id = it->second.defenderId;
@@ -252,10 +256,12 @@ void ArenaSession::HandleSpectateRequest(SOCKET client_socket,
                 map_data = pair.second.mapData;
                 history = pair.second.actionHistory;
 
-                // 计算已进行时间
-                auto now = std::chrono::steady_clock::now();
-                elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    now - pair.second.startTime).count();
+                // 计算已进行时间（从首次部署算起，不含攻击方的准备阶段）
+                if (pair.second.battleStarted) {
+                    auto now = std::chrono::steady_clock::now();
+                    elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now - pair.second.battleStartTime).count();
+                }
 
                 // 添加观战者（防止重复）
                 auto& spectators = pair.second.spectatorIds;
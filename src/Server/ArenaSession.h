@@ -86,7 +86,8 @@ class ArenaSession {
      * 记录攻击者的操作到历史记录，并同步到防守方和所有观战者。
      * 如果发送者不是活跃战斗的攻击者，操作将被忽略。
      *
-     * 操作数据格式："{elapsedMs},{unitType},{x},{y}"
+     * 操作数据格式："{unitType},{x},{y}[,{checksumFrame},{checksum},{frame}]"
+     * 首次操作的到达时间记为战斗计时起点。
      *
      * @param client_socket 发送操作的客户端套接字
      * @param action_data 操作数据
@@ -104,6 +105,7 @@ class ArenaSession {
      *
      * 成功响应格式：
      * "1|{attackerId}|{defenderId}|{elapsedMs}|{mapData}[[[HISTORY]]]{actions}"
+     * elapsedMs 从首次部署算起（尚未部署时为 0），与客户端战斗计时一致。
      *
      * 失败响应格式：
      * "0|||0|"
@@ -72,7 +72,8 @@ struct AttackRecord {
  * 地图数据、操作历史和观战者列表。用于实现实时战斗同步和观战功能。
  *
  * @note 以攻击者ID为键存储在 ArenaSession 或 ClanWarSession 中。
- * @note actionHistory 中的每条记录格式为 "elapsedMs;unitType|x|y"。
+ * @note actionHistory 中的每条记录格式为 "unitType,x,y[,checksumFrame,checksum,frame]"，
+ *       frame 是攻击方执行该操作的模拟帧，观战者据此在原帧重放。
  *
  * @see ArenaSession
  * @see ClanWarSession
@@ -90,7 +91,9 @@ struct PvpSession {
     std::vector<std::string> actionHistory;  ///< 操作历史记录，用于观战同步
 
     // 会话状态
-    std::chrono::steady_clock::time_point startTime;  ///< 战斗开始时间点
+    std::chrono::steady_clock::time_point startTime;  ///< 会话创建时间点（含攻击方准备阶段）
+    std::chrono::steady_clock::time_point battleStartTime;  ///< 首次部署的时间点（战斗计时起点）
+    bool battleStarted = false;  ///< 是否已收到首次部署
     bool isActive = true;        ///< 会话是否活跃（false 表示战斗已结束）
 };
 